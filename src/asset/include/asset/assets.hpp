@@ -1,17 +1,22 @@
 #pragma once
+#include "asset/budget.hpp"
 #include "asset/event.hpp"
 #include "asset/handle.hpp"
 #include "asset/id.hpp"
 #include "asset/io.hpp"
 #include "asset/loader.hpp"
 #include "asset/path.hpp"
+#include "asset/unused_queue.hpp"
 #include "base/log.hpp"
 #include "base/optional.hpp"
 #include "ecs/event.hpp"
 #include "ecs/system_params.hpp"
 #include "refl/type.hpp"
 
+#include <algorithm>
 #include <concepts>
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -37,7 +42,8 @@ class Assets {
   public:
     struct Entry {
         AssetId id;
-        std::shared_ptr<AssetHandleState> handle_state;
+        // Owned by the handles; expires once the last of them is dropped.
+        std::weak_ptr<AssetHandleState> handle_state;
         Optional<AssetPath> path;
         TypeId type_id;
         std::unique_ptr<T> asset;
@@ -60,12 +66,15 @@ class Assets {
     TypeId m_type_id;
     std::vector<AssetEvent<T>> m_event_queue;
     std::vector<AsyncLoadResult> m_pending_async_results;
+    AssetBudget<T> m_apply_budget;
     std::shared_ptr<AssetsState<T>> m_state;
+    std::shared_ptr<UnusedAssetQueue> m_unused;
 
   public:
     Assets(std::unique_ptr<AssetLoader<T>> loader) :
         m_loader(std::move(loader)), m_type_id(type_id<T>()),
-        m_state(std::make_shared<AssetsState<T>>()) {
+        m_state(std::make_shared<AssetsState<T>>()),
+        m_unused(std::make_shared<UnusedAssetQueue>()) {
         m_state->assets = this;
     }
     ~Assets() {
@@ -82,7 +91,9 @@ class Assets {
         m_type_id(other.m_type_id),
         m_event_queue(std::move(other.m_event_queue)),
         m_pending_async_results(std::move(other.m_pending_async_results)),
-        m_state(std::move(other.m_state)) {
+        m_apply_budget(std::move(other.m_apply_budget)),
+        m_state(std::move(other.m_state)),
+        m_unused(std::move(other.m_unused)) {
         if (m_state) {
             m_state->assets = this;
         }
@@ -96,7 +107,9 @@ class Assets {
             m_type_id = other.m_type_id;
             m_event_queue = std::move(other.m_event_queue);
             m_pending_async_results = std::move(other.m_pending_async_results);
+            m_apply_budget = std::move(other.m_apply_budget);
             m_state = std::move(other.m_state);
+            m_unused = std::move(other.m_unused);
             if (m_state) {
                 m_state->assets = this;
             }
@@ -142,11 +155,10 @@ class Assets {
     Handle<T> add_failed(AssetLoadError error) {
         AssetId id = m_next_id++;
         auto path = error.path;
-        auto handle_state = std::make_shared<AssetHandleState>(id);
-        auto handle = Handle<T>(handle_state);
+        auto handle = Handle<T>(make_handle_state(id));
         m_assets[id] = {
             .id = id,
-            .handle_state = std::move(handle_state),
+            .handle_state = handle.m_state,
             .path = std::move(path),
             .type_id = m_type_id,
             .asset = nullptr,
@@ -169,11 +181,10 @@ class Assets {
         }
 
         AssetId id = m_next_id++;
-        auto handle_state = std::make_shared<AssetHandleState>(id);
-        auto handle = Handle<T>(handle_state);
+        auto handle = Handle<T>(make_handle_state(id));
         m_assets[id] = {
             .id = id,
-            .handle_state = std::move(handle_state),
+            .handle_state = handle.m_state,
             .path = path,
             .type_id = m_type_id,
             .asset = nullptr,
@@ -239,6 +250,15 @@ class Assets {
         return true;
     }
 
+    // Limits how many finished async loads apply_async_loads turns into
+    // assets per frame; the rest wait for the next frame.
+    AssetBudget<T>& apply_budget() { return m_apply_budget; }
+    const AssetBudget<T>& apply_budget() const { return m_apply_budget; }
+
+    std::size_t pending_async_load_count() const {
+        return m_pending_async_results.size();
+    }
+
     void enqueue_async_load_result(
         AssetId id,
         AssetLoadResult<T> result,
@@ -269,6 +289,12 @@ class Assets {
         return nullopt;
     }
 
+    // Observes `handle` without keeping it alive. Expires once the last
+    // handle is gone, before the entry itself is collected.
+    static std::weak_ptr<AssetHandleState> watch(const Handle<T>& handle) {
+        return handle.m_state;
+    }
+
     template<typename... Args>
     Handle<T> emplace(Args&&... args) {
         return add(std::make_unique<T>(std::forward<Args>(args)...));
@@ -379,27 +405,35 @@ class Assets {
 
     std::shared_ptr<AssetsState<T>> state() { return m_state; }
 
+    // Unloads the entries whose last handle was dropped since the previous
+    // call. Only those candidates are visited, not every entry.
     std::size_t unload_unused() {
-        std::vector<AssetId> unused;
-        for (auto& [id, entry] : m_assets) {
-            if (!has_external_handles(entry)) {
-                unused.push_back(id);
+        std::vector<AssetId> candidates;
+        m_unused->take(candidates);
+
+        std::size_t unloaded = 0;
+        for (auto id : candidates) {
+            auto entry = get_entry(id);
+            // Already unloaded, or handed out again since the drop.
+            if (!entry || has_external_handles(*entry)) {
+                continue;
             }
-        }
-
-        for (auto id : unused) {
             unload(id);
+            ++unloaded;
         }
-
-        return unused.size();
+        return unloaded;
     }
 
     static void apply_async_loads(ResRW<Assets<T>> assets) {
         std::vector<AsyncLoadResult> pending;
         pending.swap(assets->m_pending_async_results);
 
-        for (auto& result : pending) {
+        AssetBudgetMeter meter(assets->m_apply_budget);
+        std::size_t applied = 0;
+        for (; applied < pending.size() && !meter.exhausted(); ++applied) {
+            auto& result = pending[applied];
             if (!result.result) {
+                meter.consume();
                 assets->fail_loading(
                     result.id,
                     std::move(result.result).error()
@@ -407,12 +441,28 @@ class Assets {
                 continue;
             }
 
+            auto asset = std::move(result.result).value();
+            if (asset) {
+                meter.consume(*asset);
+            } else {
+                meter.consume();
+            }
             assets->finish_loading(
                 result.id,
-                std::move(result.result).value(),
+                std::move(asset),
                 std::move(result.dependencies)
             );
         }
+
+        // Leftovers keep their place ahead of results queued meanwhile.
+        if (applied < pending.size()) {
+            pending.erase(pending.begin(), pending.begin() + applied);
+            std::ranges::move(
+                assets->m_pending_async_results,
+                std::back_inserter(pending)
+            );
+            assets->m_pending_async_results = std::move(pending);
+        }
     }
 
     static void collect_unused(ResRW<Assets<T>> assets) {
@@ -434,11 +484,10 @@ class Assets {
         std::vector<AssetKey> dependencies = {}
     ) {
         AssetId id = m_next_id++;
-        auto handle_state = std::make_shared<AssetHandleState>(id);
-        auto handle = Handle<T>(handle_state);
+        auto handle = Handle<T>(make_handle_state(id));
         m_assets[id] = {
             .id = id,
-            .handle_state = std::move(handle_state),
+            .handle_state = handle.m_state,
             .path = std::move(path),
             .type_id = m_type_id,
             .asset = std::move(asset),
@@ -459,12 +508,22 @@ class Assets {
         return handle;
     }
 
+    std::shared_ptr<AssetHandleState> make_handle_state(AssetId id) {
+        return UnusedAssetQueue::make_state(m_unused, id);
+    }
+
     Handle<T> make_handle(Entry& entry) {
-        return Handle<T>(entry.handle_state);
+        if (auto state = entry.handle_state.lock()) {
+            return Handle<T>(std::move(state));
+        }
+        // Every handle was dropped but the entry has not been collected yet.
+        auto handle = Handle<T>(make_handle_state(entry.id));
+        entry.handle_state = handle.m_state;
+        return handle;
     }
 
     static bool has_external_handles(const Entry& entry) {
-        return entry.handle_state && entry.handle_state.use_count() > 1;
+        return !entry.handle_state.expired();
     }
 
     void erase_cache_entry(const Entry& entry) {
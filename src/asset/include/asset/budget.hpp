@@ -0,0 +1,70 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+namespace fei {
+
+// Per-frame allowance for applying or preparing assets of type T. Zero
+// limits are unlimited, which is the default. Work past the budget carries
+// over to the next frame.
+template<typename T>
+struct AssetBudget {
+    std::size_t max_count {0};
+    std::size_t max_bytes {0};
+    std::chrono::microseconds max_time {0};
+    // Cost of one asset against max_bytes; without it assets cost nothing.
+    std::function<std::size_t(const T&)> byte_size;
+};
+
+// Meters one frame of work against an AssetBudget. The first item always
+// fits, so an asset larger than the whole budget still makes progress.
+// Skipped items only spend time.
+template<typename T>
+class AssetBudgetMeter {
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    const AssetBudget<T>& m_budget;
+    Clock::time_point m_start;
+    std::size_t m_count {0};
+    std::size_t m_bytes {0};
+    std::size_t m_skipped {0};
+
+  public:
+    explicit AssetBudgetMeter(const AssetBudget<T>& budget) :
+        m_budget(budget), m_start(Clock::now()) {}
+
+    bool exhausted() const {
+        if (m_count == 0 && m_skipped == 0) {
+            return false;
+        }
+        if (m_budget.max_count > 0 && m_count >= m_budget.max_count) {
+            return true;
+        }
+        if (m_budget.max_bytes > 0 && m_bytes >= m_budget.max_bytes) {
+            return true;
+        }
+        return m_budget.max_time.count() > 0 &&
+               Clock::now() - m_start >= m_budget.max_time;
+    }
+
+    // Counts an item that produced no asset, such as a failed load.
+    void consume() { ++m_count; }
+
+    // Counts an item that was tried but is not ready yet, such as an asset
+    // whose dependencies are still loading.
+    void skip() { ++m_skipped; }
+
+    void consume(const T& asset) {
+        ++m_count;
+        if (m_budget.byte_size) {
+            m_bytes += m_budget.byte_size(asset);
+        }
+    }
+
+    std::size_t count() const { return m_count; }
+    std::size_t bytes() const { return m_bytes; }
+};
+
+} // namespace fei
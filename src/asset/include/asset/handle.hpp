@@ -11,6 +11,8 @@ class Assets;
 
 struct AssetHandleState {
     AssetId id {invalid_asset_id};
+    // Links the state into an UnusedAssetQueue once its last handle is gone.
+    AssetHandleState* next_unused {nullptr};
 };
 
 template<typename T>
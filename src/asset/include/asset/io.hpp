@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <memory>
 #include <span>
 #include <string>
 #include <string_view>
@@ -10,6 +11,8 @@
 
 namespace fei {
 
+class MappedFile;
+
 struct ReaderError {
     std::filesystem::path path;
     std::string message;
@@ -17,13 +20,18 @@ struct ReaderError {
     ReaderError(std::filesystem::path path, std::string message);
 };
 
+// Read-only view over asset bytes. The bytes are either borrowed, owned, or
+// a shared read-only file mapping; copies of a mapped reader share the
+// mapping, so they stay valid on whichever task outlives the others.
 class Reader {
   private:
     std::vector<std::byte> m_buffer;
+    std::shared_ptr<const MappedFile> m_mapping;
     std::span<const std::byte> m_data;
     bool m_owns_data {false};
 
     explicit Reader(std::vector<std::byte> buffer);
+    explicit Reader(std::shared_ptr<const MappedFile> mapping);
 
     void bind_owned_data();
 
@@ -37,9 +45,16 @@ class Reader {
 
     static Result<Reader, ReaderError>
     from_file(const std::filesystem::path& path);
+    // Maps the file instead of reading it, falling back to from_file() when
+    // the file cannot be mapped. The file must not be truncated while a
+    // reader over it is alive.
+    static Result<Reader, ReaderError>
+    map_file(const std::filesystem::path& path);
 
     const std::byte* data() const;
     std::size_t size() const;
+    std::span<const std::byte> bytes() const { return m_data; }
+    bool is_mapped() const { return m_mapping != nullptr; }
     std::string_view as_string_view() const;
     std::string as_string() const;
 };
@@ -0,0 +1,94 @@
+#pragma once
+#include "asset/handle.hpp"
+#include "base/types.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fei {
+
+class TaskPool;
+
+enum class AssetLoadPriority : uint8 {
+    Background,
+    Normal,
+    High,
+    Critical,
+};
+
+struct AssetLoadQueueStats {
+    // Waiting for a free slot of their source.
+    std::size_t queued {0};
+    // Handed to the task pool and not finished yet.
+    std::size_t in_flight {0};
+    // Totals since the queue was created.
+    std::size_t completed {0};
+    std::size_t cancelled {0};
+};
+
+struct AssetLoadJob {
+    AssetLoadPriority priority {AssetLoadPriority::Normal};
+    // The handle state of the asset being loaded. Assets drops its own
+    // reference once no handle is left, after which the job is skipped.
+    std::weak_ptr<AssetHandleState> handle;
+    // Runs on a worker and returns what to apply on the main thread.
+    std::function<std::function<void()>()> work;
+};
+
+// Async loads waiting for the task pool, one queue per asset source. Each
+// source runs at most its concurrency limit of loads at a time, highest
+// priority first and in submission order within a priority. Critical loads
+// start right away regardless of the limit. Finished loads start the next
+// queued one straight from the worker.
+class AssetLoadQueue : public std::enable_shared_from_this<AssetLoadQueue> {
+  private:
+    struct QueuedJob {
+        AssetLoadJob job;
+        std::size_t sequence {0};
+    };
+
+    struct SourceQueue {
+        // Binary heap with the highest priority, then oldest, job on top.
+        std::vector<QueuedJob> jobs;
+        // 0 runs one load per task pool thread.
+        std::size_t limit {0};
+        AssetLoadQueueStats stats;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, SourceQueue> m_sources;
+    TaskPool* m_pool {nullptr};
+    std::size_t m_next_sequence {0};
+
+  public:
+    AssetLoadQueue() = default;
+
+    AssetLoadQueue(const AssetLoadQueue&) = delete;
+    AssetLoadQueue& operator=(const AssetLoadQueue&) = delete;
+    AssetLoadQueue(AssetLoadQueue&&) = delete;
+    AssetLoadQueue& operator=(AssetLoadQueue&&) = delete;
+
+    // Queues `job` for `source` and starts it on `pool` if a slot is free.
+    // The queue must be owned by a shared_ptr, which in-flight loads keep.
+    void push(TaskPool& pool, const std::string& source, AssetLoadJob job);
+
+    // Caps the loads `source` runs at once; 0 means one per pool thread.
+    void set_concurrency_limit(const std::string& source, std::size_t limit);
+
+    AssetLoadQueueStats stats() const;
+    AssetLoadQueueStats stats(const std::string& source) const;
+
+  private:
+    // Starts queued jobs of `source` while it has free slots. Expects
+    // m_mutex to be held.
+    void dispatch(const std::string& source, SourceQueue& queue);
+    void finish(const std::string& source, bool cancelled);
+    std::size_t limit_of(const SourceQueue& queue) const;
+};
+
+} // namespace fei
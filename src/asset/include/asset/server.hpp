@@ -1,6 +1,7 @@
 #pragma once
 #include "app/app.hpp"
 #include "asset/assets.hpp"
+#include "asset/load_queue.hpp"
 #include "asset/loader.hpp"
 #include "asset/path.hpp"
 #include "asset/request.hpp"
@@ -39,6 +40,9 @@ class AssetServer {
     App* m_app;
     std::unordered_map<std::string, std::unique_ptr<AssetSource>> m_sources;
     std::unordered_map<TypeId, AssetTypeAccess> m_asset_types;
+    std::shared_ptr<AssetLoadQueue> m_load_queue {
+        std::make_shared<AssetLoadQueue>()
+    };
 
   public:
     AssetServer(App* app) : m_app(app) {}
@@ -136,6 +140,17 @@ class AssetServer {
 
     template<typename T>
     Handle<T> load_async(const AssetPath& path) {
+        return load_async_with_priority<T>(path, AssetLoadPriority::Normal);
+    }
+
+    // Queues the load behind the other loads of its source; higher
+    // priorities start first. Loads whose handles are all dropped and
+    // collected before they start are skipped.
+    template<typename T>
+    Handle<T> load_async_with_priority(
+        const AssetPath& path,
+        AssetLoadPriority priority
+    ) {
         if (!m_app->has_resource<Assets<T>>()) {
             fatal("No asset found for type: {}", type_name<T>());
         }
@@ -186,74 +201,96 @@ class AssetServer {
             AssetLoadResult<T> result;
             std::vector<AssetKey> dependencies;
         };
-        m_app->resource<Tasks>().general().submit(
-            [source, loader, source_name, path, load_requests]() mutable
-                -> LoadTaskResult {
-                auto reader = source->try_get_reader(path.path());
-                if (!reader) {
-                    return {
-                        .result = failure(AssetLoadError(
-                            path,
-                            "Failed to read asset from source '" + source_name +
-                                "': " + reader.error()
-                        )),
-                        .dependencies = {},
-                    };
-                }
-
-                if (load_requests) {
-                    AsyncLoadContext context(std::move(load_requests), path);
-                    auto result = loader->load(*reader, context);
-                    auto dependencies = context.dependencies();
-                    return {
-                        .result = std::move(result),
-                        .dependencies = std::move(dependencies),
-                    };
-                }
+        auto load = [source, loader, source_name, path, load_requests]()
+            -> LoadTaskResult {
+            auto reader = source->try_get_reader(path.path());
+            if (!reader) {
+                return {
+                    .result = failure(AssetLoadError(
+                        path,
+                        "Failed to read asset from source '" + source_name +
+                            "': " + reader.error()
+                    )),
+                    .dependencies = {},
+                };
+            }
 
-                LoadContext context(path);
+            if (load_requests) {
+                AsyncLoadContext context(load_requests, path);
                 auto result = loader->load(*reader, context);
                 auto dependencies = context.dependencies();
                 return {
                     .result = std::move(result),
                     .dependencies = std::move(dependencies),
                 };
-            },
-            [assets_state,
-             id,
-             path](TaskResult<LoadTaskResult> result) mutable {
-                if (!assets_state || !assets_state->assets) {
-                    return;
-                }
+            }
 
-                auto& assets = *assets_state->assets;
-                try {
-                    auto load_result = std::move(result).value();
-                    assets.enqueue_async_load_result(
-                        id,
-                        std::move(load_result.result),
-                        std::move(load_result.dependencies)
-                    );
-                } catch (const std::exception& error) {
-                    assets.enqueue_async_load_result(
-                        id,
-                        failure(AssetLoadError(path, error.what()))
-                    );
-                } catch (...) {
-                    assets.enqueue_async_load_result(
-                        id,
-                        failure(AssetLoadError(
-                            path,
-                            "Unknown async asset load error"
-                        ))
-                    );
-                }
+            LoadContext context(path);
+            auto result = loader->load(*reader, context);
+            auto dependencies = context.dependencies();
+            return {
+                .result = std::move(result),
+                .dependencies = std::move(dependencies),
+            };
+        };
+        m_load_queue->push(
+            m_app->resource<Tasks>().general(),
+            source_name,
+            AssetLoadJob {
+                .priority = priority,
+                .handle = Assets<T>::watch(handle),
+                .work = [load, assets_state, id, path]()
+                    -> std::function<void()> {
+                    std::shared_ptr<LoadTaskResult> loaded;
+                    std::string error;
+                    try {
+                        loaded = std::make_shared<LoadTaskResult>(load());
+                    } catch (const std::exception& exception) {
+                        error = exception.what();
+                    } catch (...) {
+                        error = "Unknown async asset load error";
+                    }
+
+                    return [assets_state, id, path, loaded, error]() {
+                        if (!assets_state || !assets_state->assets) {
+                            return;
+                        }
+
+                        auto& assets = *assets_state->assets;
+                        if (!loaded) {
+                            assets.enqueue_async_load_result(
+                                id,
+                                failure(AssetLoadError(path, error))
+                            );
+                            return;
+                        }
+                        assets.enqueue_async_load_result(
+                            id,
+                            std::move(loaded->result),
+                            std::move(loaded->dependencies)
+                        );
+                    };
+                },
             }
         );
 
         return std::move(handle);
     }
 
+    // Caps how many loads from `source` run at once; 0 restores the default
+    // of one per task pool thread. Critical loads ignore the cap.
+    void set_load_concurrency(const std::string& source, std::size_t limit) {
+        m_load_queue->set_concurrency_limit(source, limit);
+    }
+
+    AssetLoadQueueStats load_queue_stats() const {
+        return m_load_queue->stats();
+    }
+
+    AssetLoadQueueStats load_queue_stats(const std::string& source) const {
+        return m_load_queue->stats(source);
+    }
+
     template<typename T>
     Handle<T> add_asset(std::unique_ptr<T> asset) {
         if (!m_app->has_resource<Assets<T>>()) {
@@ -589,7 +626,13 @@ Handle<T> AssetLoadRequestSender::load(const AssetPath& path) {
         Request {
             .process =
                 [pending, path](AssetServer& server) mutable {
-                    auto result = server.template load_async<T>(path);
+                    // The requesting load holds a slot of its source while
+                    // it waits, so its dependencies must not queue behind
+                    // the concurrency limit.
+                    auto result = server.template load_async_with_priority<T>(
+                        path,
+                        AssetLoadPriority::Critical
+                    );
                     {
                         std::scoped_lock state_lock(pending->mutex);
                         pending->result = std::move(result);
@@ -0,0 +1,41 @@
+#pragma once
+#include "asset/handle.hpp"
+#include "asset/id.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace fei {
+
+// Handle states whose last handle has been dropped, pushed from whichever
+// thread dropped it. Producers link states in with a single CAS and the
+// owner only ever takes the whole list at once, so the stack needs no lock
+// and pushes never allocate.
+class UnusedAssetQueue {
+  private:
+    std::atomic<AssetHandleState*> m_head {nullptr};
+
+  public:
+    UnusedAssetQueue() = default;
+    ~UnusedAssetQueue();
+
+    UnusedAssetQueue(const UnusedAssetQueue&) = delete;
+    UnusedAssetQueue& operator=(const UnusedAssetQueue&) = delete;
+
+    // Takes ownership of `state`. Safe to call from any thread.
+    void push(AssetHandleState* state);
+
+    // Appends the ids of every state pushed so far to `ids` and frees the
+    // states. Ids may repeat if an asset was handed out and dropped again.
+    void take(std::vector<AssetId>& ids);
+
+    bool empty() const;
+
+    // A handle state for `id` that is pushed onto `queue` instead of being
+    // deleted when its last owner goes away.
+    static std::shared_ptr<AssetHandleState>
+    make_state(const std::shared_ptr<UnusedAssetQueue>& queue, AssetId id);
+};
+
+} // namespace fei
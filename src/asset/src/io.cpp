@@ -1,5 +1,7 @@
 #include "asset/io.hpp"
 
+#include "base/mapped_file.hpp"
+
 #include <cstring>
 #include <fstream>
 #include <utility>
@@ -14,6 +16,9 @@ Reader::Reader(std::vector<std::byte> buffer) :
     bind_owned_data();
 }
 
+Reader::Reader(std::shared_ptr<const MappedFile> mapping) :
+    m_mapping(std::move(mapping)), m_data(m_mapping->bytes()) {}
+
 void Reader::bind_owned_data() {
     if (m_owns_data) {
         m_data = m_buffer;
@@ -32,13 +37,14 @@ Reader::Reader(std::string_view text) {
 }
 
 Reader::Reader(const Reader& other) :
-    m_buffer(other.m_buffer), m_data(other.m_data),
+    m_buffer(other.m_buffer), m_mapping(other.m_mapping), m_data(other.m_data),
     m_owns_data(other.m_owns_data) {
     bind_owned_data();
 }
 
 Reader::Reader(Reader&& other) noexcept :
-    m_buffer(std::move(other.m_buffer)), m_data(other.m_data),
+    m_buffer(std::move(other.m_buffer)), m_mapping(std::move(other.m_mapping)),
+    m_data(other.m_data),
     m_owns_data(other.m_owns_data) {
     bind_owned_data();
     other.m_data = {};
@@ -50,6 +56,7 @@ Reader& Reader::operator=(const Reader& other) {
         return *this;
     }
     m_buffer = other.m_buffer;
+    m_mapping = other.m_mapping;
     m_data = other.m_data;
     m_owns_data = other.m_owns_data;
     bind_owned_data();
@@ -61,6 +68,7 @@ Reader& Reader::operator=(Reader&& other) noexcept {
         return *this;
     }
     m_buffer = std::move(other.m_buffer);
+    m_mapping = std::move(other.m_mapping);
     m_data = other.m_data;
     m_owns_data = other.m_owns_data;
     bind_owned_data();
@@ -108,6 +116,15 @@ Reader::from_file(const std::filesystem::path& path) {
     return Reader(std::move(buffer));
 }
 
+Result<Reader, ReaderError>
+Reader::map_file(const std::filesystem::path& path) {
+    auto mapping = MappedFile::open(path);
+    if (!mapping) {
+        return from_file(path);
+    }
+    return Reader(std::make_shared<const MappedFile>(std::move(*mapping)));
+}
+
 const std::byte* Reader::data() const {
     return m_data.data();
 }
@@ -0,0 +1,140 @@
+#include "asset/load_queue.hpp"
+
+#include "base/log.hpp"
+#include "task/task_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace fei {
+
+namespace {
+
+// std::push_heap keeps the greatest element on top, so "less" means lower
+// priority or submitted later.
+template<typename QueuedJob>
+bool runs_after(const QueuedJob& lhs, const QueuedJob& rhs) {
+    if (lhs.job.priority != rhs.job.priority) {
+        return lhs.job.priority < rhs.job.priority;
+    }
+    return lhs.sequence > rhs.sequence;
+}
+
+} // namespace
+
+void AssetLoadQueue::push(
+    TaskPool& pool,
+    const std::string& source,
+    AssetLoadJob job
+) {
+    std::scoped_lock lock(m_mutex);
+    m_pool = &pool;
+    auto& queue = m_sources[source];
+    queue.jobs.push_back(
+        QueuedJob {
+            .job = std::move(job),
+            .sequence = m_next_sequence++,
+        }
+    );
+    std::ranges::push_heap(queue.jobs, runs_after<QueuedJob>);
+    ++queue.stats.queued;
+    dispatch(source, queue);
+}
+
+void AssetLoadQueue::set_concurrency_limit(
+    const std::string& source,
+    std::size_t limit
+) {
+    std::scoped_lock lock(m_mutex);
+    auto& queue = m_sources[source];
+    queue.limit = limit;
+    if (m_pool) {
+        dispatch(source, queue);
+    }
+}
+
+AssetLoadQueueStats AssetLoadQueue::stats() const {
+    std::scoped_lock lock(m_mutex);
+    AssetLoadQueueStats total;
+    for (const auto& [name, queue] : m_sources) {
+        total.queued += queue.stats.queued;
+        total.in_flight += queue.stats.in_flight;
+        total.completed += queue.stats.completed;
+        total.cancelled += queue.stats.cancelled;
+    }
+    return total;
+}
+
+AssetLoadQueueStats AssetLoadQueue::stats(const std::string& source) const {
+    std::scoped_lock lock(m_mutex);
+    auto it = m_sources.find(source);
+    if (it == m_sources.end()) {
+        return {};
+    }
+    return it->second.stats;
+}
+
+void AssetLoadQueue::dispatch(const std::string& source, SourceQueue& queue) {
+    while (!queue.jobs.empty() &&
+           (queue.stats.in_flight < limit_of(queue) ||
+            queue.jobs.front().job.priority == AssetLoadPriority::Critical)) {
+        std::ranges::pop_heap(queue.jobs, runs_after<QueuedJob>);
+        auto job = std::move(queue.jobs.back().job);
+        queue.jobs.pop_back();
+        --queue.stats.queued;
+        if (job.handle.expired()) {
+            ++queue.stats.cancelled;
+            continue;
+        }
+
+        ++queue.stats.in_flight;
+        m_pool->submit(
+            [self = shared_from_this(),
+             source,
+             job = std::move(job)]() mutable -> std::function<void()> {
+                if (job.handle.expired()) {
+                    self->finish(source, true);
+                    return {};
+                }
+                try {
+                    auto apply = job.work();
+                    self->finish(source, false);
+                    return apply;
+                } catch (...) {
+                    self->finish(source, false);
+                    throw;
+                }
+            },
+            [](TaskResult<std::function<void()>> result) {
+                if (!result) {
+                    warn("Async asset load threw past its job");
+                    return;
+                }
+                if (auto& apply = result.value()) {
+                    apply();
+                }
+            }
+        );
+    }
+}
+
+void AssetLoadQueue::finish(const std::string& source, bool cancelled) {
+    std::scoped_lock lock(m_mutex);
+    auto& queue = m_sources[source];
+    --queue.stats.in_flight;
+    if (cancelled) {
+        ++queue.stats.cancelled;
+    } else {
+        ++queue.stats.completed;
+    }
+    dispatch(source, queue);
+}
+
+std::size_t AssetLoadQueue::limit_of(const SourceQueue& queue) const {
+    if (queue.limit > 0) {
+        return queue.limit;
+    }
+    return std::max<std::size_t>(1, m_pool->thread_count());
+}
+
+} // namespace fei
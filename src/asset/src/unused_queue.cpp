@@ -0,0 +1,47 @@
+#include "asset/unused_queue.hpp"
+
+namespace fei {
+
+UnusedAssetQueue::~UnusedAssetQueue() {
+    std::vector<AssetId> ids;
+    take(ids);
+}
+
+void UnusedAssetQueue::push(AssetHandleState* state) {
+    auto* head = m_head.load(std::memory_order_relaxed);
+    do {
+        state->next_unused = head;
+    } while (!m_head.compare_exchange_weak(
+        head,
+        state,
+        std::memory_order_release,
+        std::memory_order_relaxed
+    ));
+}
+
+void UnusedAssetQueue::take(std::vector<AssetId>& ids) {
+    auto* state = m_head.exchange(nullptr, std::memory_order_acquire);
+    while (state) {
+        ids.push_back(state->id);
+        auto* next = state->next_unused;
+        delete state;
+        state = next;
+    }
+}
+
+bool UnusedAssetQueue::empty() const {
+    return m_head.load(std::memory_order_relaxed) == nullptr;
+}
+
+std::shared_ptr<AssetHandleState> UnusedAssetQueue::make_state(
+    const std::shared_ptr<UnusedAssetQueue>& queue,
+    AssetId id
+) {
+    // The deleter keeps the queue alive for handles that outlive Assets.
+    return std::shared_ptr<AssetHandleState>(
+        new AssetHandleState {.id = id},
+        [queue](AssetHandleState* state) { queue->push(state); }
+    );
+}
+
+} // namespace fei
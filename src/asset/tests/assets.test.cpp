@@ -12,8 +12,11 @@
 #include <catch2/catch_test_macros.hpp>
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 using namespace fei;
 
@@ -167,6 +170,70 @@ TEST_CASE("Handle copies and moves keep assets alive", "[asset][handle]") {
     REQUIRE(asset->value == 3);
 }
 
+TEST_CASE(
+    "Assets only collect entries whose handles were dropped",
+    "[asset][handle]"
+) {
+    Assets<TestAsset> assets(nullptr);
+    std::vector<Handle<TestAsset>> kept;
+    for (int i = 0; i < 8; ++i) {
+        kept.push_back(assets.emplace(TestAsset {.value = i}));
+    }
+    auto dropped_id = assets.emplace(TestAsset {.value = 8}).id();
+
+    REQUIRE(assets.unload_unused() == 1);
+    REQUIRE_FALSE(assets.load_state(dropped_id).has_value());
+    REQUIRE(assets.unload_unused() == 0);
+    for (const auto& handle : kept) {
+        REQUIRE(assets.get(handle).has_value());
+    }
+}
+
+TEST_CASE(
+    "Assets collect handles dropped on other threads",
+    "[asset][handle]"
+) {
+    Assets<TestAsset> assets(nullptr);
+    auto handle = assets.emplace(TestAsset {.value = 4});
+    auto id = handle.id();
+
+    std::thread([dropped = std::move(handle)]() mutable {
+        dropped = {};
+    }).join();
+
+    REQUIRE(assets.unload_unused() == 1);
+    REQUIRE_FALSE(assets.load_state(id).has_value());
+}
+
+TEST_CASE(
+    "Assets keep entries handed out again before collection",
+    "[asset][handle]"
+) {
+    CountingLoader::load_count = 0;
+
+    App app;
+    AssetServer server(&app);
+    Assets<TestAsset> assets(std::make_unique<CountingLoader>());
+    static constexpr std::array<std::byte, 1> bytes = {std::byte {1}};
+    SyncLoadContext context(server, AssetPath("memory://asset.bin"));
+
+    AssetId first_id = 0;
+    {
+        auto reader = reader_for(bytes);
+        first_id = assets.load(reader, context).id();
+    }
+    auto reader = reader_for(bytes);
+    auto again = assets.load(reader, context);
+
+    REQUIRE(again.id() == first_id);
+    REQUIRE(CountingLoader::load_count == 1);
+    REQUIRE(assets.unload_unused() == 0);
+    REQUIRE(assets.get(again)->value == 1);
+
+    again = {};
+    REQUIRE(assets.unload_unused() == 1);
+}
+
 TEST_CASE("Default handles are invalid", "[asset][handle]") {
     Handle<TestAsset> handle;
 
@@ -259,3 +326,34 @@ TEST_CASE("Assets load stores loader errors", "[asset][loader]") {
     REQUIRE(error->path.as_string() == "memory://asset.bin");
     REQUIRE(error->message == "test loader failed");
 }
+
+TEST_CASE(
+    "Assets apply async loads within their per-frame budget",
+    "[asset][budget]"
+) {
+    World world;
+    auto& assets = world.add_resource(Assets<TestAsset>(nullptr));
+    assets.apply_budget().max_count = 2;
+
+    std::vector<Handle<TestAsset>> handles;
+    for (int i = 0; i < 5; ++i) {
+        auto path = AssetPath("memory://asset" + std::to_string(i) + ".bin");
+        handles.push_back(assets.reserve_loading(path));
+        assets.enqueue_async_load_result(
+            handles.back().id(),
+            std::make_unique<TestAsset>(TestAsset {.value = i})
+        );
+    }
+
+    world.run_system_once(Assets<TestAsset>::apply_async_loads);
+    REQUIRE(assets.get(handles[1]).has_value());
+    REQUIRE_FALSE(assets.get(handles[2]).has_value());
+    REQUIRE(assets.pending_async_load_count() == 3);
+
+    world.run_system_once(Assets<TestAsset>::apply_async_loads);
+    world.run_system_once(Assets<TestAsset>::apply_async_loads);
+    REQUIRE(assets.pending_async_load_count() == 0);
+    for (int i = 0; i < 5; ++i) {
+        REQUIRE(assets.get(handles[i])->value == i);
+    }
+}
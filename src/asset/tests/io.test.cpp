@@ -61,3 +61,36 @@ TEST_CASE("Reader from_file returns errors", "[asset][io]") {
     REQUIRE(reader.error().path == path);
     REQUIRE(reader.error().message.contains("Failed to open file"));
 }
+
+TEST_CASE("Reader map_file shares the mapping across copies", "[asset][io]") {
+    auto path = reader_test_path("fei-reader-mapped.bin");
+    std::filesystem::remove(path);
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "mapped data";
+    }
+
+    {
+        auto reader = Reader::map_file(path);
+        REQUIRE(reader);
+        REQUIRE(reader->is_mapped());
+
+        Reader copied = *reader;
+        Reader moved = std::move(*reader);
+        REQUIRE(copied.data() == moved.data());
+        REQUIRE(copied.as_string_view() == "mapped data");
+        REQUIRE(moved.bytes().size() == 11);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Reader map_file returns errors", "[asset][io]") {
+    auto path = reader_test_path("fei-reader-mapped-missing.bin");
+    std::filesystem::remove(path);
+
+    auto reader = Reader::map_file(path);
+
+    REQUIRE_FALSE(reader);
+    REQUIRE(reader.error().message.contains("Failed to open file"));
+}
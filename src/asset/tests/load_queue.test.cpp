@@ -0,0 +1,175 @@
+#include "asset/load_queue.hpp"
+
+#include "asset/handle.hpp"
+#include "task/task_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace fei;
+using namespace std::chrono_literals;
+
+namespace {
+
+template<typename Done>
+void drain_until(TaskPool& pool, Done done) {
+    for (int i = 0; i < 1000 && !done(); ++i) {
+        pool.drain_completions();
+        std::this_thread::sleep_for(1ms);
+    }
+    REQUIRE(done());
+}
+
+// Occupies a slot until the returned promise is set.
+std::promise<void> push_blocker(
+    AssetLoadQueue& queue,
+    TaskPool& pool,
+    const std::shared_ptr<AssetHandleState>& handle
+) {
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    queue.push(
+        pool,
+        "memory",
+        AssetLoadJob {
+            .priority = AssetLoadPriority::Normal,
+            .handle = handle,
+            .work = [released]() -> std::function<void()> {
+                released.wait();
+                return {};
+            },
+        }
+    );
+    return release;
+}
+
+} // namespace
+
+TEST_CASE(
+    "AssetLoadQueue starts higher priorities first",
+    "[asset][load-queue]"
+) {
+    TaskPool pool(1);
+    auto queue = std::make_shared<AssetLoadQueue>();
+    queue->set_concurrency_limit("memory", 1);
+    auto handle = std::make_shared<AssetHandleState>(AssetId {1});
+
+    auto release = push_blocker(*queue, pool, handle);
+    std::mutex mutex;
+    std::vector<int> order;
+    for (auto [priority, value] : {
+             std::pair {AssetLoadPriority::Background, 0},
+             std::pair {AssetLoadPriority::High, 2},
+             std::pair {AssetLoadPriority::Normal, 1},
+             std::pair {AssetLoadPriority::High, 3},
+         }) {
+        queue->push(
+            pool,
+            "memory",
+            AssetLoadJob {
+                .priority = priority,
+                .handle = handle,
+                .work = [&mutex, &order, value]() -> std::function<void()> {
+                    std::scoped_lock lock(mutex);
+                    order.push_back(value);
+                    return {};
+                },
+            }
+        );
+    }
+
+    auto stats = queue->stats("memory");
+    REQUIRE(stats.queued == 4);
+    REQUIRE(stats.in_flight == 1);
+
+    release.set_value();
+    drain_until(pool, [&]() {
+        return queue->stats().completed == 5;
+    });
+    REQUIRE(order == std::vector {2, 3, 1, 0});
+    REQUIRE(queue->stats().queued == 0);
+    REQUIRE(queue->stats().in_flight == 0);
+}
+
+TEST_CASE(
+    "AssetLoadQueue skips loads whose handles expired",
+    "[asset][load-queue]"
+) {
+    TaskPool pool(1);
+    auto queue = std::make_shared<AssetLoadQueue>();
+    queue->set_concurrency_limit("memory", 1);
+    auto blocker = std::make_shared<AssetHandleState>(AssetId {1});
+    auto dropped = std::make_shared<AssetHandleState>(AssetId {2});
+
+    auto release = push_blocker(*queue, pool, blocker);
+    bool ran = false;
+    queue->push(
+        pool,
+        "memory",
+        AssetLoadJob {
+            .priority = AssetLoadPriority::Normal,
+            .handle = dropped,
+            .work = [&ran]() -> std::function<void()> {
+                ran = true;
+                return {};
+            },
+        }
+    );
+    dropped.reset();
+
+    release.set_value();
+    drain_until(pool, [&]() {
+        auto stats = queue->stats("memory");
+        return stats.completed == 1 && stats.cancelled == 1;
+    });
+    REQUIRE_FALSE(ran);
+}
+
+TEST_CASE(
+    "AssetLoadQueue caps concurrent loads per source",
+    "[asset][load-queue]"
+) {
+    TaskPool pool(4);
+    auto queue = std::make_shared<AssetLoadQueue>();
+    queue->set_concurrency_limit("memory", 2);
+    auto handle = std::make_shared<AssetHandleState>(AssetId {1});
+
+    std::atomic<int> running = 0;
+    std::atomic<int> peak = 0;
+    int applied = 0;
+    for (int i = 0; i < 8; ++i) {
+        queue->push(
+            pool,
+            "memory",
+            AssetLoadJob {
+                .priority = AssetLoadPriority::Normal,
+                .handle = handle,
+                .work = [&running, &peak, &applied]() -> std::function<void()> {
+                    auto now = ++running;
+                    auto seen = peak.load();
+                    while (now > seen && !peak.compare_exchange_weak(seen, now))
+                    {
+                    }
+                    std::this_thread::sleep_for(2ms);
+                    --running;
+                    return [&applied]() {
+                        ++applied;
+                    };
+                },
+            }
+        );
+    }
+
+    drain_until(pool, [&]() {
+        return applied == 8;
+    });
+    REQUIRE(peak.load() <= 2);
+    REQUIRE(queue->stats("memory").completed == 8);
+    REQUIRE(queue->stats("other").completed == 0);
+}
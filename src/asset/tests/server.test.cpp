@@ -636,8 +636,13 @@ TEST_CASE(
     app.run_schedule(PostUpdate);
     REQUIRE_FALSE(assets.load_state(id).has_value());
 
+    // The load is skipped if it had not started yet, else its result is
+    // dropped.
     run_post_update_until(app, [&]() {
-        return ServerLoader::load_count.load() == 1;
+        auto stats = app.resource<AssetServer>().load_queue_stats("memory");
+        return stats.completed + stats.cancelled == 1 && stats.in_flight == 0;
     });
+    app.run_schedule(PostUpdate);
+    REQUIRE(ServerLoader::load_count.load() <= 1);
     REQUIRE_FALSE(assets.load_state(id).has_value());
 }
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace fei {
+
+// Read-only memory mapping of a whole file. Empty files map to an empty span.
+class MappedFile {
+  private:
+    const std::byte* m_data {nullptr};
+    std::size_t m_size {0};
+#if defined(_WIN32)
+    void* m_file {nullptr};
+    void* m_mapping {nullptr};
+#endif
+
+    void close();
+
+  public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    static std::optional<MappedFile> open(const std::filesystem::path& path);
+
+    [[nodiscard]] std::span<const std::byte> bytes() const {
+        return {m_data, m_size};
+    }
+    [[nodiscard]] std::size_t size() const { return m_size; }
+};
+
+} // namespace fei
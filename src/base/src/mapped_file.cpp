@@ -0,0 +1,143 @@
+#include "base/mapped_file.hpp"
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+// NOLINTNEXTLINE(misc-include-cleaner)
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace fei {
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    m_data(std::exchange(other.m_data, nullptr)),
+    m_size(std::exchange(other.m_size, 0))
+#if defined(_WIN32)
+    ,
+    m_file(std::exchange(other.m_file, nullptr)),
+    m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#if defined(_WIN32)
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+std::optional<MappedFile> MappedFile::open(const std::filesystem::path& path) {
+    MappedFile mapped;
+    mapped.m_file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (mapped.m_file == INVALID_HANDLE_VALUE) {
+        mapped.m_file = nullptr;
+        return std::nullopt;
+    }
+    LARGE_INTEGER size {};
+    if (GetFileSizeEx(mapped.m_file, &size) == 0) {
+        return std::nullopt;
+    }
+    mapped.m_size = static_cast<std::size_t>(size.QuadPart);
+    if (mapped.m_size == 0) {
+        return mapped;
+    }
+    mapped.m_mapping = CreateFileMappingW(
+        mapped.m_file,
+        nullptr,
+        PAGE_READONLY,
+        0,
+        0,
+        nullptr
+    );
+    if (mapped.m_mapping == nullptr) {
+        return std::nullopt;
+    }
+    mapped.m_data = static_cast<const std::byte*>(
+        MapViewOfFile(mapped.m_mapping, FILE_MAP_READ, 0, 0, 0)
+    );
+    if (mapped.m_data == nullptr) {
+        return std::nullopt;
+    }
+    return mapped;
+}
+
+void MappedFile::close() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr) {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+
+#else
+
+std::optional<MappedFile> MappedFile::open(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode)) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    MappedFile mapped;
+    mapped.m_size = static_cast<std::size_t>(status.st_size);
+    if (mapped.m_size != 0) {
+        void* data =
+            ::mmap(nullptr, mapped.m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        mapped.m_data = static_cast<const std::byte*>(data);
+    }
+    // The mapping keeps its own reference to the file.
+    ::close(fd);
+    return mapped;
+}
+
+void MappedFile::close() {
+    if (m_data != nullptr) {
+        ::munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+} // namespace fei
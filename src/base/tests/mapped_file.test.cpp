@@ -0,0 +1,59 @@
+#include "base/mapped_file.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <utility>
+
+using namespace fei;
+
+namespace {
+
+std::filesystem::path write_test_file(
+    std::string_view name,
+    std::string_view content
+) {
+    auto root = std::filesystem::current_path() / "build" / "test" /
+                "mapped-file";
+    std::filesystem::create_directories(root);
+    auto path = root / name;
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output << content;
+    return path;
+}
+
+} // namespace
+
+TEST_CASE("MappedFile exposes file contents", "[base][mapped_file]") {
+    auto path = write_test_file("contents.bin", "mapped bytes");
+
+    auto mapped = MappedFile::open(path);
+
+    REQUIRE(mapped);
+    auto bytes = mapped->bytes();
+    REQUIRE(bytes.size() == 12);
+    CHECK(
+        std::string_view(reinterpret_cast<const char*>(bytes.data()), 12) ==
+        "mapped bytes"
+    );
+
+    auto moved = std::move(*mapped);
+    CHECK(moved.size() == 12);
+    CHECK(mapped->bytes().empty());
+}
+
+TEST_CASE(
+    "MappedFile handles empty and missing files",
+    "[base][mapped_file]"
+) {
+    auto empty = MappedFile::open(write_test_file("empty.bin", ""));
+    REQUIRE(empty);
+    CHECK(empty->bytes().empty());
+
+    CHECK_FALSE(MappedFile::open(
+        std::filesystem::current_path() / "build" / "test" / "mapped-file" /
+        "missing.bin"
+    ));
+}
@@ -4,25 +4,42 @@
 #include "asset/loader.hpp"
 #include "asset/plugin.hpp"
 #include "base/bitflags.hpp"
+#include "core/image_mips.hpp"
 #include "graphics/enums.hpp"
 #include "graphics/texture.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 
 namespace fei {
 
 class Image {
   private:
     std::unique_ptr<unsigned char[]> m_data;
+    // Set instead of m_data when the pixels stay inside a (mapped) file.
+    std::shared_ptr<const Reader> m_source;
+    const unsigned char* m_source_data {nullptr};
     TextureDescription m_texture_description;
     std::uint32_t m_channels;
+    std::uint32_t m_data_levels {1};
 
   public:
     Image(
         std::unique_ptr<unsigned char[]> data,
         TextureDescription texture_description,
-        std::uint32_t channels = 0
+        std::uint32_t channels = 0,
+        std::uint32_t data_levels = 1
+    );
+    // Views `data`, which must lie inside `source`, instead of copying it.
+    Image(
+        std::shared_ptr<const Reader> source,
+        std::span<const std::byte> data,
+        TextureDescription texture_description,
+        std::uint32_t channels,
+        std::uint32_t data_levels
     );
 
     static std::unique_ptr<Image> create_empty(
@@ -38,26 +55,98 @@ class Image {
     std::uint32_t height() const { return m_texture_description.height; }
     std::uint32_t channels() const { return m_channels; }
     std::uint32_t depth() const { return m_texture_description.depth; }
-    const unsigned char* data() const { return m_data.get(); }
-    void set_data(std::unique_ptr<unsigned char[]> data) {
+    const unsigned char* data() const {
+        return m_data ? m_data.get() : m_source_data;
+    }
+    void set_data(
+        std::unique_ptr<unsigned char[]> data,
+        std::uint32_t data_levels = 1
+    ) {
         m_data = std::move(data);
+        m_source.reset();
+        m_source_data = nullptr;
+        m_data_levels = data_levels;
+    }
+
+    // Mip levels stored in data(), full resolution first and tightly
+    // packed. The texture may declare more levels for the GPU to fill.
+    std::uint32_t data_levels() const { return m_data_levels; }
+    std::uint32_t level_width(std::uint32_t level) const {
+        return std::max(width() >> level, 1u);
+    }
+    std::uint32_t level_height(std::uint32_t level) const {
+        return std::max(height() >> level, 1u);
+    }
+    // Only 3D textures shrink in depth; other depths count layers.
+    std::uint32_t level_depth(std::uint32_t level) const {
+        if (m_texture_description.texture_type != TextureType::Texture3D) {
+            return depth();
+        }
+        return std::max(depth() >> level, 1u);
+    }
+    std::size_t level_size(std::uint32_t level) const {
+        return texture_data_size(
+            m_texture_description.texture_format,
+            level_width(level),
+            level_height(level),
+            level_depth(level)
+        );
+    }
+    std::size_t level_offset(std::uint32_t level) const {
+        std::size_t offset = 0;
+        for (std::uint32_t i = 0; i < level; ++i) {
+            offset += level_size(i);
+        }
+        return offset;
     }
+    std::size_t data_size() const { return level_offset(m_data_levels); }
+
     const TextureDescription& texture_description() const {
         return m_texture_description;
     }
     TextureDescription& texture_description() { return m_texture_description; }
 };
 
+// Optional processing of images decoded from PNG, HDR and other source
+// formats. Baked image binaries load as they are.
+struct ImageLoadSettings {
+    // Builds the full mip chain instead of leaving it to the GPU.
+    bool generate_mips {false};
+    MipFilter mip_filter {MipFilter::Kaiser};
+    // Block-compresses 8-bit images into ldr_format and float images into
+    // hdr_format, after generating mips.
+    bool compress {false};
+    PixelFormat ldr_format {PixelFormat::Bc7RgbaUnorm};
+    PixelFormat hdr_format {PixelFormat::Bc6hRgbUfloat};
+};
+
 class ImageLoader : public AssetLoader<Image> {
+  private:
+    ImageLoadSettings m_settings;
+
   public:
     AssetLoadResult<Image>
     load(Reader& reader, const LoadContext& context) override;
+
+    // Loads may run on worker threads; set this before loading starts.
+    void set_settings(const ImageLoadSettings& settings) {
+        m_settings = settings;
+    }
+    const ImageLoadSettings& settings() const { return m_settings; }
 };
 
 class ImagePlugin : public Plugin {
+  private:
+    ImageLoadSettings m_settings;
+
   public:
+    explicit ImagePlugin(ImageLoadSettings settings = {}) :
+        m_settings(settings) {}
+
     void setup(App& app) override {
         app.add_plugins(AssetPlugin<Image, ImageLoader> {});
+        static_cast<ImageLoader*>(app.resource<Assets<Image>>().loader())
+            ->set_settings(m_settings);
     }
 };
 
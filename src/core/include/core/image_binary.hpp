@@ -0,0 +1,34 @@
+#pragma once
+#include "asset/io.hpp"
+#include "base/result.hpp"
+#include "core/image.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fei {
+
+// Image in the layout the GPU consumes: a fixed header with the texture
+// description followed by every stored mip level, largest first and
+// tightly packed, compressed formats as 4x4 blocks. Little-endian, with the
+// pixel data 16-byte aligned within the file.
+inline constexpr std::string_view ImageBinaryExtension {"fimg"};
+inline constexpr std::uint32_t ImageBinaryVersion {1};
+
+bool is_image_binary(std::span<const std::byte> bytes);
+
+// Serializes `image` as it is; generate mips and compress beforehand so
+// loading does not have to.
+Result<std::vector<std::byte>, std::string>
+encode_image_binary(const Image& image);
+
+// Returns an image whose pixels view the reader's bytes. The image keeps a
+// copy of the reader alive, which shares a mapped file rather than copying
+// it; a reader that borrows its bytes must outlive the image.
+Result<Image, std::string> decode_image_binary(const Reader& reader);
+
+} // namespace fei
@@ -0,0 +1,27 @@
+#pragma once
+#include "base/result.hpp"
+#include "core/image.hpp"
+#include "graphics/enums.hpp"
+
+#include <memory>
+#include <string>
+
+namespace fei {
+
+// Whether compress_image() can encode into `format`.
+bool is_supported_compression_format(PixelFormat format);
+
+// Encodes every stored level of `image` into the block-compressed `format`,
+// spreading each level's block rows over the worker pool. Targets and the
+// sources they accept:
+//   Bc1, Bc3, Bc7 (unorm or sRGB): R8, Rg8 and Rgba8 images
+//   Bc4: the red channel of R8, Rg8 and Rgba8 images
+//   Bc5: the red and green channels of Rg8 and Rgba8 images
+//   Bc6hRgbUfloat: Rgba32Float images, negative values clamp to 0
+// Bc1 turns texels with alpha below 128 transparent. Bc7 encodes mode 6
+// and Bc6h mode 11 only, the single-region modes, which favour speed and
+// smooth content over the best quality on sharp edges.
+Result<std::unique_ptr<Image>, std::string>
+compress_image(const Image& image, PixelFormat format);
+
+} // namespace fei
@@ -0,0 +1,31 @@
+#pragma once
+#include "base/result.hpp"
+#include "base/types.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace fei {
+
+class Image;
+
+enum class MipFilter : uint8 {
+    // Averages 2x2 texels. Cheapest, and slightly soft.
+    Box,
+    // Kaiser-windowed sinc over 6x6 texels. Keeps distant textures sharper
+    // at the cost of mild ringing around hard edges.
+    Kaiser,
+};
+
+// Number of levels in a full chain for a width x height image, down to 1x1.
+std::uint32_t full_mip_count(std::uint32_t width, std::uint32_t height);
+
+// Returns a copy of the first level of `image` followed by every smaller
+// level down to 1x1, each filtered from the one above. sRGB images are
+// filtered in linear space. Supports 2D R8, Rg8 and Rgba8 unorm, Rgba8
+// sRGB and Rgba32 float images.
+Result<std::unique_ptr<Image>, std::string>
+generate_mips(const Image& image, MipFilter filter);
+
+} // namespace fei
@@ -1,6 +1,8 @@
 #include "core/image.hpp"
 
 #include "asset/io.hpp"
+#include "core/image_binary.hpp"
+#include "core/image_compress.hpp"
 #include "graphics/enums.hpp"
 #include "graphics/texture.hpp"
 
@@ -87,13 +89,31 @@ image_load_error(const LoadContext& context, std::string message) {
 Image::Image(
     std::unique_ptr<unsigned char[]> data,
     TextureDescription texture_description,
-    std::uint32_t channels
+    std::uint32_t channels,
+    std::uint32_t data_levels
 ) :
     m_data(std::move(data)), m_texture_description(texture_description),
     m_channels(
         channels ? channels :
                    pixel_format_channels(texture_description.texture_format)
-    ) {}
+    ),
+    m_data_levels(data_levels) {}
+
+Image::Image(
+    std::shared_ptr<const Reader> source,
+    std::span<const std::byte> data,
+    TextureDescription texture_description,
+    std::uint32_t channels,
+    std::uint32_t data_levels
+) :
+    m_source(std::move(source)),
+    m_source_data(reinterpret_cast<const unsigned char*>(data.data())),
+    m_texture_description(texture_description),
+    m_channels(
+        channels ? channels :
+                   pixel_format_channels(texture_description.texture_format)
+    ),
+    m_data_levels(data_levels) {}
 
 std::unique_ptr<Image> Image::create_empty(
     std::uint32_t width,
@@ -125,8 +145,10 @@ std::unique_ptr<Image> Image::create_empty(
     );
 }
 
+namespace {
+
 AssetLoadResult<Image>
-ImageLoader::load(Reader& reader, const LoadContext& context) {
+load_source_image(Reader& reader, const LoadContext& context) {
     int width = 0;
     int height = 0;
     int channels = 0;
@@ -233,4 +255,43 @@ ImageLoader::load(Reader& reader, const LoadContext& context) {
     );
 }
 
+} // namespace
+
+AssetLoadResult<Image>
+ImageLoader::load(Reader& reader, const LoadContext& context) {
+    if (is_image_binary(reader.bytes())) {
+        auto image = decode_image_binary(reader);
+        if (!image) {
+            return failure(image_load_error(context, std::move(image.error())));
+        }
+        return std::make_unique<Image>(std::move(*image));
+    }
+
+    auto image = load_source_image(reader, context);
+    if (!image) {
+        return image;
+    }
+    if (m_settings.generate_mips && (*image)->data_levels() == 1) {
+        auto mips = generate_mips(**image, m_settings.mip_filter);
+        if (!mips) {
+            return failure(image_load_error(context, std::move(mips.error())));
+        }
+        *image = std::move(*mips);
+    }
+    if (m_settings.compress) {
+        const auto format = (*image)->texture_description().texture_format ==
+                                    PixelFormat::Rgba32Float ?
+                                m_settings.hdr_format :
+                                m_settings.ldr_format;
+        auto compressed = compress_image(**image, format);
+        if (!compressed) {
+            return failure(
+                image_load_error(context, std::move(compressed.error()))
+            );
+        }
+        *image = std::move(*compressed);
+    }
+    return image;
+}
+
 } // namespace fei
@@ -0,0 +1,157 @@
+#include "core/image_binary.hpp"
+
+#include "graphics/enums.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace fei {
+
+namespace {
+
+constexpr std::array<char, 4> image_binary_magic {'F', 'I', 'M', 'G'};
+constexpr std::size_t data_alignment = 16;
+
+struct ImageBinaryHeader {
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint32_t type;
+    std::uint32_t usage;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t depth;
+    std::uint32_t layer;
+    // Levels the texture declares; the file stores the first data_levels.
+    std::uint32_t mip_level;
+    std::uint32_t data_levels;
+    std::uint32_t channels;
+    std::uint64_t data_offset;
+    std::uint64_t data_size;
+};
+static_assert(std::is_trivially_copyable_v<ImageBinaryHeader>);
+static_assert(sizeof(ImageBinaryHeader) == 64);
+
+std::size_t align_data(std::size_t offset) {
+    return (offset + data_alignment - 1) & ~(data_alignment - 1);
+}
+
+template<typename T>
+void append(std::vector<std::byte>& bytes, const T& value) {
+    const auto* data = reinterpret_cast<const std::byte*>(&value);
+    bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+} // namespace
+
+bool is_image_binary(std::span<const std::byte> bytes) {
+    return bytes.size() >= image_binary_magic.size() &&
+           std::memcmp(
+               bytes.data(),
+               image_binary_magic.data(),
+               image_binary_magic.size()
+           ) == 0;
+}
+
+Result<std::vector<std::byte>, std::string>
+encode_image_binary(const Image& image) {
+    if (image.data() == nullptr) {
+        return failure(std::string("Image has no pixel data"));
+    }
+    const auto& description = image.texture_description();
+    const auto data_offset = align_data(sizeof(ImageBinaryHeader));
+    const auto data_size = image.data_size();
+    ImageBinaryHeader header {
+        .magic = image_binary_magic,
+        .version = ImageBinaryVersion,
+        .format = static_cast<std::uint32_t>(description.texture_format),
+        .type = static_cast<std::uint32_t>(description.texture_type),
+        .usage = description.texture_usage.to_raw(),
+        .width = description.width,
+        .height = description.height,
+        .depth = description.depth,
+        .layer = description.layer,
+        .mip_level = std::max(description.mip_level, image.data_levels()),
+        .data_levels = image.data_levels(),
+        .channels = image.channels(),
+        .data_offset = data_offset,
+        .data_size = data_size,
+    };
+
+    std::vector<std::byte> bytes;
+    bytes.reserve(data_offset + data_size);
+    append(bytes, header);
+    bytes.resize(data_offset);
+    const auto* data = reinterpret_cast<const std::byte*>(image.data());
+    bytes.insert(bytes.end(), data, data + data_size);
+    return bytes;
+}
+
+Result<Image, std::string> decode_image_binary(const Reader& reader) {
+    auto owner = std::make_shared<const Reader>(reader);
+    const auto bytes = owner->bytes();
+    if (bytes.size() < sizeof(ImageBinaryHeader) || !is_image_binary(bytes)) {
+        return failure(std::string("Not an image binary"));
+    }
+    ImageBinaryHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.version == 0 || header.version > ImageBinaryVersion) {
+        return failure(
+            "Unsupported image binary version " + std::to_string(header.version)
+        );
+    }
+    if (header.format > static_cast<std::uint32_t>(PixelFormat::EacRg11Snorm) ||
+        get_pixel_format_size(static_cast<PixelFormat>(header.format)) == 0) {
+        return failure(std::string("Image binary has an invalid format"));
+    }
+    if (header.type > static_cast<std::uint32_t>(TextureType::Texture3D) ||
+        header.usage > 0xff) {
+        return failure(
+            std::string("Image binary has an invalid type or usage")
+        );
+    }
+    if (header.width == 0 || header.height == 0 || header.depth == 0 ||
+        header.data_levels == 0 || header.data_levels > header.mip_level ||
+        header.data_levels > 32) {
+        return failure(std::string("Image binary has invalid extents"));
+    }
+    if (header.data_offset < sizeof(ImageBinaryHeader) ||
+        header.data_offset > bytes.size() ||
+        header.data_size > bytes.size() - header.data_offset) {
+        return failure(std::string("Image binary is truncated"));
+    }
+
+    const TextureDescription description {
+        .width = header.width,
+        .height = header.height,
+        .depth = header.depth,
+        .mip_level = header.mip_level,
+        .layer = header.layer,
+        .texture_format = static_cast<PixelFormat>(header.format),
+        .texture_usage = BitFlags<TextureUsage>::from_raw(
+            static_cast<std::uint8_t>(header.usage)
+        ),
+        .texture_type = static_cast<TextureType>(header.type),
+    };
+    const auto data = bytes.subspan(header.data_offset, header.data_size);
+    Image image(
+        std::move(owner),
+        data,
+        description,
+        header.channels,
+        header.data_levels
+    );
+    if (image.data_size() != header.data_size) {
+        return failure(
+            std::string("Image binary data does not match its levels")
+        );
+    }
+    return image;
+}
+
+} // namespace fei
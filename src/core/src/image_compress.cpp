@@ -0,0 +1,644 @@
+#include "core/image_compress.hpp"
+
+#include "task/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace fei {
+
+namespace {
+
+constexpr std::size_t block_row_chunk = 4;
+
+// 4x4 texels in row-major order, clamped to the image edge.
+using ColorBlock = std::array<std::array<std::uint8_t, 4>, 16>;
+using HdrBlock = std::array<std::array<float, 3>, 16>;
+
+// Interpolation weights of BC6H and BC7 4-bit indices, out of 64.
+constexpr std::array<int, 16> weights4 {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+// Packs a 128-bit block least significant bit first.
+class BlockWriter {
+  private:
+    std::array<std::uint64_t, 2> m_words {};
+    std::uint32_t m_position {0};
+
+  public:
+    void put(std::uint64_t value, std::uint32_t bits) {
+        for (std::uint32_t i = 0; i < bits; ++i, ++m_position) {
+            if ((value >> i) & 1) {
+                m_words[m_position / 64] |= std::uint64_t {1}
+                                            << (m_position % 64);
+            }
+        }
+    }
+
+    void store(unsigned char* out) const {
+        std::memcpy(out, m_words.data(), sizeof(m_words));
+    }
+};
+
+template<std::size_t N>
+float distance_squared(
+    const std::array<float, N>& lhs,
+    const std::array<float, N>& rhs
+) {
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < N; ++i) {
+        sum += (lhs[i] - rhs[i]) * (lhs[i] - rhs[i]);
+    }
+    return sum;
+}
+
+// Fits a line through `points` along their principal axis and returns the
+// extreme projections onto it.
+template<std::size_t N>
+std::pair<std::array<float, N>, std::array<float, N>>
+principal_endpoints(std::span<const std::array<float, N>> points) {
+    std::array<float, N> mean {};
+    for (const auto& point : points) {
+        for (std::size_t i = 0; i < N; ++i) {
+            mean[i] += point[i];
+        }
+    }
+    for (auto& value : mean) {
+        value /= static_cast<float>(std::max<std::size_t>(points.size(), 1));
+    }
+
+    std::array<std::array<float, N>, N> covariance {};
+    for (const auto& point : points) {
+        for (std::size_t i = 0; i < N; ++i) {
+            for (std::size_t j = 0; j < N; ++j) {
+                covariance[i][j] += (point[i] - mean[i]) * (point[j] - mean[j]);
+            }
+        }
+    }
+
+    // Power iteration, seeded with the column of the largest variance.
+    std::size_t seed = 0;
+    for (std::size_t i = 1; i < N; ++i) {
+        if (covariance[i][i] > covariance[seed][seed]) {
+            seed = i;
+        }
+    }
+    auto axis = covariance[seed];
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        std::array<float, N> next {};
+        for (std::size_t i = 0; i < N; ++i) {
+            for (std::size_t j = 0; j < N; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+        }
+        float length = 0.0f;
+        for (auto value : next) {
+            length = std::max(length, std::abs(value));
+        }
+        if (length < 1e-12f) {
+            return {mean, mean};
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            axis[i] = next[i] / length;
+        }
+    }
+
+    float axis_length = 0.0f;
+    for (auto value : axis) {
+        axis_length += value * value;
+    }
+    float low = std::numeric_limits<float>::max();
+    float high = std::numeric_limits<float>::lowest();
+    for (const auto& point : points) {
+        float t = 0.0f;
+        for (std::size_t i = 0; i < N; ++i) {
+            t += (point[i] - mean[i]) * axis[i];
+        }
+        low = std::min(low, t);
+        high = std::max(high, t);
+    }
+    std::pair<std::array<float, N>, std::array<float, N>> endpoints;
+    for (std::size_t i = 0; i < N; ++i) {
+        endpoints.first[i] = mean[i] + (axis[i] * low / axis_length);
+        endpoints.second[i] = mean[i] + (axis[i] * high / axis_length);
+    }
+    return endpoints;
+}
+
+template<std::size_t N>
+std::size_t nearest_index(
+    const std::array<float, N>& texel,
+    std::span<const std::array<float, N>> palette
+) {
+    std::size_t best = 0;
+    float best_error = std::numeric_limits<float>::max();
+    for (std::size_t i = 0; i < palette.size(); ++i) {
+        const auto error = distance_squared(texel, palette[i]);
+        if (error < best_error) {
+            best_error = error;
+            best = i;
+        }
+    }
+    return best;
+}
+
+int quantize(float value, int max) {
+    return std::clamp(static_cast<int>(std::lround(value)), 0, max);
+}
+
+std::uint16_t pack_565(const std::array<float, 3>& color) {
+    const auto r = quantize(color[0] * 31.0f / 255.0f, 31);
+    const auto g = quantize(color[1] * 63.0f / 255.0f, 63);
+    const auto b = quantize(color[2] * 31.0f / 255.0f, 31);
+    return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+}
+
+std::array<float, 3> unpack_565(std::uint16_t color) {
+    const int r = (color >> 11) & 31;
+    const int g = (color >> 5) & 63;
+    const int b = color & 31;
+    return {
+        static_cast<float>((r << 3) | (r >> 2)),
+        static_cast<float>((g << 2) | (g >> 4)),
+        static_cast<float>((b << 3) | (b >> 2)),
+    };
+}
+
+// BC1 colour block. With `punch_through` texels with alpha below 128 become
+// transparent, which needs the three-colour mode.
+void encode_bc1_color(
+    const ColorBlock& block,
+    bool punch_through,
+    unsigned char* out
+) {
+    std::array<std::array<float, 3>, 16> texels {};
+    std::array<std::array<float, 3>, 16> opaque {};
+    std::size_t opaque_count = 0;
+    bool transparent = false;
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        texels[i] = {
+            static_cast<float>(block[i][0]),
+            static_cast<float>(block[i][1]),
+            static_cast<float>(block[i][2]),
+        };
+        if (punch_through && block[i][3] < 128) {
+            transparent = true;
+        } else {
+            opaque[opaque_count++] = texels[i];
+        }
+    }
+
+    const auto [low, high] = principal_endpoints<3>(
+        std::span<const std::array<float, 3>>(opaque.data(), opaque_count)
+    );
+    auto color0 = pack_565(high);
+    auto color1 = pack_565(low);
+    // color0 > color1 selects four colours, otherwise three plus transparent.
+    if (transparent ? color0 > color1 : color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    const auto end0 = unpack_565(color0);
+    const auto end1 = unpack_565(color1);
+    std::array<std::array<float, 3>, 4> palette {end0, end1};
+    for (std::size_t c = 0; c < 3; ++c) {
+        if (transparent) {
+            palette[2][c] = (end0[c] + end1[c]) / 2.0f;
+        } else {
+            palette[2][c] = ((2.0f * end0[c]) + end1[c]) / 3.0f;
+            palette[3][c] = (end0[c] + (2.0f * end1[c])) / 3.0f;
+        }
+    }
+
+    std::uint32_t indices = 0;
+    const std::span<const std::array<float, 3>> choices(
+        palette.data(),
+        transparent ? 3 : 4
+    );
+    for (std::size_t i = 0; i < texels.size(); ++i) {
+        const auto index = punch_through && block[i][3] < 128 ?
+                               3 :
+                               nearest_index(texels[i], choices);
+        indices |= static_cast<std::uint32_t>(index) << (i * 2);
+    }
+    std::memcpy(out, &color0, sizeof(color0));
+    std::memcpy(out + 2, &color1, sizeof(color1));
+    std::memcpy(out + 4, &indices, sizeof(indices));
+}
+
+// BC4 block of one channel, also the alpha of BC3 and each half of BC5.
+void encode_bc4(
+    const ColorBlock& block,
+    std::size_t channel,
+    unsigned char* out
+) {
+    int low = 255;
+    int high = 0;
+    for (const auto& texel : block) {
+        low = std::min<int>(low, texel[channel]);
+        high = std::max<int>(high, texel[channel]);
+    }
+    // Distinct endpoints with the larger first select the eight-value mode.
+    std::array<std::array<float, 1>, 8> palette {};
+    for (std::size_t i = 0; i < palette.size(); ++i) {
+        palette[i][0] = static_cast<float>(high);
+    }
+    if (high > low) {
+        palette[1][0] = static_cast<float>(low);
+        for (int i = 2; i < 8; ++i) {
+            palette[static_cast<std::size_t>(i)][0] =
+                static_cast<float>(((8 - i) * high) + ((i - 1) * low)) / 7.0f;
+        }
+    }
+
+    std::uint64_t indices = 0;
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        const std::array<float, 1> value {
+            static_cast<float>(block[i][channel]),
+        };
+        indices |= static_cast<std::uint64_t>(nearest_index<1>(value, palette))
+                   << (i * 3);
+    }
+    out[0] = static_cast<unsigned char>(high);
+    out[1] = static_cast<unsigned char>(high > low ? low : high);
+    for (std::size_t i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+    }
+}
+
+// BC7 mode 6: one subset of 7-bit RGBA endpoints plus a p-bit each, and
+// 4-bit indices.
+void encode_bc7(const ColorBlock& block, unsigned char* out) {
+    std::array<std::array<float, 4>, 16> texels {};
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            texels[i][c] = static_cast<float>(block[i][c]);
+        }
+    }
+    const auto [low, high] = principal_endpoints<4>(texels);
+
+    // Picks the p-bit that lands the endpoint closest to `target`.
+    const auto quantize_endpoint = [](const std::array<float, 4>& target) {
+        std::array<int, 4> best {};
+        int best_pbit = 0;
+        float best_error = std::numeric_limits<float>::max();
+        for (int pbit = 0; pbit < 2; ++pbit) {
+            std::array<int, 4> values {};
+            float error = 0.0f;
+            for (std::size_t c = 0; c < 4; ++c) {
+                values[c] = quantize((target[c] - pbit) / 2.0f, 127);
+                const auto decoded =
+                    static_cast<float>((values[c] << 1) | pbit);
+                error += (decoded - target[c]) * (decoded - target[c]);
+            }
+            if (error < best_error) {
+                best_error = error;
+                best = values;
+                best_pbit = pbit;
+            }
+        }
+        return std::pair {best, best_pbit};
+    };
+    auto [end0, pbit0] = quantize_endpoint(low);
+    auto [end1, pbit1] = quantize_endpoint(high);
+
+    const auto build_palette = [&]() {
+        std::array<std::array<float, 4>, 16> palette {};
+        for (std::size_t i = 0; i < palette.size(); ++i) {
+            for (std::size_t c = 0; c < 4; ++c) {
+                const int e0 = (end0[c] << 1) | pbit0;
+                const int e1 = (end1[c] << 1) | pbit1;
+                palette[i][c] = static_cast<float>(
+                    (((64 - weights4[i]) * e0) + (weights4[i] * e1) + 32) >> 6
+                );
+            }
+        }
+        return palette;
+    };
+    auto palette = build_palette();
+    std::array<std::size_t, 16> indices {};
+    for (std::size_t i = 0; i < texels.size(); ++i) {
+        indices[i] = nearest_index<4>(texels[i], palette);
+    }
+    // The first index drops its top bit, so it must stay below 8.
+    if (indices[0] >= 8) {
+        std::swap(end0, end1);
+        std::swap(pbit0, pbit1);
+        for (auto& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    BlockWriter writer;
+    writer.put(1 << 6, 7);
+    for (std::size_t c = 0; c < 4; ++c) {
+        writer.put(static_cast<std::uint64_t>(end0[c]), 7);
+        writer.put(static_cast<std::uint64_t>(end1[c]), 7);
+    }
+    writer.put(static_cast<std::uint64_t>(pbit0), 1);
+    writer.put(static_cast<std::uint64_t>(pbit1), 1);
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        writer.put(indices[i], i == 0 ? 3 : 4);
+    }
+    writer.store(out);
+}
+
+// Bits of the half float nearest to `value`, clamped to the finite
+// non-negative range BC6H unsigned stores.
+std::uint16_t to_unsigned_half(float value) {
+    if (!(value > 0.0f)) {
+        return 0;
+    }
+    if (value >= 65504.0f) {
+        return 0x7bff;
+    }
+    const auto bits = std::bit_cast<std::uint32_t>(value);
+    const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+    std::uint32_t mantissa = bits & 0x7fffff;
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return 0;
+        }
+        mantissa |= 0x800000;
+        const auto shift = static_cast<std::uint32_t>(14 - exponent);
+        return static_cast<std::uint16_t>(
+            (mantissa >> shift) + ((mantissa >> (shift - 1)) & 1)
+        );
+    }
+    const auto half = (static_cast<std::uint32_t>(exponent) << 10) +
+                      (mantissa >> 13) + ((mantissa >> 12) & 1);
+    return static_cast<std::uint16_t>(std::min<std::uint32_t>(half, 0x7bff));
+}
+
+int unquantize_bc6h(int value) {
+    if (value == 0) {
+        return 0;
+    }
+    if (value == 1023) {
+        return 0xffff;
+    }
+    return ((value << 16) + 0x8000) >> 10;
+}
+
+// BC6H mode 11: one region of 10-bit unsigned endpoints and 4-bit indices.
+// Endpoints interpolate in half float bit space, roughly logarithmic.
+void encode_bc6h(const HdrBlock& block, unsigned char* out) {
+    // Interpolated values finish as value * 31 / 64 half bits.
+    std::array<std::array<float, 3>, 16> halves {};
+    std::array<std::array<float, 3>, 16> scaled {};
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            halves[i][c] = static_cast<float>(to_unsigned_half(block[i][c]));
+            scaled[i][c] = halves[i][c] * 64.0f / 31.0f;
+        }
+    }
+    const auto [low, high] = principal_endpoints<3>(scaled);
+    std::array<int, 3> end0 {};
+    std::array<int, 3> end1 {};
+    for (std::size_t c = 0; c < 3; ++c) {
+        end0[c] = quantize((low[c] - 32.0f) / 64.0f, 1023);
+        end1[c] = quantize((high[c] - 32.0f) / 64.0f, 1023);
+    }
+
+    std::array<std::array<float, 3>, 16> palette {};
+    for (std::size_t i = 0; i < palette.size(); ++i) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            const int value = (((64 - weights4[i]) * unquantize_bc6h(end0[c])) +
+                               (weights4[i] * unquantize_bc6h(end1[c])) + 32) >>
+                              6;
+            palette[i][c] = static_cast<float>((value * 31) >> 6);
+        }
+    }
+    std::array<std::size_t, 16> indices {};
+    for (std::size_t i = 0; i < halves.size(); ++i) {
+        indices[i] = nearest_index<3>(halves[i], palette);
+    }
+    if (indices[0] >= 8) {
+        std::swap(end0, end1);
+        for (auto& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    BlockWriter writer;
+    writer.put(0b00011, 5);
+    for (std::size_t c = 0; c < 3; ++c) {
+        writer.put(static_cast<std::uint64_t>(end0[c]), 10);
+    }
+    for (std::size_t c = 0; c < 3; ++c) {
+        writer.put(static_cast<std::uint64_t>(end1[c]), 10);
+    }
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        writer.put(indices[i], i == 0 ? 3 : 4);
+    }
+    writer.store(out);
+}
+
+struct LevelView {
+    const unsigned char* data {nullptr};
+    std::uint32_t width {0};
+    std::uint32_t height {0};
+    // Bytes per texel: 1, 2 or 4 unorm channels, or 16 for RGBA floats.
+    std::uint32_t texel_size {0};
+};
+
+std::size_t texel_offset(
+    const LevelView& level,
+    std::uint32_t block_x,
+    std::uint32_t block_y,
+    std::size_t i
+) {
+    const auto x = std::min<std::uint32_t>(
+        (block_x * 4) + static_cast<std::uint32_t>(i % 4),
+        level.width - 1
+    );
+    const auto y = std::min<std::uint32_t>(
+        (block_y * 4) + static_cast<std::uint32_t>(i / 4),
+        level.height - 1
+    );
+    return ((std::size_t {y} * level.width) + x) * level.texel_size;
+}
+
+// Missing channels read as in a shader: green and blue 0, alpha 1.
+ColorBlock load_color_block(
+    const LevelView& level,
+    std::uint32_t block_x,
+    std::uint32_t block_y
+) {
+    ColorBlock block {};
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        const auto* texel =
+            level.data + texel_offset(level, block_x, block_y, i);
+        block[i] = {0, 0, 0, 255};
+        for (std::uint32_t c = 0; c < level.texel_size; ++c) {
+            block[i][c] = texel[c];
+        }
+    }
+    return block;
+}
+
+HdrBlock load_hdr_block(
+    const LevelView& level,
+    std::uint32_t block_x,
+    std::uint32_t block_y
+) {
+    HdrBlock block {};
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        std::memcpy(
+            block[i].data(),
+            level.data + texel_offset(level, block_x, block_y, i),
+            sizeof(block[i])
+        );
+    }
+    return block;
+}
+
+void encode_block(
+    PixelFormat format,
+    const LevelView& level,
+    std::uint32_t block_x,
+    std::uint32_t block_y,
+    unsigned char* out
+) {
+    if (format == PixelFormat::Bc6hRgbUfloat) {
+        encode_bc6h(load_hdr_block(level, block_x, block_y), out);
+        return;
+    }
+    const auto block = load_color_block(level, block_x, block_y);
+    switch (format) {
+        case PixelFormat::Bc1RgbaUnorm:
+        case PixelFormat::Bc1RgbaUnormSrgb:
+            encode_bc1_color(block, true, out);
+            break;
+        case PixelFormat::Bc3RgbaUnorm:
+        case PixelFormat::Bc3RgbaUnormSrgb:
+            encode_bc4(block, 3, out);
+            encode_bc1_color(block, false, out + 8);
+            break;
+        case PixelFormat::Bc4RUnorm:
+            encode_bc4(block, 0, out);
+            break;
+        case PixelFormat::Bc5RgUnorm:
+            encode_bc4(block, 0, out);
+            encode_bc4(block, 1, out + 8);
+            break;
+        case PixelFormat::Bc7RgbaUnorm:
+        case PixelFormat::Bc7RgbaUnormSrgb:
+            encode_bc7(block, out);
+            break;
+        default:
+            break;
+    }
+}
+
+// Bytes per texel of the sources `target` accepts from `source`, or 0.
+std::uint32_t source_texel_size(PixelFormat target, PixelFormat source) {
+    if (target == PixelFormat::Bc6hRgbUfloat) {
+        return source == PixelFormat::Rgba32Float ? 16 : 0;
+    }
+    switch (source) {
+        case PixelFormat::R8Unorm:
+            return target == PixelFormat::Bc5RgUnorm ? 0 : 1;
+        case PixelFormat::Rg8Unorm:
+            return 2;
+        case PixelFormat::Rgba8Unorm:
+        case PixelFormat::Rgba8UnormSrgb:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+bool is_supported_compression_format(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::Bc1RgbaUnorm:
+        case PixelFormat::Bc1RgbaUnormSrgb:
+        case PixelFormat::Bc3RgbaUnorm:
+        case PixelFormat::Bc3RgbaUnormSrgb:
+        case PixelFormat::Bc4RUnorm:
+        case PixelFormat::Bc5RgUnorm:
+        case PixelFormat::Bc6hRgbUfloat:
+        case PixelFormat::Bc7RgbaUnorm:
+        case PixelFormat::Bc7RgbaUnormSrgb:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Result<std::unique_ptr<Image>, std::string>
+compress_image(const Image& image, PixelFormat format) {
+    if (!is_supported_compression_format(format)) {
+        return failure(std::string("Unsupported compression format"));
+    }
+    const auto& source_description = image.texture_description();
+    const auto texel_size =
+        source_texel_size(format, source_description.texture_format);
+    if (texel_size == 0) {
+        return failure(
+            std::string("Image format cannot be compressed to the target")
+        );
+    }
+    if (source_description.texture_type != TextureType::Texture2D ||
+        image.depth() != 1 ||
+        source_description.texture_usage.is_set(TextureUsage::Cubemap)) {
+        return failure(std::string("Compression needs a single 2D image"));
+    }
+    if (image.data() == nullptr) {
+        return failure(std::string("Image has no pixel data"));
+    }
+
+    auto description = source_description;
+    description.texture_format = format;
+    auto result = std::make_unique<Image>(
+        nullptr,
+        description,
+        image.channels(),
+        image.data_levels()
+    );
+    auto data = std::make_unique<unsigned char[]>(result->data_size());
+    const auto block_size = get_pixel_format_size(format);
+    for (std::uint32_t i = 0; i < image.data_levels(); ++i) {
+        const LevelView level {
+            .data = image.data() + image.level_offset(i),
+            .width = image.level_width(i),
+            .height = image.level_height(i),
+            .texel_size = texel_size,
+        };
+        const auto blocks_x = (level.width + 3) / 4;
+        const auto blocks_y = (level.height + 3) / 4;
+        auto* out = data.get() + result->level_offset(i);
+        parallel_for(
+            blocks_y,
+            block_row_chunk,
+            [&](std::size_t begin, std::size_t end) {
+                for (auto y = begin; y < end; ++y) {
+                    for (std::uint32_t x = 0; x < blocks_x; ++x) {
+                        encode_block(
+                            format,
+                            level,
+                            x,
+                            static_cast<std::uint32_t>(y),
+                            out + (((y * blocks_x) + x) * block_size)
+                        );
+                    }
+                }
+            }
+        );
+    }
+    result->set_data(std::move(data), image.data_levels());
+    return result;
+}
+
+} // namespace fei
@@ -0,0 +1,279 @@
+#include "core/image_mips.hpp"
+
+#include "core/image.hpp"
+#include "task/parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <span>
+#include <vector>
+
+namespace fei {
+
+namespace {
+
+constexpr std::size_t row_chunk = 16;
+
+// How texels of a supported format map onto floats. channels is 0 for
+// formats generate_mips() does not handle.
+struct MipTexelLayout {
+    std::uint32_t channels {0};
+    bool srgb {false};
+    bool is_float {false};
+};
+
+MipTexelLayout mip_texel_layout(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::R8Unorm:
+            return {.channels = 1};
+        case PixelFormat::Rg8Unorm:
+            return {.channels = 2};
+        case PixelFormat::Rgba8Unorm:
+            return {.channels = 4};
+        case PixelFormat::Rgba8UnormSrgb:
+            return {.channels = 4, .srgb = true};
+        case PixelFormat::Rgba32Float:
+            return {.channels = 4, .is_float = true};
+        default:
+            return {};
+    }
+}
+
+float srgb_to_linear(float value) {
+    return value <= 0.04045f ? value / 12.92f :
+                               std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linear_to_srgb(float value) {
+    return value <= 0.0031308f ?
+               value * 12.92f :
+               (1.055f * std::pow(value, 1.0f / 2.4f)) - 0.055f;
+}
+
+const std::array<float, 256>& srgb_table() {
+    static const auto table = []() {
+        std::array<float, 256> values {};
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            values[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+// Separable downsampling kernel: destination texel x reads source texels
+// 2x + first_tap onwards, clamped to the edge.
+struct MipKernel {
+    int first_tap {0};
+    std::vector<float> weights;
+};
+
+// Modified Bessel function of the first kind, order 0.
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+MipKernel kaiser_kernel() {
+    // Sinc for a 2:1 reduction, windowed over a radius of 3 source texels.
+    constexpr double alpha = 4.0;
+    constexpr double radius = 3.0;
+    MipKernel kernel {.first_tap = -2, .weights = {}};
+    double total = 0.0;
+    for (int tap = 0; tap < 6; ++tap) {
+        const double t = tap - 2.5;
+        const double x = std::numbers::pi * t / 2.0;
+        const double sinc = std::sin(x) / x;
+        const double ratio = t / radius;
+        const double window =
+            bessel_i0(alpha * std::sqrt(1.0 - (ratio * ratio))) /
+            bessel_i0(alpha);
+        kernel.weights.push_back(static_cast<float>(sinc * window));
+        total += sinc * window;
+    }
+    for (auto& weight : kernel.weights) {
+        weight = static_cast<float>(weight / total);
+    }
+    return kernel;
+}
+
+const MipKernel& mip_kernel(MipFilter filter) {
+    static const MipKernel box {.first_tap = 0, .weights = {0.5f, 0.5f}};
+    static const MipKernel kaiser = kaiser_kernel();
+    return filter == MipFilter::Kaiser ? kaiser : box;
+}
+
+std::size_t clamp_tap(std::ptrdiff_t position, std::uint32_t size) {
+    return static_cast<std::size_t>(
+        std::clamp<std::ptrdiff_t>(position, 0, std::ptrdiff_t {size} - 1)
+    );
+}
+
+std::vector<float> load_level(
+    const unsigned char* data,
+    std::size_t texel_count,
+    MipTexelLayout layout
+) {
+    const std::size_t count = texel_count * layout.channels;
+    std::vector<float> values(count);
+    if (layout.is_float) {
+        std::memcpy(values.data(), data, count * sizeof(float));
+        return values;
+    }
+    const auto& table = srgb_table();
+    for (std::size_t i = 0; i < count; ++i) {
+        const bool alpha = layout.channels == 4 && i % 4 == 3;
+        values[i] = layout.srgb && !alpha ?
+                        table[data[i]] :
+                        static_cast<float>(data[i]) / 255.0f;
+    }
+    return values;
+}
+
+void store_level(
+    std::span<const float> values,
+    unsigned char* data,
+    MipTexelLayout layout
+) {
+    if (layout.is_float) {
+        std::memcpy(data, values.data(), values.size_bytes());
+        return;
+    }
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const bool alpha = layout.channels == 4 && i % 4 == 3;
+        auto value = std::clamp(values[i], 0.0f, 1.0f);
+        if (layout.srgb && !alpha) {
+            value = linear_to_srgb(value);
+        }
+        data[i] = static_cast<unsigned char>(std::lround(value * 255.0f));
+    }
+}
+
+// Filters rows first, then columns; both passes only read the previous
+// pass, so rows spread over the worker pool. The inner loops run over
+// whole contiguous rows with loop-invariant weights so they vectorize.
+std::vector<float> downsample(
+    std::span<const float> source,
+    std::uint32_t width,
+    std::uint32_t height,
+    std::uint32_t channels,
+    const MipKernel& kernel
+) {
+    const auto target_width = std::max(width / 2, 1u);
+    const auto target_height = std::max(height / 2, 1u);
+    const std::size_t source_row = std::size_t {width} * channels;
+    const std::size_t target_row = std::size_t {target_width} * channels;
+
+    std::vector<float> rows(target_row * height);
+    parallel_for(height, row_chunk, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t y = begin; y < end; ++y) {
+            const float* in = source.data() + (y * source_row);
+            float* out = rows.data() + (y * target_row);
+            for (std::size_t x = 0; x < target_width; ++x) {
+                const auto first =
+                    (static_cast<std::ptrdiff_t>(x) * 2) + kernel.first_tap;
+                for (std::size_t tap = 0; tap < kernel.weights.size(); ++tap) {
+                    const auto column = clamp_tap(
+                        first + static_cast<std::ptrdiff_t>(tap),
+                        width
+                    );
+                    const float weight = kernel.weights[tap];
+                    for (std::uint32_t c = 0; c < channels; ++c) {
+                        out[(x * channels) + c] +=
+                            weight * in[(column * channels) + c];
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<float> target(target_row * target_height);
+    parallel_for(
+        target_height,
+        row_chunk,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t y = begin; y < end; ++y) {
+                float* out = target.data() + (y * target_row);
+                const auto first =
+                    (static_cast<std::ptrdiff_t>(y) * 2) + kernel.first_tap;
+                for (std::size_t tap = 0; tap < kernel.weights.size(); ++tap)
+                {
+                    const auto row = clamp_tap(
+                        first + static_cast<std::ptrdiff_t>(tap),
+                        height
+                    );
+                    const float* in = rows.data() + (row * target_row);
+                    const float weight = kernel.weights[tap];
+                    for (std::size_t i = 0; i < target_row; ++i) {
+                        out[i] += weight * in[i];
+                    }
+                }
+            }
+        }
+    );
+    return target;
+}
+
+} // namespace
+
+std::uint32_t full_mip_count(std::uint32_t width, std::uint32_t height) {
+    return std::bit_width(std::max({width, height, 1u}));
+}
+
+Result<std::unique_ptr<Image>, std::string>
+generate_mips(const Image& image, MipFilter filter) {
+    const auto& source_description = image.texture_description();
+    const auto layout = mip_texel_layout(source_description.texture_format);
+    if (layout.channels == 0) {
+        return failure(std::string("Unsupported format for mip generation"));
+    }
+    if (source_description.texture_type != TextureType::Texture2D ||
+        image.depth() != 1 ||
+        source_description.texture_usage.is_set(TextureUsage::Cubemap)) {
+        return failure(std::string("Mip generation needs a single 2D image"));
+    }
+    if (image.data() == nullptr) {
+        return failure(std::string("Image has no pixel data"));
+    }
+
+    auto description = source_description;
+    description.mip_level = full_mip_count(image.width(), image.height());
+    auto result = std::make_unique<Image>(
+        nullptr,
+        description,
+        image.channels(),
+        description.mip_level
+    );
+    auto data = std::make_unique<unsigned char[]>(result->data_size());
+
+    const auto& kernel = mip_kernel(filter);
+    auto level = load_level(
+        image.data(),
+        std::size_t {image.width()} * image.height(),
+        layout
+    );
+    std::memcpy(data.get(), image.data(), result->level_size(0));
+    for (std::uint32_t i = 1; i < description.mip_level; ++i) {
+        level = downsample(
+            level,
+            result->level_width(i - 1),
+            result->level_height(i - 1),
+            layout.channels,
+            kernel
+        );
+        store_level(level, data.get() + result->level_offset(i), layout);
+    }
+    result->set_data(std::move(data), description.mip_level);
+    return result;
+}
+
+} // namespace fei
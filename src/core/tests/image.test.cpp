@@ -187,3 +187,25 @@ TEST_CASE("Core ImageLoader rejects invalid image data", "[core][image]") {
     REQUIRE(image.error().path.as_string() == "invalid.png");
     REQUIRE(image.error().message.contains("Failed to read image info"));
 }
+
+TEST_CASE("Core ImageLoader applies load settings", "[core][image]") {
+    App app;
+    AssetServer server(&app);
+    SyncLoadContext context(server, AssetPath("rgba.png"));
+    Reader reader(rgba_png.data(), rgba_png.size());
+    ImageLoader loader;
+    loader.set_settings({
+        .generate_mips = true,
+        .mip_filter = MipFilter::Box,
+        .compress = true,
+    });
+
+    auto image = loader.load(reader, context);
+
+    REQUIRE(image.has_value());
+    const auto& desc = (*image)->texture_description();
+    REQUIRE(desc.texture_format == PixelFormat::Bc7RgbaUnorm);
+    REQUIRE(desc.mip_level == 1);
+    REQUIRE((*image)->data_levels() == 1);
+    REQUIRE((*image)->data_size() == 16);
+}
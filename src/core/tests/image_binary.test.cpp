@@ -0,0 +1,144 @@
+#include "core/image_binary.hpp"
+
+#include "asset/io.hpp"
+#include "asset/loader.hpp"
+#include "asset/path.hpp"
+#include "core/image.hpp"
+#include "graphics/enums.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+using namespace fei;
+
+namespace {
+
+Image compressed_image() {
+    // Three BC1 levels of an 8x8 image: 2x2, 1x1 and 1x1 blocks.
+    constexpr std::size_t size = 6 * 8;
+    auto data = std::make_unique<unsigned char[]>(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<unsigned char>(i * 7);
+    }
+    return Image(
+        std::move(data),
+        TextureDescription {
+            .width = 8,
+            .height = 8,
+            .depth = 1,
+            .mip_level = 4,
+            .layer = 1,
+            .texture_format = PixelFormat::Bc1RgbaUnormSrgb,
+            .texture_usage = TextureUsage::Sampled,
+            .texture_type = TextureType::Texture2D,
+        },
+        4,
+        3
+    );
+}
+
+Reader owning_reader(const std::vector<std::byte>& bytes) {
+    return Reader(
+        std::string_view(
+            reinterpret_cast<const char*>(bytes.data()),
+            bytes.size()
+        )
+    );
+}
+
+} // namespace
+
+TEST_CASE(
+    "Image binaries round-trip the description and every level",
+    "[core][image][image-binary]"
+) {
+    const auto image = compressed_image();
+    REQUIRE(image.data_size() == 6 * 8);
+
+    auto bytes = encode_image_binary(image);
+    REQUIRE(bytes.has_value());
+    REQUIRE(is_image_binary(*bytes));
+
+    auto decoded = decode_image_binary(owning_reader(*bytes));
+
+    REQUIRE(decoded.has_value());
+    const auto& description = decoded->texture_description();
+    REQUIRE(description.width == 8);
+    REQUIRE(description.height == 8);
+    REQUIRE(description.mip_level == 4);
+    REQUIRE(description.texture_format == PixelFormat::Bc1RgbaUnormSrgb);
+    REQUIRE(description.texture_usage == TextureUsage::Sampled);
+    REQUIRE(decoded->channels() == 4);
+    REQUIRE(decoded->data_levels() == 3);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(decoded->data()) % 16 == 0);
+    REQUIRE(
+        std::memcmp(decoded->data(), image.data(), image.data_size()) == 0
+    );
+}
+
+TEST_CASE(
+    "Decoded image binaries view the reader's bytes",
+    "[core][image][image-binary]"
+) {
+    auto bytes = encode_image_binary(compressed_image());
+    REQUIRE(bytes.has_value());
+    const Reader borrowed(bytes->data(), bytes->size());
+
+    auto decoded = decode_image_binary(borrowed);
+
+    REQUIRE(decoded.has_value());
+    REQUIRE(
+        reinterpret_cast<const std::byte*>(decoded->data()) >= bytes->data()
+    );
+    REQUIRE(
+        reinterpret_cast<const std::byte*>(decoded->data()) <
+        bytes->data() + bytes->size()
+    );
+}
+
+TEST_CASE(
+    "ImageLoader loads image binaries without decoding",
+    "[core][image][image-binary]"
+) {
+    auto bytes = encode_image_binary(compressed_image());
+    REQUIRE(bytes.has_value());
+    auto reader = owning_reader(*bytes);
+
+    ImageLoader loader;
+    LoadContext context(AssetPath("textures/baked.fimg"));
+    auto image = loader.load(reader, context);
+
+    REQUIRE(image.has_value());
+    REQUIRE(
+        (*image)->texture_description().texture_format ==
+        PixelFormat::Bc1RgbaUnormSrgb
+    );
+    REQUIRE((*image)->data_levels() == 3);
+}
+
+TEST_CASE(
+    "Image binaries reject malformed input",
+    "[core][image][image-binary]"
+) {
+    auto bytes = encode_image_binary(compressed_image());
+    REQUIRE(bytes.has_value());
+
+    SECTION("wrong magic") {
+        (*bytes)[0] = std::byte {'X'};
+        REQUIRE_FALSE(is_image_binary(*bytes));
+        REQUIRE_FALSE(decode_image_binary(owning_reader(*bytes)).has_value());
+    }
+    SECTION("truncated data") {
+        bytes->resize(bytes->size() - 1);
+        REQUIRE_FALSE(decode_image_binary(owning_reader(*bytes)).has_value());
+    }
+    SECTION("newer version") {
+        (*bytes)[4] = std::byte {ImageBinaryVersion + 1};
+        REQUIRE_FALSE(decode_image_binary(owning_reader(*bytes)).has_value());
+    }
+}
@@ -0,0 +1,414 @@
+#include "core/image_compress.hpp"
+
+#include "core/image.hpp"
+#include "graphics/enums.hpp"
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace fei;
+
+namespace {
+
+using Texel = std::array<int, 4>;
+using Block = std::array<Texel, 16>;
+
+constexpr std::array<int, 16> weights4 {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+};
+
+template<typename T>
+Image make_image(
+    std::uint32_t width,
+    std::uint32_t height,
+    PixelFormat format,
+    const std::vector<T>& texels
+) {
+    auto data = std::make_unique<unsigned char[]>(texels.size() * sizeof(T));
+    std::memcpy(data.get(), texels.data(), texels.size() * sizeof(T));
+    return Image(
+        std::move(data),
+        TextureDescription {
+            .width = width,
+            .height = height,
+            .depth = 1,
+            .mip_level = 1,
+            .layer = 1,
+            .texture_format = format,
+            .texture_usage = TextureUsage::Sampled,
+            .texture_type = TextureType::Texture2D,
+        }
+    );
+}
+
+// 8x8 RGBA ramp in scanline order. Every channel is linear in the texel
+// index, so each block's colours lie on a line as the encoders assume.
+std::vector<std::uint8_t> gradient_texels() {
+    std::vector<std::uint8_t> texels;
+    for (int i = 0; i < 64; ++i) {
+        texels.insert(
+            texels.end(),
+            {
+                static_cast<std::uint8_t>(i * 2),
+                static_cast<std::uint8_t>(255 - i * 2),
+                static_cast<std::uint8_t>(64 + i),
+                static_cast<std::uint8_t>(128 + i * 2),
+            }
+        );
+    }
+    return texels;
+}
+
+class BitReader {
+  private:
+    const unsigned char* m_data;
+    std::uint32_t m_position {0};
+
+  public:
+    explicit BitReader(const unsigned char* data) : m_data(data) {}
+
+    int get(std::uint32_t bits) {
+        int value = 0;
+        for (std::uint32_t i = 0; i < bits; ++i, ++m_position) {
+            value |= ((m_data[m_position / 8] >> (m_position % 8)) & 1) << i;
+        }
+        return value;
+    }
+};
+
+std::array<int, 3> expand_565(std::uint16_t color) {
+    const int r = (color >> 11) & 31;
+    const int g = (color >> 5) & 63;
+    const int b = color & 31;
+    return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+Block decode_bc1(const unsigned char* block, bool force_four_colors) {
+    std::uint16_t color0 = 0;
+    std::uint16_t color1 = 0;
+    std::memcpy(&color0, block, 2);
+    std::memcpy(&color1, block + 2, 2);
+    const auto end0 = expand_565(color0);
+    const auto end1 = expand_565(color1);
+    std::array<Texel, 4> palette {};
+    const bool four = force_four_colors || color0 > color1;
+    for (std::size_t c = 0; c < 3; ++c) {
+        palette[0][c] = end0[c];
+        palette[1][c] = end1[c];
+        palette[2][c] = four ? (2 * end0[c] + end1[c]) / 3 :
+                               (end0[c] + end1[c]) / 2;
+        palette[3][c] = four ? (end0[c] + 2 * end1[c]) / 3 : 0;
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = four ? 255 : 0;
+
+    Block texels {};
+    BitReader reader(block + 4);
+    for (auto& texel : texels) {
+        texel = palette[static_cast<std::size_t>(reader.get(2))];
+    }
+    return texels;
+}
+
+std::array<int, 16> decode_bc4(const unsigned char* block) {
+    const int end0 = block[0];
+    const int end1 = block[1];
+    std::array<int, 8> palette {end0, end1};
+    for (int i = 2; i < 8; ++i) {
+        palette[static_cast<std::size_t>(i)] =
+            end0 > end1 ? ((8 - i) * end0 + (i - 1) * end1) / 7 :
+            i < 6       ? ((6 - i) * end0 + (i - 1) * end1) / 5 :
+            i == 6      ? 0 :
+                          255;
+    }
+    std::array<int, 16> values {};
+    BitReader reader(block + 2);
+    for (auto& value : values) {
+        value = palette[static_cast<std::size_t>(reader.get(3))];
+    }
+    return values;
+}
+
+int interpolate(int end0, int end1, int weight) {
+    return ((64 - weight) * end0 + weight * end1 + 32) >> 6;
+}
+
+Block decode_bc7_mode6(const unsigned char* block) {
+    BitReader reader(block);
+    REQUIRE(reader.get(7) == 1 << 6);
+    std::array<std::array<int, 2>, 4> ends {};
+    for (auto& channel : ends) {
+        channel[0] = reader.get(7);
+        channel[1] = reader.get(7);
+    }
+    const int pbit0 = reader.get(1);
+    const int pbit1 = reader.get(1);
+    Block texels {};
+    for (std::size_t i = 0; i < texels.size(); ++i) {
+        const auto index = reader.get(i == 0 ? 3 : 4);
+        for (std::size_t c = 0; c < 4; ++c) {
+            texels[i][c] = interpolate(
+                (ends[c][0] << 1) | pbit0,
+                (ends[c][1] << 1) | pbit1,
+                weights4[static_cast<std::size_t>(index)]
+            );
+        }
+    }
+    return texels;
+}
+
+float half_to_float(int half) {
+    const int exponent = (half >> 10) & 31;
+    const int mantissa = half & 1023;
+    if (exponent == 0) {
+        return std::ldexp(static_cast<float>(mantissa), -24);
+    }
+    return std::ldexp(
+        1.0f + (static_cast<float>(mantissa) / 1024.0f),
+        exponent - 15
+    );
+}
+
+int unquantize_bc6h(int value) {
+    if (value == 0) {
+        return 0;
+    }
+    if (value == 1023) {
+        return 0xffff;
+    }
+    return ((value << 16) + 0x8000) >> 10;
+}
+
+std::array<std::array<float, 3>, 16>
+decode_bc6h_mode11(const unsigned char* block) {
+    BitReader reader(block);
+    REQUIRE(reader.get(5) == 0b00011);
+    std::array<int, 3> end0 {};
+    std::array<int, 3> end1 {};
+    for (auto& value : end0) {
+        value = unquantize_bc6h(reader.get(10));
+    }
+    for (auto& value : end1) {
+        value = unquantize_bc6h(reader.get(10));
+    }
+    std::array<std::array<float, 3>, 16> texels {};
+    for (std::size_t i = 0; i < texels.size(); ++i) {
+        const auto index = reader.get(i == 0 ? 3 : 4);
+        for (std::size_t c = 0; c < 3; ++c) {
+            const auto value = interpolate(
+                end0[c],
+                end1[c],
+                weights4[static_cast<std::size_t>(index)]
+            );
+            texels[i][c] = half_to_float((value * 31) >> 6);
+        }
+    }
+    return texels;
+}
+
+// Largest difference of `channels` between the 8x8 source and the blocks
+// decoded by `decode`.
+template<typename Decode>
+int max_error(
+    const Image& compressed,
+    const std::vector<std::uint8_t>& texels,
+    std::size_t channels,
+    Decode decode
+) {
+    int error = 0;
+    const auto block_size = get_pixel_format_size(
+        compressed.texture_description().texture_format
+    );
+    for (std::size_t by = 0; by < 2; ++by) {
+        for (std::size_t bx = 0; bx < 2; ++bx) {
+            const auto block =
+                decode(compressed.data() + ((by * 2 + bx) * block_size));
+            for (std::size_t i = 0; i < 16; ++i) {
+                const auto x = bx * 4 + i % 4;
+                const auto y = by * 4 + i / 4;
+                for (std::size_t c = 0; c < channels; ++c) {
+                    const int expected = texels[(y * 8 + x) * 4 + c];
+                    error = std::max(error, std::abs(block[i][c] - expected));
+                }
+            }
+        }
+    }
+    return error;
+}
+
+} // namespace
+
+TEST_CASE("BC1 encodes colour within 565 precision", "[core][image][bc]") {
+    const auto texels = gradient_texels();
+    const auto image = make_image(8, 8, PixelFormat::Rgba8Unorm, texels);
+
+    auto compressed = compress_image(image, PixelFormat::Bc1RgbaUnorm);
+
+    REQUIRE(compressed.has_value());
+    REQUIRE((*compressed)->data_size() == 4 * 8);
+    const auto error = max_error(
+        **compressed,
+        texels,
+        3,
+        [](const unsigned char* block) {
+            return decode_bc1(block, false);
+        }
+    );
+    REQUIRE(error <= 16);
+}
+
+TEST_CASE("BC1 keeps transparent texels transparent", "[core][image][bc]") {
+    std::vector<std::uint8_t> texels;
+    for (int i = 0; i < 16; ++i) {
+        const auto alpha = static_cast<std::uint8_t>(i % 3 == 0 ? 0 : 255);
+        texels.insert(texels.end(), {200, 100, 50, alpha});
+    }
+    const auto image = make_image(4, 4, PixelFormat::Rgba8Unorm, texels);
+
+    auto compressed = compress_image(image, PixelFormat::Bc1RgbaUnorm);
+
+    REQUIRE(compressed.has_value());
+    const auto block = decode_bc1((*compressed)->data(), false);
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        REQUIRE(block[i][3] == texels[i * 4 + 3]);
+        if (block[i][3] != 0) {
+            REQUIRE(std::abs(block[i][0] - 200) <= 4);
+            REQUIRE(std::abs(block[i][1] - 100) <= 2);
+            REQUIRE(std::abs(block[i][2] - 50) <= 4);
+        }
+    }
+}
+
+TEST_CASE("BC3 encodes alpha separately", "[core][image][bc]") {
+    const auto texels = gradient_texels();
+    const auto image = make_image(8, 8, PixelFormat::Rgba8Unorm, texels);
+
+    auto compressed = compress_image(image, PixelFormat::Bc3RgbaUnormSrgb);
+
+    REQUIRE(compressed.has_value());
+    REQUIRE(
+        (*compressed)->texture_description().texture_format ==
+        PixelFormat::Bc3RgbaUnormSrgb
+    );
+    const auto error = max_error(
+        **compressed,
+        texels,
+        4,
+        [](const unsigned char* block) {
+            auto texels = decode_bc1(block + 8, true);
+            const auto alpha = decode_bc4(block);
+            for (std::size_t i = 0; i < texels.size(); ++i) {
+                texels[i][3] = alpha[i];
+            }
+            return texels;
+        }
+    );
+    REQUIRE(error <= 16);
+}
+
+TEST_CASE("BC4 and BC5 encode single channels", "[core][image][bc]") {
+    const auto texels = gradient_texels();
+    const auto image = make_image(8, 8, PixelFormat::Rgba8Unorm, texels);
+
+    auto bc4 = compress_image(image, PixelFormat::Bc4RUnorm);
+    auto bc5 = compress_image(image, PixelFormat::Bc5RgUnorm);
+
+    REQUIRE(bc4.has_value());
+    REQUIRE(bc5.has_value());
+    const auto decode_channels = [](const unsigned char* block) {
+        Block texels {};
+        const auto red = decode_bc4(block);
+        const auto green = decode_bc4(block + 8);
+        for (std::size_t i = 0; i < texels.size(); ++i) {
+            texels[i] = {red[i], green[i], 0, 0};
+        }
+        return texels;
+    };
+    REQUIRE(max_error(**bc4, texels, 1, decode_channels) <= 8);
+    REQUIRE(max_error(**bc5, texels, 2, decode_channels) <= 8);
+}
+
+TEST_CASE("BC7 mode 6 encodes RGBA closely", "[core][image][bc]") {
+    const auto texels = gradient_texels();
+    const auto image = make_image(8, 8, PixelFormat::Rgba8Unorm, texels);
+
+    auto compressed = compress_image(image, PixelFormat::Bc7RgbaUnorm);
+
+    REQUIRE(compressed.has_value());
+    REQUIRE((*compressed)->data_size() == 4 * 16);
+    REQUIRE(max_error(**compressed, texels, 4, decode_bc7_mode6) <= 8);
+}
+
+TEST_CASE("BC6H mode 11 encodes HDR colour", "[core][image][bc]") {
+    std::vector<float> texels;
+    for (int i = 0; i < 16; ++i) {
+        const auto value = 1.0f + static_cast<float>(i) * 0.1f;
+        texels.insert(texels.end(), {value, value * 2.0f, 0.5f, 1.0f});
+    }
+    const auto image = make_image(4, 4, PixelFormat::Rgba32Float, texels);
+
+    auto compressed = compress_image(image, PixelFormat::Bc6hRgbUfloat);
+
+    REQUIRE(compressed.has_value());
+    const auto block = decode_bc6h_mode11((*compressed)->data());
+    for (std::size_t i = 0; i < block.size(); ++i) {
+        for (std::size_t c = 0; c < 3; ++c) {
+            const auto expected = texels[i * 4 + c];
+            REQUIRE(std::abs(block[i][c] - expected) <= expected * 0.1f);
+        }
+    }
+}
+
+TEST_CASE("compress_image encodes every stored level", "[core][image][bc]") {
+    std::vector<std::uint8_t> texels((5 * 5 + 2 * 2 + 1) * 4, 128);
+    auto data = std::make_unique<unsigned char[]>(texels.size());
+    std::memcpy(data.get(), texels.data(), texels.size());
+    Image image(
+        std::move(data),
+        TextureDescription {
+            .width = 5,
+            .height = 5,
+            .depth = 1,
+            .mip_level = 3,
+            .layer = 1,
+            .texture_format = PixelFormat::Rgba8Unorm,
+            .texture_usage = TextureUsage::Sampled,
+            .texture_type = TextureType::Texture2D,
+        },
+        4,
+        3
+    );
+
+    auto compressed = compress_image(image, PixelFormat::Bc7RgbaUnorm);
+
+    REQUIRE(compressed.has_value());
+    REQUIRE((*compressed)->data_levels() == 3);
+    REQUIRE((*compressed)->level_size(0) == 4 * 16);
+    REQUIRE((*compressed)->level_size(1) == 16);
+    REQUIRE((*compressed)->data_size() == 6 * 16);
+}
+
+TEST_CASE(
+    "compress_image rejects mismatched sources",
+    "[core][image][bc]"
+) {
+    const auto ldr =
+        make_image(8, 8, PixelFormat::Rgba8Unorm, gradient_texels());
+    const auto gray = make_image(
+        1,
+        1,
+        PixelFormat::R8Unorm,
+        std::vector<std::uint8_t> {7}
+    );
+
+    REQUIRE_FALSE(compress_image(ldr, PixelFormat::Bc6hRgbUfloat).has_value());
+    REQUIRE_FALSE(compress_image(gray, PixelFormat::Bc5RgUnorm).has_value());
+    REQUIRE_FALSE(compress_image(ldr, PixelFormat::Bc2RgbaUnorm).has_value());
+}
@@ -0,0 +1,165 @@
+#include "core/image_mips.hpp"
+
+#include "core/image.hpp"
+#include "graphics/enums.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace fei;
+
+namespace {
+
+template<typename T>
+Image make_image(
+    std::uint32_t width,
+    std::uint32_t height,
+    PixelFormat format,
+    const std::vector<T>& texels
+) {
+    auto data = std::make_unique<unsigned char[]>(texels.size() * sizeof(T));
+    std::memcpy(data.get(), texels.data(), texels.size() * sizeof(T));
+    return Image(
+        std::move(data),
+        TextureDescription {
+            .width = width,
+            .height = height,
+            .depth = 1,
+            .mip_level = 1,
+            .layer = 1,
+            .texture_format = format,
+            .texture_usage = TextureUsage::Sampled,
+            .texture_type = TextureType::Texture2D,
+        }
+    );
+}
+
+} // namespace
+
+TEST_CASE("full_mip_count reaches 1x1", "[core][image][mips]") {
+    REQUIRE(full_mip_count(1, 1) == 1);
+    REQUIRE(full_mip_count(4, 4) == 3);
+    REQUIRE(full_mip_count(5, 3) == 3);
+    REQUIRE(full_mip_count(1, 256) == 9);
+}
+
+TEST_CASE(
+    "generate_mips stores every level and keeps flat images flat",
+    "[core][image][mips]"
+) {
+    std::vector<std::uint8_t> texels;
+    for (int i = 0; i < 5 * 3; ++i) {
+        texels.insert(texels.end(), {10, 20, 30, 40});
+    }
+    const auto image = make_image(5, 3, PixelFormat::Rgba8Unorm, texels);
+
+    for (auto filter : {MipFilter::Box, MipFilter::Kaiser}) {
+        auto mips = generate_mips(image, filter);
+        REQUIRE(mips.has_value());
+        const auto& result = **mips;
+        REQUIRE(result.data_levels() == 3);
+        REQUIRE(result.texture_description().mip_level == 3);
+        REQUIRE(result.level_width(1) == 2);
+        REQUIRE(result.level_height(1) == 1);
+        REQUIRE(result.data_size() == (5 * 3 + 2 + 1) * 4);
+        REQUIRE(std::memcmp(result.data(), texels.data(), texels.size()) == 0);
+        for (std::size_t i = texels.size(); i < result.data_size(); ++i) {
+            REQUIRE(result.data()[i] == texels[i % 4]);
+        }
+    }
+}
+
+TEST_CASE("Box mips average 2x2 texels", "[core][image][mips]") {
+    const auto image = make_image<std::uint8_t>(
+        2,
+        2,
+        PixelFormat::R8Unorm,
+        {0, 100, 200, 40}
+    );
+
+    auto mips = generate_mips(image, MipFilter::Box);
+
+    REQUIRE(mips.has_value());
+    REQUIRE((*mips)->data_levels() == 2);
+    REQUIRE((*mips)->data()[4] == 85);
+}
+
+TEST_CASE("sRGB mips filter in linear space", "[core][image][mips]") {
+    const auto image = make_image<std::uint8_t>(
+        2,
+        1,
+        PixelFormat::Rgba8UnormSrgb,
+        {0, 0, 0, 0, 255, 255, 255, 255}
+    );
+
+    auto mips = generate_mips(image, MipFilter::Box);
+
+    REQUIRE(mips.has_value());
+    const auto* level = (*mips)->data() + (*mips)->level_offset(1);
+    // Linear 0.5 is 188 in sRGB; alpha averages as is.
+    REQUIRE(level[0] == 188);
+    REQUIRE(level[3] == 128);
+}
+
+TEST_CASE(
+    "Kaiser mips use a wider symmetric footprint",
+    "[core][image][mips]"
+) {
+    // A hard edge between texels 3 and 4 of an 8 texel wide image.
+    std::vector<float> texels;
+    for (int x = 0; x < 8; ++x) {
+        const float value = x < 4 ? 0.0f : 1.0f;
+        texels.insert(texels.end(), {value, value, value, 1.0f});
+    }
+    const auto image = make_image(8, 1, PixelFormat::Rgba32Float, texels);
+
+    auto box = generate_mips(image, MipFilter::Box);
+    auto kaiser = generate_mips(image, MipFilter::Kaiser);
+
+    REQUIRE(box.has_value());
+    REQUIRE(kaiser.has_value());
+    const auto level_texel = [](const Image& mips, std::size_t x) {
+        float value = 0.0f;
+        std::memcpy(
+            &value,
+            mips.data() + mips.level_offset(1) + (x * 4 * sizeof(float)),
+            sizeof(float)
+        );
+        return value;
+    };
+    // Texels 1 and 2 of level 1 sit on either side of the edge.
+    REQUIRE(level_texel(**box, 1) == 0.0f);
+    REQUIRE(level_texel(**box, 2) == 1.0f);
+    const auto below = level_texel(**kaiser, 1);
+    const auto above = level_texel(**kaiser, 2);
+    REQUIRE(below > 0.0f);
+    REQUIRE(below < 0.5f);
+    REQUIRE(below + above > 0.999f);
+    REQUIRE(below + above < 1.001f);
+}
+
+TEST_CASE("generate_mips rejects unsupported images", "[core][image][mips]") {
+    auto compressed = Image::create_empty(
+        4,
+        4,
+        1,
+        PixelFormat::Bc1RgbaUnorm,
+        TextureUsage::Sampled,
+        TextureType::Texture2D
+    );
+    REQUIRE_FALSE(generate_mips(*compressed, MipFilter::Box).has_value());
+
+    auto volume = Image::create_empty(
+        4,
+        4,
+        4,
+        PixelFormat::Rgba8Unorm,
+        TextureUsage::Sampled,
+        TextureType::Texture3D
+    );
+    REQUIRE_FALSE(generate_mips(*volume, MipFilter::Box).has_value());
+}
@@ -4,7 +4,7 @@ target("fei-core")
     add_headerfiles("include/**.hpp")
     add_files("src/*.cpp")
     add_includedirs("include", {public = true})
-    add_deps("fei-base", "fei-refl", "fei-ecs", "fei-app", "fei-asset", "fei-math", "fei-graphics")
+    add_deps("fei-base", "fei-refl", "fei-ecs", "fei-app", "fei-asset", "fei-math", "fei-graphics", "fei-task")
     add_packages("stb")
 
 target("fei-core-tests")
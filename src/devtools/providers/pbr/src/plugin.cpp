@@ -295,9 +295,13 @@ void draw_fullscreen_quad(CommandBuffer& commands, const GpuMesh& mesh) {
     auto index_buffer = mesh.index_buffer();
     if (index_buffer) {
         commands.set_index_buffer(*index_buffer, IndexFormat::Uint32);
-        commands.draw_indexed(mesh.index_buffer_size() / sizeof(std::uint32_t));
+        commands.draw_indexed(
+            mesh.index_count(),
+            mesh.first_index(),
+            static_cast<std::int32_t>(mesh.base_vertex())
+        );
     } else {
-        commands.draw(0, mesh.vertex_count());
+        commands.draw(mesh.base_vertex(), mesh.vertex_count());
     }
 }
 
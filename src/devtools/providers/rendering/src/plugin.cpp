@@ -7,6 +7,9 @@
 #include "ecs/system_params.hpp"
 #include "ecs/world.hpp"
 #include "graphics/graphics_device.hpp"
+#include "rendering/render_frame.hpp"
+#include "rendering/render_queue.hpp"
+#include "rendering/resource_set_cache.hpp"
 #include "snapshot_types.hpp"
 
 #include <string_view>
@@ -70,10 +73,79 @@ struct GraphicsCache {
     }
 };
 
+struct FrameStats {
+    using RequestBody = void;
+    using ResponseBody = RenderFrameStatsSnapshot;
+
+    static constexpr std::string_view id {"rendering.frame_stats"};
+    static constexpr std::string_view label {"Frame Stats"};
+    static constexpr std::string_view schema {"rendering.frame_stats.v1"};
+    static constexpr ScheduleId schedule {RenderEnd};
+
+    static void
+    run(Optional<ResRO<RenderQueue>> render_queue,
+        Optional<ResRO<RenderFrameContext>> frame,
+        Query<Entity, const Request, const JsonRequest> requests,
+        Commands commands) {
+        for (auto [entity, request, json] : requests) {
+            (void)json;
+            if (request.capability != id) {
+                continue;
+            }
+
+            ResponseBody response;
+            if (render_queue && frame) {
+                response = make_render_frame_stats_snapshot(
+                    (*render_queue)->last_flush_stats(),
+                    (*frame)->last_frame_stats()
+                );
+            }
+            respond_capability(commands, entity, request, response);
+        }
+    }
+};
+
+struct ResourceSetCache {
+    using RequestBody = void;
+    using ResponseBody = RenderResourceSetCacheSnapshot;
+
+    static constexpr std::string_view id {"rendering.resource_set_cache"};
+    static constexpr std::string_view label {"Resource Set Cache"};
+    static constexpr std::string_view schema {
+        "rendering.resource_set_cache.v1"
+    };
+    static constexpr ScheduleId schedule {RenderEnd};
+
+    static void
+    run(Optional<ResRO<RenderResourceSetCache>> cache,
+        Query<Entity, const Request, const JsonRequest> requests,
+        Commands commands) {
+        for (auto [entity, request, json] : requests) {
+            (void)json;
+            if (request.capability != id) {
+                continue;
+            }
+
+            ResponseBody response;
+            if (cache) {
+                response = make_render_resource_set_cache_snapshot(
+                    (*cache)->stats(),
+                    (*cache)->budget_bytes()
+                );
+            }
+            respond_capability(commands, entity, request, response);
+        }
+    }
+};
+
 } // namespace
 
 void ProviderPlugin::setup(App& app) {
-    add_capabilities<RenderSchedule, GraphicsCache>(app);
+    add_capabilities<
+        RenderSchedule,
+        GraphicsCache,
+        FrameStats,
+        ResourceSetCache>(app);
 }
 
 void ProviderPlugin::finish(App&) {}
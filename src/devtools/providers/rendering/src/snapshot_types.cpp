@@ -52,4 +52,54 @@ make_graphics_cache_snapshot(const GraphicsResourceCacheStats& stats) {
     return snapshot;
 }
 
+RenderFrameStatsSnapshot make_render_frame_stats_snapshot(
+    const RenderQueueStats& queue,
+    const CommandBufferStats& command_buffer
+) {
+    return RenderFrameStatsSnapshot {
+        .available = true,
+        .queued_writes = queue.writes,
+        .queued_bytes = queue.bytes,
+        .buffer_updates = queue.updates,
+        .buffer_update_bytes = queue.update_bytes,
+        .draws = command_buffer.draws,
+        .draws_saved = command_buffer.draws_saved,
+        .binds = command_buffer.binds,
+        .binds_skipped = command_buffer.binds_skipped,
+    };
+}
+
+namespace {
+
+double ratio(std::uint64_t numerator, std::uint64_t denominator) {
+    return denominator == 0 ? 0.0 :
+                              static_cast<double>(numerator) /
+                                  static_cast<double>(denominator);
+}
+
+} // namespace
+
+RenderResourceSetCacheSnapshot make_render_resource_set_cache_snapshot(
+    const RenderResourceSetCacheStats& stats,
+    std::size_t budget_bytes
+) {
+    return RenderResourceSetCacheSnapshot {
+        .available = true,
+        .requests = stats.requests,
+        .hits = stats.hits,
+        .creates = stats.creates,
+        .evictions = stats.evictions,
+        .size = stats.size,
+        .bytes = stats.bytes,
+        .budget_bytes = budget_bytes,
+        .hit_rate = ratio(stats.hits, stats.requests),
+        .average_lookup_ns = ratio(stats.lookup_ns, stats.requests),
+        .last_frame_requests = stats.last_frame_requests,
+        .last_frame_hits = stats.last_frame_hits,
+        .last_frame_hit_rate =
+            ratio(stats.last_frame_hits, stats.last_frame_requests),
+        .last_frame_lookup_ns = stats.last_frame_lookup_ns,
+    };
+}
+
 } // namespace fei::devtools::rendering
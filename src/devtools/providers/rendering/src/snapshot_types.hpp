@@ -3,6 +3,8 @@
 #include "ecs/schedule.hpp"
 #include "graphics/graphics_device.hpp"
 #include "refl/reflect.hpp"
+#include "rendering/render_queue.hpp"
+#include "rendering/resource_set_cache.hpp"
 
 #include <cstddef>
 #include <cstdint>
@@ -47,10 +49,49 @@ struct FEI_REFLECT GraphicsCacheSnapshot {
     std::vector<ResourceSetSourceSnapshot> resource_set_sources;
 };
 
+struct FEI_REFLECT RenderFrameStatsSnapshot {
+    bool available {false};
+    std::uint64_t queued_writes {0};
+    std::uint64_t queued_bytes {0};
+    std::uint64_t buffer_updates {0};
+    std::uint64_t buffer_update_bytes {0};
+    std::uint64_t draws {0};
+    std::uint64_t draws_saved {0};
+    std::uint64_t binds {0};
+    std::uint64_t binds_skipped {0};
+};
+
+struct FEI_REFLECT RenderResourceSetCacheSnapshot {
+    bool available {false};
+    std::uint64_t requests {0};
+    std::uint64_t hits {0};
+    std::uint64_t creates {0};
+    std::uint64_t evictions {0};
+    std::size_t size {0};
+    std::size_t bytes {0};
+    std::size_t budget_bytes {0};
+    double hit_rate {0.0};
+    double average_lookup_ns {0.0};
+    std::uint64_t last_frame_requests {0};
+    std::uint64_t last_frame_hits {0};
+    double last_frame_hit_rate {0.0};
+    std::uint64_t last_frame_lookup_ns {0};
+};
+
 RenderScheduleSnapshot
 make_render_schedule_snapshot(const ScheduleDebugInfo& debug);
 
 GraphicsCacheSnapshot
 make_graphics_cache_snapshot(const GraphicsResourceCacheStats& stats);
 
+RenderFrameStatsSnapshot make_render_frame_stats_snapshot(
+    const RenderQueueStats& queue,
+    const CommandBufferStats& command_buffer
+);
+
+RenderResourceSetCacheSnapshot make_render_resource_set_cache_snapshot(
+    const RenderResourceSetCacheStats& stats,
+    std::size_t budget_bytes
+);
+
 } // namespace fei::devtools::rendering
@@ -105,3 +105,71 @@ TEST_CASE(
     REQUIRE(json->find(R"("framebuffer_requests":10)") != std::string::npos);
     REQUIRE(json->find(R"("resource_set_sources":[{)") != std::string::npos);
 }
+
+TEST_CASE(
+    "Rendering snapshot DTOs combine queue and command buffer frame stats",
+    "[devtools][rendering][snapshot]"
+) {
+    register_snapshot_test_types();
+
+    RenderQueueStats queue {
+        .writes = 12,
+        .bytes = 768,
+        .updates = 4,
+        .update_bytes = 640,
+    };
+    CommandBufferStats command_buffer {
+        .draws = 30,
+        .draws_saved = 90,
+        .binds = 40,
+        .binds_skipped = 110,
+    };
+
+    auto snapshot = make_render_frame_stats_snapshot(queue, command_buffer);
+    REQUIRE(snapshot.available);
+    REQUIRE(snapshot.queued_writes == 12);
+    REQUIRE(snapshot.buffer_updates == 4);
+    REQUIRE(snapshot.buffer_update_bytes == 640);
+    REQUIRE(snapshot.draws_saved == 90);
+    REQUIRE(snapshot.binds_skipped == 110);
+
+    auto json = encode_json(Ref(snapshot));
+    REQUIRE(json);
+    REQUIRE(json->find(R"("queued_bytes":768)") != std::string::npos);
+    REQUIRE(json->find(R"("binds":40)") != std::string::npos);
+}
+
+TEST_CASE(
+    "Rendering snapshot DTOs derive resource set cache hit rates",
+    "[devtools][rendering][snapshot]"
+) {
+    register_snapshot_test_types();
+
+    RenderResourceSetCacheStats stats {
+        .requests = 40,
+        .hits = 30,
+        .creates = 10,
+        .evictions = 2,
+        .size = 8,
+        .bytes = 1024,
+        .lookup_ns = 8000,
+        .last_frame_requests = 4,
+        .last_frame_hits = 4,
+        .last_frame_lookup_ns = 600,
+    };
+
+    auto snapshot = make_render_resource_set_cache_snapshot(stats, 4096);
+    REQUIRE(snapshot.available);
+    REQUIRE(snapshot.hit_rate == 0.75);
+    REQUIRE(snapshot.average_lookup_ns == 200.0);
+    REQUIRE(snapshot.last_frame_hit_rate == 1.0);
+    REQUIRE(snapshot.budget_bytes == 4096);
+
+    auto empty = make_render_resource_set_cache_snapshot({}, 0);
+    REQUIRE(empty.hit_rate == 0.0);
+
+    auto json = encode_json(Ref(snapshot));
+    REQUIRE(json);
+    REQUIRE(json->find(R"("evictions":2)") != std::string::npos);
+    REQUIRE(json->find(R"("last_frame_lookup_ns":600)") != std::string::npos);
+}
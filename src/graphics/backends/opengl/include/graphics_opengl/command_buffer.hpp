@@ -24,12 +24,12 @@ class CommandBufferOpenGL : public CommandBuffer {
         Submitted,
     };
 
-    std::vector<opengl_commands::Command> m_commands;
+    // Recycled through the device once the GL thread has executed it.
+    opengl_commands::CommandStream m_stream;
     State m_state {State::Initial};
     const GraphicsDeviceOpenGL& m_device;
 
   public:
-    using CommandBuffer::draw_indexed;
     using CommandBuffer::update_buffer;
 
     CommandBufferOpenGL(const GraphicsDeviceOpenGL& device) :
@@ -52,24 +52,13 @@ class CommandBufferOpenGL : public CommandBuffer {
         std::uint32_t w,
         std::uint32_t h
     ) override;
-    void set_vertex_buffer(std::shared_ptr<const Buffer> buffer) override;
-    void set_resource_set(
-        uint32 slot,
-        std::shared_ptr<const ResourceSet> resource_set,
-        std::span<const uint32> dynamic_offsets
-    ) override;
     void update_buffer(
         std::shared_ptr<Buffer> buffer,
         uint32 offset,
         const void* data,
         std::size_t size
     ) override;
-    void draw(std::size_t start, std::size_t count) override;
-    void draw_indexed(
-        std::size_t count,
-        uint32 first_index,
-        std::int32_t vertex_offset
-    ) override;
+    void reserve_buffer_updates(std::size_t size) override;
     void dispatch(
         std::size_t group_x,
         std::size_t group_y,
@@ -82,11 +71,31 @@ class CommandBufferOpenGL : public CommandBuffer {
     void set_compute_pipeline_impl(
         std::shared_ptr<const Pipeline> pipeline
     ) override;
+    void set_vertex_buffer_impl(std::shared_ptr<const Buffer> buffer
+    ) override;
     void set_index_buffer_impl(
         std::shared_ptr<const Buffer> buffer,
         IndexFormat format,
         uint32 offset
     ) override;
+    void set_resource_set_impl(
+        uint32 slot,
+        std::shared_ptr<const ResourceSet> resource_set,
+        std::span<const uint32> dynamic_offsets
+    ) override;
+    void draw_impl(
+        std::size_t start,
+        std::size_t count,
+        uint32 instance_count,
+        uint32 first_instance
+    ) override;
+    void draw_indexed_impl(
+        std::size_t count,
+        uint32 first_index,
+        std::int32_t vertex_offset,
+        uint32 instance_count,
+        uint32 first_instance
+    ) override;
     void generate_mipmaps_impl(std::shared_ptr<const Texture> texture) override;
     void copy_texture_impl(
         std::shared_ptr<const Texture> src,
@@ -9,77 +9,127 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
-#include <variant>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace fei::opengl_commands {
 
+enum class CommandType : uint8 {
+    BeginRenderPass,
+    EndRenderPass,
+    SetViewport,
+    SetScissor,
+    SetRenderPipeline,
+    SetComputePipeline,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    SetResourceSet,
+    UpdateBuffer,
+    Draw,
+    DrawIndexed,
+    Dispatch,
+    GenerateMipmaps,
+    CopyTexture,
+};
+
+// Commands are trivially copyable packets. Resource handles are raw pointers;
+// the owning CommandStream retains the matching shared_ptrs.
+
 struct BeginRenderPass {
-    RenderPassDescription desc;
+    static constexpr CommandType type = CommandType::BeginRenderPass;
+    uint32 render_pass_index;
+};
+struct EndRenderPass {
+    static constexpr CommandType type = CommandType::EndRenderPass;
 };
-struct EndRenderPass {};
 struct SetViewport {
+    static constexpr CommandType type = CommandType::SetViewport;
     std::int32_t x;
     std::int32_t y;
     std::uint32_t w;
     std::uint32_t h;
 };
 struct SetScissor {
+    static constexpr CommandType type = CommandType::SetScissor;
     std::int32_t x;
     std::int32_t y;
     std::uint32_t w;
     std::uint32_t h;
 };
 struct SetRenderPipeline {
-    std::shared_ptr<const Pipeline> pipeline;
+    static constexpr CommandType type = CommandType::SetRenderPipeline;
+    const Pipeline* pipeline;
 };
 struct SetComputePipeline {
-    std::shared_ptr<const Pipeline> pipeline;
+    static constexpr CommandType type = CommandType::SetComputePipeline;
+    const Pipeline* pipeline;
 };
 struct SetVertexBuffer {
-    std::shared_ptr<const Buffer> buffer;
+    static constexpr CommandType type = CommandType::SetVertexBuffer;
+    const Buffer* buffer;
 };
 struct SetIndexBuffer {
-    std::shared_ptr<const Buffer> buffer;
+    static constexpr CommandType type = CommandType::SetIndexBuffer;
+    const Buffer* buffer;
     IndexFormat format;
     uint32 offset;
 };
+// The offsets live in the stream's dynamic offset arena at
+// [first_dynamic_offset, first_dynamic_offset + dynamic_offset_count).
 struct SetResourceSet {
+    static constexpr CommandType type = CommandType::SetResourceSet;
+    const ResourceSet* resource_set;
     uint32 slot;
-    std::shared_ptr<const ResourceSet> resource_set;
-    std::vector<uint32> dynamic_offsets;
+    uint32 first_dynamic_offset;
+    uint32 dynamic_offset_count;
 };
+// The bytes live in the stream's upload arena at
+// [data_offset, data_offset + size).
 struct UpdateBuffer {
-    std::shared_ptr<Buffer> buffer;
+    static constexpr CommandType type = CommandType::UpdateBuffer;
+    Buffer* buffer;
     uint32 offset;
-    std::vector<std::byte> data;
+    std::size_t data_offset;
+    std::size_t size;
 };
 struct Draw {
+    static constexpr CommandType type = CommandType::Draw;
     std::size_t start;
     std::size_t count;
+    uint32 instance_count;
+    uint32 first_instance;
 };
 struct DrawIndexed {
+    static constexpr CommandType type = CommandType::DrawIndexed;
     std::size_t count;
     uint32 first_index;
     std::int32_t vertex_offset;
+    uint32 instance_count;
+    uint32 first_instance;
 };
 struct Dispatch {
+    static constexpr CommandType type = CommandType::Dispatch;
     std::size_t group_x;
     std::size_t group_y;
     std::size_t group_z;
 };
 struct GenerateMipmaps {
-    std::shared_ptr<const Texture> texture;
+    static constexpr CommandType type = CommandType::GenerateMipmaps;
+    const Texture* texture;
 };
 struct CopyTexture {
-    std::shared_ptr<const Texture> src;
+    static constexpr CommandType type = CommandType::CopyTexture;
+    const Texture* src;
     uint32 src_x;
     uint32 src_y;
     uint32 src_z;
     uint32 src_mip_level;
     uint32 src_base_array_layer;
-    std::shared_ptr<const Texture> dst;
+    const Texture* dst;
     uint32 dst_x;
     uint32 dst_y;
     uint32 dst_z;
@@ -91,21 +141,121 @@ struct CopyTexture {
     uint32 layer_count;
 };
 
-using Command = std::variant<
-    BeginRenderPass,
-    EndRenderPass,
-    SetViewport,
-    SetScissor,
-    SetRenderPipeline,
-    SetComputePipeline,
-    SetVertexBuffer,
-    SetIndexBuffer,
-    SetResourceSet,
-    UpdateBuffer,
-    Draw,
-    DrawIndexed,
-    Dispatch,
-    GenerateMipmaps,
-    CopyTexture>;
+// Linear byte encoding of one recording: each command is a CommandType tag
+// followed by its packet, both padded to `packet_alignment`. Every arena keeps
+// its capacity across clear(), so a recycled stream records without touching
+// the heap once it has grown to the frame's size.
+class CommandStream {
+  public:
+    static constexpr std::size_t packet_alignment = 8;
+
+    static constexpr std::size_t align(std::size_t size) {
+        return (size + packet_alignment - 1) & ~(packet_alignment - 1);
+    }
+
+    template<typename T>
+    static constexpr std::size_t packet_size() {
+        return packet_alignment + align(sizeof(T));
+    }
+
+  private:
+    std::vector<std::byte> m_bytes;
+    std::vector<std::byte> m_upload_data;
+    std::vector<uint32> m_dynamic_offsets;
+    // Render pass descriptions own attachment vectors, so they stay out of
+    // the byte stream and BeginRenderPass refers to them by index.
+    std::vector<RenderPassDescription> m_render_passes;
+    // Keeps every handle referenced by the stream alive until clear().
+    std::vector<std::shared_ptr<const void>> m_retained;
+
+  public:
+    template<typename T>
+    void push(const T& command) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto offset = m_bytes.size();
+        m_bytes.resize(offset + packet_size<T>());
+        const auto type = T::type;
+        std::memcpy(m_bytes.data() + offset, &type, sizeof(type));
+        std::memcpy(
+            m_bytes.data() + offset + packet_alignment,
+            &command,
+            sizeof(T)
+        );
+    }
+
+    void retain(std::shared_ptr<const void> handle) {
+        m_retained.push_back(std::move(handle));
+    }
+
+    uint32 push_render_pass(const RenderPassDescription& desc) {
+        m_render_passes.push_back(desc);
+        return static_cast<uint32>(m_render_passes.size() - 1);
+    }
+
+    uint32 push_dynamic_offsets(std::span<const uint32> offsets) {
+        const auto first = static_cast<uint32>(m_dynamic_offsets.size());
+        m_dynamic_offsets.insert(
+            m_dynamic_offsets.end(),
+            offsets.begin(),
+            offsets.end()
+        );
+        return first;
+    }
+
+    std::size_t push_upload(const void* data, std::size_t size) {
+        const auto offset = m_upload_data.size();
+        const auto* bytes = static_cast<const std::byte*>(data);
+        m_upload_data.insert(m_upload_data.end(), bytes, bytes + size);
+        return offset;
+    }
+
+    void reserve_upload(std::size_t size) {
+        m_upload_data.reserve(m_upload_data.size() + size);
+    }
+
+    // Drops the recorded commands and releases retained handles.
+    void clear() {
+        m_bytes.clear();
+        m_upload_data.clear();
+        m_dynamic_offsets.clear();
+        m_render_passes.clear();
+        m_retained.clear();
+    }
+
+    [[nodiscard]] bool empty() const { return m_bytes.empty(); }
+    [[nodiscard]] bool has_storage() const { return m_bytes.capacity() != 0; }
+    [[nodiscard]] std::size_t size_bytes() const { return m_bytes.size(); }
+
+    [[nodiscard]] CommandType peek(std::size_t offset) const {
+        CommandType type;
+        std::memcpy(&type, m_bytes.data() + offset, sizeof(type));
+        return type;
+    }
+
+    // Reads the packet at `offset` and advances it past the packet.
+    template<typename T>
+    [[nodiscard]] T decode(std::size_t& offset) const {
+        T command;
+        std::memcpy(
+            &command,
+            m_bytes.data() + offset + packet_alignment,
+            sizeof(T)
+        );
+        offset += packet_size<T>();
+        return command;
+    }
+
+    [[nodiscard]] const RenderPassDescription& render_pass(uint32 index
+    ) const {
+        return m_render_passes[index];
+    }
+    [[nodiscard]] std::span<const uint32>
+    dynamic_offsets(uint32 first, uint32 count) const {
+        return std::span(m_dynamic_offsets).subspan(first, count);
+    }
+    [[nodiscard]] std::span<const std::byte> upload_data() const {
+        return m_upload_data;
+    }
+};
 
 } // namespace fei::opengl_commands
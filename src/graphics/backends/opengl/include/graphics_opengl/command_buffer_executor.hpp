@@ -11,6 +11,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace fei {
@@ -29,12 +30,12 @@ class CommandBufferExecutorOpenGL {
         m_device(device) {}
 
     void execute(CommandBufferOpenGL& command_buffer);
-    void execute(const std::vector<opengl_commands::Command>& commands);
+    void execute(std::span<const opengl_commands::CommandStream> streams);
 
   private:
-    void execute_command(
+    void execute_stream(
         ExecutionState& state,
-        const opengl_commands::Command& command
+        const opengl_commands::CommandStream& stream
     );
     void execute_begin_render_pass(
         ExecutionState& state,
@@ -46,41 +47,49 @@ class CommandBufferExecutorOpenGL {
     );
     void execute_set_render_pipeline(
         ExecutionState& state,
-        std::shared_ptr<const Pipeline> pipeline
+        const Pipeline* pipeline
     );
     void execute_set_compute_pipeline(
         ExecutionState& state,
-        std::shared_ptr<const Pipeline> pipeline
+        const Pipeline* pipeline
     );
-    void execute_set_vertex_buffer(
+    void execute_set_vertex_buffer(ExecutionState& state, const Buffer* buffer);
+    void execute_set_index_buffer(
         ExecutionState& state,
-        std::shared_ptr<const Buffer> buffer
+        const opengl_commands::SetIndexBuffer& command
     );
     void execute_set_resource_set(
         ExecutionState& state,
         uint32 slot,
-        std::shared_ptr<const ResourceSet> resource_set,
-        const std::vector<uint32>& dynamic_offsets
+        const ResourceSet* resource_set,
+        std::span<const uint32> dynamic_offsets
     );
     void execute_update_buffer(
-        std::shared_ptr<Buffer> buffer,
+        Buffer* buffer,
         uint32 offset,
-        const std::vector<std::byte>& data
+        std::span<const std::byte> data
+    );
+    void execute_draw(
+        ExecutionState& state,
+        std::size_t start,
+        std::size_t count,
+        uint32 instance_count,
+        uint32 first_instance
     );
-    void
-    execute_draw(ExecutionState& state, std::size_t start, std::size_t count);
     void execute_draw_indexed(
         ExecutionState& state,
         std::size_t count,
         uint32 first_index,
-        std::int32_t vertex_offset
+        std::int32_t vertex_offset,
+        uint32 instance_count,
+        uint32 first_instance
     );
     void execute_dispatch(
         std::size_t group_x,
         std::size_t group_y,
         std::size_t group_z
     );
-    void execute_generate_mipmaps(std::shared_ptr<const Texture> texture);
+    void execute_generate_mipmaps(const Texture* texture);
     void execute_copy_texture(const opengl_commands::CopyTexture& command);
 };
 
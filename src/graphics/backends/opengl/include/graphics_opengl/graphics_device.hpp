@@ -9,6 +9,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <span>
 #include <thread>
 #include <unordered_map>
 #include <variant>
@@ -18,8 +19,10 @@ namespace fei {
 
 struct OpenGLTextureReadbackState;
 
+// Streams execute back to back with shared executor state, as if they had
+// been recorded into one command buffer.
 struct OpenGLPendingCommandSubmit {
-    std::vector<opengl_commands::Command> commands;
+    std::vector<opengl_commands::CommandStream> streams;
 };
 
 struct OpenGLPendingBufferUpdate {
@@ -28,6 +31,14 @@ struct OpenGLPendingBufferUpdate {
     std::vector<std::byte> data;
 };
 
+struct OpenGLPendingBufferCopy {
+    std::shared_ptr<Buffer> src;
+    std::uint32_t src_offset {0};
+    std::shared_ptr<Buffer> dst;
+    std::uint32_t dst_offset {0};
+    std::uint32_t size {0};
+};
+
 struct OpenGLPendingTextureUpdate {
     std::shared_ptr<Texture> texture;
     std::vector<std::byte> data;
@@ -48,6 +59,11 @@ struct OpenGLPendingTextureReadback {
     std::uint32_t mip_level {0};
 };
 
+// Compiles and links a pipeline's program ahead of its first draw.
+struct OpenGLPendingPipelineLink {
+    std::shared_ptr<Pipeline> pipeline;
+};
+
 struct OpenGLFramebufferAttachmentCacheKey {
     const Texture* texture {nullptr};
     std::uint32_t mip_level {0};
@@ -112,8 +128,10 @@ struct OpenGLResourceSetCacheEntry {
 using OpenGLPendingOperation = std::variant<
     OpenGLPendingCommandSubmit,
     OpenGLPendingBufferUpdate,
+    OpenGLPendingBufferCopy,
     OpenGLPendingTextureUpdate,
-    OpenGLPendingTextureReadback>;
+    OpenGLPendingTextureReadback,
+    OpenGLPendingPipelineLink>;
 
 class OpenGLDeviceState {
   public:
@@ -138,14 +156,22 @@ class OpenGLDeviceState {
     OpenGLResourceCacheStats resource_cache_stats() const;
     void collect_resource_cache();
     void clear_resource_cache();
+    // Hands out a previously executed stream so recording reuses its
+    // capacity. Returns an empty stream when none is available.
+    opengl_commands::CommandStream acquire_command_stream();
+    // Clears the stream, releasing its retained handles, and keeps it for
+    // reuse. Called on the context thread after execution.
+    void recycle_command_stream(opengl_commands::CommandStream stream);
 
   private:
     friend class GraphicsDeviceOpenGL;
 
     static constexpr std::uint64_t ResourceCacheMaxIdleTicks = 120;
+    static constexpr std::size_t MaxRecycledCommandStreams = 16;
 
     mutable std::mutex m_mutex;
     std::deque<OpenGLPendingOperation> m_pending_operations;
+    std::vector<opengl_commands::CommandStream> m_recycled_command_streams;
     std::vector<std::unique_ptr<DeferredResourceOpenGL>> m_pending_disposals;
     std::vector<std::weak_ptr<OpenGLTextureReadbackState>> m_texture_readbacks;
     std::unordered_map<MappableResource*, std::byte*> m_mapped_resources;
@@ -167,9 +193,12 @@ class OpenGLDeviceState {
 
 class GraphicsDeviceOpenGL : public GraphicsDevice {
   private:
+    friend class CommandBufferOpenGL;
+
     std::shared_ptr<OpenGLDeviceState> m_state;
     std::thread::id m_context_thread;
     std::size_t m_uniform_buffer_offset_alignment {1};
+    bool m_vertex_storage_buffers {false};
 
   public:
     GraphicsDeviceOpenGL();
@@ -207,6 +236,11 @@ class GraphicsDeviceOpenGL : public GraphicsDevice {
     void submit_commands(
         std::shared_ptr<CommandBuffer> command_buffer
     ) const override;
+    // Queues the recordings as a single pending submit, so the GL thread runs
+    // one command list per frame however many buffers recorded it.
+    void submit_command_buffers(
+        std::span<const std::shared_ptr<CommandBuffer>> command_buffers
+    ) const override;
 
     void update_texture(
         std::shared_ptr<Texture> texture,
@@ -227,6 +261,13 @@ class GraphicsDeviceOpenGL : public GraphicsDevice {
         const void* data,
         std::uint32_t size
     ) const override;
+    void copy_buffer(
+        std::shared_ptr<Buffer> src,
+        std::uint32_t src_offset,
+        std::shared_ptr<Buffer> dst,
+        std::uint32_t dst_offset,
+        std::uint32_t size
+    ) const override;
 
     MappedResource
     map(std::shared_ptr<MappableResource> resource,
@@ -237,22 +278,46 @@ class GraphicsDeviceOpenGL : public GraphicsDevice {
 
     void present(const Swapchain& swapchain) const override;
     void flush() const override;
+    // Queues the program link for the next flush() and reports whether it
+    // has run, so the pipeline cache publishes only linked pipelines and no
+    // draw links a program on first use.
+    [[nodiscard]] bool
+    prepare_pipeline(const std::shared_ptr<Pipeline>& pipeline) const override;
+    [[nodiscard]] bool supports_buffer_copy() const override { return true; }
+    [[nodiscard]] bool supports_vertex_storage_buffers() const override {
+        return m_vertex_storage_buffers;
+    }
     [[nodiscard]] std::size_t uniform_buffer_offset_alignment() const override {
         return m_uniform_buffer_offset_alignment;
     }
+    // Recording only appends to the buffer's own command list; nothing touches
+    // the context until the GL thread executes the submit.
+    [[nodiscard]] bool supports_parallel_recording() const override {
+        return true;
+    }
     OpenGLResourceCacheStats resource_cache_stats() const override;
 
     std::shared_ptr<OpenGLDeviceState> state() { return m_state; }
     std::shared_ptr<const OpenGLDeviceState> state() const { return m_state; }
 
   private:
+    // Moves a finished recording's command stream onto the end of `submit`.
+    void append_recording(
+        const std::shared_ptr<CommandBuffer>& command_buffer,
+        OpenGLPendingCommandSubmit& submit
+    ) const;
+    opengl_commands::CommandStream acquire_command_stream() const {
+        return m_state->acquire_command_stream();
+    }
     void flush_pending_work() const;
-    void execute_operation(const OpenGLPendingOperation& operation) const;
+    void execute_operation(OpenGLPendingOperation& operation) const;
     void execute_update_buffer(const OpenGLPendingBufferUpdate& update) const;
+    void execute_copy_buffer(const OpenGLPendingBufferCopy& copy) const;
     void execute_update_texture(const OpenGLPendingTextureUpdate& update) const;
     void execute_texture_readback(
         const OpenGLPendingTextureReadback& readback
     ) const;
+    void execute_pipeline_link(const OpenGLPendingPipelineLink& link) const;
     void collect_texture_readbacks() const;
     void flush_disposals() const;
     void assert_context_thread(const char* operation) const;
@@ -8,6 +8,7 @@
 #include "graphics_opengl/deferred_resource.hpp"
 #include "graphics_opengl/utils.hpp"
 
+#include <atomic>
 #include <memory>
 #include <variant>
 #include <vector>
@@ -58,6 +59,11 @@ class PipelineOpenGL : public Pipeline, public DeferredResourceOpenGL {
     mutable std::vector<std::vector<ResourceBindingInfo>> m_resource_bindings;
 
     mutable GLbitfield m_memory_barriers {0};
+    mutable GLint m_base_instance_location {-1};
+    // Written on the context thread, read by prepare_pipeline() on whichever
+    // thread processes the pipeline cache.
+    mutable std::atomic<bool> m_link_queued {false};
+    mutable std::atomic<bool> m_linked {false};
 
   public:
     explicit PipelineOpenGL(const RenderPipelineDescription& desc);
@@ -73,6 +79,9 @@ class PipelineOpenGL : public Pipeline, public DeferredResourceOpenGL {
         return m_color_attachment_count;
     }
     GLuint program() const { return m_program; }
+    // Location of the base instance uniform SPIRV-Cross emits for shaders
+    // that read the instance index, or -1 when the program has none.
+    GLint base_instance_location() const { return m_base_instance_location; }
 
     Optional<const ResourceBindingInfo&>
     get_resource_binding(uint32 slot, uint32 index) const {
@@ -101,6 +110,10 @@ class PipelineOpenGL : public Pipeline, public DeferredResourceOpenGL {
 
     GLbitfield memory_barriers() const { return m_memory_barriers; }
 
+    bool linked() const { return m_linked.load(std::memory_order_acquire); }
+    // Returns true for the first caller only, which queues the link.
+    bool request_link() const { return !m_link_queued.exchange(true); }
+
   private:
     void create_gl_resource() const override;
     void destroy_gl_resource() override;
@@ -1,8 +1,8 @@
 #include "graphics_opengl/command_buffer.hpp"
 
 #include "base/log.hpp"
+#include "graphics_opengl/graphics_device.hpp"
 
-#include <cstring>
 #include <utility>
 
 namespace fei {
@@ -20,8 +20,12 @@ void CommandBufferOpenGL::begin() {
         );
     }
 
-    m_commands.clear();
+    if (!m_stream.has_storage()) {
+        m_stream = m_device.acquire_command_stream();
+    }
+    m_stream.clear();
     m_pipeline.reset();
+    reset_recording_state();
     m_state = State::Recording;
 }
 
@@ -35,12 +39,18 @@ void CommandBufferOpenGL::end() {
 
 void CommandBufferOpenGL::begin_render_pass(const RenderPassDescription& desc) {
     ensure_recording("begin_render_pass");
-    m_commands.emplace_back(ogl_cmd::BeginRenderPass {.desc = desc});
+    invalidate_bind_state();
+    m_stream.push(
+        ogl_cmd::BeginRenderPass {
+            .render_pass_index = m_stream.push_render_pass(desc),
+        }
+    );
 }
 
 void CommandBufferOpenGL::end_render_pass() {
     ensure_recording("end_render_pass");
-    m_commands.emplace_back(ogl_cmd::EndRenderPass {});
+    invalidate_bind_state();
+    m_stream.push(ogl_cmd::EndRenderPass {});
 }
 
 void CommandBufferOpenGL::set_viewport(
@@ -50,9 +60,7 @@ void CommandBufferOpenGL::set_viewport(
     std::uint32_t h
 ) {
     ensure_recording("set_viewport");
-    m_commands.emplace_back(
-        ogl_cmd::SetViewport {.x = x, .y = y, .w = w, .h = h}
-    );
+    m_stream.push(ogl_cmd::SetViewport {.x = x, .y = y, .w = w, .h = h});
 }
 
 void CommandBufferOpenGL::set_scissor(
@@ -62,36 +70,34 @@ void CommandBufferOpenGL::set_scissor(
     std::uint32_t h
 ) {
     ensure_recording("set_scissor");
-    m_commands.emplace_back(
-        ogl_cmd::SetScissor {.x = x, .y = y, .w = w, .h = h}
-    );
+    m_stream.push(ogl_cmd::SetScissor {.x = x, .y = y, .w = w, .h = h});
 }
 
-void CommandBufferOpenGL::set_vertex_buffer(
+void CommandBufferOpenGL::set_vertex_buffer_impl(
     std::shared_ptr<const Buffer> buffer
 ) {
     ensure_recording("set_vertex_buffer");
-    m_commands.emplace_back(
-        ogl_cmd::SetVertexBuffer {.buffer = std::move(buffer)}
-    );
+    m_stream.push(ogl_cmd::SetVertexBuffer {.buffer = buffer.get()});
+    m_stream.retain(std::move(buffer));
 }
 
-void CommandBufferOpenGL::set_resource_set(
+void CommandBufferOpenGL::set_resource_set_impl(
     uint32 slot,
     std::shared_ptr<const ResourceSet> resource_set,
     std::span<const uint32> dynamic_offsets
 ) {
     ensure_recording("set_resource_set");
-    m_commands.emplace_back(
+    m_stream.push(
         ogl_cmd::SetResourceSet {
+            .resource_set = resource_set.get(),
             .slot = slot,
-            .resource_set = std::move(resource_set),
-            .dynamic_offsets = std::vector<uint32>(
-                dynamic_offsets.begin(),
-                dynamic_offsets.end()
-            ),
+            .first_dynamic_offset =
+                m_stream.push_dynamic_offsets(dynamic_offsets),
+            .dynamic_offset_count =
+                static_cast<uint32>(dynamic_offsets.size()),
         }
     );
+    m_stream.retain(std::move(resource_set));
 }
 
 void CommandBufferOpenGL::update_buffer(
@@ -105,36 +111,53 @@ void CommandBufferOpenGL::update_buffer(
         fatal("CommandBufferOpenGL::update_buffer received null data");
     }
 
-    std::vector<std::byte> bytes(size);
-    if (size > 0) {
-        std::memcpy(bytes.data(), data, size);
-    }
-
-    m_commands.emplace_back(
+    m_stream.push(
         ogl_cmd::UpdateBuffer {
-            .buffer = std::move(buffer),
+            .buffer = buffer.get(),
             .offset = offset,
-            .data = std::move(bytes),
+            .data_offset = m_stream.push_upload(data, size),
+            .size = size,
         }
     );
+    m_stream.retain(std::move(buffer));
+}
+
+void CommandBufferOpenGL::reserve_buffer_updates(std::size_t size) {
+    m_stream.reserve_upload(size);
 }
 
-void CommandBufferOpenGL::draw(size_t start, size_t count) {
+void CommandBufferOpenGL::draw_impl(
+    size_t start,
+    size_t count,
+    uint32 instance_count,
+    uint32 first_instance
+) {
     ensure_recording("draw");
-    m_commands.emplace_back(ogl_cmd::Draw {.start = start, .count = count});
+    m_stream.push(
+        ogl_cmd::Draw {
+            .start = start,
+            .count = count,
+            .instance_count = instance_count,
+            .first_instance = first_instance,
+        }
+    );
 }
 
-void CommandBufferOpenGL::draw_indexed(
+void CommandBufferOpenGL::draw_indexed_impl(
     size_t count,
     uint32 first_index,
-    std::int32_t vertex_offset
+    std::int32_t vertex_offset,
+    uint32 instance_count,
+    uint32 first_instance
 ) {
     ensure_recording("draw_indexed");
-    m_commands.emplace_back(
+    m_stream.push(
         ogl_cmd::DrawIndexed {
             .count = count,
             .first_index = first_index,
             .vertex_offset = vertex_offset,
+            .instance_count = instance_count,
+            .first_instance = first_instance,
         }
     );
 }
@@ -145,7 +168,7 @@ void CommandBufferOpenGL::dispatch(
     std::size_t group_z
 ) {
     ensure_recording("dispatch");
-    m_commands.emplace_back(
+    m_stream.push(
         ogl_cmd::Dispatch {
             .group_x = group_x,
             .group_y = group_y,
@@ -158,18 +181,16 @@ void CommandBufferOpenGL::set_render_pipeline_impl(
     std::shared_ptr<const Pipeline> pipeline
 ) {
     ensure_recording("set_render_pipeline");
-    m_commands.emplace_back(
-        ogl_cmd::SetRenderPipeline {.pipeline = std::move(pipeline)}
-    );
+    m_stream.push(ogl_cmd::SetRenderPipeline {.pipeline = pipeline.get()});
+    m_stream.retain(std::move(pipeline));
 }
 
 void CommandBufferOpenGL::set_compute_pipeline_impl(
     std::shared_ptr<const Pipeline> pipeline
 ) {
     ensure_recording("set_compute_pipeline");
-    m_commands.emplace_back(
-        ogl_cmd::SetComputePipeline {.pipeline = std::move(pipeline)}
-    );
+    m_stream.push(ogl_cmd::SetComputePipeline {.pipeline = pipeline.get()});
+    m_stream.retain(std::move(pipeline));
 }
 
 void CommandBufferOpenGL::set_index_buffer_impl(
@@ -178,22 +199,22 @@ void CommandBufferOpenGL::set_index_buffer_impl(
     uint32 offset
 ) {
     ensure_recording("set_index_buffer");
-    m_commands.emplace_back(
+    m_stream.push(
         ogl_cmd::SetIndexBuffer {
-            .buffer = std::move(buffer),
+            .buffer = buffer.get(),
             .format = format,
             .offset = offset,
         }
     );
+    m_stream.retain(std::move(buffer));
 }
 
 void CommandBufferOpenGL::generate_mipmaps_impl(
     std::shared_ptr<const Texture> texture
 ) {
     ensure_recording("generate_mipmaps");
-    m_commands.emplace_back(
-        ogl_cmd::GenerateMipmaps {.texture = std::move(texture)}
-    );
+    m_stream.push(ogl_cmd::GenerateMipmaps {.texture = texture.get()});
+    m_stream.retain(std::move(texture));
 }
 
 void CommandBufferOpenGL::copy_texture_impl(
@@ -215,15 +236,15 @@ void CommandBufferOpenGL::copy_texture_impl(
     uint32 layer_count
 ) {
     ensure_recording("copy_texture");
-    m_commands.emplace_back(
+    m_stream.push(
         ogl_cmd::CopyTexture {
-            .src = std::move(src),
+            .src = src.get(),
             .src_x = src_x,
             .src_y = src_y,
             .src_z = src_z,
             .src_mip_level = src_mip_level,
             .src_base_array_layer = src_base_array_layer,
-            .dst = std::move(dst),
+            .dst = dst.get(),
             .dst_x = dst_x,
             .dst_y = dst_y,
             .dst_z = dst_z,
@@ -235,6 +256,8 @@ void CommandBufferOpenGL::copy_texture_impl(
             .layer_count = layer_count,
         }
     );
+    m_stream.retain(std::move(src));
+    m_stream.retain(std::move(dst));
 }
 
 void CommandBufferOpenGL::ensure_recording(const char* command_name) const {
@@ -17,7 +17,6 @@
 #include <cassert>
 #include <cstdint>
 #include <memory>
-#include <type_traits>
 #include <utility>
 
 namespace fei {
@@ -26,9 +25,6 @@ namespace ogl_cmd = opengl_commands;
 
 namespace {
 
-template<class>
-inline constexpr bool always_false_v = false;
-
 void set_default_framebuffer_draw_buffer() {
     FEI_GL_CALL(glDrawBuffer(GL_BACK));
 }
@@ -153,6 +149,23 @@ std::size_t index_element_size(GLenum type) {
     }
 }
 
+// OpenGL's gl_InstanceID does not include the draw's base instance, so
+// SPIRV-Cross lowers the SPIR-V instance index to gl_InstanceID plus this
+// uniform.
+void set_base_instance_uniform(
+    const PipelineOpenGL& pipeline,
+    uint32 first_instance
+) {
+    if (pipeline.base_instance_location() < 0) {
+        return;
+    }
+    FEI_GL_CALL(glProgramUniform1i(
+        pipeline.program(),
+        pipeline.base_instance_location(),
+        static_cast<GLint>(first_instance)
+    ));
+}
+
 void bind_buffer_resource(
     GLenum target,
     GLuint binding_index,
@@ -182,8 +195,8 @@ void bind_buffer_resource(
 
 struct CommandBufferExecutorOpenGL::ExecutionState {
     std::shared_ptr<const Framebuffer> framebuffer;
-    std::shared_ptr<const Pipeline> pipeline;
-    std::vector<std::shared_ptr<const ResourceSetOpenGL>> bound_resource_sets;
+    const PipelineOpenGL* pipeline {nullptr};
+    std::vector<const ResourceSetOpenGL*> bound_resource_sets;
     GLenum draw_elements_type {GL_UNSIGNED_INT};
     uint32 index_buffer_offset {0};
     std::int32_t viewport_x {0};
@@ -196,36 +209,44 @@ struct CommandBufferExecutorOpenGL::ExecutionState {
 void CommandBufferExecutorOpenGL::execute(CommandBufferOpenGL& command_buffer) {
     FEI_PROFILE_SCOPE("OpenGL CommandBuffer Execute");
     command_buffer.ensure_executable("execute");
-    execute(command_buffer.m_commands);
+    execute(std::span(&command_buffer.m_stream, 1));
     command_buffer.mark_submitted();
 }
 
 void CommandBufferExecutorOpenGL::execute(
-    const std::vector<ogl_cmd::Command>& commands
+    std::span<const ogl_cmd::CommandStream> streams
 ) {
     FEI_PROFILE_SCOPE("OpenGL Command List Execute");
     ExecutionState state;
-    for (const auto& command : commands) {
-        execute_command(state, command);
+    for (const auto& stream : streams) {
+        execute_stream(state, stream);
     }
 }
 
-void CommandBufferExecutorOpenGL::execute_command(
+void CommandBufferExecutorOpenGL::execute_stream(
     ExecutionState& state,
-    const ogl_cmd::Command& command
+    const ogl_cmd::CommandStream& stream
 ) {
-    std::visit(
-        [this, &state](const auto& cmd) {
-            using CommandT = std::decay_t<decltype(cmd)>;
-            if constexpr (std::is_same_v<CommandT, ogl_cmd::BeginRenderPass>) {
-                execute_begin_render_pass(state, cmd.desc);
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::EndRenderPass>
-            ) {
+    using ogl_cmd::CommandType;
+
+    std::size_t offset = 0;
+    while (offset < stream.size_bytes()) {
+        switch (stream.peek(offset)) {
+            case CommandType::BeginRenderPass: {
+                const auto cmd =
+                    stream.decode<ogl_cmd::BeginRenderPass>(offset);
+                execute_begin_render_pass(
+                    state,
+                    stream.render_pass(cmd.render_pass_index)
+                );
+                break;
+            }
+            case CommandType::EndRenderPass:
+                (void)stream.decode<ogl_cmd::EndRenderPass>(offset);
                 FEI_GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::SetViewport>
-            ) {
+                break;
+            case CommandType::SetViewport: {
+                const auto cmd = stream.decode<ogl_cmd::SetViewport>(offset);
                 FEI_GL_CALL(glViewport(
                     cmd.x,
                     cmd.y,
@@ -243,9 +264,10 @@ void CommandBufferExecutorOpenGL::execute_command(
                 state.viewport_width = cmd.w;
                 state.viewport_height = cmd.h;
                 state.viewport_set = true;
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::SetScissor>
-            ) {
+                break;
+            }
+            case CommandType::SetScissor: {
+                const auto cmd = stream.decode<ogl_cmd::SetScissor>(offset);
                 if (!state.viewport_set) {
                     fatal(
                         "CommandBufferOpenGL::set_scissor executed before "
@@ -262,70 +284,100 @@ void CommandBufferExecutorOpenGL::execute_command(
                     to_gl_sizei(cmd.w),
                     to_gl_sizei(cmd.h)
                 ));
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::SetRenderPipeline>
-            ) {
+                break;
+            }
+            case CommandType::SetRenderPipeline: {
+                const auto cmd =
+                    stream.decode<ogl_cmd::SetRenderPipeline>(offset);
                 execute_set_render_pipeline(state, cmd.pipeline);
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::SetComputePipeline>
-            ) {
+                break;
+            }
+            case CommandType::SetComputePipeline: {
+                const auto cmd =
+                    stream.decode<ogl_cmd::SetComputePipeline>(offset);
                 execute_set_compute_pipeline(state, cmd.pipeline);
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::SetVertexBuffer>
-            ) {
+                break;
+            }
+            case CommandType::SetVertexBuffer: {
+                const auto cmd =
+                    stream.decode<ogl_cmd::SetVertexBuffer>(offset);
                 execute_set_vertex_buffer(state, cmd.buffer);
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::SetIndexBuffer>
-            ) {
-                auto buffer_gl =
-                    std::static_pointer_cast<const BufferOpenGL>(cmd.buffer);
-                buffer_gl->ensure_created();
-                FEI_GL_CALL(
-                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_gl->id())
-                );
-
-                state.draw_elements_type = to_gl_draw_elements_type(cmd.format);
-                state.index_buffer_offset = cmd.offset;
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::SetResourceSet>
-            ) {
+                break;
+            }
+            case CommandType::SetIndexBuffer: {
+                const auto cmd = stream.decode<ogl_cmd::SetIndexBuffer>(offset);
+                execute_set_index_buffer(state, cmd);
+                break;
+            }
+            case CommandType::SetResourceSet: {
+                const auto cmd = stream.decode<ogl_cmd::SetResourceSet>(offset);
                 execute_set_resource_set(
                     state,
                     cmd.slot,
                     cmd.resource_set,
-                    cmd.dynamic_offsets
+                    stream.dynamic_offsets(
+                        cmd.first_dynamic_offset,
+                        cmd.dynamic_offset_count
+                    )
+                );
+                break;
+            }
+            case CommandType::UpdateBuffer: {
+                const auto cmd = stream.decode<ogl_cmd::UpdateBuffer>(offset);
+                execute_update_buffer(
+                    cmd.buffer,
+                    cmd.offset,
+                    stream.upload_data().subspan(cmd.data_offset, cmd.size)
                 );
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::UpdateBuffer>
-            ) {
-                execute_update_buffer(cmd.buffer, cmd.offset, cmd.data);
-            } else if constexpr (std::is_same_v<CommandT, ogl_cmd::Draw>) {
-                execute_draw(state, cmd.start, cmd.count);
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::DrawIndexed>
-            ) {
+                break;
+            }
+            case CommandType::Draw: {
+                const auto cmd = stream.decode<ogl_cmd::Draw>(offset);
+                execute_draw(
+                    state,
+                    cmd.start,
+                    cmd.count,
+                    cmd.instance_count,
+                    cmd.first_instance
+                );
+                break;
+            }
+            case CommandType::DrawIndexed: {
+                const auto cmd = stream.decode<ogl_cmd::DrawIndexed>(offset);
                 execute_draw_indexed(
                     state,
                     cmd.count,
                     cmd.first_index,
-                    cmd.vertex_offset
+                    cmd.vertex_offset,
+                    cmd.instance_count,
+                    cmd.first_instance
                 );
-            } else if constexpr (std::is_same_v<CommandT, ogl_cmd::Dispatch>) {
+                break;
+            }
+            case CommandType::Dispatch: {
+                const auto cmd = stream.decode<ogl_cmd::Dispatch>(offset);
                 execute_dispatch(cmd.group_x, cmd.group_y, cmd.group_z);
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::GenerateMipmaps>
-            ) {
+                break;
+            }
+            case CommandType::GenerateMipmaps: {
+                const auto cmd =
+                    stream.decode<ogl_cmd::GenerateMipmaps>(offset);
                 execute_generate_mipmaps(cmd.texture);
-            } else if constexpr (
-                std::is_same_v<CommandT, ogl_cmd::CopyTexture>
-            ) {
+                break;
+            }
+            case CommandType::CopyTexture: {
+                const auto cmd = stream.decode<ogl_cmd::CopyTexture>(offset);
                 execute_copy_texture(cmd);
-            } else {
-                static_assert(always_false_v<CommandT>);
+                break;
             }
-        },
-        command
-    );
+            default:
+                fatal(
+                    "Unknown OpenGL command type {} at stream offset {}",
+                    static_cast<uint32>(stream.peek(offset)),
+                    offset
+                );
+        }
+    }
 }
 
 void CommandBufferExecutorOpenGL::execute_begin_render_pass(
@@ -437,9 +489,9 @@ void CommandBufferExecutorOpenGL::execute_set_framebuffer(
 
 void CommandBufferExecutorOpenGL::execute_set_render_pipeline(
     ExecutionState& state,
-    std::shared_ptr<const Pipeline> pipeline
+    const Pipeline* pipeline
 ) {
-    auto pipeline_gl = std::static_pointer_cast<const PipelineOpenGL>(pipeline);
+    const auto* pipeline_gl = static_cast<const PipelineOpenGL*>(pipeline);
     pipeline_gl->ensure_created();
 
     if (state.bound_resource_sets.size() <
@@ -518,14 +570,14 @@ void CommandBufferExecutorOpenGL::execute_set_render_pipeline(
         FEI_GL_CALL(glDisable(GL_SCISSOR_TEST));
     }
 
-    state.pipeline = std::move(pipeline);
+    state.pipeline = pipeline_gl;
 }
 
 void CommandBufferExecutorOpenGL::execute_set_compute_pipeline(
     ExecutionState& state,
-    std::shared_ptr<const Pipeline> pipeline
+    const Pipeline* pipeline
 ) {
-    auto pipeline_gl = std::static_pointer_cast<const PipelineOpenGL>(pipeline);
+    const auto* pipeline_gl = static_cast<const PipelineOpenGL*>(pipeline);
     pipeline_gl->ensure_created();
 
     if (state.bound_resource_sets.size() <
@@ -537,12 +589,12 @@ void CommandBufferExecutorOpenGL::execute_set_compute_pipeline(
 
     FEI_GL_CALL(glUseProgram(pipeline_gl->program()));
 
-    state.pipeline = std::move(pipeline);
+    state.pipeline = pipeline_gl;
 }
 
 void CommandBufferExecutorOpenGL::execute_set_vertex_buffer(
     ExecutionState& state,
-    std::shared_ptr<const Buffer> buffer
+    const Buffer* buffer
 ) {
     if (!state.pipeline) {
         fatal(
@@ -550,9 +602,8 @@ void CommandBufferExecutorOpenGL::execute_set_vertex_buffer(
         );
     }
 
-    auto buffer_gl = std::static_pointer_cast<const BufferOpenGL>(buffer);
-    auto pipeline_gl =
-        std::static_pointer_cast<const PipelineOpenGL>(state.pipeline);
+    const auto* buffer_gl = static_cast<const BufferOpenGL*>(buffer);
+    const auto* pipeline_gl = state.pipeline;
     buffer_gl->ensure_created();
     pipeline_gl->ensure_created();
 
@@ -575,11 +626,23 @@ void CommandBufferExecutorOpenGL::execute_set_vertex_buffer(
     }
 }
 
+void CommandBufferExecutorOpenGL::execute_set_index_buffer(
+    ExecutionState& state,
+    const ogl_cmd::SetIndexBuffer& command
+) {
+    const auto* buffer_gl = static_cast<const BufferOpenGL*>(command.buffer);
+    buffer_gl->ensure_created();
+    FEI_GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_gl->id()));
+
+    state.draw_elements_type = to_gl_draw_elements_type(command.format);
+    state.index_buffer_offset = command.offset;
+}
+
 void CommandBufferExecutorOpenGL::execute_set_resource_set(
     ExecutionState& state,
     uint32 slot,
-    std::shared_ptr<const ResourceSet> resource_set,
-    const std::vector<uint32>& dynamic_offsets
+    const ResourceSet* resource_set,
+    std::span<const uint32> dynamic_offsets
 ) {
     if (!state.pipeline) {
         fatal(
@@ -587,11 +650,10 @@ void CommandBufferExecutorOpenGL::execute_set_resource_set(
         );
     }
 
-    auto gl_pipeline =
-        std::static_pointer_cast<const PipelineOpenGL>(state.pipeline);
+    const auto* gl_pipeline = state.pipeline;
     gl_pipeline->ensure_created();
-    auto gl_resource_set =
-        std::static_pointer_cast<const ResourceSetOpenGL>(resource_set);
+    const auto* gl_resource_set =
+        static_cast<const ResourceSetOpenGL*>(resource_set);
     if (slot >= gl_pipeline->resource_layouts().size()) {
         fei::fatal(
             "Resource set slot {} out of range (max {})",
@@ -613,7 +675,7 @@ void CommandBufferExecutorOpenGL::execute_set_resource_set(
     for (uint32 i = 0; i < size; ++i) {
         auto& element = gl_layout->elements()[i];
         auto kind = element.kind;
-        auto resource = gl_resource_set->resources()[i];
+        const auto& resource = gl_resource_set->resources()[i];
         std::size_t dynamic_offset = 0;
         if (element.options.is_set(
                 ResourceLayoutElementOptions::DynamicBinding
@@ -749,11 +811,11 @@ void CommandBufferExecutorOpenGL::execute_set_resource_set(
 }
 
 void CommandBufferExecutorOpenGL::execute_update_buffer(
-    std::shared_ptr<Buffer> buffer,
+    Buffer* buffer,
     uint32 offset,
-    const std::vector<std::byte>& data
+    std::span<const std::byte> data
 ) {
-    auto buffer_gl = std::static_pointer_cast<BufferOpenGL>(buffer);
+    auto* buffer_gl = static_cast<BufferOpenGL*>(buffer);
     buffer_gl->ensure_created();
 
     if (static_cast<std::size_t>(offset) > buffer_gl->size() ||
@@ -778,21 +840,33 @@ void CommandBufferExecutorOpenGL::execute_update_buffer(
 void CommandBufferExecutorOpenGL::execute_draw(
     ExecutionState& state,
     std::size_t start,
-    std::size_t count
+    std::size_t count,
+    uint32 instance_count,
+    uint32 first_instance
 ) {
     if (!state.pipeline) {
         fatal("CommandBufferOpenGL::draw executed without pipeline");
     }
 
-    auto pipeline_gl =
-        std::static_pointer_cast<const PipelineOpenGL>(state.pipeline);
+    const auto* pipeline_gl = state.pipeline;
     pipeline_gl->ensure_created();
+    set_base_instance_uniform(*pipeline_gl, first_instance);
 
-    FEI_GL_CALL(glDrawArrays(
-        to_gl_render_primitive(pipeline_gl->render_primitive()),
-        static_cast<GLint>(start),
-        static_cast<GLsizei>(count)
-    ));
+    if (instance_count == 1 && first_instance == 0) {
+        FEI_GL_CALL(glDrawArrays(
+            to_gl_render_primitive(pipeline_gl->render_primitive()),
+            static_cast<GLint>(start),
+            static_cast<GLsizei>(count)
+        ));
+    } else {
+        FEI_GL_CALL(glDrawArraysInstancedBaseInstance(
+            to_gl_render_primitive(pipeline_gl->render_primitive()),
+            static_cast<GLint>(start),
+            static_cast<GLsizei>(count),
+            static_cast<GLsizei>(instance_count),
+            static_cast<GLuint>(first_instance)
+        ));
+    }
     if (pipeline_gl->memory_barriers() != 0) {
         FEI_GL_CALL(glMemoryBarrier(pipeline_gl->memory_barriers()));
     }
@@ -802,28 +876,42 @@ void CommandBufferExecutorOpenGL::execute_draw_indexed(
     ExecutionState& state,
     std::size_t count,
     uint32 first_index,
-    std::int32_t vertex_offset
+    std::int32_t vertex_offset,
+    uint32 instance_count,
+    uint32 first_instance
 ) {
     if (!state.pipeline) {
         fatal("CommandBufferOpenGL::draw_indexed executed without pipeline");
     }
 
-    auto pipeline_gl =
-        std::static_pointer_cast<const PipelineOpenGL>(state.pipeline);
+    const auto* pipeline_gl = state.pipeline;
     pipeline_gl->ensure_created();
+    set_base_instance_uniform(*pipeline_gl, first_instance);
     auto index_offset = reinterpret_cast<const GLvoid*>(
         static_cast<std::uintptr_t>(state.index_buffer_offset) +
         static_cast<std::uintptr_t>(first_index) *
             index_element_size(state.draw_elements_type)
     );
 
-    FEI_GL_CALL(glDrawElementsBaseVertex(
-        to_gl_render_primitive(pipeline_gl->render_primitive()),
-        static_cast<GLsizei>(count),
-        state.draw_elements_type,
-        index_offset,
-        vertex_offset
-    ));
+    if (instance_count == 1 && first_instance == 0) {
+        FEI_GL_CALL(glDrawElementsBaseVertex(
+            to_gl_render_primitive(pipeline_gl->render_primitive()),
+            static_cast<GLsizei>(count),
+            state.draw_elements_type,
+            index_offset,
+            vertex_offset
+        ));
+    } else {
+        FEI_GL_CALL(glDrawElementsInstancedBaseVertexBaseInstance(
+            to_gl_render_primitive(pipeline_gl->render_primitive()),
+            static_cast<GLsizei>(count),
+            state.draw_elements_type,
+            index_offset,
+            static_cast<GLsizei>(instance_count),
+            vertex_offset,
+            static_cast<GLuint>(first_instance)
+        ));
+    }
     if (pipeline_gl->memory_barriers() != 0) {
         FEI_GL_CALL(glMemoryBarrier(pipeline_gl->memory_barriers()));
     }
@@ -844,9 +932,9 @@ void CommandBufferExecutorOpenGL::execute_dispatch(
 }
 
 void CommandBufferExecutorOpenGL::execute_generate_mipmaps(
-    std::shared_ptr<const Texture> texture
+    const Texture* texture
 ) {
-    auto texture_gl = std::static_pointer_cast<const TextureOpenGL>(texture);
+    const auto* texture_gl = static_cast<const TextureOpenGL*>(texture);
     texture_gl->ensure_created();
     FEI_GL_CALL(glGenerateTextureMipmap(texture_gl->id()));
 }
@@ -854,8 +942,8 @@ void CommandBufferExecutorOpenGL::execute_generate_mipmaps(
 void CommandBufferExecutorOpenGL::execute_copy_texture(
     const ogl_cmd::CopyTexture& command
 ) {
-    auto src_gl = std::static_pointer_cast<const TextureOpenGL>(command.src);
-    auto dst_gl = std::static_pointer_cast<const TextureOpenGL>(command.dst);
+    const auto* src_gl = static_cast<const TextureOpenGL*>(command.src);
+    const auto* dst_gl = static_cast<const TextureOpenGL*>(command.dst);
     src_gl->ensure_created();
     dst_gl->ensure_created();
     uint32 src_z_or_layer =
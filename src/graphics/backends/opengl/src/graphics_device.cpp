@@ -25,6 +25,7 @@
 #include <thread>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace fei {
@@ -203,6 +204,29 @@ OpenGLDeviceState::take_pending_operations() {
     return operations;
 }
 
+opengl_commands::CommandStream OpenGLDeviceState::acquire_command_stream() {
+    std::scoped_lock lock(m_mutex);
+    if (m_recycled_command_streams.empty()) {
+        return {};
+    }
+    auto stream = std::move(m_recycled_command_streams.back());
+    m_recycled_command_streams.pop_back();
+    return stream;
+}
+
+void OpenGLDeviceState::recycle_command_stream(
+    opengl_commands::CommandStream stream
+) {
+    stream.clear();
+    if (!stream.has_storage()) {
+        return;
+    }
+    std::scoped_lock lock(m_mutex);
+    if (m_recycled_command_streams.size() < MaxRecycledCommandStreams) {
+        m_recycled_command_streams.push_back(std::move(stream));
+    }
+}
+
 std::vector<std::unique_ptr<DeferredResourceOpenGL>>
 OpenGLDeviceState::take_pending_disposals() {
     std::vector<std::unique_ptr<DeferredResourceOpenGL>> disposals;
@@ -414,6 +438,14 @@ GraphicsDeviceOpenGL::GraphicsDeviceOpenGL() :
     ));
     m_uniform_buffer_offset_alignment =
         static_cast<std::size_t>(uniform_buffer_offset_alignment);
+    // GL 4.5 may report zero storage blocks for the vertex stage. Mesh
+    // instancing binds two.
+    GLint vertex_storage_blocks = 0;
+    FEI_GL_CALL(glGetIntegerv(
+        GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS,
+        &vertex_storage_blocks
+    ));
+    m_vertex_storage_buffers = vertex_storage_blocks >= 2;
 
     GLuint vao;
     FEI_GL_CALL(glGenVertexArrays(1, &vao));
@@ -505,6 +537,31 @@ void GraphicsDeviceOpenGL::submit_commands(
     std::shared_ptr<CommandBuffer> command_buffer
 ) const {
     FEI_PROFILE_SCOPE("OpenGL Submit Commands");
+    OpenGLPendingCommandSubmit submit;
+    append_recording(command_buffer, submit);
+    m_state->enqueue_operation(std::move(submit));
+}
+
+void GraphicsDeviceOpenGL::submit_command_buffers(
+    std::span<const std::shared_ptr<CommandBuffer>> command_buffers
+) const {
+    FEI_PROFILE_SCOPE("OpenGL Submit Commands");
+    if (command_buffers.empty()) {
+        return;
+    }
+
+    OpenGLPendingCommandSubmit submit;
+    submit.streams.reserve(command_buffers.size());
+    for (const auto& command_buffer : command_buffers) {
+        append_recording(command_buffer, submit);
+    }
+    m_state->enqueue_operation(std::move(submit));
+}
+
+void GraphicsDeviceOpenGL::append_recording(
+    const std::shared_ptr<CommandBuffer>& command_buffer,
+    OpenGLPendingCommandSubmit& submit
+) const {
     auto command_buffer_gl =
         std::dynamic_pointer_cast<CommandBufferOpenGL>(command_buffer);
     if (!command_buffer_gl) {
@@ -515,12 +572,9 @@ void GraphicsDeviceOpenGL::submit_commands(
     }
 
     command_buffer_gl->ensure_executable("submit_commands");
-    auto commands = command_buffer_gl->m_commands;
+    // The recording is consumed by the submit; begin() starts a new one.
+    submit.streams.push_back(std::move(command_buffer_gl->m_stream));
     command_buffer_gl->mark_submitted();
-
-    m_state->enqueue_operation(
-        OpenGLPendingCommandSubmit {.commands = std::move(commands)}
-    );
 }
 
 void GraphicsDeviceOpenGL::update_texture(
@@ -536,10 +590,8 @@ void GraphicsDeviceOpenGL::update_texture(
     std::uint32_t layer
 ) const {
     FEI_PROFILE_SCOPE("OpenGL Queue Texture Update");
-    const auto byte_count = static_cast<std::size_t>(width) *
-                            static_cast<std::size_t>(height) *
-                            static_cast<std::size_t>(depth) *
-                            get_pixel_format_size(texture->format());
+    const auto byte_count =
+        texture_data_size(texture->format(), width, height, depth);
     auto bytes = copy_bytes(data, byte_count);
 
     m_state->enqueue_operation(
@@ -576,6 +628,24 @@ void GraphicsDeviceOpenGL::update_buffer(
     );
 }
 
+void GraphicsDeviceOpenGL::copy_buffer(
+    std::shared_ptr<Buffer> src,
+    std::uint32_t src_offset,
+    std::shared_ptr<Buffer> dst,
+    std::uint32_t dst_offset,
+    std::uint32_t size
+) const {
+    m_state->enqueue_operation(
+        OpenGLPendingBufferCopy {
+            .src = std::move(src),
+            .src_offset = src_offset,
+            .dst = std::move(dst),
+            .dst_offset = dst_offset,
+            .size = size,
+        }
+    );
+}
+
 MappedResource GraphicsDeviceOpenGL::map(
     std::shared_ptr<MappableResource> resource,
     MapMode map_mode
@@ -690,6 +760,21 @@ void GraphicsDeviceOpenGL::flush() const {
     flush_pending_work();
 }
 
+bool GraphicsDeviceOpenGL::prepare_pipeline(
+    const std::shared_ptr<Pipeline>& pipeline
+) const {
+    auto pipeline_gl = std::static_pointer_cast<PipelineOpenGL>(pipeline);
+    if (pipeline_gl->linked()) {
+        return true;
+    }
+    if (pipeline_gl->request_link()) {
+        m_state->enqueue_operation(OpenGLPendingPipelineLink {
+            .pipeline = pipeline,
+        });
+    }
+    return false;
+}
+
 OpenGLResourceCacheStats GraphicsDeviceOpenGL::resource_cache_stats() const {
     return m_state->resource_cache_stats();
 }
@@ -699,7 +784,7 @@ void GraphicsDeviceOpenGL::flush_pending_work() const {
     assert_context_thread("GraphicsDeviceOpenGL::flush_pending_work");
     auto operations = m_state->take_pending_operations();
 
-    for (const auto& operation : operations) {
+    for (auto& operation : operations) {
         execute_operation(operation);
     }
     operations.clear();
@@ -710,20 +795,27 @@ void GraphicsDeviceOpenGL::flush_pending_work() const {
 }
 
 void GraphicsDeviceOpenGL::execute_operation(
-    const OpenGLPendingOperation& operation
+    OpenGLPendingOperation& operation
 ) const {
     std::visit(
-        [this](const auto& op) {
+        [this](auto& op) {
             using OperationT = std::decay_t<decltype(op)>;
             if constexpr (
                 std::is_same_v<OperationT, OpenGLPendingCommandSubmit>
             ) {
                 CommandBufferExecutorOpenGL executor(*this);
-                executor.execute(op.commands);
+                executor.execute(op.streams);
+                for (auto& stream : op.streams) {
+                    m_state->recycle_command_stream(std::move(stream));
+                }
             } else if constexpr (
                 std::is_same_v<OperationT, OpenGLPendingBufferUpdate>
             ) {
                 execute_update_buffer(op);
+            } else if constexpr (
+                std::is_same_v<OperationT, OpenGLPendingBufferCopy>
+            ) {
+                execute_copy_buffer(op);
             } else if constexpr (
                 std::is_same_v<OperationT, OpenGLPendingTextureUpdate>
             ) {
@@ -732,6 +824,10 @@ void GraphicsDeviceOpenGL::execute_operation(
                 std::is_same_v<OperationT, OpenGLPendingTextureReadback>
             ) {
                 execute_texture_readback(op);
+            } else if constexpr (
+                std::is_same_v<OperationT, OpenGLPendingPipelineLink>
+            ) {
+                execute_pipeline_link(op);
             } else {
                 static_assert(always_false_v<OperationT>);
             }
@@ -765,6 +861,23 @@ void GraphicsDeviceOpenGL::execute_update_buffer(
     ));
 }
 
+void GraphicsDeviceOpenGL::execute_copy_buffer(
+    const OpenGLPendingBufferCopy& copy
+) const {
+    FEI_PROFILE_SCOPE("OpenGL Buffer Copy");
+    auto src_gl = std::static_pointer_cast<BufferOpenGL>(copy.src);
+    auto dst_gl = std::static_pointer_cast<BufferOpenGL>(copy.dst);
+    src_gl->ensure_created();
+    dst_gl->ensure_created();
+    FEI_GL_CALL(glCopyNamedBufferSubData(
+        src_gl->id(),
+        dst_gl->id(),
+        static_cast<GLintptr>(copy.src_offset),
+        static_cast<GLintptr>(copy.dst_offset),
+        to_gl_sizeiptr(copy.size)
+    ));
+}
+
 void GraphicsDeviceOpenGL::execute_update_texture(
     const OpenGLPendingTextureUpdate& update
 ) const {
@@ -772,7 +885,36 @@ void GraphicsDeviceOpenGL::execute_update_texture(
     auto gl_texture = std::static_pointer_cast<TextureOpenGL>(update.texture);
     gl_texture->ensure_created();
 
-    if (update.texture->usage().is_set(TextureUsage::Cubemap)) {
+    if (is_block_compressed_format(update.texture->format())) {
+        const auto size = static_cast<GLsizei>(update.data.size());
+        if (update.texture->usage().is_set(TextureUsage::Cubemap)) {
+            FEI_GL_CALL(glCompressedTextureSubImage3D(
+                gl_texture->id(),
+                static_cast<GLint>(update.mip_level),
+                static_cast<GLint>(update.x),
+                static_cast<GLint>(update.y),
+                static_cast<GLint>(update.z),
+                static_cast<GLsizei>(update.width),
+                static_cast<GLsizei>(update.height),
+                static_cast<GLsizei>(update.depth),
+                gl_texture->gl_sized_internal_format(),
+                size,
+                update.data.data()
+            ));
+        } else {
+            FEI_GL_CALL(glCompressedTextureSubImage2D(
+                gl_texture->id(),
+                static_cast<GLint>(update.mip_level),
+                static_cast<GLint>(update.x),
+                static_cast<GLint>(update.y),
+                static_cast<GLsizei>(update.width),
+                static_cast<GLsizei>(update.height),
+                gl_texture->gl_sized_internal_format(),
+                size,
+                update.data.data()
+            ));
+        }
+    } else if (update.texture->usage().is_set(TextureUsage::Cubemap)) {
         FEI_GL_CALL(glTextureSubImage3D(
             gl_texture->id(),
             static_cast<GLint>(update.mip_level),
@@ -807,6 +949,12 @@ void GraphicsDeviceOpenGL::execute_texture_readback(
     fei::execute_texture_readback(readback);
 }
 
+void GraphicsDeviceOpenGL::execute_pipeline_link(
+    const OpenGLPendingPipelineLink& link
+) const {
+    std::static_pointer_cast<PipelineOpenGL>(link.pipeline)->ensure_created();
+}
+
 void GraphicsDeviceOpenGL::collect_texture_readbacks() const {
     for (const auto& readback : m_state->live_texture_readbacks()) {
         fei::collect_ready_texture_readbacks(readback);
@@ -175,7 +175,11 @@ void PipelineOpenGL::create_gl_resource() const {
         fei::fatal("Failed to link OpenGL program: {}", info_log);
     }
 
+    m_base_instance_location = FEI_GL_CALL(
+        glGetUniformLocation(m_program, "SPIRV_Cross_BaseInstance")
+    );
     process_resource_layouts();
+    m_linked.store(true, std::memory_order_release);
 }
 
 void PipelineOpenGL::destroy_gl_resource() {
@@ -184,7 +188,10 @@ void PipelineOpenGL::destroy_gl_resource() {
         m_program = 0;
         m_resource_bindings.clear();
         m_memory_barriers = 0;
+        m_base_instance_location = -1;
     }
+    m_linked.store(false, std::memory_order_release);
+    m_link_queued.store(false);
 }
 
 void PipelineOpenGL::validate_shader_resource_layouts() const {
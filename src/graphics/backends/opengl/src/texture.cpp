@@ -13,6 +13,12 @@ TextureOpenGL::TextureOpenGL(const TextureDescription& desc) :
     m_texture_type(desc.texture_type), m_sample_count(desc.sample_count) {
 
     m_gl_sized_internal_format = to_gl_sized_internal_format(m_texture_format);
+    // Compressed uploads only need the internal format.
+    if (is_block_compressed_format(m_texture_format)) {
+        m_gl_format = GL_NONE;
+        m_gl_type = GL_NONE;
+        return;
+    }
     m_gl_format = to_gl_pixel_format(m_texture_format);
     m_gl_type = to_gl_pixel_type(m_texture_format);
 }
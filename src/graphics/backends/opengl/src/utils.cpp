@@ -3,6 +3,27 @@
 #include "base/log.hpp"
 #include "graphics/enums.hpp"
 
+// S3TC comes from EXT_texture_compression_s3tc and EXT_texture_sRGB rather
+// than core GL, so the loader header may not define these enums.
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
 namespace fei {
 
 std::string opengl_error_string(GLenum const err) noexcept {
@@ -291,18 +312,18 @@ GLenum to_gl_sized_internal_format(PixelFormat format) {
             return GL_DEPTH_COMPONENT32F;
         case PixelFormat::Depth32FloatStencil8:
             return GL_DEPTH32F_STENCIL8;
-        // case PixelFormat::Bc1RgbaUnorm:
-        //     return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-        // case PixelFormat::Bc1RgbaUnormSrgb:
-        //     return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
-        // case PixelFormat::Bc2RgbaUnorm:
-        //     return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-        // case PixelFormat::Bc2RgbaUnormSrgb:
-        //     return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
-        // case PixelFormat::Bc3RgbaUnorm:
-        //     return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-        // case PixelFormat::Bc3RgbaUnormSrgb:
-        //     return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case PixelFormat::Bc1RgbaUnorm:
+            return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case PixelFormat::Bc1RgbaUnormSrgb:
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case PixelFormat::Bc2RgbaUnorm:
+            return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        case PixelFormat::Bc2RgbaUnormSrgb:
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+        case PixelFormat::Bc3RgbaUnorm:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case PixelFormat::Bc3RgbaUnormSrgb:
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
         case PixelFormat::Bc4RUnorm:
             return GL_COMPRESSED_RED_RGTC1;
         case PixelFormat::Bc4RSnorm:
@@ -6,6 +6,7 @@
 #include "graphics_opengl/sampler.hpp"
 #include "graphics_opengl/texture.hpp"
 
+#include <array>
 #include <catch2/catch_test_macros.hpp>
 #include <cstddef>
 #include <memory>
@@ -385,29 +386,36 @@ TEST_CASE(
     std::weak_ptr<const Texture> weak_target = target;
     std::weak_ptr<const ResourceLayout> weak_layout = layout;
 
-    std::vector<opengl_commands::Command> commands;
-    commands.emplace_back(
+    opengl_commands::CommandStream stream;
+    stream.push(
         opengl_commands::BeginRenderPass {
-            .desc = RenderPassDescription {.framebuffer = framebuffer},
+            .render_pass_index = stream.push_render_pass(
+                RenderPassDescription {.framebuffer = framebuffer}
+            ),
         }
     );
-    commands.emplace_back(
+    stream.push(
         opengl_commands::SetResourceSet {
+            .resource_set = resource_set.get(),
             .slot = 0,
-            .resource_set = resource_set,
-            .dynamic_offsets = {},
+            .first_dynamic_offset = stream.push_dynamic_offsets({}),
+            .dynamic_offset_count = 0,
         }
     );
-    commands.emplace_back(
+    stream.retain(resource_set);
+    const std::vector<std::byte> upload(16);
+    stream.push(
         opengl_commands::UpdateBuffer {
-            .buffer = uniform,
+            .buffer = uniform.get(),
             .offset = 0,
-            .data = std::vector<std::byte>(16),
+            .data_offset = stream.push_upload(upload.data(), upload.size()),
+            .size = upload.size(),
         }
     );
-    state.enqueue_operation(
-        OpenGLPendingCommandSubmit {.commands = std::move(commands)}
-    );
+    stream.retain(uniform);
+    OpenGLPendingCommandSubmit submit;
+    submit.streams.push_back(std::move(stream));
+    state.enqueue_operation(std::move(submit));
 
     uniform.reset();
     sampled_texture.reset();
@@ -434,3 +442,105 @@ TEST_CASE(
     CHECK(weak_target.expired());
     CHECK(weak_layout.expired());
 }
+
+TEST_CASE(
+    "OpenGL command streams round-trip packed commands",
+    "[graphics][opengl][command-buffer]"
+) {
+    auto buffer = std::make_shared<BufferOpenGL>(BufferDescription {
+        .size = 64,
+        .usages = BufferUsages::Uniform,
+    });
+    const std::array<uint32, 2> dynamic_offsets {256, 512};
+    const std::array<std::byte, 4> bytes {
+        std::byte {1},
+        std::byte {2},
+        std::byte {3},
+        std::byte {4},
+    };
+
+    opengl_commands::CommandStream stream;
+    stream.push(opengl_commands::EndRenderPass {});
+    stream.push(
+        opengl_commands::SetResourceSet {
+            .resource_set = nullptr,
+            .slot = 2,
+            .first_dynamic_offset =
+                stream.push_dynamic_offsets(dynamic_offsets),
+            .dynamic_offset_count = 2,
+        }
+    );
+    stream.push(
+        opengl_commands::UpdateBuffer {
+            .buffer = buffer.get(),
+            .offset = 8,
+            .data_offset = stream.push_upload(bytes.data(), bytes.size()),
+            .size = bytes.size(),
+        }
+    );
+    stream.push(
+        opengl_commands::DrawIndexed {
+            .count = 36,
+            .first_index = 6,
+            .vertex_offset = -4,
+            .instance_count = 3,
+            .first_instance = 7,
+        }
+    );
+
+    using opengl_commands::CommandType;
+    std::size_t offset = 0;
+    REQUIRE(stream.peek(offset) == CommandType::EndRenderPass);
+    (void)stream.decode<opengl_commands::EndRenderPass>(offset);
+
+    REQUIRE(stream.peek(offset) == CommandType::SetResourceSet);
+    const auto set = stream.decode<opengl_commands::SetResourceSet>(offset);
+    CHECK(set.slot == 2);
+    const auto offsets = stream.dynamic_offsets(
+        set.first_dynamic_offset,
+        set.dynamic_offset_count
+    );
+    REQUIRE(offsets.size() == 2);
+    CHECK(offsets[0] == 256);
+    CHECK(offsets[1] == 512);
+
+    REQUIRE(stream.peek(offset) == CommandType::UpdateBuffer);
+    const auto update = stream.decode<opengl_commands::UpdateBuffer>(offset);
+    CHECK(update.buffer == buffer.get());
+    CHECK(update.offset == 8);
+    const auto data =
+        stream.upload_data().subspan(update.data_offset, update.size);
+    REQUIRE(data.size() == bytes.size());
+    CHECK(data[3] == std::byte {4});
+
+    REQUIRE(stream.peek(offset) == CommandType::DrawIndexed);
+    const auto draw = stream.decode<opengl_commands::DrawIndexed>(offset);
+    CHECK(draw.count == 36);
+    CHECK(draw.vertex_offset == -4);
+    CHECK(draw.first_instance == 7);
+    CHECK(offset == stream.size_bytes());
+}
+
+TEST_CASE(
+    "OpenGL device state recycles cleared command streams",
+    "[graphics][opengl][command-buffer]"
+) {
+    OpenGLDeviceState state;
+    auto buffer = std::make_shared<BufferOpenGL>(BufferDescription {
+        .size = 64,
+        .usages = BufferUsages::Uniform,
+    });
+    std::weak_ptr<const Buffer> weak_buffer = buffer;
+
+    auto stream = state.acquire_command_stream();
+    CHECK_FALSE(stream.has_storage());
+    stream.push(opengl_commands::SetVertexBuffer {.buffer = buffer.get()});
+    stream.retain(std::move(buffer));
+    state.recycle_command_stream(std::move(stream));
+    CHECK(weak_buffer.expired());
+
+    auto recycled = state.acquire_command_stream();
+    CHECK(recycled.has_storage());
+    CHECK(recycled.empty());
+    CHECK_FALSE(state.acquire_command_stream().has_storage());
+}
@@ -52,9 +52,12 @@ class CommandBufferVulkan : public CommandBuffer {
     std::uint32_t m_viewport_width {0};
     std::uint32_t m_viewport_height {0};
     bool m_viewport_set {false};
+    // Persistently mapped staging buffer that update_buffer sub-allocates
+    // from. It is reused from offset zero by the next recording.
+    std::shared_ptr<BufferVulkan> m_upload_staging;
+    std::size_t m_upload_staging_offset {0};
 
   public:
-    using CommandBuffer::draw_indexed;
     using CommandBuffer::update_buffer;
 
     explicit CommandBufferVulkan(std::shared_ptr<VulkanDeviceState> state);
@@ -83,24 +86,13 @@ class CommandBufferVulkan : public CommandBuffer {
         std::uint32_t w,
         std::uint32_t h
     ) override;
-    void set_vertex_buffer(std::shared_ptr<const Buffer> buffer) override;
-    void set_resource_set(
-        uint32 slot,
-        std::shared_ptr<const ResourceSet> resource_set,
-        std::span<const uint32> dynamic_offsets
-    ) override;
     void update_buffer(
         std::shared_ptr<Buffer> buffer,
         uint32 offset,
         const void* data,
         std::size_t size
     ) override;
-    void draw(std::size_t start, std::size_t count) override;
-    void draw_indexed(
-        std::size_t count,
-        uint32 first_index,
-        std::int32_t vertex_offset
-    ) override;
+    void reserve_buffer_updates(std::size_t size) override;
     void dispatch(
         std::size_t group_x,
         std::size_t group_y,
@@ -113,11 +105,31 @@ class CommandBufferVulkan : public CommandBuffer {
     void set_compute_pipeline_impl(
         std::shared_ptr<const Pipeline> pipeline
     ) override;
+    void set_vertex_buffer_impl(std::shared_ptr<const Buffer> buffer
+    ) override;
     void set_index_buffer_impl(
         std::shared_ptr<const Buffer> buffer,
         IndexFormat format,
         uint32 offset
     ) override;
+    void set_resource_set_impl(
+        uint32 slot,
+        std::shared_ptr<const ResourceSet> resource_set,
+        std::span<const uint32> dynamic_offsets
+    ) override;
+    void draw_impl(
+        std::size_t start,
+        std::size_t count,
+        uint32 instance_count,
+        uint32 first_instance
+    ) override;
+    void draw_indexed_impl(
+        std::size_t count,
+        uint32 first_index,
+        std::int32_t vertex_offset,
+        uint32 instance_count,
+        uint32 first_instance
+    ) override;
     void generate_mipmaps_impl(std::shared_ptr<const Texture> texture) override;
     void copy_texture_impl(
         std::shared_ptr<const Texture> src,
@@ -146,6 +158,7 @@ class CommandBufferVulkan : public CommandBuffer {
     void end_native_render_pass();
     void prepare_graphics_resource_sets();
     void prepare_compute_resource_sets();
+    void ensure_upload_staging(std::size_t size);
     void mark_submitted();
     void mark_completed();
 };
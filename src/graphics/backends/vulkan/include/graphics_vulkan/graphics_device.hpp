@@ -94,6 +94,17 @@ class GraphicsDeviceVulkan : public GraphicsDevice {
         const void* data,
         std::uint32_t size
     ) const override;
+    void copy_buffer(
+        std::shared_ptr<Buffer> src,
+        std::uint32_t src_offset,
+        std::shared_ptr<Buffer> dst,
+        std::uint32_t dst_offset,
+        std::uint32_t size
+    ) const override;
+    [[nodiscard]] bool supports_buffer_copy() const override { return true; }
+    [[nodiscard]] bool supports_vertex_storage_buffers() const override {
+        return true;
+    }
 
     MappedResource
     map(std::shared_ptr<MappableResource> resource,
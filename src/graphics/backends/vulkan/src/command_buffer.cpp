@@ -10,6 +10,7 @@
 #include "graphics_vulkan/utils.hpp"
 
 #include <algorithm>
+#include <bit>
 #include <cstring>
 #include <limits>
 #include <mutex>
@@ -747,12 +748,13 @@ void transition_resource_set_buffers(
 void record_buffer_copy(
     VkCommandBuffer command_buffer,
     const BufferVulkan& src,
+    VkDeviceSize src_offset,
     const BufferVulkan& dst,
     VkDeviceSize dst_offset,
     VkDeviceSize size
 ) {
     VkBufferCopy copy {
-        .srcOffset = 0,
+        .srcOffset = src_offset,
         .dstOffset = dst_offset,
         .size = size,
     };
@@ -1051,6 +1053,7 @@ void CommandBufferVulkan::begin() {
     }
 
     m_pipeline.reset();
+    reset_recording_state();
     m_graphics_pipeline.reset();
     m_compute_pipeline.reset();
     m_active_framebuffer.reset();
@@ -1063,6 +1066,7 @@ void CommandBufferVulkan::begin() {
     m_logical_render_pass_active = false;
     m_native_render_pass_active = false;
     m_viewport_set = false;
+    m_upload_staging_offset = 0;
 
     std::scoped_lock lock(m_state->immediate_mutex());
     check_vk(vkResetCommandBuffer(m_command_buffer, 0), "vkResetCommandBuffer");
@@ -1090,6 +1094,7 @@ void CommandBufferVulkan::end() {
 
 void CommandBufferVulkan::begin_render_pass(const RenderPassDescription& desc) {
     ensure_recording("begin_render_pass");
+    invalidate_bind_state();
     if (m_logical_render_pass_active) {
         fatal(
             "CommandBufferVulkan::begin_render_pass called inside render pass"
@@ -1183,6 +1188,7 @@ void CommandBufferVulkan::end_native_render_pass() {
 
 void CommandBufferVulkan::end_render_pass() {
     ensure_recording("end_render_pass");
+    invalidate_bind_state();
     if (!m_logical_render_pass_active) {
         fatal(
             "CommandBufferVulkan::end_render_pass called outside render pass"
@@ -1244,7 +1250,7 @@ void CommandBufferVulkan::set_scissor(
     vkCmdSetScissor(m_command_buffer, 0, 1, &scissor);
 }
 
-void CommandBufferVulkan::set_vertex_buffer(
+void CommandBufferVulkan::set_vertex_buffer_impl(
     std::shared_ptr<const Buffer> buffer
 ) {
     ensure_recording("set_vertex_buffer");
@@ -1258,7 +1264,7 @@ void CommandBufferVulkan::set_vertex_buffer(
     m_resource_retention.retain_buffer(std::move(buffer_vk));
 }
 
-void CommandBufferVulkan::set_resource_set(
+void CommandBufferVulkan::set_resource_set_impl(
     uint32 slot,
     std::shared_ptr<const ResourceSet> resource_set,
     std::span<const uint32> dynamic_offsets
@@ -1381,25 +1387,60 @@ void CommandBufferVulkan::update_buffer(
         );
     }
 
-    auto staging = std::make_shared<BufferVulkan>(
-        m_state,
-        BufferDescription {
-            .size = size,
-            .usages = BufferUsages::Staging,
-        }
+    ensure_upload_staging(size);
+    const auto staging_offset = m_upload_staging_offset;
+    m_upload_staging->update(
+        checked_u32(staging_offset, "update buffer staging offset"),
+        data,
+        update_size
     );
-    staging->update(0, data, update_size);
+    m_upload_staging_offset += size;
     record_buffer_copy(
         m_command_buffer,
-        *staging,
+        *m_upload_staging,
+        static_cast<VkDeviceSize>(staging_offset),
         *buffer_vk,
         offset,
         static_cast<VkDeviceSize>(size)
     );
-    m_resource_retention.retain_transient_buffer(std::move(staging));
 }
 
-void CommandBufferVulkan::draw(std::size_t start, std::size_t count) {
+void CommandBufferVulkan::reserve_buffer_updates(std::size_t size) {
+    ensure_recording("reserve_buffer_updates");
+    if (size > 0) {
+        ensure_upload_staging(size);
+    }
+}
+
+void CommandBufferVulkan::ensure_upload_staging(std::size_t size) {
+    constexpr std::size_t min_upload_staging_size = 64 * 1024;
+    if (m_upload_staging &&
+        size <= m_upload_staging->size() - m_upload_staging_offset) {
+        return;
+    }
+
+    std::size_t capacity = min_upload_staging_size;
+    if (m_upload_staging) {
+        // Copies recorded earlier still read from the old buffer.
+        m_resource_retention.retain_transient_buffer(m_upload_staging);
+        capacity = std::max(capacity, m_upload_staging->size() * 2);
+    }
+    m_upload_staging = std::make_shared<BufferVulkan>(
+        m_state,
+        BufferDescription {
+            .size = std::max(capacity, std::bit_ceil(size)),
+            .usages = BufferUsages::Staging,
+        }
+    );
+    m_upload_staging_offset = 0;
+}
+
+void CommandBufferVulkan::draw_impl(
+    std::size_t start,
+    std::size_t count,
+    uint32 instance_count,
+    uint32 first_instance
+) {
     ensure_recording("draw");
     if (!m_logical_render_pass_active) {
         fatal("CommandBufferVulkan::draw called outside render pass");
@@ -1412,16 +1453,18 @@ void CommandBufferVulkan::draw(std::size_t start, std::size_t count) {
     vkCmdDraw(
         m_command_buffer,
         checked_u32(count, "draw count"),
-        1,
+        instance_count,
         checked_u32(start, "draw start"),
-        0
+        first_instance
     );
 }
 
-void CommandBufferVulkan::draw_indexed(
+void CommandBufferVulkan::draw_indexed_impl(
     std::size_t count,
     uint32 first_index,
-    std::int32_t vertex_offset
+    std::int32_t vertex_offset,
+    uint32 instance_count,
+    uint32 first_instance
 ) {
     ensure_recording("draw_indexed");
     if (!m_logical_render_pass_active) {
@@ -1435,10 +1478,10 @@ void CommandBufferVulkan::draw_indexed(
     vkCmdDrawIndexed(
         m_command_buffer,
         checked_u32(count, "draw indexed count"),
-        1,
+        instance_count,
         first_index,
         vertex_offset,
-        0
+        first_instance
     );
 }
 
@@ -225,6 +225,7 @@ void transition_image_layout(
 void copy_buffer_immediate(
     const VulkanDeviceState& state,
     VkBuffer src,
+    VkDeviceSize src_offset,
     VkBuffer dst,
     VkDeviceSize dst_offset,
     VkDeviceSize size,
@@ -262,7 +263,7 @@ void copy_buffer_immediate(
     );
 
     VkBufferCopy copy_region {
-        .srcOffset = 0,
+        .srcOffset = src_offset,
         .dstOffset = dst_offset,
         .size = size,
     };
@@ -477,38 +478,6 @@ checked_multiply(std::size_t lhs, std::size_t rhs, std::string_view name) {
     return lhs * rhs;
 }
 
-bool is_block_compressed_format(PixelFormat format) {
-    switch (format) {
-        case PixelFormat::Bc1RgbaUnorm:
-        case PixelFormat::Bc1RgbaUnormSrgb:
-        case PixelFormat::Bc2RgbaUnorm:
-        case PixelFormat::Bc2RgbaUnormSrgb:
-        case PixelFormat::Bc3RgbaUnorm:
-        case PixelFormat::Bc3RgbaUnormSrgb:
-        case PixelFormat::Bc4RUnorm:
-        case PixelFormat::Bc4RSnorm:
-        case PixelFormat::Bc5RgUnorm:
-        case PixelFormat::Bc5RgSnorm:
-        case PixelFormat::Bc6hRgbUfloat:
-        case PixelFormat::Bc6hRgbFloat:
-        case PixelFormat::Bc7RgbaUnorm:
-        case PixelFormat::Bc7RgbaUnormSrgb:
-        case PixelFormat::Etc2Rgb8Unorm:
-        case PixelFormat::Etc2Rgb8UnormSrgb:
-        case PixelFormat::Etc2Rgb8A1Unorm:
-        case PixelFormat::Etc2Rgb8A1UnormSrgb:
-        case PixelFormat::Etc2Rgba8Unorm:
-        case PixelFormat::Etc2Rgba8UnormSrgb:
-        case PixelFormat::EacR11Unorm:
-        case PixelFormat::EacR11Snorm:
-        case PixelFormat::EacRg11Unorm:
-        case PixelFormat::EacRg11Snorm:
-            return true;
-        default:
-            return false;
-    }
-}
-
 VkImageAspectFlags mapped_texture_aspect(PixelFormat format) {
     if (is_vk_stencil_format(format)) {
         fatal("GraphicsDeviceVulkan::map does not support stencil textures");
@@ -947,10 +916,8 @@ void GraphicsDeviceVulkan::update_texture(
         layer
     );
 
-    const auto byte_count = static_cast<std::size_t>(width) *
-                            static_cast<std::size_t>(height) *
-                            static_cast<std::size_t>(depth) *
-                            get_pixel_format_size(texture_vk->format());
+    const auto byte_count =
+        texture_data_size(texture_vk->format(), width, height, depth);
     if (byte_count > std::numeric_limits<std::uint32_t>::max()) {
         fatal(
             "GraphicsDeviceVulkan::update_texture upload is too large: {} "
@@ -1025,6 +992,7 @@ void GraphicsDeviceVulkan::update_buffer(
     copy_buffer_immediate(
         *m_state,
         staging.handle(),
+        0,
         buffer_vk->handle(),
         offset,
         size,
@@ -1032,6 +1000,41 @@ void GraphicsDeviceVulkan::update_buffer(
     );
 }
 
+void GraphicsDeviceVulkan::copy_buffer(
+    std::shared_ptr<Buffer> src,
+    std::uint32_t src_offset,
+    std::shared_ptr<Buffer> dst,
+    std::uint32_t dst_offset,
+    std::uint32_t size
+) const {
+    auto src_vk = std::dynamic_pointer_cast<BufferVulkan>(src);
+    auto dst_vk = std::dynamic_pointer_cast<BufferVulkan>(dst);
+    if (!src_vk || !dst_vk) {
+        fatal("GraphicsDeviceVulkan::copy_buffer received non-Vulkan buffer");
+    }
+    if (size == 0) {
+        return;
+    }
+    if (static_cast<std::size_t>(src_offset) + size > src_vk->size() ||
+        static_cast<std::size_t>(dst_offset) + size > dst_vk->size()) {
+        fatal(
+            "GraphicsDeviceVulkan::copy_buffer range of {} bytes exceeds "
+            "buffer size",
+            size
+        );
+    }
+
+    copy_buffer_immediate(
+        *m_state,
+        src_vk->handle(),
+        src_offset,
+        dst_vk->handle(),
+        dst_offset,
+        size,
+        dst_vk->usages()
+    );
+}
+
 MappedResource GraphicsDeviceVulkan::map(
     std::shared_ptr<MappableResource> resource,
     MapMode map_mode
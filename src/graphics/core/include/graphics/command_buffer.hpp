@@ -9,17 +9,53 @@
 #include "graphics/texture.hpp"
 #include "graphics/utils.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <span>
 #include <utility>
+#include <vector>
 
 namespace fei {
 
+// Per-recording counters for the redundant state filtering in CommandBuffer.
+struct CommandBufferStats {
+    uint32 draws {0};
+    // Instances drawn beyond the first, i.e. draw calls folded away.
+    uint32 draws_saved {0};
+    uint32 binds {0};
+    uint32 binds_skipped {0};
+};
+
 class CommandBuffer {
   protected:
     std::shared_ptr<const Pipeline> m_pipeline;
 
+  private:
+    struct BoundResourceSet {
+        std::shared_ptr<const ResourceSet> resource_set;
+        std::vector<uint32> dynamic_offsets;
+    };
+
+    // Mirror of what has been recorded so far. Binds matching it are dropped
+    // before they reach the backend.
+    std::shared_ptr<const Pipeline> m_bound_pipeline;
+    std::vector<BoundResourceSet> m_bound_resource_sets;
+    std::shared_ptr<const Buffer> m_bound_vertex_buffer;
+    std::shared_ptr<const Buffer> m_bound_index_buffer;
+    IndexFormat m_bound_index_format {IndexFormat::Uint16};
+    uint32 m_bound_index_offset {0};
+    CommandBufferStats m_stats;
+
+    bool filter_bind(bool redundant) {
+        if (redundant) {
+            m_stats.binds_skipped++;
+            return false;
+        }
+        m_stats.binds++;
+        return true;
+    }
+
   public:
     virtual ~CommandBuffer() = default;
 
@@ -42,26 +78,52 @@ class CommandBuffer {
         std::uint32_t h
     ) = 0;
     void set_render_pipeline(std::shared_ptr<const Pipeline> pipeline) {
+        if (!filter_bind(pipeline && pipeline == m_bound_pipeline)) {
+            return;
+        }
+        // Resource bindings and vertex attributes are resolved against the
+        // pipeline layout, so they have to be re-recorded after a switch.
+        m_bound_resource_sets.clear();
+        m_bound_vertex_buffer.reset();
+        m_bound_pipeline = pipeline;
         m_pipeline = pipeline;
         set_render_pipeline_impl(pipeline);
     }
     void set_compute_pipeline(std::shared_ptr<const Pipeline> pipeline) {
+        m_stats.binds++;
+        invalidate_bind_state();
         m_pipeline = pipeline;
         set_compute_pipeline_impl(pipeline);
     }
-    virtual void set_vertex_buffer(std::shared_ptr<const Buffer> buffer) = 0;
+    void set_vertex_buffer(std::shared_ptr<const Buffer> buffer) {
+        if (!filter_bind(buffer && buffer == m_bound_vertex_buffer)) {
+            return;
+        }
+        m_bound_vertex_buffer = buffer;
+        set_vertex_buffer_impl(std::move(buffer));
+    }
 
-    virtual void
+    void
     set_index_buffer(std::shared_ptr<const Buffer> buffer, IndexFormat format) {
-        set_index_buffer_impl(buffer, format, 0);
+        set_index_buffer(std::move(buffer), format, 0);
     }
 
-    virtual void set_index_buffer(
+    void set_index_buffer(
         std::shared_ptr<const Buffer> buffer,
         IndexFormat format,
         uint32 offset
     ) {
-        set_index_buffer_impl(buffer, format, offset);
+        if (!filter_bind(
+                buffer && buffer == m_bound_index_buffer &&
+                format == m_bound_index_format &&
+                offset == m_bound_index_offset
+            )) {
+            return;
+        }
+        m_bound_index_buffer = buffer;
+        m_bound_index_format = format;
+        m_bound_index_offset = offset;
+        set_index_buffer_impl(std::move(buffer), format, offset);
     }
 
     void set_resource_set(
@@ -71,11 +133,28 @@ class CommandBuffer {
         set_resource_set(slot, std::move(resource_set), {});
     }
 
-    virtual void set_resource_set(
+    void set_resource_set(
         uint32 slot,
         std::shared_ptr<const ResourceSet> resource_set,
         std::span<const uint32> dynamic_offsets
-    ) = 0;
+    ) {
+        if (slot >= m_bound_resource_sets.size()) {
+            m_bound_resource_sets.resize(slot + 1);
+        }
+        auto& bound = m_bound_resource_sets[slot];
+        if (!filter_bind(
+                resource_set && resource_set == bound.resource_set &&
+                std::ranges::equal(dynamic_offsets, bound.dynamic_offsets)
+            )) {
+            return;
+        }
+        bound.resource_set = resource_set;
+        bound.dynamic_offsets.assign(
+            dynamic_offsets.begin(),
+            dynamic_offsets.end()
+        );
+        set_resource_set_impl(slot, std::move(resource_set), dynamic_offsets);
+    }
     void update_buffer(
         std::shared_ptr<Buffer> buffer,
         const void* data,
@@ -89,13 +168,47 @@ class CommandBuffer {
         const void* data,
         std::size_t size
     ) = 0;
-    virtual void draw(std::size_t start, std::size_t count) = 0;
+    // Announces roughly how many bytes of update_buffer data are about to be
+    // recorded, so backends can size their upload storage once.
+    virtual void reserve_buffer_updates(std::size_t /*size*/) {}
+    void draw(std::size_t start, std::size_t count) {
+        draw(start, count, 1, 0);
+    }
+    // `first_instance` is visible to shaders through the instance index, which
+    // lets a single draw select per-instance data such as mesh transforms.
+    void draw(
+        std::size_t start,
+        std::size_t count,
+        uint32 instance_count,
+        uint32 first_instance
+    ) {
+        count_draw(instance_count);
+        draw_impl(start, count, instance_count, first_instance);
+    }
     void draw_indexed(std::size_t count) { draw_indexed(count, 0, 0); }
-    virtual void draw_indexed(
+    void draw_indexed(
         std::size_t count,
         uint32 first_index,
         std::int32_t vertex_offset
-    ) = 0;
+    ) {
+        draw_indexed(count, first_index, vertex_offset, 1, 0);
+    }
+    void draw_indexed(
+        std::size_t count,
+        uint32 first_index,
+        std::int32_t vertex_offset,
+        uint32 instance_count,
+        uint32 first_instance
+    ) {
+        count_draw(instance_count);
+        draw_indexed_impl(
+            count,
+            first_index,
+            vertex_offset,
+            instance_count,
+            first_instance
+        );
+    }
     virtual void
     dispatch(std::size_t group_x, std::size_t group_y, std::size_t group_z) = 0;
 
@@ -104,6 +217,7 @@ class CommandBuffer {
             error("Texture does not have GenerateMipmaps usage flag set");
             return;
         }
+        invalidate_bind_state();
         generate_mipmaps_impl(texture);
     }
 
@@ -144,6 +258,7 @@ class CommandBuffer {
         uint32 array_layer
     ) {
         auto [width, height, depth] = Utils::get_mip_dimensions(src, mip_level);
+        invalidate_bind_state();
         copy_texture_impl(
             src,
             0,
@@ -182,6 +297,7 @@ class CommandBuffer {
         uint32 depth,
         uint32 layer_count
     ) {
+        invalidate_bind_state();
         copy_texture_impl(
             src,
             src_x,
@@ -202,16 +318,62 @@ class CommandBuffer {
         );
     }
 
+    const CommandBufferStats& stats() const { return m_stats; }
+
   protected:
+    // Backends call this from begin(); it clears the counters and forgets all
+    // tracked bindings.
+    void reset_recording_state() {
+        m_stats = {};
+        invalidate_bind_state();
+    }
+
+    // Backends call this whenever the native state may no longer match what
+    // was recorded, e.g. at render pass boundaries.
+    void invalidate_bind_state() {
+        m_bound_pipeline.reset();
+        m_bound_resource_sets.clear();
+        m_bound_vertex_buffer.reset();
+        m_bound_index_buffer.reset();
+        m_bound_index_offset = 0;
+    }
+
+    void count_draw(uint32 instance_count) {
+        m_stats.draws++;
+        if (instance_count > 1) {
+            m_stats.draws_saved += instance_count - 1;
+        }
+    }
+
     virtual void
     set_render_pipeline_impl(std::shared_ptr<const Pipeline> pipeline) = 0;
     virtual void
     set_compute_pipeline_impl(std::shared_ptr<const Pipeline> pipeline) = 0;
+    virtual void set_vertex_buffer_impl(std::shared_ptr<const Buffer> buffer
+    ) = 0;
     virtual void set_index_buffer_impl(
         std::shared_ptr<const Buffer> buffer,
         IndexFormat format,
         uint32 offset
     ) = 0;
+    virtual void set_resource_set_impl(
+        uint32 slot,
+        std::shared_ptr<const ResourceSet> resource_set,
+        std::span<const uint32> dynamic_offsets
+    ) = 0;
+    virtual void draw_impl(
+        std::size_t start,
+        std::size_t count,
+        uint32 instance_count,
+        uint32 first_instance
+    ) = 0;
+    virtual void draw_indexed_impl(
+        std::size_t count,
+        uint32 first_index,
+        std::int32_t vertex_offset,
+        uint32 instance_count,
+        uint32 first_instance
+    ) = 0;
     virtual void
     generate_mipmaps_impl(std::shared_ptr<const Texture> texture) = 0;
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "base/types.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
@@ -270,6 +271,54 @@ constexpr std::size_t get_pixel_format_size(PixelFormat format) {
     }
 }
 
+constexpr bool is_block_compressed_format(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::Bc1RgbaUnorm:
+        case PixelFormat::Bc1RgbaUnormSrgb:
+        case PixelFormat::Bc2RgbaUnorm:
+        case PixelFormat::Bc2RgbaUnormSrgb:
+        case PixelFormat::Bc3RgbaUnorm:
+        case PixelFormat::Bc3RgbaUnormSrgb:
+        case PixelFormat::Bc4RUnorm:
+        case PixelFormat::Bc4RSnorm:
+        case PixelFormat::Bc5RgUnorm:
+        case PixelFormat::Bc5RgSnorm:
+        case PixelFormat::Bc6hRgbUfloat:
+        case PixelFormat::Bc6hRgbFloat:
+        case PixelFormat::Bc7RgbaUnorm:
+        case PixelFormat::Bc7RgbaUnormSrgb:
+        case PixelFormat::Etc2Rgb8Unorm:
+        case PixelFormat::Etc2Rgb8UnormSrgb:
+        case PixelFormat::Etc2Rgb8A1Unorm:
+        case PixelFormat::Etc2Rgb8A1UnormSrgb:
+        case PixelFormat::Etc2Rgba8Unorm:
+        case PixelFormat::Etc2Rgba8UnormSrgb:
+        case PixelFormat::EacR11Unorm:
+        case PixelFormat::EacR11Snorm:
+        case PixelFormat::EacRg11Unorm:
+        case PixelFormat::EacRg11Snorm:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Bytes of a tightly packed width x height x depth region. Compressed
+// formats store whole 4x4 blocks, so partial blocks round up.
+constexpr std::size_t texture_data_size(
+    PixelFormat format,
+    std::uint32_t width,
+    std::uint32_t height,
+    std::uint32_t depth
+) {
+    if (is_block_compressed_format(format)) {
+        width = (width + 3) / 4;
+        height = (height + 3) / 4;
+    }
+    return static_cast<std::size_t>(width) * height * depth *
+           get_pixel_format_size(format);
+}
+
 enum class TextureType : uint8 {
     Texture1D,
     Texture2D,
@@ -16,6 +16,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -73,6 +74,14 @@ class GraphicsDevice {
     create_sampler(const SamplerDescription& desc) const = 0;
     virtual void
     submit_commands(std::shared_ptr<CommandBuffer> command_buffer) const = 0;
+    // Submits several finished command buffers so they execute in span order.
+    virtual void submit_command_buffers(
+        std::span<const std::shared_ptr<CommandBuffer>> command_buffers
+    ) const {
+        for (const auto& command_buffer : command_buffers) {
+            submit_commands(command_buffer);
+        }
+    }
 
     virtual void update_texture(
         std::shared_ptr<Texture> texture,
@@ -94,6 +103,17 @@ class GraphicsDevice {
         std::uint32_t size
     ) const = 0;
 
+    // Copies `size` bytes between two buffers on the GPU timeline, ordered
+    // after previously queued updates and submissions. Only valid when
+    // supports_buffer_copy() is true.
+    virtual void copy_buffer(
+        std::shared_ptr<Buffer> /*src*/,
+        std::uint32_t /*src_offset*/,
+        std::shared_ptr<Buffer> /*dst*/,
+        std::uint32_t /*dst_offset*/,
+        std::uint32_t /*size*/
+    ) const {}
+
     virtual MappedResource
     map(std::shared_ptr<MappableResource> resource, MapMode map_mode) const = 0;
     virtual void unmap(std::shared_ptr<MappableResource> resource) const = 0;
@@ -111,8 +131,32 @@ class GraphicsDevice {
 
     virtual void flush() const {}
 
+    // Starts the context work a created pipeline still needs before it can be
+    // bound without stalling, and returns true once that work is done. Called
+    // repeatedly until it succeeds; backends that finish pipelines inside
+    // create_*_pipeline() keep the default.
+    [[nodiscard]] virtual bool
+    prepare_pipeline(const std::shared_ptr<Pipeline>& /*pipeline*/) const {
+        return true;
+    }
+
     [[nodiscard]] virtual std::size_t max_frames_in_flight() const { return 1; }
 
+    // Whether distinct command buffers may be recorded concurrently from
+    // worker threads. Backends that resolve state such as image layouts while
+    // recording must keep recording in submission order and return false.
+    [[nodiscard]] virtual bool supports_parallel_recording() const {
+        return false;
+    }
+
+    [[nodiscard]] virtual bool supports_buffer_copy() const { return false; }
+
+    // Whether vertex shaders can read storage buffers, which per-instance
+    // mesh data needs.
+    [[nodiscard]] virtual bool supports_vertex_storage_buffers() const {
+        return false;
+    }
+
     [[nodiscard]] virtual std::size_t uniform_buffer_offset_alignment() const {
         return 256;
     }
@@ -179,6 +179,7 @@ void prepare_lighting(
 void setup_shadow_mapping(
     ResRO<GraphicsDevice> device,
     ResRW<ShaderCache> shader_cache,
+    ResRO<MeshUniforms> mesh_uniforms,
     ResRO<Assets<Mesh>> mesh_assets,
     ResRO<FullscreenQuad> fs_quad,
     Commands commands
@@ -202,18 +203,21 @@ void queue_shadow_map_meshes(
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
+        const Transform3d,
+        MeshMaterialPipelineIds> query_meshes,
     ResRO<RenderAssets<PreparedMaterial>> materials,
     ResRO<RenderAssets<GpuMesh>> gpu_meshes,
-    ResRO<MeshUniforms> mesh_uniforms,
+    ResRW<MeshUniforms> mesh_uniforms,
     ResRW<MeshMaterialPipelines> mesh_material_pipelines,
     ResRO<ShadowMappingResources> shadow_mapping_resources,
     ResRO<ViewVisibleEntities> visible_entities,
+    ResRO<GraphicsDevice> device,
+    ResRO<RenderQueue> render_queue,
     ResRW<ShadowMapPhase> phase
 );
 
 void render_shadow_map_passes(
-    ResRW<RenderFrameContext> frame,
+    ResRO<RenderFrameContext> frame,
     ResRO<ShadowMapPhase> phase,
     ResRO<ShadowMappingResources> shadow_mapping_resources,
     ResRO<PipelineCache> pipeline_cache
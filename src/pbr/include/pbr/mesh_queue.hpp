@@ -11,19 +11,31 @@
 
 namespace fei {
 
-template<class QueryT, class PhaseT, class SpecializerT, class ShouldQueueT>
+// `query` yields (entity, Mesh3d, MeshMaterial3d, Transform3d,
+// MeshMaterialPipelineIds) rows. `lod_of` returns the level of detail to draw
+// for an entity, usually the one select_mesh_lods() picked for the view.
+template<
+    class QueryT,
+    class PhaseT,
+    class SpecializerT,
+    class ShouldQueueT,
+    class LodOfT>
 void queue_mesh_draw_items(
     QueryT&& query,
     PhaseT& phase,
     std::shared_ptr<const ResourceSet> view_resource_set,
+    const Transform3d& view_transform,
     const RenderAssets<GpuMesh>& gpu_meshes,
     const RenderAssets<PreparedMaterial>& materials,
     const MeshUniforms& mesh_uniforms,
     MeshMaterialPipelines& mesh_material_pipelines,
     const SpecializerT& specializer,
-    ShouldQueueT&& should_queue
+    ShouldQueueT&& should_queue,
+    LodOfT&& lod_of
 ) {
-    for (auto&& [entity, mesh3d, material3d, transform3d] : query) {
+    const auto slot = mesh_material_pipelines.slot(specializer);
+    for (auto&& [entity, mesh3d, material3d, transform3d, pipeline_ids] :
+         query) {
         if (!std::invoke(
                 should_queue,
                 entity,
@@ -47,21 +59,57 @@ void queue_mesh_draw_items(
             continue;
         }
 
-        auto pipeline_id =
-            mesh_material_pipelines
-                .request(entity, material, gpu_mesh, specializer);
+        auto pipeline_id = mesh_material_pipelines.request(
+            pipeline_ids,
+            slot,
+            material,
+            gpu_mesh,
+            specializer
+        );
         phase.items.push_back(make_mesh_draw_item(
             entity,
             pipeline_id,
             view_resource_set,
             mesh_uniforms.resource_set,
-            mesh_uniform_it->second.dynamic_offset,
+            mesh_uniform_it->second,
             material.resource_set(),
-            gpu_mesh
+            gpu_mesh,
+            view_depth(view_transform, transform3d),
+            std::invoke(lod_of, entity)
         ));
     }
 
-    sort_by_pipeline(phase);
+    sort_mesh_draw_items(phase);
+}
+
+template<class QueryT, class PhaseT, class SpecializerT, class ShouldQueueT>
+void queue_mesh_draw_items(
+    QueryT&& query,
+    PhaseT& phase,
+    std::shared_ptr<const ResourceSet> view_resource_set,
+    const Transform3d& view_transform,
+    const RenderAssets<GpuMesh>& gpu_meshes,
+    const RenderAssets<PreparedMaterial>& materials,
+    const MeshUniforms& mesh_uniforms,
+    MeshMaterialPipelines& mesh_material_pipelines,
+    const SpecializerT& specializer,
+    ShouldQueueT&& should_queue
+) {
+    queue_mesh_draw_items(
+        std::forward<QueryT>(query),
+        phase,
+        std::move(view_resource_set),
+        view_transform,
+        gpu_meshes,
+        materials,
+        mesh_uniforms,
+        mesh_material_pipelines,
+        specializer,
+        std::forward<ShouldQueueT>(should_queue),
+        [](Entity) {
+            return uint32 {0};
+        }
+    );
 }
 
 template<class QueryT, class PhaseT, class SpecializerT>
@@ -69,6 +117,7 @@ void queue_mesh_draw_items(
     QueryT&& query,
     PhaseT& phase,
     std::shared_ptr<const ResourceSet> view_resource_set,
+    const Transform3d& view_transform,
     const RenderAssets<GpuMesh>& gpu_meshes,
     const RenderAssets<PreparedMaterial>& materials,
     const MeshUniforms& mesh_uniforms,
@@ -79,6 +128,7 @@ void queue_mesh_draw_items(
         std::forward<QueryT>(query),
         phase,
         std::move(view_resource_set),
+        view_transform,
         gpu_meshes,
         materials,
         mesh_uniforms,
@@ -8,6 +8,7 @@
 #include "pbr/mesh_view.hpp"
 #include "pbr/passes/deferred.hpp"
 #include "pbr/passes/target.hpp"
+#include "pbr/pipeline_specializer.hpp"
 #include "pbr/pipelines.hpp"
 #include "pbr/postprocess.hpp"
 #include "pbr/vxgi.hpp"
@@ -17,11 +18,42 @@
 #include "rendering/mesh/mesh_uniform.hpp"
 #include "rendering/render_asset.hpp"
 #include "rendering/render_frame.hpp"
+#include "rendering/render_queue.hpp"
 #include "rendering/resource_set_cache.hpp"
 #include "rendering/shader_cache.hpp"
 #include "rendering/visibility.hpp"
 namespace fei {
 
+// Renders material prepass shaders into the G-buffer targets.
+class DeferredPipelineSpecializer : public PipelineSpecializer {
+  public:
+    explicit DeferredPipelineSpecializer(
+        const PbrMeshShaderDefaults& /*shader_defaults*/
+    ) {}
+
+    MaterialShaderType vertex_shader_type() const override {
+        return MaterialShaderType::PrepassVertex;
+    }
+
+    MaterialShaderType fragment_shader_type() const override {
+        return MaterialShaderType::PrepassFragment;
+    }
+
+    BitFlags<PbrMeshPipelineKeyFlags> mesh_pipeline_flags() const override {
+        return {
+            PbrMeshPipelineKeyFlags::DepthPrepass,
+            PbrMeshPipelineKeyFlags::DeferredPrepass,
+            PbrMeshPipelineKeyFlags::PrepassReadsMaterial,
+        };
+    }
+
+    void specialize(
+        RenderPipelineDescription& desc,
+        const GpuMesh& mesh,
+        const PreparedMaterial& material
+    ) const override;
+};
+
 void setup_deferred_pipelines(
     ResRO<GraphicsDevice> device,
     ResRO<FullscreenQuad> fullscreen_quad,
@@ -40,21 +72,24 @@ void queue_deferred_prepass_meshes(
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
-    Query<Entity, const MeshViewResourceSet>::Filter<With<Camera3d>>
-        query_cameras,
+        const Transform3d,
+        MeshMaterialPipelineIds> query_meshes,
+    Query<Entity, const MeshViewResourceSet, const Transform3d>::Filter<
+        With<Camera3d>> query_cameras,
     ResRW<DeferredPrepassPhase> phase,
     ResRO<RenderAssets<GpuMesh>> gpu_meshes,
-    ResRO<MeshUniforms> mesh_uniforms,
+    ResRW<MeshUniforms> mesh_uniforms,
     ResRW<MeshMaterialPipelines> mesh_material_pipelines,
     ResRO<RenderAssets<PreparedMaterial>> materials,
     ResRO<ViewVisibleEntities> visible_entities,
     ResRO<PbrMeshShaderDefaults> shader_defaults,
+    ResRO<GraphicsDevice> device,
+    ResRO<RenderQueue> render_queue,
     ResRW<PipelineCache>
 );
 
 void deferred_prepass(
-    ResRW<RenderFrameContext> frame,
+    ResRO<RenderFrameContext> frame,
     ResRO<DeferredPrepassPhase> phase,
     ResRO<RenderTarget> target,
     ResRO<DeferredViewTargets> targets,
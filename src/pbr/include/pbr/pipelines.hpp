@@ -1,12 +1,19 @@
 #pragma once
+#include "asset/event.hpp"
+#include "asset/id.hpp"
 #include "base/hash.hpp"
 #include "base/log.hpp"
 #include "base/optional.hpp"
+#include "ecs/change_detection.hpp"
+#include "ecs/commands.hpp"
+#include "ecs/event.hpp"
+#include "ecs/query.hpp"
 #include "graphics/pipeline.hpp"
 #include "graphics/shader_module.hpp"
 #include "pbr/mesh_view.hpp"
 #include "pbr/pipeline_specializer.hpp"
 #include "refl/type.hpp"
+#include "rendering/components.hpp"
 #include "rendering/material.hpp"
 #include "rendering/mesh/mesh.hpp"
 #include "rendering/mesh/mesh_uniform.hpp"
@@ -17,7 +24,11 @@
 #include <algorithm>
 #include <concepts>
 #include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -62,11 +73,11 @@ inline bool mesh_vertex_layout_has_attribute(
            ) != layout.attribute_ids.end();
 }
 
-inline ShaderDefs pbr_mesh_shader_defs(const GpuMesh& mesh) {
-    const auto& layout = mesh.vertex_buffer_layout();
+inline ShaderDefs
+pbr_mesh_shader_defs(std::span<const MeshVertexAttributeId> attribute_ids) {
     ShaderDefs defs;
     auto add_def = [&](MeshVertexAttributeId id, const char* name) {
-        if (mesh_vertex_layout_has_attribute(layout, id)) {
+        if (std::ranges::find(attribute_ids, id) != attribute_ids.end()) {
             defs.push_back(ShaderDefVal::bool_def(name));
         }
     };
@@ -78,6 +89,10 @@ inline ShaderDefs pbr_mesh_shader_defs(const GpuMesh& mesh) {
     return normalized_shader_defs(std::move(defs));
 }
 
+inline ShaderDefs pbr_mesh_shader_defs(const GpuMesh& mesh) {
+    return pbr_mesh_shader_defs(mesh.vertex_buffer_layout().attribute_ids);
+}
+
 inline bool pbr_shader_uses_vertex_attribute(MeshVertexAttributeId id) {
     return id == Mesh::ATTRIBUTE_POSITION.id ||
            id == Mesh::ATTRIBUTE_NORMAL.id || id == Mesh::ATTRIBUTE_UV_0.id ||
@@ -212,20 +227,51 @@ inline const char* pbr_material_shader_entry(MaterialShaderType shader_type) {
     return "main";
 }
 
-inline std::shared_ptr<const ShaderModule> resolve_material_shader(
+// A specialized mesh pipeline whose material shader variants may still have
+// to be compiled by the pipeline creation job.
+struct PbrMaterialPipelineDescription {
+    RenderPipelineDescription description;
+    std::vector<DeferredPipelineShader> deferred_shaders;
+};
+
+// Sets shader `slot` of `pipeline` to the material's shader for
+// `shader_type`. A variant the ShaderCache has not compiled yet is left to the
+// creation job, so compiling it does not stall the thread queueing meshes.
+inline void resolve_material_shader(
+    PbrMaterialPipelineDescription& pipeline,
+    std::size_t slot,
     const PreparedMaterial& material,
     MaterialShaderType shader_type,
     const PbrMeshShaderDefaults& defaults,
     ShaderCache& shader_cache,
     const ShaderDefs& shader_defs
 ) {
+    auto& shaders = pipeline.description.shader_program.shaders;
     if (auto shader = material.shader_request(shader_type)) {
-        return shader_cache.get(
+        auto variant = shader_cache.get_variant(
             shader->ref,
             pbr_material_shader_stage(shader_type),
             pbr_material_shader_entry(shader_type),
             merge_shader_defs(shader->defs, shader_defs)
         );
+        if (variant->done() && variant->shader_module()) {
+            shaders[slot] = variant->shader_module();
+            return;
+        }
+        pipeline.deferred_shaders.push_back(
+            DeferredPipelineShader {
+                .slot = slot,
+                .compile = [variant](std::string& error)
+                    -> std::shared_ptr<const ShaderModule> {
+                    auto shader_module = variant->compile();
+                    if (!shader_module) {
+                        error = variant->error();
+                    }
+                    return shader_module;
+                },
+            }
+        );
+        return;
     }
     auto fallback = pbr_default_shader(defaults, shader_type);
     if (!fallback) {
@@ -234,7 +280,7 @@ inline std::shared_ptr<const ShaderModule> resolve_material_shader(
             static_cast<int>(shader_type)
         );
     }
-    return fallback;
+    shaders[slot] = std::move(fallback);
 }
 
 inline bool pbr_forward_color_pass(const PbrMeshPipelineKey& key) {
@@ -278,51 +324,57 @@ struct PbrMaterialPipelineSpecializer {
     ShaderCache& shader_cache;
     const PbrMeshShaderDefaults& shader_defaults;
 
-    RenderPipelineDescription specialize(
+    PbrMaterialPipelineDescription specialize(
         const PbrMeshPipelineKey& key,
         const PreparedMaterial& material,
         const GpuMesh& gpu_mesh,
         const PipelineSpecializer& pass_specializer
     ) const {
-        const auto shader_defs = pbr_mesh_shader_defs(gpu_mesh, key);
-        auto shader_modules =
-            pass_specializer.overrides_shaders() ?
-                std::vector<std::shared_ptr<const ShaderModule>> {
-                    shader_defaults.forward_vertex,
-                    shader_defaults.forward_fragment,
-                } :
-                std::vector<std::shared_ptr<const ShaderModule>> {
-                    resolve_material_shader(
-                        material,
-                        pass_specializer.vertex_shader_type(),
-                        shader_defaults,
-                        shader_cache,
-                        shader_defs
-                    ),
-                    resolve_material_shader(
-                        material,
-                        pass_specializer.fragment_shader_type(),
-                        shader_defaults,
-                        shader_cache,
-                        shader_defs
-                    ),
-                };
-
-        RenderPipelineDescription pipeline_desc {
-            .depth_stencil_state =
-                DepthStencilStateDescription::DepthOnlyLessEqual,
-            .render_primitive = key.primitive,
-            .shader_program =
-                {
-                    .vertex_layouts = {pbr_vertex_layout_description(gpu_mesh)},
-                    .shaders = std::move(shader_modules),
+        PbrMaterialPipelineDescription pipeline {
+            .description = {
+                .depth_stencil_state =
+                    DepthStencilStateDescription::DepthOnlyLessEqual,
+                .render_primitive = key.primitive,
+                .shader_program =
+                    {
+                        .vertex_layouts =
+                            {pbr_vertex_layout_description(gpu_mesh)},
+                        .shaders =
+                            {
+                                shader_defaults.forward_vertex,
+                                shader_defaults.forward_fragment,
+                            },
+                    },
+                .resource_layouts = {
+                    mesh_view_layout.layout,
+                    mesh_uniforms.resource_layout,
+                    material.resource_layout(),
                 },
-            .resource_layouts = {
-                mesh_view_layout.layout,
-                mesh_uniforms.resource_layout,
-                material.resource_layout(),
             },
         };
+        if (!pass_specializer.overrides_shaders()) {
+            const auto shader_defs = merge_shader_defs(
+                pbr_mesh_shader_defs(gpu_mesh, key),
+                mesh_uniform_shader_defs(mesh_uniforms)
+            );
+            const MaterialShaderType shader_types[] = {
+                pass_specializer.vertex_shader_type(),
+                pass_specializer.fragment_shader_type(),
+            };
+            for (std::size_t slot = 0; slot < std::size(shader_types); slot++) {
+                resolve_material_shader(
+                    pipeline,
+                    slot,
+                    material,
+                    shader_types[slot],
+                    shader_defaults,
+                    shader_cache,
+                    shader_defs
+                );
+            }
+        }
+
+        auto& pipeline_desc = pipeline.description;
         if (pbr_forward_color_pass(key)) {
             pipeline_desc.resource_layouts.push_back(
                 mesh_view_layout.environment_layout
@@ -334,7 +386,7 @@ struct PbrMaterialPipelineSpecializer {
             material.pipeline_state()
         );
         pass_specializer.specialize(pipeline_desc, gpu_mesh, material);
-        return pipeline_desc;
+        return pipeline;
     }
 };
 
@@ -375,10 +427,41 @@ MAKE_STD_HASHABLE(
 
 namespace fei {
 
+// Pipelines a mesh entity resolved, indexed by the slot
+// MeshMaterialPipelines::slot() gave each specializer.
+// track_mesh_material_pipelines() empties it whenever the entity's mesh or
+// material, or the prepared assets behind them, change.
+struct MeshMaterialPipelineIds {
+    std::vector<Optional<CachedRenderPipelineId>> ids;
+
+    [[nodiscard]] Optional<CachedRenderPipelineId>
+    get(std::size_t slot) const {
+        if (slot >= ids.size()) {
+            return nullopt;
+        }
+        return ids[slot];
+    }
+
+    void set(std::size_t slot, CachedRenderPipelineId id) {
+        if (slot >= ids.size()) {
+            ids.resize(slot + 1);
+        }
+        ids[slot] = id;
+    }
+};
+
 class MeshMaterialPipelines {
   private:
+    struct SpecializerSlot {
+        TypeId type;
+        std::size_t key;
+
+        bool operator==(const SpecializerSlot&) const = default;
+    };
+
     std::unordered_map<MeshMaterialPipelineKey, CachedRenderPipelineId>
         m_pipelines;
+    std::vector<SpecializerSlot> m_specializer_slots;
 
     PipelineCache& m_pipeline_cache;
     PbrMaterialPipelineSpecializer m_material_pipeline_specializer;
@@ -407,11 +490,12 @@ class MeshMaterialPipelines {
     ) {
         const auto mesh_key =
             make_pbr_mesh_pipeline_key(gpu_mesh, material, specializer);
-        auto pipeline_desc =
+        auto pipeline =
             m_material_pipeline_specializer
                 .specialize(mesh_key, material, gpu_mesh, specializer);
         return m_pipeline_cache.request_render_pipeline(
-            std::move(pipeline_desc)
+            std::move(pipeline.description),
+            std::move(pipeline.deferred_shaders)
         );
     }
 
@@ -430,37 +514,103 @@ class MeshMaterialPipelines {
                                               shader_defaults,
                                           } {}
 
+    // Index of `specializer` in MeshMaterialPipelineIds. Look it up once per
+    // queue pass rather than per entity.
+    template<std::derived_from<PipelineSpecializer> SpecializerType>
+    std::size_t slot(const SpecializerType& specializer) {
+        const SpecializerSlot entry {
+            .type = type_id<SpecializerType>(),
+            .key = specializer.cache_key(),
+        };
+        auto it = std::ranges::find(m_specializer_slots, entry);
+        if (it == m_specializer_slots.end()) {
+            m_specializer_slots.push_back(entry);
+            return m_specializer_slots.size() - 1;
+        }
+        return static_cast<std::size_t>(
+            std::distance(m_specializer_slots.begin(), it)
+        );
+    }
+
+    // Returns the pipeline for a mesh and material under `specializer`,
+    // creating it the first time any entity needs that combination.
     template<std::derived_from<PipelineSpecializer> SpecializerType>
     CachedRenderPipelineId request(
-        Entity,
         const PreparedMaterial& material,
         const GpuMesh& gpu_mesh,
         const SpecializerType& specializer
     ) {
         auto key = make_key(material, gpu_mesh, specializer);
-        auto it = m_pipelines.find(key);
-        if (it != m_pipelines.end()) {
+        if (auto it = m_pipelines.find(key); it != m_pipelines.end()) {
             return it->second;
         }
         auto id = create_pipeline(material, gpu_mesh, specializer);
-        m_pipelines[key] = id;
+        m_pipelines.emplace(key, id);
         return id;
     }
 
+    // Returns the entity's pipeline in `slot`. Only an entity without one
+    // builds a key, so unchanged meshes skip hashing entirely.
     template<std::derived_from<PipelineSpecializer> SpecializerType>
-    Optional<CachedRenderPipelineId> find(
-        Entity,
+    CachedRenderPipelineId request(
+        ComponentRW<MeshMaterialPipelineIds> entity_pipelines,
+        std::size_t slot,
         const PreparedMaterial& material,
         const GpuMesh& gpu_mesh,
         const SpecializerType& specializer
-    ) const {
-        auto key = make_key(material, gpu_mesh, specializer);
-        auto it = m_pipelines.find(key);
-        if (it != m_pipelines.end()) {
-            return it->second;
+    ) {
+        if (auto id = entity_pipelines.read().get(slot)) {
+            return *id;
         }
-        return nullopt;
+        auto id = request(material, gpu_mesh, specializer);
+        entity_pipelines->set(slot, id);
+        return id;
     }
 };
 
+// Gives mesh entities their MeshMaterialPipelineIds and empties it once
+// Mesh3d or MeshMaterial3d<M> changed or the GpuMesh or PreparedMaterial
+// they point at was prepared again or removed.
+template<std::derived_from<Material> M>
+void track_mesh_material_pipelines(
+    Query<Entity>::Filter<
+        With<Mesh3d>,
+        With<MeshMaterial3d<M>>,
+        Without<MeshMaterialPipelineIds>> untracked,
+    Query<MeshMaterialPipelineIds>::Filter<
+        Or<Changed<Mesh3d>, Changed<MeshMaterial3d<M>>>> changed,
+    Query<const Mesh3d, const MeshMaterial3d<M>, MeshMaterialPipelineIds>
+        tracked,
+    EventReader<AssetEvent<GpuMesh>> gpu_mesh_events,
+    EventReader<AssetEvent<PreparedMaterial>> material_events,
+    Commands commands
+) {
+    for (auto [entity] : untracked) {
+        commands.entity(entity).add(MeshMaterialPipelineIds {});
+    }
+    for (auto [pipeline_ids] : changed) {
+        pipeline_ids->ids.clear();
+    }
+
+    std::unordered_set<AssetId> gpu_meshes;
+    for (auto event = gpu_mesh_events.next(); event;
+         event = gpu_mesh_events.next()) {
+        gpu_meshes.insert(event->id);
+    }
+    std::unordered_set<AssetId> materials;
+    for (auto event = material_events.next(); event;
+         event = material_events.next()) {
+        materials.insert(event->id);
+    }
+    if (gpu_meshes.empty() && materials.empty()) {
+        return;
+    }
+    for (auto [mesh3d, material3d, pipeline_ids] : tracked) {
+        if (gpu_meshes.contains(mesh3d.mesh.id()) ||
+            materials.contains(material3d.material.id())) {
+            pipeline_ids->ids.clear();
+        }
+    }
+}
+
 } // namespace fei
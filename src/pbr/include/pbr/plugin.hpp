@@ -1,6 +1,7 @@
 #pragma once
 #include "app/app.hpp"
 #include "app/plugin.hpp"
+#include "base/types.hpp"
 #include "ecs/system_set.hpp"
 
 namespace fei {
@@ -21,6 +22,13 @@ struct PbrSystems {
     struct DeferredPrepass : SystemSet<DeferredPrepass> {};
 };
 
+// RenderFrameContext::begin_pass orders of the passes that record concurrently
+// in the Prepass set.
+struct PbrPassOrder {
+    static constexpr uint32 ShadowMaps = 0;
+    static constexpr uint32 DeferredPrepass = 1;
+};
+
 class PbrPlugin : public Plugin {
   public:
     void setup(App& app) override;
@@ -0,0 +1,45 @@
+#pragma once
+#include "base/bitflags.hpp"
+#include "pbr/pipeline_specializer.hpp"
+#include "rendering/material.hpp"
+#include "rendering/mesh/mesh_uniform.hpp"
+#include "rendering/shader_compiler.hpp"
+
+#include <vector>
+
+namespace fei {
+
+// Mesh key flags and material shader slots of one mesh pass.
+struct PbrShaderVariantPass {
+    BitFlags<PbrMeshPipelineKeyFlags> flags {
+        PbrMeshPipelineKeyFlags::MeshPipeline
+    };
+    MaterialShaderType vertex_shader {MaterialShaderType::Vertex};
+    MaterialShaderType fragment_shader {MaterialShaderType::Fragment};
+
+    static PbrShaderVariantPass from(const PipelineSpecializer& specializer);
+};
+
+// The variant space the PBR and VXGI passes can request at runtime. Material
+// shader variants are expanded over every combination of the vertex
+// attributes the PBR shaders read, with and without MayDiscard.
+struct PbrShaderVariantSpace {
+    std::vector<MeshUniformLayout> mesh_uniform_layouts {
+        MeshUniformLayout::DynamicUniform,
+        MeshUniformLayout::StorageBuffer,
+    };
+    // Passes whose specializer does not override shaders.
+    std::vector<PbrShaderVariantPass> passes;
+    // Only shaders referenced by asset path can be enumerated offline.
+    std::vector<const Material*> materials;
+
+    // The engine's own passes and StandardMaterial.
+    static PbrShaderVariantSpace defaults();
+};
+
+// Every distinct variant in `space`, with the entry point and normalized defs
+// ShaderCache passes to the compiler, so compiled artifacts are cache hits.
+std::vector<ShaderVariantRequest>
+pbr_shader_variants(const PbrShaderVariantSpace& space);
+
+} // namespace fei
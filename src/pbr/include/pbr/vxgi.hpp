@@ -115,6 +115,7 @@ void setup_vxgi(
     ResRW<VxgiVolumes> volumes,
     ResRO<GraphicsDevice> device,
     ResRW<ShaderCache> shader_cache,
+    ResRO<MeshUniforms> mesh_uniforms,
     Commands commands
 );
 
@@ -139,7 +140,8 @@ void queue_vxgi_voxelization_pipelines(
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
+        const Transform3d,
+        MeshMaterialPipelineIds> query_meshes,
     ResRW<VxgiVoxelization> voxelization,
     ResRW<MeshMaterialPipelines> pipelines,
     ResRO<RenderAssets<GpuMesh>> gpu_meshes,
@@ -151,7 +153,8 @@ void render_vxgi_voxelization_pass(
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
+        const Transform3d,
+        const MeshMaterialPipelineIds> query_meshes,
     ResRW<VxgiVoxelization> voxelization,
     ResRW<VxgiVolumes> volumes,
     ResRW<MeshMaterialPipelines> pipelines,
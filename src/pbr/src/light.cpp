@@ -3,6 +3,7 @@
 #include "base/hash.hpp"
 #include "math/matrix.hpp"
 #include "math/vector.hpp"
+#include "pbr/plugin.hpp"
 
 #include <array>
 #include <cmath>
@@ -24,10 +25,14 @@ struct ShadowMapDrawItem {
     std::shared_ptr<const ResourceSet> mesh_set;
     std::shared_ptr<const ResourceSet> material_set;
     uint32 mesh_uniform_dynamic_offset {};
+    uint32 mesh_uniform_instance_index {};
     std::shared_ptr<const Buffer> vertex_buffer;
     std::shared_ptr<const Buffer> index_buffer;
+    uint32 base_vertex {};
+    uint32 first_index {};
     uint32 index_count {};
     uint32 vertex_count {};
+    uint32 instance_count {1};
 };
 
 struct ShadowBlurPassData {
@@ -37,6 +42,8 @@ struct ShadowBlurPassData {
     std::shared_ptr<Buffer> uniform_buffer;
     std::shared_ptr<const Buffer> quad_vertex_buffer;
     std::shared_ptr<const Buffer> quad_index_buffer;
+    uint32 quad_base_vertex {};
+    uint32 quad_first_index {};
     uint32 quad_index_count {};
     uint32 quad_vertex_count {};
     uint32 output_width {};
@@ -96,9 +103,13 @@ void draw_shadow_blur_quad(
             data.quad_index_buffer,
             IndexFormat::Uint32
         );
-        command_buffer.draw_indexed(data.quad_index_count);
+        command_buffer.draw_indexed(
+            data.quad_index_count,
+            data.quad_first_index,
+            static_cast<std::int32_t>(data.quad_base_vertex)
+        );
     } else {
-        command_buffer.draw(0, data.quad_vertex_count);
+        command_buffer.draw(data.quad_base_vertex, data.quad_vertex_count);
     }
 }
 
@@ -119,9 +130,20 @@ void draw_shadow_map_item(
 
     if (item.index_buffer) {
         command_buffer.set_index_buffer(item.index_buffer, IndexFormat::Uint32);
-        command_buffer.draw_indexed(item.index_count);
+        command_buffer.draw_indexed(
+            item.index_count,
+            item.first_index,
+            static_cast<std::int32_t>(item.base_vertex),
+            item.instance_count,
+            item.mesh_uniform_instance_index
+        );
     } else {
-        command_buffer.draw(0, item.vertex_count);
+        command_buffer.draw(
+            item.base_vertex,
+            item.vertex_count,
+            item.instance_count,
+            item.mesh_uniform_instance_index
+        );
     }
 }
 
@@ -357,6 +379,7 @@ void prepare_lighting(
 void setup_shadow_mapping(
     ResRO<GraphicsDevice> device,
     ResRW<ShaderCache> shader_cache,
+    ResRO<MeshUniforms> mesh_uniforms,
     ResRO<Assets<Mesh>> mesh_assets,
     ResRO<FullscreenQuad> fs_quad,
     Commands commands
@@ -365,12 +388,14 @@ void setup_shadow_mapping(
         shader_cache->get_or_compile(
             AssetPath("shader://pbr/shadow.slang"),
             ShaderStages::Vertex,
-            {}
+            {},
+            mesh_uniform_shader_defs(*mesh_uniforms)
         ),
         shader_cache->get_or_compile(
             AssetPath("shader://pbr/shadow.slang"),
             ShaderStages::Fragment,
-            {}
+            {},
+            mesh_uniform_shader_defs(*mesh_uniforms)
         ),
     };
 
@@ -513,16 +538,22 @@ void queue_shadow_map_meshes(
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
+        const Transform3d,
+        MeshMaterialPipelineIds> query_meshes,
     ResRO<RenderAssets<PreparedMaterial>> materials,
     ResRO<RenderAssets<GpuMesh>> gpu_meshes,
-    ResRO<MeshUniforms> mesh_uniforms,
+    ResRW<MeshUniforms> mesh_uniforms,
     ResRW<MeshMaterialPipelines> mesh_material_pipelines,
     ResRO<ShadowMappingResources> shadow_mapping_resources,
     ResRO<ViewVisibleEntities> visible_entities,
+    ResRO<GraphicsDevice> device,
+    ResRO<RenderQueue> render_queue,
     ResRW<ShadowMapPhase> phase
 ) {
     phase->clear();
+    const auto shadow_slot = mesh_material_pipelines->slot(
+        shadow_mapping_resources->pipeline_specializer
+    );
 
     for (auto [light_entity, light, transform, view_resource_set, shadow_map] :
          query_light) {
@@ -540,7 +571,7 @@ void queue_shadow_map_meshes(
         pass.texture = shadow_map.texture;
         pass.blur_texture = shadow_map.blur_texture;
 
-        for (auto [entity, mesh, mesh_material, mesh_transform] :
+        for (auto [entity, mesh, mesh_material, mesh_transform, pipeline_ids] :
              query_meshes) {
             if (!mesh.cast_shadow || !visible_meshes->contains(entity)) {
                 continue;
@@ -556,7 +587,8 @@ void queue_shadow_map_meshes(
             auto& gpu_mesh = *gpu_mesh_opt;
             auto& material = *material_opt;
             auto pipeline_id = mesh_material_pipelines->request(
-                entity,
+                pipeline_ids,
+                shadow_slot,
                 material,
                 gpu_mesh,
                 shadow_mapping_resources->pipeline_specializer
@@ -566,24 +598,30 @@ void queue_shadow_map_meshes(
                 pipeline_id,
                 view_resource_set.resource_set,
                 mesh_uniforms->resource_set,
-                mesh_uniform_it->second.dynamic_offset,
+                mesh_uniform_it->second,
                 material.resource_set(),
-                gpu_mesh
+                gpu_mesh,
+                view_depth(transform, mesh_transform),
+                visible_meshes->lod(entity)
             ));
         }
 
-        sort_by_pipeline(pass);
+        sort_mesh_draw_items(pass);
+        instance_mesh_draw_items(pass, *device, *render_queue, *mesh_uniforms);
     }
 }
 
 void render_shadow_map_passes(
-    ResRW<RenderFrameContext> frame,
+    ResRO<RenderFrameContext> frame,
     ResRO<ShadowMapPhase> phase,
     ResRO<ShadowMappingResources> shadow_mapping_resources,
     ResRO<PipelineCache> pipeline_cache
 ) {
-    auto* command_buffer = frame->command_buffer();
-    if (!command_buffer || phase->passes.empty()) {
+    if (phase->passes.empty()) {
+        return;
+    }
+    auto command_buffer = frame->begin_pass(PbrPassOrder::ShadowMaps);
+    if (!command_buffer) {
         return;
     }
 
@@ -623,10 +661,15 @@ void render_shadow_map_passes(
                     .material_set = item.material_set,
                     .mesh_uniform_dynamic_offset =
                         item.mesh_uniform_dynamic_offset,
+                    .mesh_uniform_instance_index =
+                        item.mesh_uniform_instance_index,
                     .vertex_buffer = item.vertex_buffer,
                     .index_buffer = item.index_buffer,
+                    .base_vertex = item.base_vertex,
+                    .first_index = item.first_index,
                     .index_count = item.index_count,
                     .vertex_count = item.vertex_count,
+                    .instance_count = item.instance_count,
                 }
             );
         }
@@ -660,9 +703,9 @@ void render_shadow_blur_passes(
     auto blur_uniform_buffer = blur_resources->uniform_buffer;
     auto blur_sampler = blur_resources->sampler;
     auto quad_vertex_buffer = quad_mesh.vertex_buffer();
-    auto quad_index_count = static_cast<uint32>(
-        quad_mesh.index_buffer_size() / sizeof(std::uint32_t)
-    );
+    auto quad_base_vertex = quad_mesh.base_vertex();
+    auto quad_first_index = quad_mesh.first_index();
+    auto quad_index_count = quad_mesh.index_count();
     auto quad_vertex_count = static_cast<uint32>(quad_mesh.vertex_count());
     for (const auto& pass : phase->passes) {
         if (!pass.texture || !pass.blur_texture) {
@@ -672,7 +715,11 @@ void render_shadow_blur_passes(
             *device,
             "shadow.blur.horizontal",
             blur_resource_layout,
-            {blur_uniform_buffer, pass.texture, blur_sampler}
+            ResourceBindings<3> {
+                blur_uniform_buffer,
+                pass.texture,
+                blur_sampler,
+            }
         );
         execute_shadow_blur_pass(
             *command_buffer,
@@ -684,6 +731,8 @@ void render_shadow_blur_passes(
                 .quad_vertex_buffer = quad_vertex_buffer,
                 .quad_index_buffer =
                     quad_index_buffer ? *quad_index_buffer : nullptr,
+                .quad_base_vertex = quad_base_vertex,
+                .quad_first_index = quad_first_index,
                 .quad_index_count = quad_index_count,
                 .quad_vertex_count = quad_vertex_count,
                 .output_width = pass.texture->width(),
@@ -696,7 +745,11 @@ void render_shadow_blur_passes(
             *device,
             "shadow.blur.vertical",
             blur_resource_layout,
-            {blur_uniform_buffer, pass.blur_texture, blur_sampler}
+            ResourceBindings<3> {
+                blur_uniform_buffer,
+                pass.blur_texture,
+                blur_sampler,
+            }
         );
         execute_shadow_blur_pass(
             *command_buffer,
@@ -708,6 +761,8 @@ void render_shadow_blur_passes(
                 .quad_vertex_buffer = quad_vertex_buffer,
                 .quad_index_buffer =
                     quad_index_buffer ? *quad_index_buffer : nullptr,
+                .quad_base_vertex = quad_base_vertex,
+                .quad_first_index = quad_first_index,
                 .quad_index_count = quad_index_count,
                 .quad_vertex_count = quad_vertex_count,
                 .output_width = pass.texture->width(),
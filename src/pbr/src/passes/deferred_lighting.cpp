@@ -3,7 +3,6 @@
 #include <cstdint>
 #include <memory>
 #include <utility>
-#include <vector>
 
 namespace fei {
 
@@ -13,6 +12,8 @@ struct FullscreenQuadPassData {
     std::shared_ptr<const ResourceSet> view_set;
     std::shared_ptr<const Buffer> vertex_buffer;
     std::shared_ptr<const Buffer> index_buffer;
+    uint32 base_vertex {};
+    uint32 first_index {};
     uint32 index_count {};
     uint32 vertex_count {};
 };
@@ -26,9 +27,9 @@ FullscreenQuadPassData make_fullscreen_quad_pass_data(
         .view_set = std::move(view_set),
         .vertex_buffer = mesh.vertex_buffer(),
         .index_buffer = index_buffer ? *index_buffer : nullptr,
-        .index_count = static_cast<uint32>(
-            mesh.index_buffer_size() / sizeof(std::uint32_t)
-        ),
+        .base_vertex = mesh.base_vertex(),
+        .first_index = mesh.first_index(),
+        .index_count = mesh.index_count(),
         .vertex_count = static_cast<uint32>(mesh.vertex_count()),
     };
 }
@@ -40,9 +41,13 @@ void draw_fullscreen_quad(
     command_buffer.set_vertex_buffer(quad.vertex_buffer);
     if (quad.index_buffer) {
         command_buffer.set_index_buffer(quad.index_buffer, IndexFormat::Uint32);
-        command_buffer.draw_indexed(quad.index_count);
+        command_buffer.draw_indexed(
+            quad.index_count,
+            quad.first_index,
+            static_cast<std::int32_t>(quad.base_vertex)
+        );
     } else {
-        command_buffer.draw(0, quad.vertex_count);
+        command_buffer.draw(quad.base_vertex, quad.vertex_count);
     }
 }
 
@@ -78,7 +83,7 @@ void execute_fullscreen_lighting_pass(
     command_buffer.end_render_pass();
 }
 
-std::vector<std::shared_ptr<const BindableResource>> gbuffer_bindings(
+ResourceBindings<6> gbuffer_bindings(
     const DeferredViewTargets& targets,
     const std::shared_ptr<Sampler>& sampler
 ) {
@@ -101,7 +106,7 @@ std::shared_ptr<Texture> first_shadow_map(Query<const ShadowMap> query) {
     return nullptr;
 }
 
-std::vector<std::shared_ptr<const BindableResource>> lighting_bindings(
+ResourceBindings<3> lighting_bindings(
     const LightingResources& lighting,
     std::shared_ptr<Texture> shadow_map,
     std::shared_ptr<Texture> fallback
@@ -113,7 +118,7 @@ std::vector<std::shared_ptr<const BindableResource>> lighting_bindings(
     };
 }
 
-std::vector<std::shared_ptr<const BindableResource>>
+ResourceBindings<10>
 vxgi_bindings(const VxgiResources& resources, const VxgiVolumes& volumes) {
     return {
         resources.uniform_buffer,
@@ -288,7 +293,11 @@ void composite_pass(
         *device,
         "deferred.composite",
         pipelines->composite_resource_layout,
-        {targets->direct, targets->indirect, pipelines->point_sampler}
+        ResourceBindings<3> {
+            targets->direct,
+            targets->indirect,
+            pipelines->point_sampler,
+        }
     );
     auto pipeline = pipeline_cache->get_render_pipeline(
         pipelines->composite_lighting_pipeline
@@ -348,7 +357,10 @@ void present_composite_pass(
         *device,
         "deferred.present",
         (*pipelines)->present_resource_layout,
-        {targets->composite, (*pipelines)->point_sampler}
+        ResourceBindings<2> {
+            targets->composite,
+            (*pipelines)->point_sampler,
+        }
     );
     auto fullscreen_quad_data =
         make_fullscreen_quad_pass_data(nullptr, gpu_mesh.value());
@@ -1,6 +1,7 @@
 #include "pbr/mesh_queue.hpp"
 #include "pbr/passes/deferred_internal.hpp"
 #include "pbr/pipeline_specializer.hpp"
+#include "pbr/plugin.hpp"
 
 #include <array>
 #include <memory>
@@ -36,47 +37,20 @@ OutputDescription deferred_gbuffer_output_description() {
     };
 }
 
-class DeferredPipelineSpecializer : public PipelineSpecializer {
-  public:
-    explicit DeferredPipelineSpecializer(
-        const PbrMeshShaderDefaults& /*shader_defaults*/
-    ) {}
-
-    MaterialShaderType vertex_shader_type() const override {
-        return MaterialShaderType::PrepassVertex;
-    }
-
-    MaterialShaderType fragment_shader_type() const override {
-        return MaterialShaderType::PrepassFragment;
-    }
-
-    BitFlags<PbrMeshPipelineKeyFlags> mesh_pipeline_flags() const override {
-        return {
-            PbrMeshPipelineKeyFlags::DepthPrepass,
-            PbrMeshPipelineKeyFlags::DeferredPrepass,
-            PbrMeshPipelineKeyFlags::PrepassReadsMaterial,
-        };
-    }
-
-    void specialize(
-        RenderPipelineDescription& desc,
-        const GpuMesh&,
-        const PreparedMaterial&
-    ) const override {
-        desc.output_description = deferred_gbuffer_output_description();
-    }
-};
-
 struct DeferredPrepassDrawItem {
     std::shared_ptr<Pipeline> pipeline;
     std::shared_ptr<const ResourceSet> view_set;
     std::shared_ptr<const ResourceSet> mesh_set;
     std::shared_ptr<const ResourceSet> material_set;
     uint32 mesh_uniform_dynamic_offset {};
+    uint32 mesh_uniform_instance_index {};
     std::shared_ptr<const Buffer> vertex_buffer;
     std::shared_ptr<const Buffer> index_buffer;
+    uint32 base_vertex {};
+    uint32 first_index {};
     uint32 index_count {};
     uint32 vertex_count {};
+    uint32 instance_count {1};
 };
 
 void draw_deferred_prepass_item(
@@ -96,29 +70,51 @@ void draw_deferred_prepass_item(
 
     if (item.index_buffer) {
         command_buffer.set_index_buffer(item.index_buffer, IndexFormat::Uint32);
-        command_buffer.draw_indexed(item.index_count);
+        command_buffer.draw_indexed(
+            item.index_count,
+            item.first_index,
+            static_cast<std::int32_t>(item.base_vertex),
+            item.instance_count,
+            item.mesh_uniform_instance_index
+        );
     } else {
-        command_buffer.draw(0, item.vertex_count);
+        command_buffer.draw(
+            item.base_vertex,
+            item.vertex_count,
+            item.instance_count,
+            item.mesh_uniform_instance_index
+        );
     }
 }
 
 } // namespace
 
+void DeferredPipelineSpecializer::specialize(
+    RenderPipelineDescription& desc,
+    const GpuMesh&,
+    const PreparedMaterial&
+) const {
+    desc.output_description = deferred_gbuffer_output_description();
+}
+
 void queue_deferred_prepass_meshes(
     Query<
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
-    Query<Entity, const MeshViewResourceSet>::Filter<With<Camera3d>>
-        query_cameras,
+        const Transform3d,
+        MeshMaterialPipelineIds> query_meshes,
+    Query<Entity, const MeshViewResourceSet, const Transform3d>::Filter<
+        With<Camera3d>> query_cameras,
     ResRW<DeferredPrepassPhase> phase,
     ResRO<RenderAssets<GpuMesh>> gpu_meshes,
-    ResRO<MeshUniforms> mesh_uniforms,
+    ResRW<MeshUniforms> mesh_uniforms,
     ResRW<MeshMaterialPipelines> mesh_material_pipelines,
     ResRO<RenderAssets<PreparedMaterial>> materials,
     ResRO<ViewVisibleEntities> visible_entities,
     ResRO<PbrMeshShaderDefaults> shader_defaults,
+    ResRO<GraphicsDevice> device,
+    ResRO<RenderQueue> render_queue,
     ResRW<PipelineCache>
 ) {
     phase->clear();
@@ -126,7 +122,8 @@ void queue_deferred_prepass_meshes(
         return;
     }
 
-    auto [camera_entity, mesh_view_resource_set] = query_cameras.first();
+    auto [camera_entity, mesh_view_resource_set, camera_transform] =
+        query_cameras.first();
     auto visible_meshes =
         visible_entities->get(ViewId::from_source(camera_entity));
     if (!visible_meshes) {
@@ -137,6 +134,7 @@ void queue_deferred_prepass_meshes(
         query_meshes,
         *phase,
         mesh_view_resource_set.resource_set,
+        camera_transform,
         *gpu_meshes,
         *materials,
         *mesh_uniforms,
@@ -149,19 +147,26 @@ void queue_deferred_prepass_meshes(
             const Transform3d&
         ) {
             return visible_meshes->contains(entity);
+        },
+        [visible_meshes](Entity entity) {
+            return visible_meshes->lod(entity);
         }
     );
+    instance_mesh_draw_items(*phase, *device, *render_queue, *mesh_uniforms);
 }
 
 void deferred_prepass(
-    ResRW<RenderFrameContext> frame,
+    ResRO<RenderFrameContext> frame,
     ResRO<DeferredPrepassPhase> phase,
     ResRO<RenderTarget> target,
     ResRO<DeferredViewTargets> targets,
     ResRO<PipelineCache> pipeline_cache
 ) {
-    auto* command_buffer = frame->command_buffer();
-    if (!command_buffer || !target->valid() || !targets->valid()) {
+    if (!target->valid() || !targets->valid()) {
+        return;
+    }
+    auto command_buffer = frame->begin_pass(PbrPassOrder::DeferredPrepass);
+    if (!command_buffer) {
         return;
     }
 
@@ -204,10 +209,14 @@ void deferred_prepass(
                 .mesh_set = item.mesh_set,
                 .material_set = item.material_set,
                 .mesh_uniform_dynamic_offset = item.mesh_uniform_dynamic_offset,
+                .mesh_uniform_instance_index = item.mesh_uniform_instance_index,
                 .vertex_buffer = item.vertex_buffer,
                 .index_buffer = item.index_buffer,
+                .base_vertex = item.base_vertex,
+                .first_index = item.first_index,
                 .index_count = item.index_count,
                 .vertex_count = item.vertex_count,
+                .instance_count = item.instance_count,
             }
         );
     }
@@ -19,11 +19,17 @@ namespace {
 
 void init_pbr_mesh_shader_defaults(
     ResRW<PbrMeshShaderDefaults> defaults,
-    ResRW<ShaderCache> shader_cache
+    ResRW<ShaderCache> shader_cache,
+    ResRO<MeshUniforms> mesh_uniforms
 ) {
     auto create_shader_module =
         [&](const char* path, ShaderStages stage, const char* entry) {
-            return shader_cache->get_or_compile(AssetPath(path), stage, entry);
+            return shader_cache->get_or_compile(
+                AssetPath(path),
+                stage,
+                entry,
+                mesh_uniform_shader_defs(*mesh_uniforms)
+            );
         };
 
     defaults->forward_vertex = create_shader_module(
@@ -71,11 +77,9 @@ void PbrPlugin::setup(App& app) {
                 PbrSystems::PrepareLighting {},
                 PbrSystems::PrepareVxgi {}
             ),
-            chain(
-                PbrSystems::ShadowPass {},
-                PbrSystems::VxgiPass {},
-                PbrSystems::DeferredPrepass {}
-            )
+            // The G-buffer prepass does not read shadow maps or voxels, so it
+            // records alongside them on its own command buffer.
+            chain(PbrSystems::ShadowPass {}, PbrSystems::VxgiPass {})
         );
 
     app.add_plugins(
@@ -115,6 +119,8 @@ void PbrPlugin::setup(App& app) {
         )
         .add_systems(
             RenderUpdate,
+            track_mesh_material_pipelines<StandardMaterial> |
+                in_set<RenderingSystems::PrepareResources>(),
             queue_shadow_map_meshes | in_set<RenderingSystems::Queue>()
         )
         .add_systems(
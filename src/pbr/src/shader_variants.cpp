@@ -0,0 +1,224 @@
+#include "pbr/shader_variants.hpp"
+
+#include "pbr/material.hpp"
+#include "pbr/passes/deferred_internal.hpp"
+#include "pbr/pipelines.hpp"
+#include "rendering/mesh/mesh.hpp"
+#include "rendering/shader_cache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace fei {
+
+namespace {
+
+constexpr const char* forward_shader_path = "shader://pbr/forward.slang";
+constexpr const char* prepass_shader_path =
+    "shader://pbr/deferred_prepass.slang";
+
+// Shaders compiled once with the mesh uniform defs, by setup systems.
+struct MeshShaderCallSite {
+    const char* path;
+    ShaderStages stage;
+};
+
+constexpr MeshShaderCallSite mesh_shader_call_sites[] = {
+    {forward_shader_path, ShaderStages::Vertex},
+    {forward_shader_path, ShaderStages::Fragment},
+    {prepass_shader_path, ShaderStages::Vertex},
+    {prepass_shader_path, ShaderStages::Fragment},
+    {"shader://pbr/shadow.slang", ShaderStages::Vertex},
+    {"shader://pbr/shadow.slang", ShaderStages::Fragment},
+    {"shader://pbr/voxelization.slang", ShaderStages::Vertex},
+    {"shader://pbr/voxelization.slang", ShaderStages::Geometry},
+    {"shader://pbr/voxelization.slang", ShaderStages::Fragment},
+};
+
+// Shaders compiled without defs.
+constexpr MeshShaderCallSite plain_shader_call_sites[] = {
+    {"shader://pbr/cubemap2irradiance.slang", ShaderStages::Compute},
+    {"shader://pbr/cubemap2radiance.slang", ShaderStages::Compute},
+    {"shader://pbr/equirect2cube.slang", ShaderStages::Compute},
+    {"shader://pbr/skybox.slang", ShaderStages::Vertex},
+    {"shader://pbr/skybox.slang", ShaderStages::Fragment},
+    {"shader://pbr/quad.slang", ShaderStages::Vertex},
+    {"shader://pbr/blur.slang", ShaderStages::Fragment},
+    {"shader://pbr/deferred_gi_direct.slang", ShaderStages::Fragment},
+    {"shader://pbr/deferred_gi_indirect.slang", ShaderStages::Fragment},
+    {"shader://pbr/deferred_gi_composite.slang", ShaderStages::Fragment},
+    {"shader://pbr/deferred_present.slang", ShaderStages::Fragment},
+    {"shader://pbr/clear_voxels.slang", ShaderStages::Compute},
+    {"shader://pbr/resolve_voxels.slang", ShaderStages::Compute},
+    {"shader://pbr/aniso_mipmapbase.slang", ShaderStages::Compute},
+    {"shader://pbr/aniso_mipmapvolume.slang", ShaderStages::Compute},
+    {"shader://pbr/inject_radiance.slang", ShaderStages::Compute},
+    {"shader://pbr/inject_propagation.slang", ShaderStages::Compute},
+};
+
+ShaderRef
+material_shader_ref(const Material& material, MaterialShaderType type) {
+    switch (type) {
+        case MaterialShaderType::Vertex:
+            return material.vertex_shader();
+        case MaterialShaderType::Fragment:
+            return material.fragment_shader();
+        case MaterialShaderType::PrepassVertex:
+            return material.prepass_vertex_shader();
+        case MaterialShaderType::PrepassFragment:
+            return material.prepass_fragment_shader();
+    }
+    return ShaderRef::default_shader();
+}
+
+// POSITION plus every subset of the other attributes the PBR shaders read.
+std::vector<std::vector<MeshVertexAttributeId>> pbr_vertex_attribute_sets() {
+    const MeshVertexAttributeId optional_attributes[] = {
+        Mesh::ATTRIBUTE_NORMAL.id,
+        Mesh::ATTRIBUTE_UV_0.id,
+        Mesh::ATTRIBUTE_TANGENT.id,
+    };
+    constexpr std::size_t optional_count = std::size(optional_attributes);
+
+    std::vector<std::vector<MeshVertexAttributeId>> sets;
+    for (std::size_t mask = 0; mask < (std::size_t {1} << optional_count);
+         mask++) {
+        std::vector<MeshVertexAttributeId> attribute_ids {
+            Mesh::ATTRIBUTE_POSITION.id,
+        };
+        for (std::size_t i = 0; i < optional_count; i++) {
+            if (mask & (std::size_t {1} << i)) {
+                attribute_ids.push_back(optional_attributes[i]);
+            }
+        }
+        sets.push_back(std::move(attribute_ids));
+    }
+    return sets;
+}
+
+void add_variant(
+    std::vector<ShaderVariantRequest>& variants,
+    ShaderVariantRequest variant
+) {
+    variant.defs = normalized_shader_defs(std::move(variant.defs));
+    if (std::ranges::find(variants, variant) == variants.end()) {
+        variants.push_back(std::move(variant));
+    }
+}
+
+ShaderVariantRequest make_variant(
+    const char* path,
+    ShaderStages stage,
+    std::string entry,
+    ShaderDefs defs
+) {
+    return ShaderVariantRequest {
+        .logical_path = AssetPath(path).path(),
+        .stage = stage,
+        .entry = ShaderCache::normalized_shader_entry(stage, std::move(entry)),
+        .defs = std::move(defs),
+    };
+}
+
+} // namespace
+
+PbrShaderVariantPass
+PbrShaderVariantPass::from(const PipelineSpecializer& specializer) {
+    auto flags = specializer.mesh_pipeline_flags();
+    flags |= PbrMeshPipelineKeyFlags::MeshPipeline;
+    return PbrShaderVariantPass {
+        .flags = flags,
+        .vertex_shader = specializer.vertex_shader_type(),
+        .fragment_shader = specializer.fragment_shader_type(),
+    };
+}
+
+PbrShaderVariantSpace PbrShaderVariantSpace::defaults() {
+    static const StandardMaterial standard_material;
+    const PbrMeshShaderDefaults shader_defaults;
+    return PbrShaderVariantSpace {
+        .passes =
+            {
+                PbrShaderVariantPass::from(
+                    DeferredPipelineSpecializer {shader_defaults}
+                ),
+            },
+        .materials = {&standard_material},
+    };
+}
+
+std::vector<ShaderVariantRequest>
+pbr_shader_variants(const PbrShaderVariantSpace& space) {
+    std::vector<ShaderVariantRequest> variants;
+    const auto attribute_sets = pbr_vertex_attribute_sets();
+
+    for (auto layout : space.mesh_uniform_layouts) {
+        const auto mesh_uniform_defs =
+            mesh_uniform_shader_defs(MeshUniforms {.layout = layout});
+        for (const auto& call_site : mesh_shader_call_sites) {
+            add_variant(
+                variants,
+                make_variant(
+                    call_site.path,
+                    call_site.stage,
+                    {},
+                    mesh_uniform_defs
+                )
+            );
+        }
+
+        for (const auto& pass : space.passes) {
+            for (bool may_discard : {false, true}) {
+                PbrMeshPipelineKey key {.flags = pass.flags};
+                if (may_discard) {
+                    key.flags |= PbrMeshPipelineKeyFlags::MayDiscard;
+                }
+                for (const auto& attribute_ids : attribute_sets) {
+                    // Same composition as PbrMaterialPipelineSpecializer.
+                    const auto pass_defs = merge_shader_defs(
+                        merge_shader_defs(
+                            pbr_mesh_shader_defs(attribute_ids),
+                            pbr_mesh_pipeline_shader_defs(key)
+                        ),
+                        mesh_uniform_defs
+                    );
+                    for (const auto* material : space.materials) {
+                        for (auto type : {pass.vertex_shader,
+                                          pass.fragment_shader}) {
+                            auto ref = material_shader_ref(*material, type);
+                            auto path = ref.asset_path();
+                            if (!path) {
+                                continue;
+                            }
+                            add_variant(
+                                variants,
+                                ShaderVariantRequest {
+                                    .logical_path = path->path(),
+                                    .stage = pbr_material_shader_stage(type),
+                                    .entry = pbr_material_shader_entry(type),
+                                    .defs = merge_shader_defs(
+                                        normalized_shader_defs(
+                                            material->shader_defs(type)
+                                        ),
+                                        pass_defs
+                                    ),
+                                }
+                            );
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (const auto& call_site : plain_shader_call_sites) {
+        add_variant(
+            variants,
+            make_variant(call_site.path, call_site.stage, {}, {})
+        );
+    }
+    return variants;
+}
+
+} // namespace fei
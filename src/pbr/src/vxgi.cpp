@@ -85,6 +85,7 @@ void setup_vxgi(
     ResRW<VxgiVolumes> volumes,
     ResRO<GraphicsDevice> device,
     ResRW<ShaderCache> shader_cache,
+    ResRO<MeshUniforms> mesh_uniforms,
     Commands commands
 ) {
     const auto& config = volumes->config;
@@ -151,17 +152,20 @@ void setup_vxgi(
         shader_cache->get_or_compile(
             AssetPath("shader://pbr/voxelization.slang"),
             ShaderStages::Vertex,
-            {}
+            {},
+            mesh_uniform_shader_defs(*mesh_uniforms)
         ),
         shader_cache->get_or_compile(
             AssetPath("shader://pbr/voxelization.slang"),
             ShaderStages::Geometry,
-            {}
+            {},
+            mesh_uniform_shader_defs(*mesh_uniforms)
         ),
         shader_cache->get_or_compile(
             AssetPath("shader://pbr/voxelization.slang"),
             ShaderStages::Fragment,
-            {}
+            {},
+            mesh_uniform_shader_defs(*mesh_uniforms)
         ),
     };
 
@@ -367,7 +371,8 @@ void queue_vxgi_voxelization_pipelines(
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
+        const Transform3d,
+        MeshMaterialPipelineIds> query_meshes,
     ResRW<VxgiVoxelization> voxelization,
     ResRW<MeshMaterialPipelines> pipelines,
     ResRO<RenderAssets<GpuMesh>> gpu_meshes,
@@ -377,7 +382,8 @@ void queue_vxgi_voxelization_pipelines(
         return;
     }
 
-    for (const auto& [entity, mesh3d, mesh_material3d, transform3d] :
+    const auto slot = pipelines->slot(voxelization->pipeline_specializer);
+    for (auto [entity, mesh3d, mesh_material3d, transform3d, pipeline_ids] :
          query_meshes) {
         auto gpu_mesh_opt = gpu_meshes->get(mesh3d.mesh);
         auto material_opt = materials->get(mesh_material3d.material);
@@ -386,7 +392,8 @@ void queue_vxgi_voxelization_pipelines(
         }
 
         pipelines->request(
-            entity,
+            pipeline_ids,
+            slot,
             *material_opt,
             *gpu_mesh_opt,
             voxelization->pipeline_specializer
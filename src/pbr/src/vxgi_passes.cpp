@@ -3,6 +3,8 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace fei {
@@ -12,16 +14,18 @@ namespace {
 struct VoxelDrawItem {
     std::shared_ptr<const Buffer> vertex_buffer;
     std::shared_ptr<const Buffer> index_buffer;
+    uint32 base_vertex {};
+    uint32 first_index {};
     uint32 index_count {};
     uint32 vertex_count {};
     std::shared_ptr<const ResourceSet> mesh_set;
     std::shared_ptr<const ResourceSet> material_set;
     uint32 mesh_uniform_dynamic_offset {};
+    uint32 mesh_uniform_instance_index {};
     std::shared_ptr<Pipeline> pipeline;
 };
 
-std::vector<std::shared_ptr<const BindableResource>>
-volume_bindings(const VxgiVolumes& volumes) {
+ResourceBindings<5> volume_bindings(const VxgiVolumes& volumes) {
     return {
         volumes.albedo,
         volumes.normal,
@@ -31,12 +35,12 @@ volume_bindings(const VxgiVolumes& volumes) {
     };
 }
 
-std::vector<std::shared_ptr<const BindableResource>>
+ResourceBindings<1>
 voxelization_bindings(const VxgiVoxelization& voxelization) {
     return {voxelization.voxelization_uniform_buffer};
 }
 
-std::vector<std::shared_ptr<const BindableResource>>
+ResourceBindings<4>
 accumulation_bindings(const VxgiVoxelization& voxelization) {
     return {
         voxelization.albedo_accumulation_buffer,
@@ -46,7 +50,7 @@ accumulation_bindings(const VxgiVoxelization& voxelization) {
     };
 }
 
-std::vector<std::shared_ptr<const BindableResource>> mipmap_base_bindings(
+ResourceBindings<8> mipmap_base_bindings(
     const VxgiGenerateMipmapBase& mipmap_base,
     const VxgiVolumes& volumes
 ) {
@@ -62,7 +66,7 @@ std::vector<std::shared_ptr<const BindableResource>> mipmap_base_bindings(
     };
 }
 
-std::vector<std::shared_ptr<const BindableResource>> mipmap_volume_bindings(
+ResourceBindings<13> mipmap_volume_bindings(
     const VxgiGenerateMipmapVolume& mipmap_volume,
     const VxgiGenerateMipmapVolume::MipEntry& entry
 ) {
@@ -83,7 +87,7 @@ std::vector<std::shared_ptr<const BindableResource>> mipmap_volume_bindings(
     };
 }
 
-std::vector<std::shared_ptr<const BindableResource>> propagation_bindings(
+ResourceBindings<11> propagation_bindings(
     const VxgiInjectPropagation& propagation,
     const VxgiVolumes& volumes
 ) {
@@ -118,12 +122,11 @@ bool volumes_valid(const VxgiVolumes& volumes) {
 std::shared_ptr<ResourceSet> cached_set(
     RenderResourceSetCache& cache,
     const GraphicsDevice& device,
-    std::string name,
+    std::string_view name,
     const std::shared_ptr<ResourceLayout>& layout,
-    std::vector<std::shared_ptr<const BindableResource>> bindings
+    std::span<const std::shared_ptr<const BindableResource>> bindings
 ) {
-    return cache
-        .get_or_create(device, std::move(name), layout, std::move(bindings));
+    return cache.get_or_create(device, name, layout, bindings);
 }
 
 void render_mipmap_base(
@@ -192,7 +195,8 @@ void render_vxgi_voxelization_pass(
         Entity,
         const Mesh3d,
         const MeshMaterial3d<StandardMaterial>,
-        const Transform3d> query_meshes,
+        const Transform3d,
+        const MeshMaterialPipelineIds> query_meshes,
     ResRW<VxgiVoxelization> voxelization,
     ResRW<VxgiVolumes> volumes,
     ResRW<MeshMaterialPipelines> pipelines,
@@ -209,8 +213,10 @@ void render_vxgi_voxelization_pass(
         return;
     }
 
+    const auto slot = pipelines->slot(voxelization->pipeline_specializer);
     std::vector<VoxelDrawItem> draw_items;
-    for (auto [entity, mesh, mesh_material, transform] : query_meshes) {
+    for (auto [entity, mesh, mesh_material, transform, pipeline_ids] :
+         query_meshes) {
         (void)transform;
         auto gpu_mesh = gpu_meshes->get(mesh.mesh);
         auto material = materials->get(mesh_material.material);
@@ -219,12 +225,7 @@ void render_vxgi_voxelization_pass(
             mesh_uniform == mesh_uniforms->entries.end()) {
             return;
         }
-        auto pipeline_id = pipelines->find(
-            entity,
-            *material,
-            *gpu_mesh,
-            voxelization->pipeline_specializer
-        );
+        auto pipeline_id = pipeline_ids.get(slot);
         if (!pipeline_id) {
             return;
         }
@@ -237,14 +238,16 @@ void render_vxgi_voxelization_pass(
             VoxelDrawItem {
                 .vertex_buffer = gpu_mesh->vertex_buffer(),
                 .index_buffer = index ? *index : nullptr,
-                .index_count = static_cast<uint32>(
-                    gpu_mesh->index_buffer_size() / sizeof(std::uint32_t)
-                ),
+                .base_vertex = gpu_mesh->base_vertex(),
+                .first_index = gpu_mesh->first_index(),
+                .index_count = gpu_mesh->index_count(),
                 .vertex_count = static_cast<uint32>(gpu_mesh->vertex_count()),
                 .mesh_set = mesh_uniforms->resource_set,
                 .material_set = material->resource_set(),
                 .mesh_uniform_dynamic_offset =
                     mesh_uniform->second.dynamic_offset,
+                .mesh_uniform_instance_index =
+                    mesh_uniform->second.instance_index,
                 .pipeline = std::move(pipeline),
             }
         );
@@ -317,9 +320,20 @@ void render_vxgi_voxelization_pass(
                     item.index_buffer,
                     IndexFormat::Uint32
                 );
-                commands->draw_indexed(item.index_count);
+                commands->draw_indexed(
+                    item.index_count,
+                    item.first_index,
+                    static_cast<std::int32_t>(item.base_vertex),
+                    1,
+                    item.mesh_uniform_instance_index
+                );
             } else {
-                commands->draw(0, item.vertex_count);
+                commands->draw(
+                    item.base_vertex,
+                    item.vertex_count,
+                    1,
+                    item.mesh_uniform_instance_index
+                );
             }
         }
         commands->end_render_pass();
@@ -444,7 +458,7 @@ void render_vxgi_inject_radiance_pass(
         *device,
         "lighting",
         lighting->resource_layout,
-        {
+        ResourceBindings<3> {
             lighting->uniform_buffer,
             shadow_map ? shadow_map : rendering_defaults->default_texture,
             lighting->shadow_map_sampler,
@@ -455,7 +469,7 @@ void render_vxgi_inject_radiance_pass(
         *device,
         "vxgi.inject_radiance",
         inject_radiance->resource_layout,
-        {inject_radiance->uniform_buffer}
+        ResourceBindings<1> {inject_radiance->uniform_buffer}
     );
     if (!volumes_set || !voxelization_set || !lighting_set || !inject_set ||
         !inject_radiance->pipeline) {
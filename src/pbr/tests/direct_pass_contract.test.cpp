@@ -40,18 +40,25 @@ class ContractCommandBuffer : public CommandBuffer {
     uint32 draw_calls {0};
     std::vector<std::pair<std::size_t, std::size_t>> draws;
 
-    void begin() override { ++begin_calls; }
+    void begin() override {
+        ++begin_calls;
+        reset_recording_state();
+    }
     void end() override { ++end_calls; }
     void begin_render_pass(const RenderPassDescription& desc) override {
+        invalidate_bind_state();
         render_passes.push_back(desc);
     }
-    void end_render_pass() override { ++end_render_pass_calls; }
+    void end_render_pass() override {
+        invalidate_bind_state();
+        ++end_render_pass_calls;
+    }
     void set_viewport(int32 x, int32 y, uint32 width, uint32 height) override {
         viewports.push_back({x, y, width, height});
     }
     void set_scissor(int32, int32, uint32, uint32) override {}
-    void set_vertex_buffer(std::shared_ptr<const Buffer>) override {}
-    void set_resource_set(
+    void set_vertex_buffer_impl(std::shared_ptr<const Buffer>) override {}
+    void set_resource_set_impl(
         uint32 slot,
         std::shared_ptr<const ResourceSet> resource_set,
         std::span<const uint32>
@@ -64,11 +71,13 @@ class ContractCommandBuffer : public CommandBuffer {
         const void*,
         std::size_t
     ) override {}
-    void draw(std::size_t start, std::size_t count) override {
+    void
+    draw_impl(std::size_t start, std::size_t count, uint32, uint32) override {
         ++draw_calls;
         draws.emplace_back(start, count);
     }
-    void draw_indexed(std::size_t, uint32, int32) override {}
+    void
+    draw_indexed_impl(std::size_t, uint32, int32, uint32, uint32) override {}
     void dispatch(
         std::size_t group_x,
         std::size_t group_y,
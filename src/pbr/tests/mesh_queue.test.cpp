@@ -3,11 +3,13 @@
 #include "../../rendering/tests/test_graphics_device.hpp"
 #include "asset/assets.hpp"
 #include "asset/server.hpp"
+#include "ecs/change_detection.hpp"
 #include "pbr/material.hpp"
 #include "pbr/mesh_view.hpp"
 #include "rendering/shader_cache.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -23,6 +25,7 @@ struct QueueEntry {
     Mesh3d mesh;
     MeshMaterial3d<StandardMaterial> material;
     Transform3d transform;
+    ComponentRW<MeshMaterialPipelineIds> pipeline_ids;
 };
 
 std::shared_ptr<ResourceLayout> create_layout(FakeGraphicsDevice& device) {
@@ -211,12 +214,22 @@ TEST_CASE(
             },
         },
     };
+    std::vector<MeshMaterialPipelineIds> pipeline_ids(query.size());
+    std::vector<ComponentTicks> pipeline_ticks(query.size());
+    for (std::size_t index = 0; index < query.size(); ++index) {
+        query[index].pipeline_ids = ComponentRW<MeshMaterialPipelineIds>(
+            pipeline_ids[index],
+            pipeline_ticks[index],
+            SystemTicks {}
+        );
+    }
     auto view_set = create_resource_set(device);
 
     queue_mesh_draw_items(
         query,
         phase,
         view_set,
+        Transform3d {},
         gpu_meshes,
         prepared_materials,
         mesh_uniforms,
@@ -242,6 +255,10 @@ TEST_CASE(
         pipeline_cache.get_render_pipeline_state(phase.items[0].pipeline) ==
         CachedPipelineState::Queued
     );
+    const auto slot = mesh_material_pipelines.slot(PipelineSpecializer {});
+    REQUIRE(pipeline_ids[0].get(slot));
+    CHECK(*pipeline_ids[0].get(slot) == phase.items[0].pipeline);
+    CHECK_FALSE(pipeline_ids[1].get(slot));
 
     pipeline_cache.process_queued_pipelines();
 
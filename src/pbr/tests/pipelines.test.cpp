@@ -1,13 +1,18 @@
 #include "pbr/pipelines.hpp"
 
 #include "../../rendering/tests/test_graphics_device.hpp"
+#include "app/app.hpp"
 #include "asset/assets.hpp"
+#include "asset/event.hpp"
 #include "asset/server.hpp"
 #include "base/optional.hpp"
+#include "ecs/change_detection.hpp"
+#include "ecs/event.hpp"
 #include "graphics/enums.hpp"
 #include "graphics/pipeline.hpp"
 #include "graphics/resource.hpp"
 #include "graphics/shader_module.hpp"
+#include "pbr/material.hpp"
 #include "pbr/mesh_view.hpp"
 #include "pbr/pipeline_specializer.hpp"
 #include "rendering/material.hpp"
@@ -320,13 +325,10 @@ TEST_CASE(
     auto mesh = create_gpu_mesh(RenderPrimitive::Triangles);
     TestPipelineSpecializer specializer {11, CullMode::Back};
 
-    auto first_id = pipelines.request(1, material, mesh, specializer);
-    auto second_id = pipelines.request(2, material, mesh, specializer);
+    auto first_id = pipelines.request(material, mesh, specializer);
+    auto second_id = pipelines.request(material, mesh, specializer);
 
     REQUIRE(first_id == second_id);
-    auto found_id = pipelines.find(1, material, mesh, specializer);
-    REQUIRE(found_id);
-    REQUIRE(*found_id == first_id);
     REQUIRE(device.render_pipeline_descriptions.empty());
 
     pipeline_cache.process_queued_pipelines();
@@ -362,13 +364,11 @@ TEST_CASE(
     TestPipelineSpecializer specializer {11, CullMode::Back};
 
     auto triangle_id = pipelines.request(
-        1,
         material,
         create_gpu_mesh(RenderPrimitive::Triangles),
         specializer
     );
     auto line_id = pipelines.request(
-        2,
         material,
         create_gpu_mesh(RenderPrimitive::Lines),
         specializer
@@ -414,13 +414,11 @@ TEST_CASE(
     auto mesh = create_gpu_mesh(RenderPrimitive::Triangles);
 
     auto back_id = pipelines.request(
-        1,
         material,
         mesh,
         TestPipelineSpecializer {11, CullMode::Back}
     );
     auto front_id = pipelines.request(
-        2,
         material,
         mesh,
         TestPipelineSpecializer {12, CullMode::Front}
@@ -466,7 +464,6 @@ TEST_CASE(
     auto mesh = create_gpu_mesh(RenderPrimitive::Triangles);
 
     auto depth_id = pipelines.request(
-        1,
         material,
         mesh,
         TestPipelineSpecializer {
@@ -476,7 +473,6 @@ TEST_CASE(
         }
     );
     auto deferred_id = pipelines.request(
-        2,
         material,
         mesh,
         TestPipelineSpecializer {
@@ -495,7 +491,7 @@ TEST_CASE(
 }
 
 TEST_CASE(
-    "MeshMaterialPipelines find does not request missing pipelines",
+    "MeshMaterialPipelines resolves an entity only while its slot is empty",
     "[pbr][pipelines]"
 ) {
     FakeGraphicsDevice device;
@@ -514,14 +510,156 @@ TEST_CASE(
         shader_defaults
     );
 
-    auto material = create_material(device, create_layout(device));
+    auto first_material = create_material(device, create_layout(device), 1);
+    auto second_material = create_material(device, create_layout(device), 2);
     auto mesh = create_gpu_mesh(RenderPrimitive::Triangles);
-    TestPipelineSpecializer specializer {11, CullMode::Back};
+    TestPipelineSpecializer color {11, CullMode::Back};
+    TestPipelineSpecializer shadow {12, CullMode::Front};
+
+    const auto color_slot = pipelines.slot(color);
+    const auto shadow_slot = pipelines.slot(shadow);
+    REQUIRE(color_slot != shadow_slot);
+    REQUIRE(
+        pipelines.slot(TestPipelineSpecializer {11, CullMode::Back}) ==
+        color_slot
+    );
+
+    MeshMaterialPipelineIds pipeline_ids;
+    ComponentTicks ticks;
+    ComponentRW<MeshMaterialPipelineIds> entity_pipelines(
+        pipeline_ids,
+        ticks,
+        SystemTicks {}
+    );
+
+    auto color_id = pipelines.request(
+        entity_pipelines,
+        color_slot,
+        first_material,
+        mesh,
+        color
+    );
+    auto shadow_id = pipelines.request(
+        entity_pipelines,
+        shadow_slot,
+        first_material,
+        mesh,
+        shadow
+    );
+    REQUIRE(color_id != shadow_id);
+    REQUIRE(pipeline_ids.get(color_slot));
+    REQUIRE(*pipeline_ids.get(color_slot) == color_id);
+
+    // A stored id is returned as is; the inputs are not looked at again.
+    REQUIRE(
+        pipelines.request(
+            entity_pipelines,
+            color_slot,
+            second_material,
+            mesh,
+            color
+        ) == color_id
+    );
+
+    pipeline_ids.ids.clear();
+    auto second_id = pipelines.request(
+        entity_pipelines,
+        color_slot,
+        second_material,
+        mesh,
+        color
+    );
+    REQUIRE(second_id != color_id);
+    REQUIRE(pipelines.request(first_material, mesh, color) == color_id);
 
-    CHECK(pipelines.find(1, material, mesh, specializer) == nullopt);
     pipeline_cache.process_queued_pipelines();
 
-    CHECK(device.render_pipeline_descriptions.empty());
+    REQUIRE(device.render_pipeline_descriptions.size() == 3);
+}
+
+TEST_CASE(
+    "track_mesh_material_pipelines empties entities whose inputs changed",
+    "[pbr][pipelines]"
+) {
+    constexpr ScheduleId test_render_schedule = 79;
+    App app;
+    app.add_event<AssetEvent<GpuMesh>>();
+    app.add_event<AssetEvent<PreparedMaterial>>();
+    app.add_systems(
+        test_render_schedule,
+        track_mesh_material_pipelines<StandardMaterial>
+    );
+    app.world().sort_systems();
+
+    Assets<Mesh> meshes(nullptr);
+    Assets<StandardMaterial> materials(nullptr);
+    auto first_mesh =
+        meshes.add(std::make_unique<Mesh>(RenderPrimitive::Triangles));
+    auto second_mesh =
+        meshes.add(std::make_unique<Mesh>(RenderPrimitive::Triangles));
+    auto material = materials.add(std::make_unique<StandardMaterial>());
+
+    auto& world = app.world();
+    std::vector<Entity> entities;
+    for (const auto& mesh : {first_mesh, second_mesh}) {
+        const auto entity = world.entity();
+        world.add_component(entity, Mesh3d {.mesh = mesh});
+        world.add_component(
+            entity,
+            MeshMaterial3d<StandardMaterial> {.material = material}
+        );
+        entities.push_back(entity);
+    }
+
+    app.run_schedule(test_render_schedule);
+    REQUIRE(world.has_component<MeshMaterialPipelineIds>(entities[0]));
+    REQUIRE(world.has_component<MeshMaterialPipelineIds>(entities[1]));
+
+    const auto resolved = [&](Entity entity) {
+        return world.get_component<MeshMaterialPipelineIds>(entity)
+            .get(0)
+            .has_value();
+    };
+    for (const auto entity : entities) {
+        world.get_component_rw<MeshMaterialPipelineIds>(entity)->set(
+            0,
+            CachedRenderPipelineId {7}
+        );
+    }
+    app.run_schedule(test_render_schedule);
+    REQUIRE(resolved(entities[0]));
+    REQUIRE(resolved(entities[1]));
+
+    SECTION("a changed Mesh3d empties only that entity") {
+        world.get_component_rw<Mesh3d>(entities[0])->cast_shadow = false;
+        app.run_schedule(test_render_schedule);
+        CHECK_FALSE(resolved(entities[0]));
+        CHECK(resolved(entities[1]));
+    }
+
+    SECTION("a prepared GpuMesh empties the entities drawing it") {
+        app.resource<Events<AssetEvent<GpuMesh>>>().send(
+            AssetEvent<GpuMesh> {
+                .type = AssetEventType::Modified,
+                .id = second_mesh.id(),
+            }
+        );
+        app.run_schedule(test_render_schedule);
+        CHECK(resolved(entities[0]));
+        CHECK_FALSE(resolved(entities[1]));
+    }
+
+    SECTION("a prepared material empties every entity using it") {
+        app.resource<Events<AssetEvent<PreparedMaterial>>>().send(
+            AssetEvent<PreparedMaterial> {
+                .type = AssetEventType::Added,
+                .id = material.id(),
+            }
+        );
+        app.run_schedule(test_render_schedule);
+        CHECK_FALSE(resolved(entities[0]));
+        CHECK_FALSE(resolved(entities[1]));
+    }
 }
 
 TEST_CASE(
@@ -548,7 +686,7 @@ TEST_CASE(
         create_default_shader_material(device, create_layout(device));
     auto mesh = create_gpu_mesh(RenderPrimitive::Triangles);
 
-    pipelines.request(1, material, mesh, PipelineSpecializer {});
+    pipelines.request(material, mesh, PipelineSpecializer {});
     pipeline_cache.process_queued_pipelines();
 
     REQUIRE(device.render_pipeline_descriptions.size() == 1);
@@ -675,8 +813,9 @@ TEST_CASE(
     };
     TestPipelineSpecializer pass_specializer {11, CullMode::Front};
 
-    auto desc = material_pipeline_specializer
-                    .specialize(key, material, mesh, pass_specializer);
+    auto pipeline = material_pipeline_specializer
+                        .specialize(key, material, mesh, pass_specializer);
+    const auto& desc = pipeline.description;
 
     CHECK(desc.render_primitive == RenderPrimitive::Lines);
     CHECK(desc.rasterizer_state.cull_mode == CullMode::Front);
@@ -690,6 +829,17 @@ TEST_CASE(
     CHECK(desc.resource_layouts[1] == mesh_uniforms.resource_layout);
     CHECK(desc.resource_layouts[2] == material_layout);
 
+    // Uncompiled variants are left to the pipeline creation job.
+    CHECK(device.shader_descriptions.empty());
+    REQUIRE(pipeline.deferred_shaders.size() == 2);
+    for (const auto& deferred : pipeline.deferred_shaders) {
+        std::string error;
+        CHECK(deferred.compile(error));
+        CHECK(error.empty());
+    }
+    CHECK(pipeline.deferred_shaders[0].slot == 0);
+    CHECK(pipeline.deferred_shaders[1].slot == 1);
+
     REQUIRE(device.shader_descriptions.size() == 2);
     const auto& vertex_shader_desc = device.shader_descriptions[0];
     const auto& fragment_shader_desc = device.shader_descriptions[1];
@@ -745,7 +895,8 @@ TEST_CASE(
     };
 
     auto desc = material_pipeline_specializer
-                    .specialize(key, material, mesh, PipelineSpecializer {});
+                    .specialize(key, material, mesh, PipelineSpecializer {})
+                    .description;
 
     CHECK(desc.rasterizer_state.cull_mode == CullMode::None);
     CHECK_FALSE(desc.depth_stencil_state.depth_write_enabled);
@@ -795,7 +946,8 @@ TEST_CASE(
     );
     auto mesh = create_gpu_mesh(RenderPrimitive::Triangles);
 
-    pipelines.request(1, material, mesh, PipelineSpecializer {});
+    pipelines.request(material, mesh, PipelineSpecializer {});
+    pipeline_cache.process_queued_pipelines();
 
     REQUIRE(device.shader_descriptions.size() == 2);
     CHECK(has_shader_def(
@@ -807,8 +959,6 @@ TEST_CASE(
         MAY_DISCARD_SHADER_DEF
     ));
 
-    pipeline_cache.process_queued_pipelines();
-
     REQUIRE(device.render_pipeline_descriptions.size() == 1);
     REQUIRE(
         device.render_pipeline_descriptions[0]
@@ -862,7 +1012,11 @@ TEST_CASE(
         }
     );
 
-    pipelines.request(1, material, mesh, PipelineSpecializer {});
+    pipelines.request(material, mesh, PipelineSpecializer {});
+
+    // The variants compile as part of creating the pipeline.
+    CHECK(device.shader_descriptions.empty());
+    pipeline_cache.process_queued_pipelines();
 
     REQUIRE(device.shader_descriptions.size() == 2);
     const auto& vertex_shader_desc = device.shader_descriptions[0];
@@ -877,9 +1031,12 @@ TEST_CASE(
         has_shader_def(fragment_shader_desc.defs, VERTEX_TANGENTS_SHADER_DEF)
     );
 
-    pipeline_cache.process_queued_pipelines();
-
     REQUIRE(device.render_pipeline_descriptions.size() == 1);
+    const auto& pipeline_shaders =
+        device.render_pipeline_descriptions[0].shader_program.shaders;
+    REQUIRE(pipeline_shaders.size() == 2);
+    CHECK(pipeline_shaders[0]->path() == vertex_shader_desc.path);
+    CHECK(pipeline_shaders[1]->path() == fragment_shader_desc.path);
     REQUIRE(
         device.render_pipeline_descriptions[0]
             .shader_program.vertex_layouts.size() == 1
@@ -929,7 +1086,6 @@ TEST_CASE(
     auto mesh = create_gpu_mesh(RenderPrimitive::Triangles);
 
     pipelines.request(
-        1,
         material,
         mesh,
         TestPipelineSpecializer {
@@ -942,6 +1098,7 @@ TEST_CASE(
             },
         }
     );
+    pipeline_cache.process_queued_pipelines();
 
     REQUIRE(device.shader_descriptions.size() == 2);
     const auto& vertex_shader_desc = device.shader_descriptions[0];
@@ -0,0 +1,153 @@
+#include "pbr/shader_variants.hpp"
+
+#include "pbr/material.hpp"
+#include "pbr/passes/deferred_internal.hpp"
+#include "pbr/pipelines.hpp"
+#include "rendering/mesh/mesh.hpp"
+#include "rendering/mesh/mesh_uniform.hpp"
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace fei;
+
+namespace {
+
+GpuMesh create_gpu_mesh(std::vector<MeshVertexAttribute> attributes) {
+    std::vector<MeshVertexAttributeId> attribute_ids;
+    std::vector<VertexAttributeDescription> vertex_attributes;
+    std::uint64_t offset = 0;
+    for (const auto& attribute : attributes) {
+        attribute_ids.push_back(attribute.id);
+        vertex_attributes.push_back(
+            VertexAttributeDescription {
+                .location = attribute.id,
+                .offset = offset,
+                .format = attribute.format,
+            }
+        );
+        offset += vertex_format_size(attribute.format);
+    }
+
+    return GpuMesh {
+        nullptr,
+        nullopt,
+        RenderPrimitive::Triangles,
+        MeshVertexBufferLayout {
+            .attribute_ids = std::move(attribute_ids),
+            .layout = VertexBufferLayout(
+                offset,
+                VertexStepMode::Vertex,
+                std::move(vertex_attributes)
+            ),
+        },
+        0,
+        3,
+    };
+}
+
+bool contains_variant(
+    const std::vector<ShaderVariantRequest>& variants,
+    const ShaderVariantRequest& variant
+) {
+    return std::ranges::find(variants, variant) != variants.end();
+}
+
+} // namespace
+
+TEST_CASE("PBR shader variants are distinct", "[pbr][shader_variants]") {
+    auto variants = pbr_shader_variants(PbrShaderVariantSpace::defaults());
+
+    REQUIRE_FALSE(variants.empty());
+    for (std::size_t i = 0; i < variants.size(); i++) {
+        CHECK_FALSE(variants[i].entry.empty());
+        CHECK(variants[i].defs == normalized_shader_defs(variants[i].defs));
+        for (std::size_t j = i + 1; j < variants.size(); j++) {
+            CHECK_FALSE(variants[i] == variants[j]);
+        }
+    }
+}
+
+TEST_CASE(
+    "PBR shader variants cover deferred material pipelines",
+    "[pbr][shader_variants]"
+) {
+    auto variants = pbr_shader_variants(PbrShaderVariantSpace::defaults());
+
+    StandardMaterial material;
+    PreparedMaterial prepared_material {
+        {},
+        nullptr,
+        nullptr,
+        1,
+        MaterialPipelineState {.alpha_mode = MaterialAlphaMode::Mask},
+    };
+    auto mesh = create_gpu_mesh({
+        Mesh::ATTRIBUTE_POSITION,
+        Mesh::ATTRIBUTE_NORMAL,
+        Mesh::ATTRIBUTE_UV_0,
+        Mesh::ATTRIBUTE_COLOR,
+    });
+    MeshUniforms mesh_uniforms {.layout = MeshUniformLayout::StorageBuffer};
+    PbrMeshShaderDefaults shader_defaults;
+    DeferredPipelineSpecializer specializer(shader_defaults);
+
+    auto key = make_pbr_mesh_pipeline_key(mesh, prepared_material, specializer);
+    auto pass_defs = merge_shader_defs(
+        pbr_mesh_shader_defs(mesh, key),
+        mesh_uniform_shader_defs(mesh_uniforms)
+    );
+
+    for (auto type : {MaterialShaderType::PrepassVertex,
+                      MaterialShaderType::PrepassFragment}) {
+        CHECK(contains_variant(
+            variants,
+            ShaderVariantRequest {
+                .logical_path = "pbr/deferred_prepass.slang",
+                .stage = pbr_material_shader_stage(type),
+                .entry = pbr_material_shader_entry(type),
+                .defs = merge_shader_defs(
+                    normalized_shader_defs(material.shader_defs(type)),
+                    pass_defs
+                ),
+            }
+        ));
+    }
+}
+
+TEST_CASE(
+    "PBR shader variants include setup shaders",
+    "[pbr][shader_variants]"
+) {
+    auto variants = pbr_shader_variants(PbrShaderVariantSpace::defaults());
+
+    const MeshUniformLayout layouts[] = {
+        MeshUniformLayout::DynamicUniform,
+        MeshUniformLayout::StorageBuffer,
+    };
+    for (auto layout : layouts) {
+        MeshUniforms mesh_uniforms {.layout = layout};
+        CHECK(contains_variant(
+            variants,
+            ShaderVariantRequest {
+                .logical_path = "pbr/voxelization.slang",
+                .stage = ShaderStages::Geometry,
+                .entry = "geometry_main",
+                .defs = mesh_uniform_shader_defs(mesh_uniforms),
+            }
+        ));
+    }
+    CHECK(contains_variant(
+        variants,
+        ShaderVariantRequest {
+            .logical_path = "pbr/inject_radiance.slang",
+            .stage = ShaderStages::Compute,
+            .entry = "compute_main",
+            .defs = {},
+        }
+    ));
+}
@@ -4,7 +4,9 @@
 #include "graphics/texture.hpp"
 #include "rendering/render_asset.hpp"
 
+#include <cstdint>
 #include <memory>
+#include <utility>
 
 namespace fei {
 
@@ -22,6 +24,9 @@ class GpuImage {
     std::shared_ptr<const Texture> texture() const { return m_texture; }
 };
 
+// Images are decoded, converted, mipmapped and compressed by ImageLoader on
+// load threads, so preparing one only creates and fills the texture and the
+// adapter does not stage.
 class GpuImageAdapter : public RenderAssetAdapter<Image, GpuImage> {
   public:
     Optional<GpuImage>
@@ -32,18 +37,22 @@ class GpuImageAdapter : public RenderAssetAdapter<Image, GpuImage> {
         if (!texture) {
             return nullopt;
         }
-        device.update_texture(
-            texture,
-            source_asset.data(),
-            0,
-            0,
-            0,
-            source_asset.width(),
-            source_asset.height(),
-            source_asset.depth(),
-            0,
-            0
-        );
+        const auto* data = source_asset.data();
+        const auto level_count = data ? source_asset.data_levels() : 1;
+        for (std::uint32_t level = 0; level < level_count; ++level) {
+            device.update_texture(
+                texture,
+                data ? data + source_asset.level_offset(level) : data,
+                0,
+                0,
+                0,
+                source_asset.level_width(level),
+                source_asset.level_height(level),
+                source_asset.level_depth(level),
+                level,
+                0
+            );
+        }
         return {texture};
     }
 };
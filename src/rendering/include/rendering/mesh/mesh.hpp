@@ -6,23 +6,51 @@
 #include "graphics/graphics_device.hpp"
 #include "math/primitives.hpp"
 #include "math/vector.hpp"
+#include "rendering/mesh/mesh_geometry_pool.hpp"
+#include "rendering/mesh/mesh_optimize.hpp"
+#include "rendering/mesh/mesh_simplify.hpp"
 #include "rendering/mesh/vertex.hpp"
 #include "rendering/render_asset.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <span>
 #include <utility>
 #include <vector>
 
 namespace fei {
 
+// Where one level of detail sits in a mesh's index buffer.
+struct MeshLodRange {
+    uint32 first_index {0};
+    uint32 index_count {0};
+    // Geometric error relative to the mesh's bounding radius.
+    float error {0.0f};
+};
+
+// Vertex and index streams already laid out for the GPU, usually viewing a
+// mapped mesh binary that `owner` keeps alive.
+struct PackedMeshData {
+    std::shared_ptr<const void> owner;
+    MeshVertexBufferLayout layout;
+    std::span<const std::byte> vertices;
+    std::span<const std::byte> indices;
+    Aabb aabb;
+    // Empty, or every level with full detail first.
+    std::vector<MeshLodRange> lods;
+};
+
 class Mesh {
   private:
     RenderPrimitive m_primitive;
     std::map<MeshVertexAttributeId, MeshAttributeData> m_attributes;
     Optional<std::vector<std::uint32_t>> m_indices;
+    std::vector<MeshLod> m_lods;
+    Optional<PackedMeshData> m_packed;
 
   public:
     static inline MeshVertexAttribute ATTRIBUTE_POSITION =
@@ -39,8 +67,19 @@ class Mesh {
         {.name = "Vertex_Color", .id = 5, .format = VertexFormat::Float4};
 
     Mesh(RenderPrimitive primitive) : m_primitive(primitive) {}
+    // Packed meshes keep no per-attribute data on the CPU: the buffer
+    // accessors and compute_aabb() read the packed streams, and the editing
+    // operations below leave them untouched.
+    Mesh(RenderPrimitive primitive, PackedMeshData packed) :
+        m_primitive(primitive), m_packed(std::move(packed)) {}
 
     RenderPrimitive primitive() const { return m_primitive; }
+    Optional<const PackedMeshData&> packed() const {
+        if (!m_packed) {
+            return nullopt;
+        }
+        return *m_packed;
+    }
 
     void insert_attribute(
         MeshVertexAttribute attribute,
@@ -49,6 +88,7 @@ class Mesh {
 
     void insert_indices(std::vector<std::uint32_t> indices) {
         m_indices = std::move(indices);
+        m_lods.clear();
     }
 
     const VertexAttributeValues& get_attribute(MeshVertexAttributeId id) const {
@@ -67,99 +107,232 @@ class Mesh {
     void scale_by(Vector3 scale);
     void rotate_by(Vector3 euler_angles);
 
+    // Reorders triangles for the post-transform vertex cache and, unless
+    // disabled, vertices for fetch locality. Triangle lists only.
+    MeshOptimizeStats optimize(const MeshOptimizeOptions& options = {});
+    VertexCacheStats vertex_cache_stats(uint32 cache_size = 16) const;
+
+    // Builds coarser index lists over the same vertices, replacing any
+    // existing ones. Returns how many levels were built.
+    uint32 generate_lods(const MeshLodOptions& options = {});
+    const std::vector<MeshLod>& lods() const { return m_lods; }
+    // Every level's range in index_buffer_data(), full detail first. Empty
+    // when the mesh has no coarser levels.
+    std::vector<MeshLodRange> lod_ranges() const;
+
     std::size_t vertex_count() const;
     std::uint64_t vertex_size() const;
     std::size_t vertex_buffer_size() const;
     std::unique_ptr<std::byte[]> vertex_buffer_data() const;
     MeshVertexBufferLayout vertex_buffer_layout() const;
+    // The index buffer holds every level of detail back to back.
     std::size_t index_buffer_size() const;
     std::unique_ptr<std::byte[]> index_buffer_data() const;
 };
 
 class GpuMesh {
   private:
-    std::shared_ptr<Buffer> m_vertex_buffer;
-    Optional<std::shared_ptr<Buffer>> m_index_buffer;
+    std::shared_ptr<MeshGeometry> m_geometry;
     RenderPrimitive m_primitive;
     MeshVertexBufferLayout m_vertex_layout;
     std::size_t m_vertex_layout_hash {0};
-    std::size_t m_index_buffer_size;
-    std::size_t m_vertex_count;
+    std::vector<MeshLodRange> m_lods;
 
   public:
     GpuMesh(
-        std::shared_ptr<Buffer> vertex_buffer,
-        Optional<std::shared_ptr<Buffer>> index_buffer,
+        std::shared_ptr<MeshGeometry> geometry,
         RenderPrimitive primitive,
         MeshVertexBufferLayout vertex_layout,
-        std::size_t index_buffer_size,
-        std::size_t vertex_count
+        std::vector<MeshLodRange> lods = {}
     ) :
-        m_vertex_buffer(std::move(vertex_buffer)),
-        m_index_buffer(std::move(index_buffer)), m_primitive(primitive),
-        m_vertex_layout(std::move(vertex_layout)),
-        m_index_buffer_size(index_buffer_size), m_vertex_count(vertex_count) {
+        m_geometry(std::move(geometry)), m_primitive(primitive),
+        m_vertex_layout(std::move(vertex_layout)), m_lods(std::move(lods)) {
         m_vertex_layout_hash =
             std::hash<MeshVertexBufferLayout> {}(m_vertex_layout);
     }
+    GpuMesh(
+        std::shared_ptr<Buffer> vertex_buffer,
+        Optional<std::shared_ptr<Buffer>> index_buffer,
+        RenderPrimitive primitive,
+        MeshVertexBufferLayout vertex_layout,
+        std::size_t index_buffer_size,
+        std::size_t vertex_count,
+        std::vector<MeshLodRange> lods = {}
+    ) :
+        GpuMesh(
+            std::make_shared<MeshGeometry>(
+                std::move(vertex_buffer),
+                index_buffer ? std::move(*index_buffer) : nullptr,
+                static_cast<uint32>(vertex_count),
+                static_cast<uint32>(index_buffer_size / sizeof(std::uint32_t))
+            ),
+            primitive,
+            std::move(vertex_layout),
+            std::move(lods)
+        ) {}
 
-    std::shared_ptr<Buffer> vertex_buffer() { return m_vertex_buffer; }
+    std::shared_ptr<Buffer> vertex_buffer() {
+        return m_geometry->vertex_buffer();
+    }
     std::shared_ptr<const Buffer> vertex_buffer() const {
-        return m_vertex_buffer;
+        return m_geometry->vertex_buffer();
+    }
+    Optional<std::shared_ptr<Buffer>> index_buffer() {
+        if (!m_geometry->index_buffer()) {
+            return nullopt;
+        }
+        return m_geometry->index_buffer();
     }
-    Optional<std::shared_ptr<Buffer>> index_buffer() { return m_index_buffer; }
     Optional<std::shared_ptr<const Buffer>> index_buffer() const {
-        if (!m_index_buffer) {
+        if (!m_geometry->index_buffer()) {
             return nullopt;
         }
-        return std::shared_ptr<const Buffer>(*m_index_buffer);
+        return std::shared_ptr<const Buffer>(m_geometry->index_buffer());
     }
+    // Pooled meshes share their buffers; draws address them through the base
+    // vertex and first index. Coarser levels of detail are further index
+    // ranges over the same vertices; levels past the last one clamp to it.
+    const MeshGeometry& geometry() const { return *m_geometry; }
+    uint32 base_vertex() const { return m_geometry->base_vertex(); }
+    uint32 first_index(uint32 lod = 0) const {
+        if (m_lods.empty()) {
+            return m_geometry->first_index();
+        }
+        return m_geometry->first_index() + lod_range(lod).first_index;
+    }
+    uint32 index_count(uint32 lod = 0) const {
+        if (m_lods.empty()) {
+            return m_geometry->index_count();
+        }
+        return lod_range(lod).index_count;
+    }
+    uint32 lod_count() const {
+        return m_lods.empty() ? 1 : static_cast<uint32>(m_lods.size());
+    }
+    const std::vector<MeshLodRange>& lods() const { return m_lods; }
     RenderPrimitive primitive() const { return m_primitive; }
     const MeshVertexBufferLayout& vertex_buffer_layout() const {
         return m_vertex_layout;
     }
     std::size_t vertex_layout_hash() const { return m_vertex_layout_hash; }
-    std::size_t index_buffer_size() const { return m_index_buffer_size; }
-    std::size_t vertex_count() const { return m_vertex_count; }
+    std::size_t index_buffer_size() const {
+        return static_cast<std::size_t>(index_count()) * sizeof(std::uint32_t);
+    }
+    std::size_t vertex_count() const { return m_geometry->vertex_count(); }
+
+  private:
+    const MeshLodRange& lod_range(uint32 lod) const {
+        return m_lods[std::min<std::size_t>(lod, m_lods.size() - 1)];
+    }
 };
 
 class GpuMeshAdapter : public RenderAssetAdapter<Mesh, GpuMesh> {
   public:
+    // Vertex and index streams ready for upload. Interleaved meshes own
+    // them; packed meshes point into their own (usually mapped) storage,
+    // which stays valid while the source mesh does.
+    struct Staged {
+        RenderPrimitive primitive;
+        MeshVertexBufferLayout layout;
+        std::unique_ptr<std::byte[]> vertex_data;
+        std::unique_ptr<std::byte[]> index_data;
+        std::span<const std::byte> vertices;
+        std::span<const std::byte> indices;
+        std::vector<MeshLodRange> lods;
+    };
+
     Optional<GpuMesh>
     prepare_asset(const Mesh& source_asset, World& world) override {
+        auto staged = stage_asset(source_asset);
+        if (!staged) {
+            return nullopt;
+        }
+        return create_asset(std::move(*staged), world);
+    }
+
+    Optional<Staged> stage_asset(const Mesh& source_asset) const {
+        if (auto packed = source_asset.packed()) {
+            return Staged {
+                .primitive = source_asset.primitive(),
+                .layout = packed->layout,
+                .vertex_data = nullptr,
+                .index_data = nullptr,
+                .vertices = packed->vertices,
+                .indices = packed->indices,
+                .lods = packed->lods,
+            };
+        }
+        auto vertex_data = source_asset.vertex_buffer_data();
+        auto index_data = source_asset.index_buffer_data();
+        const std::span<const std::byte> vertices(
+            vertex_data.get(),
+            source_asset.vertex_buffer_size()
+        );
+        const std::span<const std::byte> indices(
+            index_data.get(),
+            source_asset.index_buffer_size()
+        );
+        return Staged {
+            .primitive = source_asset.primitive(),
+            .layout = source_asset.vertex_buffer_layout(),
+            .vertex_data = std::move(vertex_data),
+            .index_data = std::move(index_data),
+            .vertices = vertices,
+            .indices = indices,
+            .lods = source_asset.lod_ranges(),
+        };
+    }
+
+    Optional<GpuMesh> create_asset(Staged staged, World& world) const {
         auto& device = world.resource<GraphicsDevice>();
+        const auto vertices = staged.vertices;
+        const auto indices = staged.indices;
+        const auto stride = static_cast<uint32>(staged.layout.layout.stride);
+        if (world.has_resource<MeshGeometryPool>()) {
+            auto geometry = world.resource<MeshGeometryPool>().allocate(
+                device,
+                std::hash<MeshVertexBufferLayout> {}(staged.layout),
+                stride,
+                vertices,
+                indices
+            );
+            if (!geometry) {
+                return nullopt;
+            }
+            return GpuMesh {
+                std::move(geometry),
+                staged.primitive,
+                std::move(staged.layout),
+                std::move(staged.lods),
+            };
+        }
+
         auto vertex_buffer = device.create_buffer(
             BufferDescription {
-                .size = static_cast<std::uint32_t>(
-                    source_asset.vertex_buffer_size()
-                ),
+                .size = static_cast<std::uint32_t>(vertices.size()),
                 .usages = BufferUsages::Vertex,
             }
         );
-        auto vertex_data = source_asset.vertex_buffer_data();
         device.update_buffer(
             vertex_buffer,
             0,
-            vertex_data.get(),
-            static_cast<std::uint32_t>(source_asset.vertex_buffer_size())
+            vertices.data(),
+            static_cast<std::uint32_t>(vertices.size())
         );
 
         Optional<std::shared_ptr<Buffer>> index_buffer = nullopt;
-        if (source_asset.index_buffer_size() > 0) {
+        if (!indices.empty()) {
             auto ibuffer = device.create_buffer(
                 BufferDescription {
-                    .size = static_cast<std::uint32_t>(
-                        source_asset.index_buffer_size()
-                    ),
+                    .size = static_cast<std::uint32_t>(indices.size()),
                     .usages = BufferUsages::Index,
                 }
             );
-            auto index_data = source_asset.index_buffer_data();
             device.update_buffer(
                 ibuffer,
                 0,
-                index_data.get(),
-                static_cast<std::uint32_t>(source_asset.index_buffer_size())
+                indices.data(),
+                static_cast<std::uint32_t>(indices.size())
             );
             index_buffer = ibuffer;
         }
@@ -167,10 +340,11 @@ class GpuMeshAdapter : public RenderAssetAdapter<Mesh, GpuMesh> {
         return GpuMesh {
             vertex_buffer,
             index_buffer,
-            source_asset.primitive(),
-            source_asset.vertex_buffer_layout(),
-            source_asset.index_buffer_size(),
-            source_asset.vertex_count(),
+            staged.primitive,
+            std::move(staged.layout),
+            indices.size(),
+            stride == 0 ? 0 : vertices.size() / stride,
+            std::move(staged.lods),
         };
     }
 };
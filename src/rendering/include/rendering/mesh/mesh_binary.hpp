@@ -0,0 +1,35 @@
+#pragma once
+#include "asset/io.hpp"
+#include "base/result.hpp"
+#include "rendering/mesh/mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fei {
+
+// Preprocessed mesh in the layout the GPU consumes: a fixed header with the
+// AABB, the attribute table, the level-of-detail table (version 2), one
+// interleaved vertex stream matching Mesh::vertex_buffer_layout() and uint32
+// indices holding every level back to back. Little-endian, with the streams
+// 16-byte aligned within the file. Version 1 files still load.
+inline constexpr std::string_view MeshBinaryExtension {"fmesh"};
+inline constexpr std::uint32_t MeshBinaryVersion {2};
+
+bool is_mesh_binary(std::span<const std::byte> bytes);
+
+// Serializes `mesh` as it is; generate normals and tangents beforehand so
+// loading does not have to.
+Result<std::vector<std::byte>, std::string>
+encode_mesh_binary(const Mesh& mesh);
+
+// Returns a packed mesh whose streams view the reader's bytes. The mesh
+// keeps a copy of the reader alive, which shares a mapped file rather than
+// copying it; a reader that borrows its bytes must outlive the mesh.
+Result<Mesh, std::string> decode_mesh_binary(const Reader& reader);
+
+} // namespace fei
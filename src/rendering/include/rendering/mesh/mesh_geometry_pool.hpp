@@ -0,0 +1,140 @@
+#pragma once
+#include "base/optional.hpp"
+#include "base/types.hpp"
+#include "graphics/buffer.hpp"
+#include "graphics/graphics_device.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+
+namespace fei {
+
+// First-fit free list over [0, capacity) that merges neighbouring free ranges
+// on release.
+class RangeAllocator {
+  private:
+    // Offset -> size of every free range.
+    std::map<std::size_t, std::size_t> m_free;
+    std::size_t m_capacity {0};
+    std::size_t m_used {0};
+
+  public:
+    explicit RangeAllocator(std::size_t capacity);
+
+    Optional<std::size_t> allocate(std::size_t size);
+    void release(std::size_t offset, std::size_t size);
+
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t used() const { return m_used; }
+    std::size_t free_range_count() const { return m_free.size(); }
+    std::size_t largest_free_range() const;
+};
+
+struct MeshGeometryPoolConfig {
+    std::size_t vertex_slab_bytes {32 * 1024 * 1024};
+    std::size_t index_slab_bytes {16 * 1024 * 1024};
+    // Slabs holding less than this fraction of their capacity are emptied
+    // into their siblings so they can be released.
+    float defragment_threshold {0.25f};
+    // Bytes moved per maintain() call while defragmenting.
+    std::size_t defragment_budget_bytes {4 * 1024 * 1024};
+};
+
+struct MeshGeometryPoolStats {
+    std::size_t vertex_slabs {0};
+    std::size_t index_slabs {0};
+    std::size_t vertex_capacity_bytes {0};
+    std::size_t vertex_used_bytes {0};
+    std::size_t index_capacity_bytes {0};
+    std::size_t index_used_bytes {0};
+    std::size_t geometries {0};
+    std::uint64_t moved_bytes {0};
+    std::uint64_t released_slabs {0};
+};
+
+struct MeshGeometryPoolState;
+struct MeshGeometrySlab;
+
+// Where one mesh's vertices and indices live. Pooled geometry shares its
+// buffers with other meshes of the same vertex layout and is addressed by
+// base vertex and first index; it returns its ranges to the pool when
+// destroyed. MeshGeometryPool::maintain() may relocate it, so read the
+// buffers when recording rather than caching them across frames.
+class MeshGeometry {
+  private:
+    friend class MeshGeometryPool;
+    friend struct MeshGeometryPoolState;
+
+    std::weak_ptr<MeshGeometryPoolState> m_pool;
+    MeshGeometrySlab* m_vertex_slab {nullptr};
+    MeshGeometrySlab* m_index_slab {nullptr};
+    std::shared_ptr<Buffer> m_vertex_buffer;
+    std::shared_ptr<Buffer> m_index_buffer;
+    uint32 m_base_vertex {0};
+    uint32 m_vertex_count {0};
+    uint32 m_first_index {0};
+    uint32 m_index_count {0};
+
+    MeshGeometry() = default;
+
+  public:
+    // Geometry that owns dedicated buffers starting at offset zero.
+    MeshGeometry(
+        std::shared_ptr<Buffer> vertex_buffer,
+        std::shared_ptr<Buffer> index_buffer,
+        uint32 vertex_count,
+        uint32 index_count
+    );
+    MeshGeometry(const MeshGeometry&) = delete;
+    MeshGeometry& operator=(const MeshGeometry&) = delete;
+    ~MeshGeometry();
+
+    const std::shared_ptr<Buffer>& vertex_buffer() const {
+        return m_vertex_buffer;
+    }
+    // Null for non-indexed geometry.
+    const std::shared_ptr<Buffer>& index_buffer() const {
+        return m_index_buffer;
+    }
+    uint32 base_vertex() const { return m_base_vertex; }
+    uint32 vertex_count() const { return m_vertex_count; }
+    uint32 first_index() const { return m_first_index; }
+    uint32 index_count() const { return m_index_count; }
+    bool pooled() const { return m_vertex_slab != nullptr; }
+};
+
+// Sub-allocates mesh geometry from large shared buffers: one list of vertex
+// slabs per vertex layout hash and one list of uint32 index slabs. Freed
+// ranges are held back for the frames in flight before they are reused.
+// Allocation is thread-safe; maintain() must not overlap with draw
+// recording.
+class MeshGeometryPool {
+  private:
+    std::shared_ptr<MeshGeometryPoolState> m_state;
+
+  public:
+    explicit MeshGeometryPool(MeshGeometryPoolConfig config = {});
+
+    // Uploads `vertices` and `indices` into pooled slabs. Returns nullptr
+    // when the vertex data is empty or not a multiple of `vertex_stride`.
+    std::shared_ptr<MeshGeometry> allocate(
+        const GraphicsDevice& device,
+        std::size_t layout_hash,
+        uint32 vertex_stride,
+        std::span<const std::byte> vertices,
+        std::span<const std::byte> indices
+    );
+
+    // Runs once per frame: reclaims retired ranges, empties sparse slabs
+    // into their siblings when the device can copy buffers, and releases
+    // slabs nothing lives in anymore.
+    void maintain(const GraphicsDevice& device);
+
+    MeshGeometryPoolStats stats() const;
+    const MeshGeometryPoolConfig& config() const;
+};
+
+} // namespace fei
@@ -5,6 +5,8 @@
 
 namespace fei {
 
+// Loads OBJ text, or preprocessed mesh binaries recognised by their magic
+// (see mesh_binary.hpp).
 class MeshLoader : public AssetLoader<Mesh> {
   public:
     AssetLoadResult<Mesh>
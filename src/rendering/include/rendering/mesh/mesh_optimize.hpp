@@ -0,0 +1,72 @@
+#pragma once
+#include "base/types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace fei {
+
+// Post-transform vertex cache behaviour of a triangle list, simulated with a
+// FIFO cache.
+struct VertexCacheStats {
+    std::size_t vertices_transformed {0};
+    // Average cache miss ratio: transformed vertices per triangle. 0.5 is
+    // the ideal for large regular meshes, 3 the worst case.
+    float acmr {0.0f};
+    // Average transform to vertex ratio: transformed vertices per vertex.
+    // 1 is ideal.
+    float atvr {0.0f};
+};
+
+struct MeshOptimizeOptions {
+    uint32 cache_size {16};
+    // Renumber vertices in first-use order and drop unused ones.
+    bool reorder_vertices {true};
+    // Reorder triangle clusters so outward-facing ones draw first.
+    bool optimize_overdraw {false};
+    // How much ACMR the overdraw pass may give up, as a ratio.
+    float overdraw_threshold {1.05f};
+};
+
+struct MeshOptimizeStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+VertexCacheStats analyze_vertex_cache(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count,
+    uint32 cache_size
+);
+
+// Tipsify (Sander et al. 2007): reorders triangles for a post-transform
+// cache of `cache_size` entries in linear time.
+std::vector<std::uint32_t> optimize_vertex_cache(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count,
+    uint32 cache_size
+);
+
+// Splits cache-optimized `indices` into clusters and sorts them so that
+// clusters facing away from the mesh centre draw first, giving up at most
+// `threshold` times the ACMR of each cluster. Faces use the winding of
+// Mesh::compute_smooth_normals().
+std::vector<std::uint32_t> optimize_overdraw(
+    std::span<const std::uint32_t> indices,
+    std::span<const std::array<float, 3>> positions,
+    uint32 cache_size,
+    float threshold
+);
+
+// Maps every vertex to its first-use position in `indices`. Unused
+// vertices map to UnusedVertex.
+inline constexpr std::uint32_t UnusedVertex {0xffffffffu};
+std::vector<std::uint32_t> vertex_fetch_remap(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count
+);
+
+} // namespace fei
@@ -0,0 +1,38 @@
+#pragma once
+#include "base/types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace fei {
+
+// A coarser version of a mesh that draws a subset of its vertices.
+struct MeshLod {
+    std::vector<std::uint32_t> indices;
+    // Geometric error relative to the mesh's bounding radius.
+    float error {0.0f};
+};
+
+struct MeshLodOptions {
+    // Coarser levels to build below the full-detail mesh.
+    uint32 level_count {3};
+    // Share of the previous level's triangles each level aims to keep.
+    float reduction {0.5f};
+    // Largest error a level may reach, relative to the bounding radius.
+    float max_error {0.05f};
+};
+
+// Quadric error edge collapse (Garland and Heckbert 1997). Vertices never
+// move, so every level indexes the source vertex buffer. Open borders only
+// collapse along themselves, and vertices sharing a position with another
+// vertex (attribute seams) stay put so the levels do not crack. Stops early
+// once a level cannot reach its target within `max_error` or barely shrinks.
+std::vector<MeshLod> simplify_lod_chain(
+    std::span<const std::uint32_t> indices,
+    std::span<const std::array<float, 3>> positions,
+    const MeshLodOptions& options
+);
+
+} // namespace fei
@@ -6,10 +6,12 @@
 #include "graphics/buffer.hpp"
 #include "graphics/graphics_device.hpp"
 #include "graphics/resource.hpp"
+#include "graphics/shader_defs.hpp"
 #include "math/matrix.hpp"
 #include "rendering/render_queue.hpp"
 
 #include <memory>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -19,24 +21,73 @@ struct alignas(16) MeshUniform {
     Matrix4x4 world_from_local;
 };
 
+struct Mesh3d;
+
+inline constexpr const char* MESH_STORAGE_BUFFER_SHADER_DEF =
+    "MESH_STORAGE_BUFFER";
+
+enum class MeshUniformLayout : uint8 {
+    // One `uniform_buffer_offset_alignment`-aligned slot per mesh, selected
+    // by a dynamic offset on every draw.
+    DynamicUniform,
+    // Tightly packed storage buffer bound once. The vertex shader maps its
+    // instance index through `instance_buffer` to a mesh slot, which lets
+    // identical meshes be drawn as one instanced draw.
+    StorageBuffer,
+};
+
+// Mesh uniforms keep one stable slot per entity. Slots of despawned meshes go
+// to a free list, and only slots whose transform changed are re-uploaded,
+// coalesced into contiguous buffer ranges. `layout` is chosen through
+// RenderingSettings and must not change once the first frame is prepared.
 struct MeshUniforms {
     struct Entry {
+        // Offset and first instance a draw of this mesh binds with.
         uint32 dynamic_offset {};
+        uint32 instance_index {};
+        uint32 slot {};
+        uint64 last_seen_frame {};
     };
 
+    MeshUniformLayout layout {MeshUniformLayout::DynamicUniform};
     std::shared_ptr<ResourceLayout> resource_layout;
     std::shared_ptr<Buffer> uniform_buffer;
+    // Storage layout only. The first `capacity` entries map every slot to
+    // itself; instanced draws append their slots after them each frame.
+    std::shared_ptr<Buffer> instance_buffer;
     std::shared_ptr<ResourceSet> resource_set;
     std::unordered_map<Entity, Entry> entries;
+    // CPU mirror of the uniform buffer, `slot_count * stride` bytes.
     std::vector<std::byte> upload_data;
+    std::vector<uint32> free_slots;
+    std::vector<uint32> dirty_slots;
+    std::size_t slot_count {};
     std::size_t stride {};
     std::size_t capacity {};
+    std::size_t instance_capacity {};
+    std::size_t instance_count {};
+    uint64 frame {};
+    // Scratch for instance_mesh_draw_items, reused across phases and frames.
+    std::vector<uint32> instance_slots;
 };
 
-struct Mesh3d;
+// Shader defs the mesh pipelines must be compiled with for `mesh_uniforms`.
+ShaderDefs mesh_uniform_shader_defs(const MeshUniforms& mesh_uniforms);
+
+// Appends per-instance mesh slots for this frame and returns the instance
+// index of the first one. May replace `resource_set`; draws using the returned
+// range must bind the set current after the call.
+uint32 allocate_mesh_instances(
+    const GraphicsDevice& device,
+    const RenderQueue& render_queue,
+    MeshUniforms& mesh_uniforms,
+    std::span<const uint32> slots
+);
 
 void prepare_mesh_uniforms(
-    Query<Entity, const Mesh3d, const Transform3d> query,
+    Query<Entity, const Transform3d>::Filter<With<Mesh3d>> query,
+    Query<Entity, const Transform3d>::Filter<With<Mesh3d>, Changed<Transform3d>>
+        changed_query,
     ResRO<GraphicsDevice> device,
     ResRO<RenderQueue> render_queue,
     ResRW<MeshUniforms> mesh_uniforms
@@ -5,7 +5,9 @@
 #include "graphics/pipeline.hpp"
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <variant>
 #include <vector>
@@ -43,6 +45,9 @@ class VertexAttributeValues {
     std::size_t size() const;
     const void* data() const;
     VertexFormat vertex_format() const;
+    // Moves value `i` to `remap[i]` in a list of `new_size` values; values
+    // mapped to UnusedVertex are dropped.
+    void remap(std::span<const std::uint32_t> remap, std::size_t new_size);
     Optional<std::vector<std::array<float, 3>>&> as_float3();
     Optional<const std::vector<std::array<float, 3>>&> as_float3() const;
 
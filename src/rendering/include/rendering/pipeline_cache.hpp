@@ -2,8 +2,17 @@
 #include "base/types.hpp"
 #include "graphics/graphics_device.hpp"
 #include "graphics/pipeline.hpp"
+#include "graphics/shader_module.hpp"
+#include "task/task_pool.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -21,8 +30,19 @@ enum class CachedPipelineState : uint8 {
     Failed,
 };
 
+// A shader of a requested render pipeline whose variant is compiled by the
+// creation job, which stores the module at `shader_program.shaders[slot]`.
+// `compile` runs on a worker; it returns null and sets `error` on failure.
+struct DeferredPipelineShader {
+    std::size_t slot {0};
+    std::function<std::shared_ptr<const ShaderModule>(std::string& error)>
+        compile;
+};
+
 struct CachedRenderPipeline {
     RenderPipelineDescription description;
+    // Handed to the creation job, which fills in these shaders first.
+    std::vector<DeferredPipelineShader> deferred_shaders;
     std::shared_ptr<Pipeline> pipeline;
     CachedPipelineState state {CachedPipelineState::Queued};
     std::string error;
@@ -35,8 +55,36 @@ struct CachedComputePipeline {
     std::string error;
 };
 
+// Pipelines requested from the cache stay Queued until a later
+// process_queued_pipelines() call creates them. With a task pool, creation
+// (compiling deferred shader variants, then the device's create call) runs on
+// its workers and Queued means "in flight". Every call then hands at most
+// `finalize_budget` finished pipelines to GraphicsDevice::prepare_pipeline(),
+// so backends that defer context work, like OpenGL's program link, do it for
+// a bounded number per frame. Pipelines become Ready once prepared, so a
+// burst of new material/mesh combinations is spread over several frames
+// instead of stalling one. Callers skip draws whose pipeline is not Ready.
 class PipelineCache {
+  public:
+    static constexpr std::size_t unlimited_budget =
+        std::numeric_limits<std::size_t>::max();
+
   private:
+    struct CreatedPipeline {
+        bool compute {false};
+        uint32 id {0};
+        std::shared_ptr<Pipeline> pipeline;
+        std::string error;
+    };
+
+    // Shared with the worker jobs, which may outlive a moved-from cache.
+    struct Completions {
+        std::mutex mutex;
+        std::condition_variable created;
+        std::vector<CreatedPipeline> pipelines;
+        std::size_t in_flight {0};
+    };
+
     std::unordered_map<CachedRenderPipelineId, CachedRenderPipeline>
         m_render_pipelines;
     std::unordered_map<CachedComputePipelineId, CachedComputePipeline>
@@ -46,9 +94,61 @@ class PipelineCache {
     const GraphicsDevice& m_device;
     CachedRenderPipelineId m_next_render_pipeline_id {0};
     CachedComputePipelineId m_next_compute_pipeline_id {0};
+    std::size_t m_finalize_budget {unlimited_budget};
+    std::shared_ptr<Completions> m_completions {
+        std::make_shared<Completions>()
+    };
+    // Created pipelines whose backend preparation has started.
+    std::vector<CreatedPipeline> m_preparing;
+    TaskPool* m_workers {nullptr};
 
   public:
-    PipelineCache(const GraphicsDevice& device) : m_device(device) {}
+    // Without a task pool, pipelines are created on the thread that
+    // processes the queue.
+    explicit PipelineCache(
+        const GraphicsDevice& device,
+        TaskPool* workers = nullptr
+    ) :
+        m_device(device), m_workers(workers) {}
+
+    // Jobs still in flight use the device, so they finish first.
+    ~PipelineCache() {
+        if (!m_completions) {
+            return;
+        }
+        std::unique_lock lock(m_completions->mutex);
+        m_completions->created.wait(lock, [this]() {
+            return m_completions->in_flight == 0;
+        });
+    }
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+    PipelineCache(PipelineCache&&) noexcept = default;
+    PipelineCache& operator=(PipelineCache&&) = delete;
+
+    [[nodiscard]] bool asynchronous() const { return m_workers != nullptr; }
+
+    // Maximum number of created pipelines that start backend preparation, or
+    // fail, per process_queued_pipelines() call.
+    void set_finalize_budget(std::size_t budget) {
+        m_finalize_budget = std::max<std::size_t>(1, budget);
+    }
+    [[nodiscard]] std::size_t finalize_budget() const {
+        return m_finalize_budget;
+    }
+
+    // Number of requested pipelines that are not Ready or Failed yet.
+    [[nodiscard]] std::size_t pending_pipelines() const {
+        std::size_t pending = 0;
+        for (const auto& [id, cached] : m_render_pipelines) {
+            pending += cached.state == CachedPipelineState::Queued ? 1 : 0;
+        }
+        for (const auto& [id, cached] : m_compute_pipelines) {
+            pending += cached.state == CachedPipelineState::Queued ? 1 : 0;
+        }
+        return pending;
+    }
 
     std::shared_ptr<Pipeline>
     get_render_pipeline(CachedRenderPipelineId id) const {
@@ -106,8 +206,10 @@ class PipelineCache {
         return "Compute pipeline is missing";
     }
 
-    CachedRenderPipelineId
-    request_render_pipeline(RenderPipelineDescription description) {
+    CachedRenderPipelineId request_render_pipeline(
+        RenderPipelineDescription description,
+        std::vector<DeferredPipelineShader> deferred_shaders = {}
+    ) {
         CachedRenderPipelineId id = m_next_render_pipeline_id;
         m_next_render_pipeline_id = static_cast<CachedRenderPipelineId>(
             static_cast<uint32>(m_next_render_pipeline_id) + 1
@@ -116,6 +218,7 @@ class PipelineCache {
             {id,
              CachedRenderPipeline {
                  .description = std::move(description),
+                 .deferred_shaders = std::move(deferred_shaders),
                  .pipeline = nullptr,
                  .state = CachedPipelineState::Queued,
                  .error = {},
@@ -144,46 +247,281 @@ class PipelineCache {
         return id;
     }
 
+    // Starts creation of the queued pipelines and publishes finished ones;
+    // at most finalize_budget() of them start backend preparation.
     void process_queued_pipelines() {
-        for (auto id : m_queued_render_pipelines) {
-            auto it = m_render_pipelines.find(id);
-            if (it == m_render_pipelines.end() ||
-                it->second.state != CachedPipelineState::Queued) {
-                continue;
-            }
+        if (!m_workers) {
+            create_queued_pipelines(m_finalize_budget);
+        } else {
+            dispatch_queued_pipelines();
+        }
+        finalize_created_pipelines(m_finalize_budget);
+    }
+
+    // Blocks until every requested pipeline is created, ignoring the budget.
+    // Pipelines are then Ready or Failed, except those whose backend
+    // preparation waits for the next GraphicsDevice::flush(); they become
+    // Ready on the first process_queued_pipelines() call after it. Meant for
+    // loading screens and tests.
+    void wait_for_pipelines() {
+        if (!m_workers) {
+            create_queued_pipelines(unlimited_budget);
+        } else {
+            dispatch_queued_pipelines();
+            std::unique_lock lock(m_completions->mutex);
+            m_completions->created.wait(lock, [this]() {
+                return m_completions->in_flight == 0;
+            });
+        }
+        finalize_created_pipelines(unlimited_budget);
+    }
 
-            auto& cached = it->second;
-            cached.pipeline =
-                m_device.create_render_pipeline(cached.description);
-            if (cached.pipeline) {
-                cached.state = CachedPipelineState::Ready;
-                cached.error.clear();
-            } else {
-                cached.state = CachedPipelineState::Failed;
+  private:
+    void finalize_render_pipeline(
+        CachedRenderPipeline& cached,
+        std::shared_ptr<Pipeline> pipeline,
+        std::string error
+    ) {
+        cached.pipeline = std::move(pipeline);
+        if (cached.pipeline) {
+            cached.state = CachedPipelineState::Ready;
+            cached.error.clear();
+        } else {
+            cached.state = CachedPipelineState::Failed;
+            cached.error = std::move(error);
+            if (cached.error.empty()) {
                 cached.error = "GraphicsDevice returned null render pipeline";
             }
         }
+    }
+
+    void finalize_compute_pipeline(
+        CachedComputePipeline& cached,
+        std::shared_ptr<Pipeline> pipeline,
+        std::string error
+    ) {
+        cached.pipeline = std::move(pipeline);
+        if (cached.pipeline) {
+            cached.state = CachedPipelineState::Ready;
+            cached.error.clear();
+        } else {
+            cached.state = CachedPipelineState::Failed;
+            cached.error = std::move(error);
+            if (cached.error.empty()) {
+                cached.error = "GraphicsDevice returned null compute pipeline";
+            }
+        }
+    }
+
+    // Returns the queued entry for `id`, or null when it was already handled.
+    CachedRenderPipeline* queued_render_pipeline(CachedRenderPipelineId id) {
+        auto it = m_render_pipelines.find(id);
+        if (it == m_render_pipelines.end() ||
+            it->second.state != CachedPipelineState::Queued) {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    CachedComputePipeline* queued_compute_pipeline(CachedComputePipelineId id) {
+        auto it = m_compute_pipelines.find(id);
+        if (it == m_compute_pipelines.end() ||
+            it->second.state != CachedPipelineState::Queued) {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    // Runs on a worker, or inline without one. The device's create functions
+    // are const and callable from any thread; each job owns its description.
+    static CreatedPipeline create_render_pipeline(
+        const GraphicsDevice& device,
+        uint32 id,
+        RenderPipelineDescription description,
+        const std::vector<DeferredPipelineShader>& deferred_shaders
+    ) {
+        CreatedPipeline created {.compute = false, .id = id};
+        auto& shaders = description.shader_program.shaders;
+        for (const auto& deferred : deferred_shaders) {
+            auto shader_module = deferred.compile(created.error);
+            if (!shader_module) {
+                return created;
+            }
+            if (deferred.slot >= shaders.size()) {
+                shaders.resize(deferred.slot + 1);
+            }
+            shaders[deferred.slot] = std::move(shader_module);
+        }
+        created.pipeline = device.create_render_pipeline(description);
+        return created;
+    }
+
+    void push_created(CreatedPipeline created) {
+        std::scoped_lock lock(m_completions->mutex);
+        m_completions->pipelines.push_back(std::move(created));
+    }
+
+    void create_queued_pipelines(std::size_t budget) {
+        std::size_t render_count = 0;
+        for (; render_count < m_queued_render_pipelines.size() && budget > 0;
+             render_count++) {
+            auto id = m_queued_render_pipelines[render_count];
+            if (auto* cached = queued_render_pipeline(id)) {
+                push_created(create_render_pipeline(
+                    m_device,
+                    static_cast<uint32>(id),
+                    cached->description,
+                    std::exchange(cached->deferred_shaders, {})
+                ));
+                budget--;
+            }
+        }
+        m_queued_render_pipelines.erase(
+            m_queued_render_pipelines.begin(),
+            m_queued_render_pipelines.begin() +
+                static_cast<std::ptrdiff_t>(render_count)
+        );
+
+        std::size_t compute_count = 0;
+        for (; compute_count < m_queued_compute_pipelines.size() && budget > 0;
+             compute_count++) {
+            auto id = m_queued_compute_pipelines[compute_count];
+            if (auto* cached = queued_compute_pipeline(id)) {
+                push_created(CreatedPipeline {
+                    .compute = true,
+                    .id = static_cast<uint32>(id),
+                    .pipeline =
+                        m_device.create_compute_pipeline(cached->description),
+                });
+                budget--;
+            }
+        }
+        m_queued_compute_pipelines.erase(
+            m_queued_compute_pipelines.begin(),
+            m_queued_compute_pipelines.begin() +
+                static_cast<std::ptrdiff_t>(compute_count)
+        );
+    }
+
+    template<typename Create>
+    void submit_creation(Create create) {
+        {
+            std::scoped_lock lock(m_completions->mutex);
+            m_completions->in_flight++;
+        }
+        m_workers->submit([completions = m_completions,
+                           create = std::move(create)]() mutable {
+            auto created = create();
+            {
+                std::scoped_lock lock(completions->mutex);
+                completions->pipelines.push_back(std::move(created));
+                completions->in_flight--;
+            }
+            completions->created.notify_all();
+        });
+    }
+
+    void dispatch_queued_pipelines() {
+        const auto* device = &m_device;
+        for (auto id : m_queued_render_pipelines) {
+            if (auto* cached = queued_render_pipeline(id)) {
+                submit_creation([device,
+                                 id = static_cast<uint32>(id),
+                                 description = cached->description,
+                                 deferred_shaders = std::exchange(
+                                     cached->deferred_shaders,
+                                     {}
+                                 )]() {
+                    return create_render_pipeline(
+                        *device,
+                        id,
+                        description,
+                        deferred_shaders
+                    );
+                });
+            }
+        }
         m_queued_render_pipelines.clear();
 
         for (auto id : m_queued_compute_pipelines) {
-            auto it = m_compute_pipelines.find(id);
-            if (it == m_compute_pipelines.end() ||
-                it->second.state != CachedPipelineState::Queued) {
-                continue;
+            if (auto* cached = queued_compute_pipeline(id)) {
+                submit_creation([device,
+                                 id = static_cast<uint32>(id),
+                                 description = cached->description]() {
+                    return CreatedPipeline {
+                        .compute = true,
+                        .id = id,
+                        .pipeline =
+                            device->create_compute_pipeline(description),
+                    };
+                });
             }
+        }
+        m_queued_compute_pipelines.clear();
+    }
 
-            auto& cached = it->second;
-            cached.pipeline =
-                m_device.create_compute_pipeline(cached.description);
-            if (cached.pipeline) {
-                cached.state = CachedPipelineState::Ready;
-                cached.error.clear();
-            } else {
-                cached.state = CachedPipelineState::Failed;
-                cached.error = "GraphicsDevice returned null compute pipeline";
+    void publish_created_pipeline(CreatedPipeline& created) {
+        if (created.compute) {
+            auto it = m_compute_pipelines.find(
+                static_cast<CachedComputePipelineId>(created.id)
+            );
+            if (it != m_compute_pipelines.end()) {
+                finalize_compute_pipeline(
+                    it->second,
+                    std::move(created.pipeline),
+                    std::move(created.error)
+                );
+            }
+        } else {
+            auto it = m_render_pipelines.find(
+                static_cast<CachedRenderPipelineId>(created.id)
+            );
+            if (it != m_render_pipelines.end()) {
+                finalize_render_pipeline(
+                    it->second,
+                    std::move(created.pipeline),
+                    std::move(created.error)
+                );
             }
         }
-        m_queued_compute_pipelines.clear();
+    }
+
+    // Publishes pipelines whose preparation finished since the last call,
+    // then starts preparing up to `budget` newly created ones.
+    void finalize_created_pipelines(std::size_t budget) {
+        std::erase_if(m_preparing, [this](CreatedPipeline& created) {
+            if (!m_device.prepare_pipeline(created.pipeline)) {
+                return false;
+            }
+            publish_created_pipeline(created);
+            return true;
+        });
+
+        std::vector<CreatedPipeline> created;
+        {
+            std::scoped_lock lock(m_completions->mutex);
+            auto& pipelines = m_completions->pipelines;
+            const auto count = std::min(budget, pipelines.size());
+            created.assign(
+                std::make_move_iterator(pipelines.begin()),
+                std::make_move_iterator(
+                    pipelines.begin() + static_cast<std::ptrdiff_t>(count)
+                )
+            );
+            pipelines.erase(
+                pipelines.begin(),
+                pipelines.begin() + static_cast<std::ptrdiff_t>(count)
+            );
+        }
+
+        for (auto& result : created) {
+            if (result.pipeline &&
+                !m_device.prepare_pipeline(result.pipeline)) {
+                m_preparing.push_back(std::move(result));
+                continue;
+            }
+            publish_created_pipeline(result);
+        }
     }
 };
 
@@ -1,6 +1,8 @@
 #pragma once
 #include "app/app.hpp"
 #include "app/plugin.hpp"
+#include "base/optional.hpp"
+#include "base/types.hpp"
 #include "ecs/system_set.hpp"
 
 namespace fei {
@@ -21,8 +23,23 @@ struct RenderingSystems {
     struct Submit : SystemSet<Submit> {};
 };
 
+enum class MeshUniformLayout : uint8;
+
+struct RenderingSettings {
+    // Layout of the MeshUniforms resource. Unset picks the storage buffer
+    // layout, which lets identical meshes be drawn instanced, whenever the
+    // device can read storage buffers from vertex shaders.
+    Optional<MeshUniformLayout> mesh_uniform_layout;
+};
+
 class RenderingPlugin : public Plugin {
+  private:
+    RenderingSettings m_settings;
+
   public:
+    explicit RenderingPlugin(RenderingSettings settings = {}) :
+        m_settings(settings) {}
+
     void setup(App& app) override;
 };
 
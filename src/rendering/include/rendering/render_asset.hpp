@@ -1,6 +1,7 @@
 #pragma once
 #include "app/app.hpp"
 #include "asset/assets.hpp"
+#include "asset/budget.hpp"
 #include "asset/event.hpp"
 #include "asset/handle.hpp"
 #include "asset/id.hpp"
@@ -12,9 +13,14 @@
 #include "ecs/system_profile.hpp"
 #include "ecs/world.hpp"
 #include "rendering/plugin.hpp"
+#include "task/parallel.hpp"
 
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
 #include <memory>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace fei {
@@ -27,10 +33,34 @@ class RenderAssetAdapter {
     prepare_asset(const Source& source_asset, World& world) = 0;
 };
 
+// Adapters can split preparation in two. stage_asset() does the CPU work,
+// such as interleaving vertex streams, into an upload-ready Staged value
+// without touching the world, so prepare_assets runs it on worker threads.
+// create_asset() then only creates and uploads device objects.
+template<typename Adapter, typename Source, typename Target>
+concept StagedRenderAssetAdapter = requires(
+    Adapter adapter,
+    const Source& source_asset,
+    typename Adapter::Staged staged,
+    World& world
+) {
+    {
+        adapter.stage_asset(source_asset)
+    } -> std::same_as<Optional<typename Adapter::Staged>>;
+    {
+        adapter.create_asset(std::move(staged), world)
+    } -> std::same_as<Optional<Target>>;
+};
+
+// Staged adapters stage this many assets at a time. Blobs staged past the
+// frame's budget are dropped and staged again on a later frame.
+inline constexpr std::size_t render_asset_stage_batch = 8;
+
 template<typename T>
 class RenderAssets {
   private:
     std::unordered_map<AssetId, std::unique_ptr<T>> m_render_assets;
+    AssetBudget<T> m_prepare_budget;
 
   public:
     RenderAssets() = default;
@@ -66,6 +96,12 @@ class RenderAssets {
         m_render_assets.emplace(id, std::move(asset));
     }
     void remove(AssetId id) { m_render_assets.erase(id); }
+
+    // Limits how many extracted assets prepare_assets converts per frame,
+    // measured on the prepared assets. The rest stay extracted and are
+    // prepared on later frames.
+    AssetBudget<T>& prepare_budget() { return m_prepare_budget; }
+    const AssetBudget<T>& prepare_budget() const { return m_prepare_budget; }
 };
 
 template<typename T>
@@ -86,12 +122,20 @@ void extract_render_assets(
     EventReader<AssetEvent<Source>> events,
     ResRO<Assets<Source>> assets
 ) {
+    // Leftovers from the previous frame keep their place ahead of newly
+    // added assets, so retries are not starved by fresh work.
+    std::vector<AssetId> order;
     std::unordered_set<AssetId> need_extracting, added, removed, modified;
+    auto request = [&](AssetId id) {
+        if (need_extracting.insert(id).second) {
+            order.push_back(id);
+        }
+    };
     if (world->has_resource<ExtractedAssets<Source>>()) {
         auto& previous = world->resource<ExtractedAssets<Source>>();
         for (auto& entry : previous.extracted) {
             if (assets->get(entry.id)) {
-                need_extracting.insert(entry.id);
+                request(entry.id);
             }
         }
     }
@@ -101,11 +145,11 @@ void extract_render_assets(
         AssetId id = event->id;
         switch (type) {
             case AssetEventType::Added: {
-                need_extracting.insert(id);
+                request(id);
                 break;
             }
             case AssetEventType::Modified: {
-                need_extracting.insert(id);
+                request(id);
                 modified.insert(id);
                 break;
             }
@@ -123,7 +167,13 @@ void extract_render_assets(
         }
     }
     std::vector<typename ExtractedAssets<Source>::Entry> extracted;
-    for (AssetId id : need_extracting) {
+    extracted.reserve(need_extracting.size());
+    for (AssetId id : order) {
+        // Erasing on emit drops ids removed above and repeats of an id that
+        // was removed and added again.
+        if (!need_extracting.erase(id)) {
+            continue;
+        }
         if (auto source_asset = assets->get(id)) {
             extracted.push_back(
                 typename ExtractedAssets<Source>::Entry {
@@ -148,32 +198,97 @@ void extract_render_assets(
     );
 }
 
+// Sends an AssetEvent<Target> for every render asset it inserts, replaces or
+// removes, so render systems can drop state derived from the old one.
 template<typename Source, typename Target, typename Adapter>
 void prepare_assets(
     ResRW<ExtractedAssets<Source>> extracted_assets,
     ResRW<RenderAssets<Target>> render_assets,
+    EventWriter<AssetEvent<Target>> events,
     WorldRef world
 ) {
     for (auto id : extracted_assets->removed) {
         render_assets->remove(id);
+        events.send(
+            AssetEvent<Target> {
+                .type = AssetEventType::Removed,
+                .id = id,
+            }
+        );
     }
     extracted_assets->removed.clear();
 
-    std::vector<typename ExtractedAssets<Source>::Entry> pending;
-    for (const auto& entry : extracted_assets->extracted) {
-        auto id = entry.id;
-        auto* source_asset = entry.asset;
-        auto render_asset = Adapter().prepare_asset(*source_asset, *world);
+    using Entry = typename ExtractedAssets<Source>::Entry;
+    const auto& entries = extracted_assets->extracted;
+    const auto& budget = render_assets->prepare_budget();
+    std::vector<Entry> pending;
+    // Assets that are not ready yet are not charged against the budget and
+    // retry behind the ones that have not been tried, so one that never
+    // becomes ready cannot hold up the rest.
+    std::vector<Entry> not_ready;
+    AssetBudgetMeter meter(budget);
+    auto store = [&](const Entry& entry, Optional<Target> render_asset) {
         if (!render_asset) {
-            pending.push_back(entry);
-            continue;
+            meter.skip();
+            not_ready.push_back(entry);
+            return;
         }
-        render_assets->remove(id);
+        meter.consume(*render_asset);
+        const bool replaced = render_assets->get(entry.id).has_value();
+        render_assets->remove(entry.id);
         render_assets->insert(
-            id,
+            entry.id,
             std::make_unique<Target>(std::move(*render_asset))
         );
+        events.send(
+            AssetEvent<Target> {
+                .type = replaced ? AssetEventType::Modified :
+                                   AssetEventType::Added,
+                .id = entry.id,
+            }
+        );
+    };
+
+    std::size_t next = 0;
+    if constexpr (StagedRenderAssetAdapter<Adapter, Source, Target>) {
+        std::vector<Optional<typename Adapter::Staged>> staged;
+        while (next < entries.size() && !meter.exhausted()) {
+            auto batch =
+                std::min(entries.size() - next, render_asset_stage_batch);
+            if (budget.max_count > 0) {
+                batch = std::min(batch, budget.max_count - meter.count());
+            }
+            staged.clear();
+            staged.resize(batch);
+            parallel_for(batch, 1, [&](std::size_t begin, std::size_t end) {
+                for (auto index = begin; index < end; ++index) {
+                    staged[index] =
+                        Adapter().stage_asset(*entries[next + index].asset);
+                }
+            });
+            for (std::size_t index = 0; index < batch; ++index) {
+                const auto& entry = entries[next + index];
+                if (meter.exhausted()) {
+                    pending.push_back(entry);
+                } else if (!staged[index]) {
+                    store(entry, nullopt);
+                } else {
+                    auto& blob = *staged[index];
+                    auto render_asset =
+                        Adapter().create_asset(std::move(blob), *world);
+                    store(entry, std::move(render_asset));
+                }
+            }
+            next += batch;
+        }
+    } else {
+        for (; next < entries.size() && !meter.exhausted(); ++next) {
+            const auto& entry = entries[next];
+            store(entry, Adapter().prepare_asset(*entry.asset, *world));
+        }
     }
+    pending.insert(pending.end(), entries.begin() + next, entries.end());
+    pending.insert(pending.end(), not_ready.begin(), not_ready.end());
     extracted_assets->extracted = std::move(pending);
 }
 
@@ -185,6 +300,7 @@ struct RenderAssetPlugin : public Plugin {
     void setup(App& app) override {
         // app.add_resource<ExtractedAssets<Source>>();
         app.add_resource<RenderAssets<Target>>();
+        app.add_event<AssetEvent<Target>>();
         app.add_systems(
             RenderUpdate,
             chain(
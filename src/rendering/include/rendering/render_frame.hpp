@@ -1,13 +1,38 @@
 #pragma once
 
+#include "base/types.hpp"
 #include "ecs/system_params.hpp"
 #include "graphics/command_buffer.hpp"
 #include "graphics/graphics_device.hpp"
 
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace fei {
 
+// Command buffer handed out by RenderFrameContext::begin_pass(). On devices
+// without parallel recording it is the frame's primary buffer, locked for the
+// lifetime of the handle.
+class RenderPassCommands {
+  private:
+    CommandBuffer* m_command_buffer {nullptr};
+    std::unique_lock<std::mutex> m_lock;
+
+  public:
+    RenderPassCommands() = default;
+    explicit RenderPassCommands(
+        CommandBuffer* command_buffer,
+        std::unique_lock<std::mutex> lock = {}
+    ) : m_command_buffer(command_buffer), m_lock(std::move(lock)) {}
+
+    [[nodiscard]] CommandBuffer* get() const { return m_command_buffer; }
+    CommandBuffer& operator*() const { return *m_command_buffer; }
+    CommandBuffer* operator->() const { return m_command_buffer; }
+    explicit operator bool() const { return m_command_buffer != nullptr; }
+};
+
 class RenderFrameContext {
   private:
     enum class State {
@@ -17,16 +42,53 @@ class RenderFrameContext {
         Finished,
     };
 
+    struct Recording {
+        // Segment index in the high bits, then primary before passes, then the
+        // pass order. Submission sorts by this key.
+        uint64 submit_key {0};
+        std::shared_ptr<CommandBuffer> command_buffer;
+    };
+
+    // Shared so begin_pass() can stay const and be called from systems that
+    // only hold ResRO<RenderFrameContext>.
+    struct PassState {
+        std::mutex mutex;
+        const GraphicsDevice* device {nullptr};
+        bool parallel_recording {false};
+        uint32 segment {0};
+        bool segment_has_passes {false};
+        std::vector<Recording> recordings;
+    };
+
     std::shared_ptr<CommandBuffer> m_command_buffer;
+    std::shared_ptr<PassState> m_passes {std::make_shared<PassState>()};
     State m_state {State::Idle};
+    CommandBufferStats m_last_frame_stats;
+
+    void split_primary_segment();
 
   public:
     [[nodiscard]] bool begin(const GraphicsDevice& device);
-    [[nodiscard]] CommandBuffer* command_buffer() const {
+    // Exclusive access to the primary buffer. Once passes have been opened,
+    // the primary continues in a fresh buffer that is submitted after them.
+    [[nodiscard]] CommandBuffer* command_buffer() {
+        split_primary_segment();
         return m_command_buffer.get();
     }
     [[nodiscard]] bool recording() const { return m_command_buffer != nullptr; }
-    [[nodiscard]] std::shared_ptr<CommandBuffer> finish();
+
+    // Opens a command buffer for one pass. Safe to call concurrently from
+    // systems holding ResRO<RenderFrameContext>. Pass buffers opened between
+    // two uses of the primary buffer are submitted after the earlier one, in
+    // ascending `order`, with ties kept in the order they were opened.
+    [[nodiscard]] RenderPassCommands begin_pass(uint32 order = 0) const;
+
+    // Ends every recording of the frame and returns them in submission order.
+    [[nodiscard]] std::vector<std::shared_ptr<CommandBuffer>> finish();
+    // Counters summed over every command buffer of the last finished frame.
+    [[nodiscard]] const CommandBufferStats& last_frame_stats() const {
+        return m_last_frame_stats;
+    }
 };
 
 void begin_render_frame(
@@ -1,27 +1,102 @@
 #pragma once
 #include "base/types.hpp"
+#include "core/transform.hpp"
 #include "ecs/fwd.hpp"
 #include "graphics/buffer.hpp"
 #include "graphics/command_buffer.hpp"
 #include "graphics/enums.hpp"
+#include "graphics/graphics_device.hpp"
 #include "graphics/resource.hpp"
 #include "rendering/mesh/mesh.hpp"
+#include "rendering/mesh/mesh_uniform.hpp"
 #include "rendering/pipeline_cache.hpp"
+#include "rendering/render_queue.hpp"
 
-#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace fei {
 
+struct PhaseSortEntry {
+    uint64 key {};
+    uint32 index {};
+};
+
 template<class Item>
 struct RenderPhase {
     std::vector<Item> items;
 
+    // Scratch storage reused by the phase sorts and by instancing so
+    // steady-state frames do not allocate.
+    std::vector<PhaseSortEntry> sort_entries;
+    std::vector<PhaseSortEntry> sort_scratch;
+    std::vector<Item> sorted_items;
+
     void clear() { items.clear(); }
 };
 
+// Stable LSD radix sort on the 64-bit keys, one byte per pass. Passes where
+// every key shares the same byte are skipped, which is the common case for
+// the high bits of small pipeline ids.
+inline void radix_sort_phase_entries(
+    std::vector<PhaseSortEntry>& entries,
+    std::vector<PhaseSortEntry>& scratch
+) {
+    scratch.resize(entries.size());
+    for (uint32 shift = 0; shift < 64; shift += 8) {
+        std::array<uint32, 256> counts {};
+        for (const auto& entry : entries) {
+            counts[(entry.key >> shift) & 0xff]++;
+        }
+        if (counts[(entries.front().key >> shift) & 0xff] == entries.size()) {
+            continue;
+        }
+
+        uint32 offset = 0;
+        for (auto& count : counts) {
+            offset += std::exchange(count, offset);
+        }
+        for (const auto& entry : entries) {
+            scratch[counts[(entry.key >> shift) & 0xff]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
+
+// Reorders the phase items by the key `key_of` returns for each of them.
+template<class Item, class KeyFn>
+void sort_phase_by_key(RenderPhase<Item>& phase, KeyFn&& key_of) {
+    auto& items = phase.items;
+    if (items.size() < 2) {
+        return;
+    }
+
+    auto& entries = phase.sort_entries;
+    entries.clear();
+    for (std::size_t index = 0; index < items.size(); ++index) {
+        entries.push_back(
+            PhaseSortEntry {
+                .key = key_of(items[index]),
+                .index = static_cast<uint32>(index),
+            }
+        );
+    }
+    radix_sort_phase_entries(entries, phase.sort_scratch);
+
+    auto& sorted = phase.sorted_items;
+    sorted.clear();
+    sorted.reserve(items.size());
+    for (const auto& entry : entries) {
+        sorted.push_back(std::move(items[entry.index]));
+    }
+    items.swap(sorted);
+    sorted.clear();
+}
+
 struct MeshDrawItem {
     Entity entity {};
     CachedRenderPipelineId pipeline {};
@@ -30,12 +105,17 @@ struct MeshDrawItem {
     std::shared_ptr<const ResourceSet> mesh_set;
     std::shared_ptr<const ResourceSet> material_set;
     uint32 mesh_uniform_dynamic_offset {};
+    uint32 mesh_uniform_instance_index {};
 
     std::shared_ptr<const Buffer> vertex_buffer;
     std::shared_ptr<const Buffer> index_buffer;
 
+    // Pooled meshes share buffers; these locate the mesh inside them.
+    uint32 base_vertex {};
+    uint32 first_index {};
     uint32 index_count {};
     uint32 vertex_count {};
+    uint32 instance_count {1};
     float depth {};
 };
 
@@ -44,10 +124,11 @@ inline MeshDrawItem make_mesh_draw_item(
     CachedRenderPipelineId pipeline,
     std::shared_ptr<const ResourceSet> view_set,
     std::shared_ptr<const ResourceSet> mesh_set,
-    uint32 mesh_uniform_dynamic_offset,
+    const MeshUniforms::Entry& mesh_uniform,
     std::shared_ptr<const ResourceSet> material_set,
     const GpuMesh& gpu_mesh,
-    float depth = 0.0f
+    float depth = 0.0f,
+    uint32 lod = 0
 ) {
     auto index_buffer = gpu_mesh.index_buffer();
     return MeshDrawItem {
@@ -56,26 +137,149 @@ inline MeshDrawItem make_mesh_draw_item(
         .view_set = std::move(view_set),
         .mesh_set = std::move(mesh_set),
         .material_set = std::move(material_set),
-        .mesh_uniform_dynamic_offset = mesh_uniform_dynamic_offset,
+        .mesh_uniform_dynamic_offset = mesh_uniform.dynamic_offset,
+        .mesh_uniform_instance_index = mesh_uniform.instance_index,
         .vertex_buffer = gpu_mesh.vertex_buffer(),
         .index_buffer = index_buffer ? *index_buffer : nullptr,
-        .index_count = static_cast<uint32>(
-            gpu_mesh.index_buffer_size() / sizeof(std::uint32_t)
-        ),
+        .base_vertex = gpu_mesh.base_vertex(),
+        .first_index = gpu_mesh.first_index(lod),
+        .index_count = gpu_mesh.index_count(lod),
         .vertex_count = static_cast<uint32>(gpu_mesh.vertex_count()),
         .depth = depth,
     };
 }
 
-inline void sort_by_pipeline(RenderPhase<MeshDrawItem>& phase) {
-    std::sort(
-        phase.items.begin(),
-        phase.items.end(),
-        [](const MeshDrawItem& lhs, const MeshDrawItem& rhs) {
-            return static_cast<uint32>(lhs.pipeline) <
-                   static_cast<uint32>(rhs.pipeline);
+// Distance of `object` along the view direction of `view`.
+inline float view_depth(const Transform3d& view, const Transform3d& object) {
+    return Vector3::dot(object.position - view.position, view.forward());
+}
+
+enum class MeshSortOrder : uint8 {
+    // Opaque phases: state first, then nearest first to reduce overdraw.
+    FrontToBack,
+    // Blended phases: farthest first, state only breaks depth ties.
+    BackToFront,
+};
+
+// Maps a float to 16 bits that order the same way as the float itself.
+inline uint64 quantize_sort_depth(float depth) {
+    auto bits = std::bit_cast<uint32>(depth);
+    bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    return bits >> 16;
+}
+
+// Folds a pointer into `bits` bits. Distinct objects may collide, which only
+// costs batching, never correctness.
+inline uint64 sort_key_bits(const void* pointer, uint32 bits) {
+    const auto value =
+        static_cast<uint64>(reinterpret_cast<std::uintptr_t>(pointer));
+    return (value * 0x9e3779b97f4a7c15ull) >> (64 - bits);
+}
+
+// Packs pipeline (20 bits), material (16 bits), mesh (12 bits) and depth
+// (16 bits). Back-to-front keys move the inverted depth to the top. Meshes
+// sharing pooled buffers are told apart by their offsets.
+inline uint64
+make_mesh_sort_key(const MeshDrawItem& item, MeshSortOrder order) {
+    const uint64 pipeline = static_cast<uint32>(item.pipeline) & 0xfffffu;
+    const uint64 material = sort_key_bits(item.material_set.get(), 16);
+    const auto offsets =
+        (static_cast<uint64>(item.base_vertex) << 32) | item.first_index;
+    const uint64 mesh = sort_key_bits(item.vertex_buffer.get(), 12) ^
+                        sort_key_bits(item.index_buffer.get(), 12) ^
+                        ((offsets * 0x9e3779b97f4a7c15ull) >> 52);
+    const uint64 state = (pipeline << 28) | (material << 12) | mesh;
+    const uint64 depth = quantize_sort_depth(item.depth);
+    if (order == MeshSortOrder::BackToFront) {
+        return ((0xffffu - depth) << 48) | state;
+    }
+    return (state << 16) | depth;
+}
+
+// Orders draws by their packed sort key so state changes are minimized and
+// draws that can be instanced end up adjacent.
+inline void sort_mesh_draw_items(
+    RenderPhase<MeshDrawItem>& phase,
+    MeshSortOrder order = MeshSortOrder::FrontToBack
+) {
+    sort_phase_by_key(phase, [order](const MeshDrawItem& item) {
+        return make_mesh_sort_key(item, order);
+    });
+}
+
+inline bool
+can_instance_mesh_draw_items(const MeshDrawItem& lhs, const MeshDrawItem& rhs) {
+    return lhs.pipeline == rhs.pipeline && lhs.view_set == rhs.view_set &&
+           lhs.mesh_set == rhs.mesh_set &&
+           lhs.material_set == rhs.material_set &&
+           lhs.vertex_buffer == rhs.vertex_buffer &&
+           lhs.index_buffer == rhs.index_buffer &&
+           lhs.base_vertex == rhs.base_vertex &&
+           lhs.first_index == rhs.first_index &&
+           lhs.index_count == rhs.index_count &&
+           lhs.vertex_count == rhs.vertex_count;
+}
+
+// Collapses adjacent draws of the same mesh, material and pipeline into one
+// instanced draw. Only the storage buffer mesh layout can index transforms
+// per instance; with dynamic uniforms the phase is left untouched. Call after
+// sorting.
+inline void instance_mesh_draw_items(
+    RenderPhase<MeshDrawItem>& phase,
+    const GraphicsDevice& device,
+    const RenderQueue& render_queue,
+    MeshUniforms& mesh_uniforms
+) {
+    if (mesh_uniforms.layout != MeshUniformLayout::StorageBuffer ||
+        phase.items.size() < 2) {
+        return;
+    }
+
+    auto& items = phase.items;
+    auto& instance_slots = mesh_uniforms.instance_slots;
+    auto& batched = phase.sorted_items;
+    instance_slots.clear();
+    batched.clear();
+    batched.reserve(items.size());
+    for (std::size_t begin = 0; begin < items.size();) {
+        auto end = begin + 1;
+        while (end < items.size() &&
+               can_instance_mesh_draw_items(items[begin], items[end])) {
+            ++end;
+        }
+
+        const auto local_first = static_cast<uint32>(instance_slots.size());
+        if (end - begin > 1) {
+            for (auto index = begin; index < end; ++index) {
+                const auto& instance = items[index];
+                instance_slots.push_back(instance.mesh_uniform_instance_index);
+            }
         }
+
+        auto& item = batched.emplace_back(std::move(items[begin]));
+        if (end - begin > 1) {
+            // Instanced draws index past the identity range; record the
+            // local offset now and rebase once the range is allocated.
+            item.instance_count = static_cast<uint32>(end - begin);
+            item.mesh_uniform_instance_index = local_first;
+        }
+        begin = end;
+    }
+
+    const auto first_instance = allocate_mesh_instances(
+        device,
+        render_queue,
+        mesh_uniforms,
+        instance_slots
     );
+    for (auto& item : batched) {
+        if (item.instance_count > 1) {
+            item.mesh_uniform_instance_index += first_instance;
+        }
+        item.mesh_set = mesh_uniforms.resource_set;
+    }
+    items.swap(batched);
+    batched.clear();
 }
 
 inline void draw_mesh_item(
@@ -97,9 +301,20 @@ inline void draw_mesh_item(
 
     if (item.index_buffer) {
         command_buffer.set_index_buffer(item.index_buffer, IndexFormat::Uint32);
-        command_buffer.draw_indexed(item.index_count);
+        command_buffer.draw_indexed(
+            item.index_count,
+            item.first_index,
+            static_cast<std::int32_t>(item.base_vertex),
+            item.instance_count,
+            item.mesh_uniform_instance_index
+        );
     } else {
-        command_buffer.draw(0, item.vertex_count);
+        command_buffer.draw(
+            item.base_vertex,
+            item.vertex_count,
+            item.instance_count,
+            item.mesh_uniform_instance_index
+        );
     }
 }
 
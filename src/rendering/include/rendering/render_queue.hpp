@@ -5,6 +5,7 @@
 #include "graphics/buffer.hpp"
 #include "rendering/render_frame.hpp"
 
+#include <array>
 #include <cstddef>
 #include <memory>
 #include <mutex>
@@ -13,22 +14,61 @@
 
 namespace fei {
 
+class CommandBuffer;
+
+// Counters for the most recent flush_render_queue.
+struct RenderQueueStats {
+    // Writes and bytes queued by systems.
+    uint32 writes {0};
+    uint64 bytes {0};
+    // update_buffer commands and bytes recorded after coalescing.
+    uint32 updates {0};
+    uint64 update_bytes {0};
+};
+
 class RenderQueue {
+  public:
+    // Staging frames kept alive round-robin. Writes land in the current one.
+    // Taking it for a flush clears the next frame and makes that current, so
+    // with two frames a flushed one stays intact until the next flush.
+    static constexpr std::size_t staging_frame_count = 2;
+
   private:
     struct BufferWrite {
         std::shared_ptr<Buffer> destination;
         uint32 offset {};
-        std::vector<std::byte> data;
+        std::size_t staging_offset {};
+        std::size_t size {};
+    };
+
+    // Linear arena for one frame. Both vectors keep their capacity across
+    // frames, so steady-state writes do not allocate.
+    struct StagingFrame {
+        std::vector<std::byte> bytes;
+        std::vector<BufferWrite> writes;
     };
 
     struct State {
         std::mutex mutex;
-        std::vector<BufferWrite> buffer_writes;
+        std::array<StagingFrame, staging_frame_count> frames;
+        std::size_t frame_index {0};
+        RenderQueueStats last_flush_stats;
+
+        // Flush scratch, only touched by the flushing thread.
+        std::vector<uint32> flush_order;
+        std::vector<std::byte> merged_bytes;
     };
 
     std::shared_ptr<State> m_state {std::make_shared<State>()};
 
-    [[nodiscard]] std::vector<BufferWrite> take_buffer_writes() const;
+    // Hands the current frame to the caller, then clears the next one and
+    // makes it current. The returned frame stays intact until a later take
+    // makes it current again.
+    [[nodiscard]] const StagingFrame& take_staging_frame() const;
+    void record_staging_frame(
+        const StagingFrame& staged,
+        CommandBuffer& command_buffer
+    ) const;
 
     friend void flush_render_queue(
         ResRO<RenderQueue> queue,
@@ -51,6 +91,8 @@ class RenderQueue {
     }
 
     [[nodiscard]] std::size_t pending_buffer_writes() const;
+    [[nodiscard]] std::size_t pending_buffer_bytes() const;
+    [[nodiscard]] RenderQueueStats last_flush_stats() const;
 };
 
 void flush_render_queue(
@@ -2,10 +2,15 @@
 
 #include "graphics/graphics_device.hpp"
 
+#include <array>
+#include <chrono>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <list>
 #include <memory>
-#include <string>
+#include <span>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -15,9 +20,24 @@ struct RenderResourceSetCacheStats {
     std::uint64_t requests {0};
     std::uint64_t hits {0};
     std::uint64_t creates {0};
+    std::uint64_t evictions {0};
     std::size_t size {0};
+    // Estimated host memory held by the cached entries.
+    std::size_t bytes {0};
+    // Time spent in get_or_create(), resource set creation included.
+    std::uint64_t lookup_ns {0};
+    std::uint64_t last_frame_requests {0};
+    std::uint64_t last_frame_hits {0};
+    std::uint64_t last_frame_lookup_ns {0};
 };
 
+// Fixed-size bindings for one lookup, so callers do not allocate per frame.
+template<std::size_t N>
+using ResourceBindings = std::array<std::shared_ptr<const BindableResource>, N>;
+
+// Reuses resource sets across frames, keyed by layout and the physical
+// resources bound. The resource set itself keeps its layout and resources
+// alive, so cached keys never refer to a freed address.
 class RenderResourceSetCache {
   private:
     struct ResourceKey {
@@ -30,36 +50,106 @@ class RenderResourceSetCache {
 
     struct Key {
         const ResourceLayout* layout {nullptr};
+        std::size_t hash {0};
         std::vector<ResourceKey> resources;
+    };
 
-        bool operator==(const Key&) const = default;
+    // The request, keyed once into m_request_keys. Hits compare against it
+    // without materializing a Key.
+    struct KeyView {
+        const ResourceLayout* layout {nullptr};
+        std::size_t hash {0};
+        std::span<const ResourceKey> resources;
     };
 
     struct KeyHash {
-        std::size_t operator()(const Key& key) const;
+        using is_transparent = void;
+        std::size_t operator()(const Key& key) const { return key.hash; }
+        std::size_t operator()(const KeyView& key) const { return key.hash; }
+    };
+
+    struct KeyEqual {
+        using is_transparent = void;
+        bool operator()(const Key& lhs, const Key& rhs) const;
+        bool operator()(const KeyView& lhs, const Key& rhs) const;
+        bool operator()(const Key& lhs, const KeyView& rhs) const {
+            return (*this)(rhs, lhs);
+        }
     };
 
     struct Entry {
         std::shared_ptr<ResourceSet> resource_set;
-        std::shared_ptr<const ResourceLayout> layout;
-        std::vector<std::shared_ptr<const BindableResource>> resources;
         std::uint64_t last_used_frame {0};
+        std::size_t bytes {0};
+        // Position in m_lru, most recently used first.
+        std::list<const Key*>::iterator lru;
     };
 
-    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    using Entries = std::unordered_map<Key, Entry, KeyHash, KeyEqual>;
+
+    Entries m_entries;
+    std::list<const Key*> m_lru;
     std::uint64_t m_frame_index {0};
+    std::size_t m_budget_bytes {DefaultBudgetBytes};
     RenderResourceSetCacheStats m_stats;
+    RenderResourceSetCacheStats m_frame_start;
+    // Keys and hash of the current request. The key storage is reused, so
+    // hits do not allocate.
+    std::vector<ResourceKey> m_request_keys;
+    std::size_t m_request_hash {0};
 
-    static constexpr std::uint64_t MaxIdleFrames = 120;
+    static ResourceKey resource_key(const BindableResource& resource);
+    static std::size_t entry_bytes(std::size_t resource_count);
+    void touch(Entry& entry);
+    void erase(Entries::iterator entry);
+    void evict_over_budget();
+    void record_latency(std::chrono::steady_clock::time_point start);
+    // Keys and hashes the request, computing each resource key once. Returns
+    // false if the layout or a resource is null.
+    bool key_request(
+        const ResourceLayout* layout,
+        std::span<const std::shared_ptr<const BindableResource>> resources
+    );
+    std::shared_ptr<ResourceSet> find(const ResourceLayout* layout);
+    std::shared_ptr<ResourceSet> create(
+        const GraphicsDevice& device,
+        std::string_view name,
+        std::shared_ptr<const ResourceLayout> layout,
+        std::span<const std::shared_ptr<const BindableResource>> resources
+    );
 
   public:
+    static constexpr std::uint64_t MaxIdleFrames = 120;
+    static constexpr std::size_t DefaultBudgetBytes = 4 * 1024 * 1024;
+
     void begin_frame();
+    // The name, layout and resources are only copied when a new set has to
+    // be created. Accepts mutable layouts as well, so callers holding one do
+    // not convert it to a temporary on every lookup.
+    template<typename Layout>
+        requires std::convertible_to<Layout*, const ResourceLayout*>
     [[nodiscard]] std::shared_ptr<ResourceSet> get_or_create(
         const GraphicsDevice& device,
-        std::string name,
-        std::shared_ptr<const ResourceLayout> layout,
-        std::vector<std::shared_ptr<const BindableResource>> resources
-    );
+        std::string_view name,
+        const std::shared_ptr<Layout>& layout,
+        std::span<const std::shared_ptr<const BindableResource>> resources
+    ) {
+        const auto start = std::chrono::steady_clock::now();
+        ++m_stats.requests;
+        if (!key_request(layout.get(), resources)) {
+            return nullptr;
+        }
+        auto resource_set = find(layout.get());
+        if (!resource_set) {
+            resource_set = create(device, name, layout, resources);
+        }
+        record_latency(start);
+        return resource_set;
+    }
+    // Least recently used entries are evicted once the estimated footprint
+    // exceeds `bytes`, in addition to entries idle for MaxIdleFrames.
+    void set_budget_bytes(std::size_t bytes);
+    [[nodiscard]] std::size_t budget_bytes() const { return m_budget_bytes; }
     void clear();
     [[nodiscard]] const RenderResourceSetCacheStats& stats() const {
         return m_stats;
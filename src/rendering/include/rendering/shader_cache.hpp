@@ -10,8 +10,11 @@
 #include "rendering/shader.hpp"
 #include "rendering/shader_compiler.hpp"
 
+#include <atomic>
 #include <filesystem>
+#include <format>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -46,24 +49,115 @@ struct hash<fei::ShaderVariantKey> { // NOLINT(readability-identifier-naming)
 
 namespace fei {
 
+struct ShaderFileDependency {
+    std::filesystem::path path;
+    std::filesystem::file_time_type modified_time;
+};
+
+// One shader variant, compiled from a copy of the asset's source so that
+// compile() touches no asset storage and can run on a pipeline worker. The
+// first caller compiles; concurrent callers wait for it and share the module.
+class ShaderVariantCompile {
+  private:
+    ShaderVariantCompiler* m_compiler;
+    const GraphicsDevice& m_device;
+    std::filesystem::path m_path;
+    std::string m_source;
+    ShaderStages m_stage;
+    std::string m_entry;
+    ShaderDefs m_defs;
+
+    std::once_flag m_compiled;
+    std::atomic<bool> m_done {false};
+    std::shared_ptr<ShaderModule> m_module;
+    std::vector<ShaderFileDependency> m_dependencies;
+    std::string m_error;
+
+  public:
+    ShaderVariantCompile(
+        ShaderVariantCompiler* compiler,
+        const GraphicsDevice& device,
+        const Shader& shader,
+        const ShaderVariantKey& key
+    ) :
+        m_compiler(compiler), m_device(device), m_path(shader.path),
+        m_source(shader.source), m_stage(key.stage), m_entry(key.entry),
+        m_defs(key.defs) {}
+
+    // Returns null when compilation failed; error() then says why.
+    std::shared_ptr<ShaderModule> compile() {
+        std::call_once(m_compiled, [this]() {
+            run_compile();
+            m_done.store(true, std::memory_order_release);
+        });
+        return m_module;
+    }
+
+    [[nodiscard]] bool done() const {
+        return m_done.load(std::memory_order_acquire);
+    }
+
+    // The accessors below are valid once done() is true.
+    [[nodiscard]] const std::shared_ptr<ShaderModule>& shader_module() const {
+        return m_module;
+    }
+    [[nodiscard]] const std::vector<ShaderFileDependency>&
+    dependencies() const {
+        return m_dependencies;
+    }
+    [[nodiscard]] const std::string& error() const { return m_error; }
+
+  private:
+    void run_compile() {
+        if (m_compiler == nullptr) {
+            m_error = std::format(
+                "ShaderCache: cannot compile shader '{}' without a "
+                "ShaderVariantCompiler",
+                m_path.string()
+            );
+            return;
+        }
+
+        auto compiled = m_compiler->compile_with_dependencies(
+            m_path,
+            std::move(m_source),
+            m_stage,
+            m_entry,
+            m_defs
+        );
+        if (!compiled) {
+            auto error = std::move(compiled).error();
+            m_error = std::format(
+                "ShaderCache: failed to compile shader '{}': {}\n{}",
+                m_path.string(),
+                error.message,
+                error.diagnostics
+            );
+            return;
+        }
+        auto output = std::move(compiled).value();
+        m_module = m_device.create_shader_module(output.description);
+        m_dependencies.reserve(output.dependencies.size());
+        for (auto& path : output.dependencies) {
+            std::error_code error;
+            auto modified_time = std::filesystem::last_write_time(path, error);
+            if (error) {
+                continue;
+            }
+            m_dependencies.push_back(
+                ShaderFileDependency {
+                    .path = std::move(path),
+                    .modified_time = modified_time,
+                }
+            );
+        }
+    }
+};
+
 class ShaderCache {
   private:
-    struct ShaderFileDependency {
-        std::filesystem::path path;
-        std::filesystem::file_time_type modified_time;
-    };
-
-    struct ShaderCacheEntry {
-        std::shared_ptr<ShaderModule> module;
-        std::vector<ShaderFileDependency> dependencies;
-    };
-
-    struct ShaderDescriptionWithDependencies {
-        ShaderDescription description;
-        std::vector<std::filesystem::path> dependencies;
-    };
-
-    std::unordered_map<ShaderVariantKey, ShaderCacheEntry> m_cache;
+    std::unordered_map<ShaderVariantKey, std::shared_ptr<ShaderVariantCompile>>
+        m_cache;
     AssetServer& m_asset_server;
     Assets<Shader>& m_shaders;
     const GraphicsDevice& m_device;
@@ -110,6 +204,23 @@ class ShaderCache {
         ShaderStages stage,
         std::string entry,
         ShaderDefs defs = {}) {
+        auto variant =
+            get_variant(id, stage, std::move(entry), std::move(defs));
+        auto shader_module = variant->compile();
+        if (!shader_module) {
+            fatal("{}", variant->error());
+        }
+        return shader_module;
+    }
+
+    // Like get(), but a variant that is not compiled yet is left to the
+    // caller, which may run ShaderVariantCompile::compile() on a worker.
+    std::shared_ptr<ShaderVariantCompile> get_variant(
+        const AssetId& id,
+        ShaderStages stage,
+        std::string entry,
+        ShaderDefs defs = {}
+    ) {
         ShaderVariantKey key {
             .shader = id,
             .stage = stage,
@@ -117,8 +228,8 @@ class ShaderCache {
             .defs = normalized_shader_defs(std::move(defs)),
         };
         auto it = m_cache.find(key);
-        if (it != m_cache.end() && dependencies_are_current(it->second)) {
-            return it->second.module;
+        if (it != m_cache.end() && is_current(*it->second)) {
+            return it->second;
         }
         if (it != m_cache.end()) {
             m_cache.erase(it);
@@ -127,19 +238,28 @@ class ShaderCache {
         if (!shader_asset) {
             fatal("ShaderCache: Shader asset '{}' not found", id);
         }
-        auto compiled =
-            make_description(*shader_asset, key.stage, key.entry, key.defs);
-        auto shader_module =
-            m_device.create_shader_module(compiled.description);
-        m_cache.emplace(
-            std::move(key),
-            ShaderCacheEntry {
-                .module = shader_module,
-                .dependencies =
-                    make_file_dependencies(std::move(compiled.dependencies)),
-            }
+        auto variant = std::make_shared<ShaderVariantCompile>(
+            m_variant_compiler,
+            m_device,
+            *shader_asset,
+            key
+        );
+        m_cache.emplace(std::move(key), variant);
+        return variant;
+    }
+
+    std::shared_ptr<ShaderVariantCompile> get_variant(
+        const ShaderRef& ref,
+        ShaderStages stage,
+        std::string entry,
+        ShaderDefs defs = {}
+    ) {
+        return get_variant(
+            ref.resolve(m_asset_server).id(),
+            stage,
+            std::move(entry),
+            std::move(defs)
         );
-        return shader_module;
     }
 
     std::shared_ptr<ShaderModule>
@@ -198,7 +318,6 @@ class ShaderCache {
         );
     }
 
-  private:
     static std::string default_shader_entry(ShaderStages stage) {
         switch (stage) {
             case ShaderStages::Vertex:
@@ -222,28 +341,17 @@ class ShaderCache {
         return entry;
     }
 
-    static std::vector<ShaderFileDependency>
-    make_file_dependencies(std::vector<std::filesystem::path> paths) {
-        std::vector<ShaderFileDependency> dependencies;
-        dependencies.reserve(paths.size());
-        for (auto& path : paths) {
-            std::error_code error;
-            auto modified_time = std::filesystem::last_write_time(path, error);
-            if (error) {
-                continue;
-            }
-            dependencies.push_back(
-                ShaderFileDependency {
-                    .path = std::move(path),
-                    .modified_time = modified_time,
-                }
-            );
+  private:
+    // A variant still compiling stays current; a finished one is current
+    // while it compiled and none of its dependencies changed since.
+    static bool is_current(const ShaderVariantCompile& variant) {
+        if (!variant.done()) {
+            return true;
         }
-        return dependencies;
-    }
-
-    static bool dependencies_are_current(const ShaderCacheEntry& entry) {
-        for (const auto& dependency : entry.dependencies) {
+        if (!variant.shader_module()) {
+            return false;
+        }
+        for (const auto& dependency : variant.dependencies()) {
             std::error_code error;
             auto modified_time =
                 std::filesystem::last_write_time(dependency.path, error);
@@ -253,52 +361,6 @@ class ShaderCache {
         }
         return true;
     }
-
-    ShaderDescriptionWithDependencies make_description(
-        const Shader& shader,
-        ShaderStages stage,
-        const std::string& entry,
-        const ShaderDefs& defs
-    ) {
-        return compile_description(shader, stage, entry, defs);
-    }
-
-    ShaderDescriptionWithDependencies compile_description(
-        const Shader& shader,
-        ShaderStages stage,
-        const std::string& entry,
-        const ShaderDefs& defs
-    ) {
-        if (m_variant_compiler == nullptr) {
-            fatal(
-                "ShaderCache: cannot compile shader '{}' without a "
-                "ShaderVariantCompiler",
-                shader.path.string()
-            );
-        }
-
-        auto compiled = m_variant_compiler->compile_with_dependencies(
-            shader.path,
-            shader.source,
-            stage,
-            entry,
-            defs
-        );
-        if (!compiled) {
-            auto error = std::move(compiled).error();
-            fatal(
-                "ShaderCache: failed to compile shader '{}': {}\n{}",
-                shader.path.string(),
-                error.message,
-                error.diagnostics
-            );
-        }
-        auto output = std::move(compiled).value();
-        return ShaderDescriptionWithDependencies {
-            .description = std::move(output.description),
-            .dependencies = std::move(output.dependencies),
-        };
-    }
 };
 
 } // namespace fei
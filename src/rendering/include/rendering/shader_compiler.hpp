@@ -5,6 +5,7 @@
 #include "graphics/shader_module.hpp"
 #include "rendering/shader.hpp"
 
+#include <cstddef>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -25,6 +26,16 @@ struct ShaderCompileRequest {
     ShaderDefs defs;
 };
 
+// One variant to compile ahead of time, keyed the way ShaderCache keys it.
+struct ShaderVariantRequest {
+    std::filesystem::path logical_path;
+    ShaderStages stage {ShaderStages::None};
+    std::string entry;
+    ShaderDefs defs;
+
+    bool operator==(const ShaderVariantRequest&) const = default;
+};
+
 struct ShaderDependencySnapshot {
     std::filesystem::path path;
     std::string source;
@@ -52,6 +63,23 @@ struct ShaderVariantCompileOutput {
     std::vector<std::filesystem::path> dependencies;
 };
 
+struct ShaderArtifactPackStats {
+    std::size_t entries {0};
+    // Loose artifact files folded into the archive.
+    std::size_t packed_files {0};
+    // Entries whose dependencies changed since they were compiled.
+    std::size_t dropped {0};
+    std::size_t bytes {0};
+};
+
+// Rebuilds the archive under `cache_root` from its valid entries and the loose
+// artifact files next to it, then removes the loose files. The archive is
+// memory-mapped by running ShaderVariantCompilers, so pack while none is open
+// on the same cache.
+Result<ShaderArtifactPackStats, std::string>
+pack_shader_artifacts(const std::filesystem::path& cache_root);
+
+// compile() runs on pipeline workers, possibly several variants at once.
 class ShaderCompiler {
   public:
     virtual ~ShaderCompiler() = default;
@@ -60,6 +88,8 @@ class ShaderCompiler {
     compile(ShaderCompileRequest request) = 0;
 };
 
+// Callable from several threads at once for distinct variants; each call
+// builds its own request and the artifact cache locks what it shares.
 class ShaderVariantCompiler {
   private:
     ShaderCompiler* m_compiler;
@@ -9,6 +9,7 @@
 #include "math/primitives.hpp"
 #include "math/vector.hpp"
 #include "rendering/components.hpp"
+#include "rendering/render_asset.hpp"
 
 #include <array>
 #include <cstddef>
@@ -81,10 +82,14 @@ struct RenderView {
 struct VisibleMeshEntities {
     std::vector<Entity> entities;
     std::unordered_set<Entity> entity_set;
+    // Level of detail picked for this view; absent entities draw level 0.
+    std::unordered_map<Entity, uint32> lods;
 
     void clear();
     void add(Entity entity);
     bool contains(Entity entity) const;
+    void set_lod(Entity entity, uint32 lod);
+    uint32 lod(Entity entity) const;
 };
 
 struct ViewVisibleEntities {
@@ -92,9 +97,16 @@ struct ViewVisibleEntities {
 
     void clear();
     VisibleMeshEntities& get_or_insert(const ViewId& view_id);
+    VisibleMeshEntities* get(const ViewId& view_id);
     const VisibleMeshEntities* get(const ViewId& view_id) const;
 };
 
+struct MeshLodSettings {
+    // Largest geometric error a level may show, as a share of the view
+    // height. The default is about a pixel at 1080p.
+    float error_threshold {0.001f};
+};
+
 Frustum extract_frustum(const Matrix4x4& clip_from_world);
 
 void check_mesh_visibility(
@@ -103,4 +115,24 @@ void check_mesh_visibility(
     ResRW<ViewVisibleEntities> visible_entities
 );
 
+// Coarsest level of `gpu_mesh` whose error, projected into `view` at the
+// near side of the mesh bounds, stays within `error_threshold`.
+uint32 select_mesh_lod(
+    const GpuMesh& gpu_mesh,
+    const RenderView& view,
+    const Aabb& local_aabb,
+    const Matrix4x4& world_from_local,
+    float error_threshold
+);
+
+// Picks a level of detail per visible mesh and view. Runs after
+// check_mesh_visibility so the queues can read the levels.
+void select_mesh_lods(
+    Query<Entity, const ViewUniformBuffer> query_views,
+    Query<Entity, const Mesh3d, const Transform3d, const Aabb> query_meshes,
+    ResRO<RenderAssets<GpuMesh>> gpu_meshes,
+    ResRO<MeshLodSettings> settings,
+    ResRW<ViewVisibleEntities> visible_entities
+);
+
 } // namespace fei
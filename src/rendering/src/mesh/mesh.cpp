@@ -1,5 +1,6 @@
 #include "rendering/mesh/mesh.hpp"
 
+#include "base/hash.hpp"
 #include "base/log.hpp"
 #include "base/optional.hpp"
 #include "graphics/enums.hpp"
@@ -8,15 +9,210 @@
 #include "math/primitives.hpp"
 #include "math/vector.hpp"
 #include "rendering/mesh/vertex.hpp"
+#include "task/parallel.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <limits>
 #include <mikktspace.h>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 namespace fei {
 
+namespace {
+
+// Work split for the CPU kernels below. Meshes smaller than one chunk run
+// inline on the calling thread.
+constexpr std::size_t vertex_chunk = 64 * 1024;
+constexpr std::size_t triangle_chunk = 16 * 1024;
+constexpr std::size_t smooth_normal_block = 256 * 1024;
+constexpr std::size_t tangent_face_chunk = 128 * 1024;
+
+// Faces around each vertex as MikkTSpace sees them. It welds vertices whose
+// position, normal and UV compare equal, whatever their index, and averages
+// a corner's tangent over every face around its welded vertex.
+struct WeldedFaces {
+    // Weld id of each vertex index.
+    std::vector<std::uint32_t> welds;
+    // Faces around weld `w` are faces[offsets[w]] to faces[offsets[w + 1]],
+    // in face order.
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> faces;
+};
+
+template<typename CornerIndex>
+WeldedFaces weld_faces(
+    const float* positions,
+    const float* normals,
+    const float* uvs,
+    std::size_t vertex_count,
+    std::size_t face_count,
+    CornerIndex&& corner_index
+) {
+    using Key = std::array<float, 8>;
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            return hash_value(key);
+        }
+    };
+
+    WeldedFaces welded;
+    welded.welds.resize(vertex_count);
+    std::unordered_map<Key, std::uint32_t, KeyHash> weld_ids;
+    weld_ids.reserve(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        const Key key {
+            positions[(v * 3) + 0],
+            positions[(v * 3) + 1],
+            positions[(v * 3) + 2],
+            normals[(v * 3) + 0],
+            normals[(v * 3) + 1],
+            normals[(v * 3) + 2],
+            uvs[(v * 2) + 0],
+            uvs[(v * 2) + 1],
+        };
+        welded.welds[v] =
+            weld_ids
+                .try_emplace(key, static_cast<std::uint32_t>(weld_ids.size()))
+                .first->second;
+    }
+
+    welded.offsets.assign(weld_ids.size() + 1, 0);
+    for (std::size_t corner = 0; corner < face_count * 3; ++corner) {
+        ++welded.offsets[welded.welds[corner_index(corner)] + 1];
+    }
+    for (std::size_t w = 1; w < welded.offsets.size(); ++w) {
+        welded.offsets[w] += welded.offsets[w - 1];
+    }
+    welded.faces.resize(face_count * 3);
+    auto cursor = welded.offsets;
+    for (std::size_t corner = 0; corner < face_count * 3; ++corner) {
+        welded.faces[cursor[welded.welds[corner_index(corner)]]++] =
+            static_cast<std::uint32_t>(corner / 3);
+    }
+    return welded;
+}
+
+struct PositionBounds {
+    std::array<float, 3> min;
+    std::array<float, 3> max;
+
+    void encapsulate(const std::array<float, 3>& pos) {
+        for (int i = 0; i < 3; i++) {
+            min[i] = std::min(min[i], pos[i]);
+            max[i] = std::max(max[i], pos[i]);
+        }
+    }
+};
+
+// Bounds of the positions the mesh references: the indexed ones when there
+// are indices. Returns nullopt for an out-of-range index.
+Optional<PositionBounds> position_bounds(
+    const std::vector<std::array<float, 3>>& positions,
+    const std::vector<std::uint32_t>* indices
+) {
+    const bool indexed = indices != nullptr && !indices->empty();
+    const std::size_t count = indexed ? indices->size() : positions.size();
+    std::vector<PositionBounds> chunk_bounds(
+        parallel_chunk_count(count, vertex_chunk),
+        PositionBounds {.min = positions[0], .max = positions[0]}
+    );
+    std::atomic<bool> out_of_range {false};
+    parallel_for(count, vertex_chunk, [&](std::size_t begin, std::size_t end) {
+        auto& bounds = chunk_bounds[begin / vertex_chunk];
+        if (!indexed) {
+            for (auto v = begin; v < end; ++v) {
+                bounds.encapsulate(positions[v]);
+            }
+            return;
+        }
+        for (auto i = begin; i < end; ++i) {
+            const auto index = (*indices)[i];
+            if (index >= positions.size()) {
+                out_of_range.store(true, std::memory_order_relaxed);
+                return;
+            }
+            bounds.encapsulate(positions[index]);
+        }
+    });
+    if (out_of_range.load()) {
+        return nullopt;
+    }
+    auto bounds = chunk_bounds.front();
+    for (const auto& chunk : chunk_bounds) {
+        bounds.encapsulate(chunk.min);
+        bounds.encapsulate(chunk.max);
+    }
+    return bounds;
+}
+
+// Face normal of one triangle weighted by the angle at each corner; zero for
+// degenerate triangles.
+std::array<Vector3, 3>
+weighted_corner_normals(Vector3 pa, Vector3 pb, Vector3 pc) {
+    auto ab = pb - pa;
+    auto ba = pa - pb;
+    auto bc = pc - pb;
+    auto cb = pb - pc;
+    auto ca = pc - pa;
+    auto ac = pa - pc;
+
+    constexpr auto epsilon = std::numeric_limits<float>::epsilon();
+    float weight_a = (ab.sqr_magnitude() * ac.sqr_magnitude() > epsilon) ?
+                         ab.angle(ac) :
+                         0.0f;
+    float weight_b = (ba.sqr_magnitude() * bc.sqr_magnitude() > epsilon) ?
+                         ba.angle(bc) :
+                         0.0f;
+    float weight_c = (ca.sqr_magnitude() * cb.sqr_magnitude() > epsilon) ?
+                         ca.angle(cb) :
+                         0.0f;
+
+    auto face_normal = ab.cross(ac);
+    if (face_normal.sqr_magnitude() <= epsilon) {
+        return {Vector3::Zero, Vector3::Zero, Vector3::Zero};
+    }
+    face_normal.normalize();
+    return {
+        face_normal * weight_a,
+        face_normal * weight_b,
+        face_normal * weight_c,
+    };
+}
+
+// Rotates the xyz part of each vector by the upper 3x3 of `rotation`; any
+// further components are left alone.
+template<std::size_t N>
+void rotate_vectors(
+    std::array<float, N>* vectors,
+    std::size_t count,
+    const Matrix4x4& rotation,
+    bool normalize
+) {
+    const auto& m = rotation.mat;
+    parallel_for(count, vertex_chunk, [&](std::size_t begin, std::size_t end) {
+        for (auto v = begin; v < end; ++v) {
+            auto& vec = vectors[v];
+            Vector3 rotated(
+                m[0][0] * vec[0] + m[0][1] * vec[1] + m[0][2] * vec[2],
+                m[1][0] * vec[0] + m[1][1] * vec[1] + m[1][2] * vec[2],
+                m[2][0] * vec[0] + m[2][1] * vec[1] + m[2][2] * vec[2]
+            );
+            if (normalize) {
+                rotated.normalize();
+            }
+            vec[0] = rotated.x;
+            vec[1] = rotated.y;
+            vec[2] = rotated.z;
+        }
+    });
+}
+
+} // namespace
+
 void Mesh::insert_attribute(
     MeshVertexAttribute attribute,
     VertexAttributeValues values
@@ -37,6 +233,10 @@ void Mesh::insert_attribute(
 }
 
 std::size_t Mesh::vertex_count() const {
+    if (m_packed) {
+        const auto stride = m_packed->layout.layout.stride;
+        return stride == 0 ? 0 : m_packed->vertices.size() / stride;
+    }
     Optional<std::size_t> count;
     for (const auto& [id, data] : m_attributes) {
         auto size = data.values.size();
@@ -73,54 +273,68 @@ void Mesh::compute_smooth_normals() {
     }
 
     const auto& positions = *positions_opt;
-    std::vector<Vector3> normals(positions.size(), Vector3::Zero);
     const auto& indices = m_indices.value();
-    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
-        std::uint32_t a = indices[i];
-        std::uint32_t b = indices[i + 1];
-        std::uint32_t c = indices[i + 2];
-        if (a >= positions.size() || b >= positions.size() ||
-            c >= positions.size()) {
+    const std::size_t triangle_count = indices.size() / 3;
+    std::vector<Vector3> normals(positions.size(), Vector3::Zero);
+
+    // Weighted corner normals are computed in parallel one block at a time
+    // and accumulated in triangle order, so the result matches a serial pass
+    // while the scratch buffer stays bounded.
+    std::vector<std::array<Vector3, 3>> corners(
+        std::min(triangle_count, smooth_normal_block)
+    );
+    for (std::size_t block = 0; block < triangle_count;
+         block += smooth_normal_block) {
+        const auto block_size =
+            std::min(smooth_normal_block, triangle_count - block);
+        std::atomic<bool> out_of_range {false};
+        parallel_for(
+            block_size,
+            triangle_chunk,
+            [&](std::size_t begin, std::size_t end) {
+                for (auto t = begin; t < end; ++t) {
+                    const auto* triangle = &indices[(block + t) * 3];
+                    if (triangle[0] >= positions.size() ||
+                        triangle[1] >= positions.size() ||
+                        triangle[2] >= positions.size()) {
+                        out_of_range.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                    corners[t] = weighted_corner_normals(
+                        Vector3(positions[triangle[0]]),
+                        Vector3(positions[triangle[1]]),
+                        Vector3(positions[triangle[2]])
+                    );
+                }
+            }
+        );
+        if (out_of_range.load()) {
             fei::warn("Mesh contains an out-of-range index");
             return;
         }
-
-        Vector3 pa(positions[a]), pb(positions[b]), pc(positions[c]);
-        auto ab = pb - pa;
-        auto ba = pa - pb;
-        auto bc = pc - pb;
-        auto cb = pb - pc;
-        auto ca = pc - pa;
-        auto ac = pa - pc;
-
-        constexpr auto epsilon = std::numeric_limits<float>::epsilon();
-        float weight_a = (ab.sqr_magnitude() * ac.sqr_magnitude() > epsilon) ?
-                             ab.angle(ac) :
-                             0.0f;
-        float weight_b = (ba.sqr_magnitude() * bc.sqr_magnitude() > epsilon) ?
-                             ba.angle(bc) :
-                             0.0f;
-        float weight_c = (ca.sqr_magnitude() * cb.sqr_magnitude() > epsilon) ?
-                             ca.angle(cb) :
-                             0.0f;
-
-        auto face_normal = ab.cross(ac);
-        if (face_normal.sqr_magnitude() <= epsilon) {
-            continue;
-        }
-        face_normal.normalize();
-        normals[a] += face_normal * weight_a;
-        normals[b] += face_normal * weight_b;
-        normals[c] += face_normal * weight_c;
-    }
-    std::vector<std::array<float, 3>> normalized_normals;
-    normalized_normals.reserve(normals.size());
-    for (auto normal : normals) {
-        if (normal.sqr_magnitude() > std::numeric_limits<float>::epsilon()) {
-            normal.normalize();
+        for (std::size_t t = 0; t < block_size; ++t) {
+            const auto* triangle = &indices[(block + t) * 3];
+            normals[triangle[0]] += corners[t][0];
+            normals[triangle[1]] += corners[t][1];
+            normals[triangle[2]] += corners[t][2];
         }
-        normalized_normals.push_back({normal.x, normal.y, normal.z});
     }
+
+    std::vector<std::array<float, 3>> normalized_normals(normals.size());
+    parallel_for(
+        normals.size(),
+        vertex_chunk,
+        [&](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                auto normal = normals[i];
+                if (normal.sqr_magnitude() >
+                    std::numeric_limits<float>::epsilon()) {
+                    normal.normalize();
+                }
+                normalized_normals[i] = {normal.x, normal.y, normal.z};
+            }
+        }
+    );
     insert_attribute(
         ATTRIBUTE_NORMAL,
         VertexAttributeValues(normalized_normals)
@@ -138,38 +352,28 @@ void Mesh::center_positions() {
         fei::warn("Mesh has no positions, cannot center");
         return;
     }
-    std::array<float, 3> min = positions[0];
-    std::array<float, 3> max = positions[0];
-    if (m_indices && !m_indices->empty()) {
-        for (auto index : m_indices.value()) {
-            if (index >= positions.size()) {
-                fei::warn("Mesh contains an out-of-range index");
-                return;
-            }
-            const auto& pos = positions[index];
-            for (int i = 0; i < 3; i++) {
-                min[i] = std::min(min[i], pos[i]);
-                max[i] = std::max(max[i], pos[i]);
-            }
-        }
-    } else {
-        for (const auto& pos : positions) {
-            for (int i = 0; i < 3; i++) {
-                min[i] = std::min(min[i], pos[i]);
-                max[i] = std::max(max[i], pos[i]);
-            }
-        }
+    auto bounds =
+        position_bounds(positions, m_indices ? &m_indices.value() : nullptr);
+    if (!bounds) {
+        fei::warn("Mesh contains an out-of-range index");
+        return;
     }
     std::array<float, 3> center = {
-        (min[0] + max[0]) / 2.0f,
-        (min[1] + max[1]) / 2.0f,
-        (min[2] + max[2]) / 2.0f,
+        (bounds->min[0] + bounds->max[0]) / 2.0f,
+        (bounds->min[1] + bounds->max[1]) / 2.0f,
+        (bounds->min[2] + bounds->max[2]) / 2.0f,
     };
-    for (auto& pos : positions) {
-        for (int i = 0; i < 3; i++) {
-            pos[i] -= center[i];
+    parallel_for(
+        positions.size(),
+        vertex_chunk,
+        [&](std::size_t begin, std::size_t end) {
+            for (auto v = begin; v < end; ++v) {
+                for (int i = 0; i < 3; i++) {
+                    positions[v][i] -= center[i];
+                }
+            }
         }
-    }
+    );
 }
 
 void Mesh::generate_tangents() {
@@ -203,21 +407,61 @@ void Mesh::generate_tangents() {
         m_indices ? &m_indices.value() : nullptr;
     const std::size_t face_count =
         (indices != nullptr) ? indices->size() / 3 : v_count / 3;
+    auto corner_index = [indices](std::size_t corner) {
+        return indices ? (*indices)[corner] :
+                         static_cast<std::uint32_t>(corner);
+    };
+
+    // Large meshes run one MikkTSpace pass per chunk of faces. Each pass also
+    // sees every face sharing a welded vertex with the chunk, in face order,
+    // so corner tangents average over the same faces as a single pass would.
+    // Only corners of the chunk's own faces are written, and a vertex shared
+    // between chunks takes its tangent from the chunk of the last face using
+    // it, matching the last write of a single pass.
+    const std::size_t chunk_count =
+        parallel_chunk_count(face_count, tangent_face_chunk);
+    std::vector<std::uint32_t> owners;
+    WeldedFaces welded;
+    if (chunk_count > 1) {
+        owners.resize(v_count);
+        for (std::size_t corner = 0; corner < face_count * 3; ++corner) {
+            owners[corner_index(corner)] =
+                static_cast<std::uint32_t>(corner / 3 / tangent_face_chunk);
+        }
+        welded = weld_faces(
+            positions,
+            normals,
+            uvs,
+            v_count,
+            face_count,
+            corner_index
+        );
+    }
 
     struct UserData {
         const float* positions;
         const float* normals;
         const float* uvs;
         const std::vector<std::uint32_t>* indices;
+        // Global face of each face MikkTSpace sees, or null for all of them.
+        const std::vector<std::uint32_t>* faces;
         std::size_t face_count;
+        // Faces [own_begin, own_end) belong to the chunk.
+        std::size_t own_begin;
+        std::size_t own_end;
+        const std::vector<std::uint32_t>* owners;
+        std::uint32_t chunk;
         std::vector<std::array<float, 4>>* tangents;
-    } user_data {
-        .positions = positions,
-        .normals = normals,
-        .uvs = uvs,
-        .indices = indices,
-        .face_count = face_count,
-        .tangents = &tangents
+
+        std::size_t global_face(int face) const {
+            return faces ? (*faces)[face] : static_cast<std::size_t>(face);
+        }
+
+        std::uint32_t index(int face, int vert) const {
+            const std::size_t corner = (global_face(face) * 3) + vert;
+            return indices ? (*indices)[corner] :
+                             static_cast<std::uint32_t>(corner);
+        }
     };
 
     SMikkTSpaceInterface iface {};
@@ -235,9 +479,7 @@ void Mesh::generate_tangents() {
                              const int face,
                              const int vert) {
         const auto* d = static_cast<const UserData*>(ctx->m_pUserData);
-        const std::uint32_t idx =
-            d->indices ? (*d->indices)[(face * 3) + vert] :
-                         static_cast<std::uint32_t>((face * 3) + vert);
+        const std::uint32_t idx = d->index(face, vert);
         pos[0] = d->positions[(idx * 3) + 0];
         pos[1] = d->positions[(idx * 3) + 1];
         pos[2] = d->positions[(idx * 3) + 2];
@@ -247,9 +489,7 @@ void Mesh::generate_tangents() {
                            const int face,
                            const int vert) {
         const auto* d = static_cast<const UserData*>(ctx->m_pUserData);
-        const std::uint32_t idx =
-            d->indices ? (*d->indices)[(face * 3) + vert] :
-                         static_cast<std::uint32_t>((face * 3) + vert);
+        const std::uint32_t idx = d->index(face, vert);
         norm[0] = d->normals[(idx * 3) + 0];
         norm[1] = d->normals[(idx * 3) + 1];
         norm[2] = d->normals[(idx * 3) + 2];
@@ -259,9 +499,7 @@ void Mesh::generate_tangents() {
                              const int face,
                              const int vert) {
         const auto* d = static_cast<const UserData*>(ctx->m_pUserData);
-        const std::uint32_t idx =
-            d->indices ? (*d->indices)[(face * 3) + vert] :
-                         static_cast<std::uint32_t>((face * 3) + vert);
+        const std::uint32_t idx = d->index(face, vert);
         uv[0] = d->uvs[(idx * 2) + 0];
         uv[1] = d->uvs[(idx * 2) + 1];
     };
@@ -271,17 +509,90 @@ void Mesh::generate_tangents() {
                                 const int face,
                                 const int vert) {
         auto* d = static_cast<UserData*>(ctx->m_pUserData);
-        const std::uint32_t idx =
-            d->indices ? (*d->indices)[(face * 3) + vert] :
-                         static_cast<std::uint32_t>((face * 3) + vert);
+        const auto global_face = d->global_face(face);
+        if (global_face < d->own_begin || global_face >= d->own_end) {
+            return;
+        }
+        const std::uint32_t idx = d->index(face, vert);
+        if (d->owners && (*d->owners)[idx] != d->chunk) {
+            return;
+        }
         (*d->tangents)[idx] =
             {fv_tangent[0], fv_tangent[1], fv_tangent[2], f_sign};
     };
 
-    SMikkTSpaceContext ctx {};
-    ctx.m_pInterface = &iface;
-    ctx.m_pUserData = &user_data;
-    genTangSpaceDefault(&ctx);
+    auto run = [&](UserData& user_data) {
+        SMikkTSpaceContext ctx {};
+        ctx.m_pInterface = &iface;
+        ctx.m_pUserData = &user_data;
+        genTangSpaceDefault(&ctx);
+    };
+
+    if (chunk_count <= 1) {
+        UserData user_data {
+            .positions = positions,
+            .normals = normals,
+            .uvs = uvs,
+            .indices = indices,
+            .faces = nullptr,
+            .face_count = face_count,
+            .own_begin = 0,
+            .own_end = face_count,
+            .owners = nullptr,
+            .chunk = 0,
+            .tangents = &tangents,
+        };
+        run(user_data);
+    } else {
+        parallel_for(chunk_count, 1, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::uint32_t> halo;
+            std::vector<std::uint32_t> faces;
+            for (auto chunk = begin; chunk < end; ++chunk) {
+                const auto own_begin = chunk * tangent_face_chunk;
+                const auto own_end =
+                    std::min(own_begin + tangent_face_chunk, face_count);
+
+                halo.clear();
+                for (auto corner = own_begin * 3; corner < own_end * 3;
+                     ++corner) {
+                    const auto weld = welded.welds[corner_index(corner)];
+                    for (auto i = welded.offsets[weld];
+                         i < welded.offsets[weld + 1];
+                         ++i) {
+                        const auto face = welded.faces[i];
+                        if (face < own_begin || face >= own_end) {
+                            halo.push_back(face);
+                        }
+                    }
+                }
+                std::ranges::sort(halo);
+                halo.erase(std::ranges::unique(halo).begin(), halo.end());
+
+                // Own faces sit between the halo faces before and after them.
+                const auto split = std::ranges::lower_bound(halo, own_begin);
+                faces.assign(halo.begin(), split);
+                for (auto face = own_begin; face < own_end; ++face) {
+                    faces.push_back(static_cast<std::uint32_t>(face));
+                }
+                faces.insert(faces.end(), split, halo.end());
+
+                UserData user_data {
+                    .positions = positions,
+                    .normals = normals,
+                    .uvs = uvs,
+                    .indices = indices,
+                    .faces = &faces,
+                    .face_count = faces.size(),
+                    .own_begin = own_begin,
+                    .own_end = own_end,
+                    .owners = &owners,
+                    .chunk = static_cast<std::uint32_t>(chunk),
+                    .tangents = &tangents,
+                };
+                run(user_data);
+            }
+        });
+    }
 
     insert_attribute(
         ATTRIBUTE_TANGENT,
@@ -290,6 +601,9 @@ void Mesh::generate_tangents() {
 }
 
 Aabb Mesh::compute_aabb() const {
+    if (m_packed) {
+        return m_packed->aabb;
+    }
     if (!has_attribute(ATTRIBUTE_POSITION.id)) {
         fei::warn("Mesh has no position attribute, cannot compute AABB");
         return {};
@@ -300,31 +614,15 @@ Aabb Mesh::compute_aabb() const {
         fei::warn("Mesh has no positions, cannot compute AABB");
         return {};
     }
-    std::array<float, 3> min = positions[0];
-    std::array<float, 3> max = positions[0];
-    if (m_indices && !m_indices->empty()) {
-        for (auto index : m_indices.value()) {
-            if (index >= positions.size()) {
-                fei::warn("Mesh contains an out-of-range index");
-                return {};
-            }
-            const auto& pos = positions[index];
-            for (int i = 0; i < 3; i++) {
-                min[i] = std::min(min[i], pos[i]);
-                max[i] = std::max(max[i], pos[i]);
-            }
-        }
-    } else {
-        for (const auto& pos : positions) {
-            for (int i = 0; i < 3; i++) {
-                min[i] = std::min(min[i], pos[i]);
-                max[i] = std::max(max[i], pos[i]);
-            }
-        }
+    auto bounds =
+        position_bounds(positions, m_indices ? &m_indices.value() : nullptr);
+    if (!bounds) {
+        fei::warn("Mesh contains an out-of-range index");
+        return {};
     }
     return Aabb {
-        .min = {min[0], min[1], min[2]},
-        .max = {max[0], max[1], max[2]}
+        .min = {bounds->min[0], bounds->min[1], bounds->min[2]},
+        .max = {bounds->max[0], bounds->max[1], bounds->max[2]}
     };
 }
 
@@ -335,11 +633,17 @@ void Mesh::scale_by(Vector3 scale) {
     }
     auto& positions =
         m_attributes.at(ATTRIBUTE_POSITION.id).values.as_float3().value();
-    for (auto& pos : positions) {
-        pos[0] *= scale.x;
-        pos[1] *= scale.y;
-        pos[2] *= scale.z;
-    }
+    parallel_for(
+        positions.size(),
+        vertex_chunk,
+        [&](std::size_t begin, std::size_t end) {
+            for (auto v = begin; v < end; ++v) {
+                positions[v][0] *= scale.x;
+                positions[v][1] *= scale.y;
+                positions[v][2] *= scale.z;
+            }
+        }
+    );
 
     if (scale.x != scale.y || scale.y != scale.z) {
         fei::fatal("Non-uniform scaling is not yet supported");
@@ -360,47 +664,28 @@ void Mesh::rotate_by(Vector3 euler_angles) {
     {
         auto& positions =
             m_attributes.at(ATTRIBUTE_POSITION.id).values.as_float3().value();
-        for (auto& pos : positions) {
-            Vector4 p(pos[0], pos[1], pos[2], 1.0f);
-            p = rotation * p;
-            pos[0] = p.x;
-            pos[1] = p.y;
-            pos[2] = p.z;
-        }
+        rotate_vectors(positions.data(), positions.size(), rotation, false);
     }
 
     // Normals
     if (has_attribute(ATTRIBUTE_NORMAL.id)) {
         auto& normals =
             m_attributes.at(ATTRIBUTE_NORMAL.id).values.as_float3().value();
-        for (auto& norm : normals) {
-            Vector4 n(norm[0], norm[1], norm[2], 0.0f);
-            n = rotation * n;
-            Vector3 n3(n.x, n.y, n.z);
-            n3.normalize();
-            norm[0] = n3.x;
-            norm[1] = n3.y;
-            norm[2] = n3.z;
-        }
+        rotate_vectors(normals.data(), normals.size(), rotation, true);
     }
 
-    // Tangents
+    // Tangents keep their handedness in w.
     if (has_attribute(ATTRIBUTE_TANGENT.id)) {
         auto& tangents =
             m_attributes.at(ATTRIBUTE_TANGENT.id).values.as_float4().value();
-        for (auto& tan : tangents) {
-            Vector4 t(tan[0], tan[1], tan[2], 0.0f);
-            t = rotation * t;
-            Vector3 t3(t.x, t.y, t.z);
-            t3.normalize();
-            tan[0] = t3.x;
-            tan[1] = t3.y;
-            tan[2] = t3.z;
-        }
+        rotate_vectors(tangents.data(), tangents.size(), rotation, true);
     }
 }
 
 std::uint64_t Mesh::vertex_size() const {
+    if (m_packed) {
+        return m_packed->layout.layout.stride;
+    }
     std::uint64_t size = 0;
     for (const auto& [id, data] : m_attributes) {
         size += vertex_format_size(data.attribute.format);
@@ -414,6 +699,14 @@ std::size_t Mesh::vertex_buffer_size() const {
 
 std::unique_ptr<std::byte[]> Mesh::vertex_buffer_data() const {
     auto buffer = std::make_unique<std::byte[]>(vertex_buffer_size());
+    if (m_packed) {
+        std::memcpy(
+            buffer.get(),
+            m_packed->vertices.data(),
+            vertex_buffer_size()
+        );
+        return buffer;
+    }
     std::size_t v_count = vertex_count();
     std::uint64_t vertex_stride = vertex_size();
 
@@ -443,6 +736,9 @@ std::unique_ptr<std::byte[]> Mesh::vertex_buffer_data() const {
 }
 
 MeshVertexBufferLayout Mesh::vertex_buffer_layout() const {
+    if (m_packed) {
+        return m_packed->layout;
+    }
     std::vector<MeshVertexAttributeId> attribute_ids;
     std::vector<VertexAttributeDescription> attributes;
     std::uint64_t offset = 0;
@@ -466,26 +762,71 @@ MeshVertexBufferLayout Mesh::vertex_buffer_layout() const {
 }
 
 std::size_t Mesh::index_buffer_size() const {
+    if (m_packed) {
+        return m_packed->indices.size();
+    }
     if (!m_indices) {
         return 0;
     }
-    using IndexType = decltype(m_indices->at(0));
-    return m_indices->size() * sizeof(IndexType);
+    std::size_t count = m_indices->size();
+    for (const auto& lod : m_lods) {
+        count += lod.indices.size();
+    }
+    return count * sizeof(std::uint32_t);
 }
 
 std::unique_ptr<std::byte[]> Mesh::index_buffer_data() const {
+    if (m_packed) {
+        if (m_packed->indices.empty()) {
+            return nullptr;
+        }
+        auto buffer = std::make_unique<std::byte[]>(m_packed->indices.size());
+        std::memcpy(
+            buffer.get(),
+            m_packed->indices.data(),
+            m_packed->indices.size()
+        );
+        return buffer;
+    }
     if (!m_indices) {
         return nullptr;
     }
-    using IndexType = decltype(m_indices->at(0));
-    auto buffer =
-        std::make_unique<std::byte[]>(m_indices->size() * sizeof(IndexType));
-    std::memcpy(
-        buffer.get(),
-        m_indices->data(),
-        m_indices->size() * sizeof(IndexType)
-    );
+    auto buffer = std::make_unique<std::byte[]>(index_buffer_size());
+    auto* out = buffer.get();
+    const auto append = [&out](const std::vector<std::uint32_t>& indices) {
+        const auto size = indices.size() * sizeof(std::uint32_t);
+        std::memcpy(out, indices.data(), size);
+        out += size;
+    };
+    append(*m_indices);
+    for (const auto& lod : m_lods) {
+        append(lod.indices);
+    }
     return buffer;
 }
 
+std::vector<MeshLodRange> Mesh::lod_ranges() const {
+    if (m_packed) {
+        return m_packed->lods;
+    }
+    if (!m_indices || m_lods.empty()) {
+        return {};
+    }
+    std::vector<MeshLodRange> ranges;
+    ranges.reserve(m_lods.size() + 1);
+    ranges.push_back({
+        .first_index = 0,
+        .index_count = static_cast<uint32>(m_indices->size()),
+    });
+    for (const auto& lod : m_lods) {
+        const auto& previous = ranges.back();
+        ranges.push_back({
+            .first_index = previous.first_index + previous.index_count,
+            .index_count = static_cast<uint32>(lod.indices.size()),
+            .error = lod.error,
+        });
+    }
+    return ranges;
+}
+
 } // namespace fei
@@ -15,6 +15,10 @@ void compute_mesh_aabb(
         if (!mesh) {
             continue;
         }
+        if (mesh->packed()) {
+            commands.entity(entity).add(mesh->compute_aabb());
+            continue;
+        }
         auto positions =
             mesh->get_attribute(Mesh::ATTRIBUTE_POSITION.id).as_float3();
         if (!positions) {
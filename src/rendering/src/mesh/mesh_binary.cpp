@@ -0,0 +1,291 @@
+#include "rendering/mesh/mesh_binary.hpp"
+
+#include "graphics/enums.hpp"
+#include "graphics/pipeline.hpp"
+#include "math/primitives.hpp"
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace fei {
+
+namespace {
+
+constexpr std::array<char, 4> mesh_binary_magic {'F', 'M', 'S', 'H'};
+constexpr std::size_t stream_alignment = 16;
+
+struct MeshBinaryHeader {
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t primitive;
+    std::uint32_t attribute_count;
+    std::uint32_t vertex_stride;
+    std::uint32_t vertex_count;
+    std::uint32_t index_count;
+    // Always 0 in version 1 files.
+    std::uint32_t lod_count;
+    std::array<float, 3> aabb_min;
+    std::array<float, 3> aabb_max;
+    std::uint64_t vertex_offset;
+    std::uint64_t index_offset;
+};
+static_assert(std::is_trivially_copyable_v<MeshBinaryHeader>);
+static_assert(sizeof(MeshBinaryHeader) == 72);
+
+struct MeshBinaryAttribute {
+    std::uint32_t id;
+    std::uint32_t format;
+    std::uint32_t offset;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(MeshBinaryAttribute) == 16);
+
+struct MeshBinaryLod {
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+    float error;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(MeshBinaryLod) == 16);
+
+std::size_t align_stream(std::size_t offset) {
+    return (offset + stream_alignment - 1) & ~(stream_alignment - 1);
+}
+
+template<typename T>
+void append(std::vector<std::byte>& bytes, const T& value) {
+    const auto* data = reinterpret_cast<const std::byte*>(&value);
+    bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+template<typename T>
+T read_at(std::span<const std::byte> bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+bool is_mesh_binary(std::span<const std::byte> bytes) {
+    return bytes.size() >= mesh_binary_magic.size() &&
+           std::memcmp(
+               bytes.data(),
+               mesh_binary_magic.data(),
+               mesh_binary_magic.size()
+           ) == 0;
+}
+
+Result<std::vector<std::byte>, std::string>
+encode_mesh_binary(const Mesh& mesh) {
+    const auto layout = mesh.vertex_buffer_layout();
+    const auto vertex_count = mesh.vertex_count();
+    if (vertex_count == 0 || layout.layout.stride == 0) {
+        return failure(std::string("Mesh has no vertices"));
+    }
+    if (mesh.index_buffer_size() % sizeof(std::uint32_t) != 0) {
+        return failure(std::string("Mesh indices are not uint32"));
+    }
+
+    const auto lods = mesh.lod_ranges();
+    const auto tables_size =
+        (layout.layout.attributes.size() * sizeof(MeshBinaryAttribute)) +
+        (lods.size() * sizeof(MeshBinaryLod));
+    const auto vertex_offset =
+        align_stream(sizeof(MeshBinaryHeader) + tables_size);
+    const auto vertex_size = mesh.vertex_buffer_size();
+    const auto index_offset = align_stream(vertex_offset + vertex_size);
+    const auto index_size = mesh.index_buffer_size();
+
+    const auto aabb = mesh.compute_aabb();
+    MeshBinaryHeader header {
+        .magic = mesh_binary_magic,
+        .version = MeshBinaryVersion,
+        .primitive = static_cast<std::uint32_t>(mesh.primitive()),
+        .attribute_count =
+            static_cast<std::uint32_t>(layout.layout.attributes.size()),
+        .vertex_stride = static_cast<std::uint32_t>(layout.layout.stride),
+        .vertex_count = static_cast<std::uint32_t>(vertex_count),
+        .index_count =
+            static_cast<std::uint32_t>(index_size / sizeof(std::uint32_t)),
+        .lod_count = static_cast<std::uint32_t>(lods.size()),
+        .aabb_min = {aabb.min.x, aabb.min.y, aabb.min.z},
+        .aabb_max = {aabb.max.x, aabb.max.y, aabb.max.z},
+        .vertex_offset = vertex_offset,
+        .index_offset = index_offset,
+    };
+
+    std::vector<std::byte> bytes;
+    bytes.reserve(index_offset + index_size);
+    append(bytes, header);
+    for (const auto& attribute : layout.layout.attributes) {
+        append(
+            bytes,
+            MeshBinaryAttribute {
+                .id = static_cast<std::uint32_t>(attribute.location),
+                .format = static_cast<std::uint32_t>(attribute.format),
+                .offset = static_cast<std::uint32_t>(attribute.offset),
+                .reserved = 0,
+            }
+        );
+    }
+    for (const auto& lod : lods) {
+        append(
+            bytes,
+            MeshBinaryLod {
+                .first_index = lod.first_index,
+                .index_count = lod.index_count,
+                .error = lod.error,
+                .reserved = 0,
+            }
+        );
+    }
+
+    bytes.resize(vertex_offset);
+    const auto vertex_data = mesh.vertex_buffer_data();
+    bytes.insert(
+        bytes.end(),
+        vertex_data.get(),
+        vertex_data.get() + vertex_size
+    );
+    bytes.resize(index_offset);
+    if (const auto index_data = mesh.index_buffer_data()) {
+        bytes.insert(
+            bytes.end(),
+            index_data.get(),
+            index_data.get() + index_size
+        );
+    }
+    return bytes;
+}
+
+Result<Mesh, std::string> decode_mesh_binary(const Reader& reader) {
+    auto owner = std::make_shared<const Reader>(reader);
+    const auto bytes = owner->bytes();
+    if (bytes.size() < sizeof(MeshBinaryHeader) || !is_mesh_binary(bytes)) {
+        return failure(std::string("Not a mesh binary"));
+    }
+    const auto header = read_at<MeshBinaryHeader>(bytes, 0);
+    if (header.version == 0 || header.version > MeshBinaryVersion) {
+        return failure(
+            "Unsupported mesh binary version " + std::to_string(header.version)
+        );
+    }
+    if (header.primitive >
+        static_cast<std::uint32_t>(RenderPrimitive::TrianglesStrip)) {
+        return failure(std::string("Mesh binary has an invalid primitive"));
+    }
+    if (header.vertex_stride == 0) {
+        return failure(std::string("Mesh binary has a zero vertex stride"));
+    }
+
+    const std::size_t attributes_end =
+        sizeof(MeshBinaryHeader) +
+        std::size_t {header.attribute_count} * sizeof(MeshBinaryAttribute);
+    const std::size_t lods_end =
+        attributes_end +
+        std::size_t {header.lod_count} * sizeof(MeshBinaryLod);
+    const std::size_t vertex_size =
+        std::size_t {header.vertex_count} * header.vertex_stride;
+    const std::size_t index_size =
+        std::size_t {header.index_count} * sizeof(std::uint32_t);
+    if (lods_end > bytes.size() || header.vertex_offset < lods_end ||
+        header.vertex_offset > bytes.size() ||
+        vertex_size > bytes.size() - header.vertex_offset ||
+        header.index_offset > bytes.size() ||
+        index_size > bytes.size() - header.index_offset) {
+        return failure(std::string("Mesh binary is truncated"));
+    }
+
+    std::vector<MeshVertexAttributeId> attribute_ids;
+    std::vector<VertexAttributeDescription> attributes;
+    attribute_ids.reserve(header.attribute_count);
+    attributes.reserve(header.attribute_count);
+    for (std::uint32_t i = 0; i < header.attribute_count; ++i) {
+        const auto attribute = read_at<MeshBinaryAttribute>(
+            bytes,
+            sizeof(MeshBinaryHeader) + i * sizeof(MeshBinaryAttribute)
+        );
+        if (attribute.format >
+            static_cast<std::uint32_t>(VertexFormat::UByte4)) {
+            return failure(std::string("Mesh binary has an invalid format"));
+        }
+        const auto format = static_cast<VertexFormat>(attribute.format);
+        if (attribute.offset + vertex_format_size(format) >
+            header.vertex_stride) {
+            return failure(
+                std::string("Mesh binary attribute exceeds the vertex stride")
+            );
+        }
+        attribute_ids.push_back(attribute.id);
+        attributes.push_back({
+            .location = attribute.id,
+            .offset = attribute.offset,
+            .format = format,
+        });
+    }
+
+    std::vector<MeshLodRange> lods;
+    lods.reserve(header.lod_count);
+    for (std::uint32_t i = 0; i < header.lod_count; ++i) {
+        const auto lod = read_at<MeshBinaryLod>(
+            bytes,
+            attributes_end + i * sizeof(MeshBinaryLod)
+        );
+        if (std::uint64_t {lod.first_index} + lod.index_count >
+            header.index_count) {
+            return failure(
+                std::string("Mesh binary LOD exceeds the index stream")
+            );
+        }
+        lods.push_back({
+            .first_index = lod.first_index,
+            .index_count = lod.index_count,
+            .error = lod.error,
+        });
+    }
+
+    const auto indices = bytes.subspan(header.index_offset, index_size);
+    for (std::size_t i = 0; i < header.index_count; ++i) {
+        if (read_at<std::uint32_t>(indices, i * sizeof(std::uint32_t)) >=
+            header.vertex_count) {
+            return failure(
+                std::string("Mesh binary contains an out-of-range index")
+            );
+        }
+    }
+
+    PackedMeshData packed {
+        .owner = owner,
+        .layout =
+            MeshVertexBufferLayout {
+                .attribute_ids = std::move(attribute_ids),
+                .layout = VertexBufferLayout(
+                    header.vertex_stride,
+                    VertexStepMode::Vertex,
+                    std::move(attributes)
+                ),
+            },
+        .vertices = bytes.subspan(header.vertex_offset, vertex_size),
+        .indices = indices,
+        .aabb =
+            Aabb {
+                .min = {header.aabb_min[0],
+                        header.aabb_min[1],
+                        header.aabb_min[2]},
+                .max = {header.aabb_max[0],
+                        header.aabb_max[1],
+                        header.aabb_max[2]},
+            },
+        .lods = std::move(lods),
+    };
+    return Mesh(
+        static_cast<RenderPrimitive>(header.primitive),
+        std::move(packed)
+    );
+}
+
+} // namespace fei
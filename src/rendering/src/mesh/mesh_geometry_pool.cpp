@@ -0,0 +1,449 @@
+#include "rendering/mesh/mesh_geometry_pool.hpp"
+
+#include "base/log.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace fei {
+
+RangeAllocator::RangeAllocator(std::size_t capacity) : m_capacity(capacity) {
+    if (capacity > 0) {
+        m_free.emplace(0, capacity);
+    }
+}
+
+Optional<std::size_t> RangeAllocator::allocate(std::size_t size) {
+    if (size == 0) {
+        return nullopt;
+    }
+    for (auto range = m_free.begin(); range != m_free.end(); ++range) {
+        if (range->second < size) {
+            continue;
+        }
+        const auto offset = range->first;
+        const auto remaining = range->second - size;
+        m_free.erase(range);
+        if (remaining > 0) {
+            m_free.emplace(offset + size, remaining);
+        }
+        m_used += size;
+        return offset;
+    }
+    return nullopt;
+}
+
+void RangeAllocator::release(std::size_t offset, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    m_used -= size;
+
+    auto next = m_free.lower_bound(offset);
+    if (next != m_free.end() && offset + size == next->first) {
+        size += next->second;
+        next = m_free.erase(next);
+    }
+    if (next != m_free.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    m_free.emplace_hint(next, offset, size);
+}
+
+std::size_t RangeAllocator::largest_free_range() const {
+    std::size_t largest = 0;
+    for (const auto& [offset, size] : m_free) {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
+
+struct MeshGeometrySlab {
+    std::shared_ptr<Buffer> buffer;
+    RangeAllocator allocator;
+    uint32 element_size {0};
+    std::unordered_set<MeshGeometry*> residents;
+    // Elements released by geometry but not yet safe to reuse.
+    std::size_t retired_elements {0};
+    bool evacuating {false};
+
+    std::size_t live_elements() const {
+        return allocator.used() - retired_elements;
+    }
+};
+
+namespace {
+
+struct MeshGeometryArena {
+    BufferUsages usage {BufferUsages::Vertex};
+    uint32 element_size {0};
+    std::vector<std::unique_ptr<MeshGeometrySlab>> slabs;
+};
+
+struct SlabRange {
+    MeshGeometrySlab* slab {nullptr};
+    std::size_t offset {0};
+};
+
+struct RetiredRange {
+    MeshGeometrySlab* slab {nullptr};
+    std::size_t offset {0};
+    std::size_t count {0};
+    std::uint64_t frame {0};
+};
+
+std::size_t vertex_arena_key(std::size_t layout_hash, uint32 stride) {
+    return layout_hash ^ (static_cast<std::size_t>(stride) + 0x9e3779b9 +
+                          (layout_hash << 6) + (layout_hash >> 2));
+}
+
+} // namespace
+
+struct MeshGeometryPoolState {
+    std::mutex mutex;
+    MeshGeometryPoolConfig config;
+    std::unordered_map<std::size_t, MeshGeometryArena> vertex_arenas;
+    MeshGeometryArena index_arena {
+        .usage = BufferUsages::Index,
+        .element_size = sizeof(std::uint32_t),
+    };
+    std::vector<RetiredRange> retired;
+    std::uint64_t frame {0};
+    std::size_t geometries {0};
+    std::uint64_t moved_bytes {0};
+    std::uint64_t released_slabs {0};
+
+    Optional<SlabRange> allocate(
+        const GraphicsDevice* device,
+        MeshGeometryArena& arena,
+        std::size_t count,
+        std::size_t slab_bytes
+    ) {
+        for (auto& slab : arena.slabs) {
+            if (slab->evacuating) {
+                continue;
+            }
+            if (auto offset = slab->allocator.allocate(count)) {
+                return SlabRange {.slab = slab.get(), .offset = *offset};
+            }
+        }
+        if (!device) {
+            return nullopt;
+        }
+
+        const auto elements =
+            std::max(slab_bytes / arena.element_size, count);
+        auto buffer = device->create_buffer(
+            BufferDescription {
+                .size = elements * arena.element_size,
+                .usages = arena.usage,
+            }
+        );
+        if (!buffer) {
+            return nullopt;
+        }
+        auto& slab = arena.slabs.emplace_back(
+            std::make_unique<MeshGeometrySlab>(MeshGeometrySlab {
+                .buffer = std::move(buffer),
+                .allocator = RangeAllocator(elements),
+                .element_size = arena.element_size,
+            })
+        );
+        return SlabRange {
+            .slab = slab.get(),
+            .offset = *slab->allocator.allocate(count),
+        };
+    }
+
+    void retire(MeshGeometrySlab* slab, std::size_t offset, std::size_t count) {
+        slab->retired_elements += count;
+        retired.push_back(
+            RetiredRange {
+                .slab = slab,
+                .offset = offset,
+                .count = count,
+                .frame = frame,
+            }
+        );
+    }
+
+    void release(MeshGeometry& geometry) {
+        std::scoped_lock lock(mutex);
+        if (auto* slab = geometry.m_vertex_slab) {
+            slab->residents.erase(&geometry);
+            retire(slab, geometry.m_base_vertex, geometry.m_vertex_count);
+        }
+        if (auto* slab = geometry.m_index_slab) {
+            slab->residents.erase(&geometry);
+            retire(slab, geometry.m_first_index, geometry.m_index_count);
+        }
+        --geometries;
+    }
+
+    void reclaim_retired(std::uint64_t frames_in_flight) {
+        std::erase_if(retired, [&](const RetiredRange& range) {
+            if (frame - range.frame <= frames_in_flight) {
+                return false;
+            }
+            range.slab->allocator.release(range.offset, range.count);
+            range.slab->retired_elements -= range.count;
+            return true;
+        });
+    }
+
+    // Moves the geometry of the sparsest slab into its siblings, without
+    // creating slabs, until `budget` bytes have been copied. The first move
+    // of a maintain() call may exceed the budget, so a resident larger than
+    // the whole budget still moves instead of pinning its slab forever.
+    void evacuate(
+        const GraphicsDevice& device,
+        MeshGeometryArena& arena,
+        bool index_arena,
+        std::size_t& budget
+    ) {
+        if (arena.slabs.size() < 2 || budget == 0) {
+            return;
+        }
+
+        MeshGeometrySlab* sparsest = nullptr;
+        double sparsest_fill = 1.0;
+        for (auto& slab : arena.slabs) {
+            if (slab->residents.empty()) {
+                continue;
+            }
+            const auto fill = static_cast<double>(slab->live_elements()) /
+                              static_cast<double>(slab->allocator.capacity());
+            if (slab->evacuating || fill < sparsest_fill) {
+                sparsest = slab.get();
+                sparsest_fill = slab->evacuating ? 0.0 : fill;
+            }
+        }
+        if (!sparsest ||
+            (!sparsest->evacuating &&
+             sparsest_fill >= config.defragment_threshold)) {
+            return;
+        }
+
+        sparsest->evacuating = true;
+        const std::vector<MeshGeometry*> residents(
+            sparsest->residents.begin(),
+            sparsest->residents.end()
+        );
+        for (auto* geometry : residents) {
+            auto& first = index_arena ? geometry->m_first_index :
+                                        geometry->m_base_vertex;
+            const auto count = index_arena ? geometry->m_index_count :
+                                             geometry->m_vertex_count;
+            const auto bytes =
+                static_cast<std::size_t>(count) * arena.element_size;
+            if (bytes > budget &&
+                budget < config.defragment_budget_bytes) {
+                return;
+            }
+
+            auto target = allocate(nullptr, arena, count, 0);
+            if (!target) {
+                // The siblings are full; keep the slab until space frees up.
+                sparsest->evacuating = false;
+                return;
+            }
+
+            device.copy_buffer(
+                sparsest->buffer,
+                first * arena.element_size,
+                target->slab->buffer,
+                static_cast<uint32>(target->offset * arena.element_size),
+                static_cast<uint32>(bytes)
+            );
+            retire(sparsest, first, count);
+            sparsest->residents.erase(geometry);
+            target->slab->residents.insert(geometry);
+            first = static_cast<uint32>(target->offset);
+            if (index_arena) {
+                geometry->m_index_slab = target->slab;
+                geometry->m_index_buffer = target->slab->buffer;
+            } else {
+                geometry->m_vertex_slab = target->slab;
+                geometry->m_vertex_buffer = target->slab->buffer;
+            }
+            budget -= std::min(bytes, budget);
+            moved_bytes += bytes;
+        }
+    }
+
+    void release_empty_slabs(MeshGeometryArena& arena) {
+        released_slabs += std::erase_if(arena.slabs, [](const auto& slab) {
+            return slab->allocator.used() == 0;
+        });
+    }
+};
+
+MeshGeometry::MeshGeometry(
+    std::shared_ptr<Buffer> vertex_buffer,
+    std::shared_ptr<Buffer> index_buffer,
+    uint32 vertex_count,
+    uint32 index_count
+) :
+    m_vertex_buffer(std::move(vertex_buffer)),
+    m_index_buffer(std::move(index_buffer)), m_vertex_count(vertex_count),
+    m_index_count(index_count) {}
+
+MeshGeometry::~MeshGeometry() {
+    if (auto pool = m_pool.lock()) {
+        pool->release(*this);
+    }
+}
+
+MeshGeometryPool::MeshGeometryPool(MeshGeometryPoolConfig config) :
+    m_state(std::make_shared<MeshGeometryPoolState>()) {
+    m_state->config = config;
+}
+
+std::shared_ptr<MeshGeometry> MeshGeometryPool::allocate(
+    const GraphicsDevice& device,
+    std::size_t layout_hash,
+    uint32 vertex_stride,
+    std::span<const std::byte> vertices,
+    std::span<const std::byte> indices
+) {
+    if (vertex_stride == 0 || vertices.empty() ||
+        vertices.size() % vertex_stride != 0 ||
+        indices.size() % sizeof(std::uint32_t) != 0) {
+        error(
+            "MeshGeometryPool::allocate received {} vertex bytes with stride "
+            "{} and {} index bytes",
+            vertices.size(),
+            vertex_stride,
+            indices.size()
+        );
+        return nullptr;
+    }
+
+    const auto vertex_count = vertices.size() / vertex_stride;
+    const auto index_count = indices.size() / sizeof(std::uint32_t);
+
+    std::scoped_lock lock(m_state->mutex);
+    auto& vertex_arena = m_state->vertex_arenas[vertex_arena_key(
+        layout_hash,
+        vertex_stride
+    )];
+    vertex_arena.element_size = vertex_stride;
+
+    auto vertex_range = m_state->allocate(
+        &device,
+        vertex_arena,
+        vertex_count,
+        m_state->config.vertex_slab_bytes
+    );
+    if (!vertex_range) {
+        return nullptr;
+    }
+    Optional<SlabRange> index_range;
+    if (index_count > 0) {
+        index_range = m_state->allocate(
+            &device,
+            m_state->index_arena,
+            index_count,
+            m_state->config.index_slab_bytes
+        );
+        if (!index_range) {
+            vertex_range->slab->allocator.release(
+                vertex_range->offset,
+                vertex_count
+            );
+            return nullptr;
+        }
+    }
+
+    auto geometry = std::shared_ptr<MeshGeometry>(new MeshGeometry());
+    geometry->m_pool = m_state;
+    geometry->m_vertex_slab = vertex_range->slab;
+    geometry->m_vertex_buffer = vertex_range->slab->buffer;
+    geometry->m_base_vertex = static_cast<uint32>(vertex_range->offset);
+    geometry->m_vertex_count = static_cast<uint32>(vertex_count);
+    vertex_range->slab->residents.insert(geometry.get());
+    device.update_buffer(
+        geometry->m_vertex_buffer,
+        static_cast<uint32>(vertex_range->offset * vertex_stride),
+        vertices.data(),
+        static_cast<uint32>(vertices.size())
+    );
+
+    if (index_range) {
+        geometry->m_index_slab = index_range->slab;
+        geometry->m_index_buffer = index_range->slab->buffer;
+        geometry->m_first_index = static_cast<uint32>(index_range->offset);
+        geometry->m_index_count = static_cast<uint32>(index_count);
+        index_range->slab->residents.insert(geometry.get());
+        device.update_buffer(
+            geometry->m_index_buffer,
+            static_cast<uint32>(index_range->offset * sizeof(std::uint32_t)),
+            indices.data(),
+            static_cast<uint32>(indices.size())
+        );
+    }
+    ++m_state->geometries;
+    return geometry;
+}
+
+void MeshGeometryPool::maintain(const GraphicsDevice& device) {
+    std::scoped_lock lock(m_state->mutex);
+    ++m_state->frame;
+    m_state->reclaim_retired(device.max_frames_in_flight());
+
+    if (device.supports_buffer_copy()) {
+        auto budget = m_state->config.defragment_budget_bytes;
+        for (auto& [key, arena] : m_state->vertex_arenas) {
+            m_state->evacuate(device, arena, false, budget);
+        }
+        m_state->evacuate(device, m_state->index_arena, true, budget);
+    }
+
+    for (auto& [key, arena] : m_state->vertex_arenas) {
+        m_state->release_empty_slabs(arena);
+    }
+    m_state->release_empty_slabs(m_state->index_arena);
+    std::erase_if(m_state->vertex_arenas, [](const auto& entry) {
+        return entry.second.slabs.empty();
+    });
+}
+
+MeshGeometryPoolStats MeshGeometryPool::stats() const {
+    std::scoped_lock lock(m_state->mutex);
+    MeshGeometryPoolStats stats {
+        .geometries = m_state->geometries,
+        .moved_bytes = m_state->moved_bytes,
+        .released_slabs = m_state->released_slabs,
+    };
+    for (const auto& [key, arena] : m_state->vertex_arenas) {
+        for (const auto& slab : arena.slabs) {
+            ++stats.vertex_slabs;
+            stats.vertex_capacity_bytes +=
+                slab->allocator.capacity() * slab->element_size;
+            stats.vertex_used_bytes +=
+                slab->live_elements() * slab->element_size;
+        }
+    }
+    for (const auto& slab : m_state->index_arena.slabs) {
+        ++stats.index_slabs;
+        stats.index_capacity_bytes +=
+            slab->allocator.capacity() * slab->element_size;
+        stats.index_used_bytes += slab->live_elements() * slab->element_size;
+    }
+    return stats;
+}
+
+const MeshGeometryPoolConfig& MeshGeometryPool::config() const {
+    return m_state->config;
+}
+
+} // namespace fei
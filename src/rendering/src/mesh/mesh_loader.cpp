@@ -1,9 +1,13 @@
 #include "rendering/mesh/mesh_loader.hpp"
 
+#include "rendering/mesh/mesh_binary.hpp"
+
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <span>
+#include <spanstream>
 #include <string>
 #include <tiny_obj_loader.h>
 #include <unordered_map>
@@ -49,24 +53,43 @@ mesh_load_error(const LoadContext& context, std::string message) {
 
 AssetLoadResult<Mesh>
 MeshLoader::load(Reader& reader, const LoadContext& context) {
-    tinyobj::ObjReaderConfig reader_config;
-    tinyobj::ObjReader obj_reader;
+    if (is_mesh_binary(reader.bytes())) {
+        auto mesh = decode_mesh_binary(reader);
+        if (!mesh) {
+            return failure(mesh_load_error(context, std::move(mesh.error())));
+        }
+        return std::make_unique<Mesh>(std::move(*mesh));
+    }
 
-    if (!obj_reader.ParseFromString(reader.as_string(), "", reader_config)) {
-        auto message = obj_reader.Error().empty() ?
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warning;
+    std::string error_message;
+
+    // Parse straight out of the reader; mapped files are never copied.
+    const auto text = reader.as_string_view();
+    std::ispanstream stream(std::span<const char>(text.data(), text.size()));
+    if (!tinyobj::LoadObj(
+            &attrib,
+            &shapes,
+            &materials,
+            &warning,
+            &error_message,
+            &stream
+        )) {
+        auto message = error_message.empty() ?
                            "Failed to parse OBJ mesh" :
-                           "TinyObjReader: " + obj_reader.Error();
+                           "TinyObjReader: " + error_message;
         return failure(
             AssetLoadError(context.asset_path(), std::move(message))
         );
     }
 
-    if (!obj_reader.Warning().empty()) {
-        fei::warn("TinyObjReader: {}", obj_reader.Warning());
+    if (!warning.empty()) {
+        fei::warn("TinyObjReader: {}", warning);
     }
 
-    const auto& attrib = obj_reader.GetAttrib();
-    const auto& shapes = obj_reader.GetShapes();
     if (shapes.empty()) {
         return failure(
             AssetLoadError(context.asset_path(), "OBJ mesh has no shapes")
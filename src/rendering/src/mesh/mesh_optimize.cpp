@@ -0,0 +1,381 @@
+#include "rendering/mesh/mesh_optimize.hpp"
+
+#include "base/log.hpp"
+#include "math/vector.hpp"
+#include "rendering/mesh/mesh.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace fei {
+
+namespace {
+
+// FIFO post-transform cache. A vertex is cached while fewer than
+// `cache_size` misses happened since it was loaded, so lookups and resets
+// are O(1).
+class FifoCache {
+  private:
+    std::vector<std::size_t> m_loaded_at;
+    std::size_t m_misses {0};
+    std::size_t m_reset_at {0};
+    std::size_t m_cache_size;
+
+  public:
+    FifoCache(std::size_t vertex_count, uint32 cache_size) :
+        m_loaded_at(vertex_count, 0), m_cache_size(cache_size) {}
+
+    // Returns 1 on a miss.
+    std::size_t touch(std::uint32_t vertex) {
+        const auto loaded_at = m_loaded_at[vertex];
+        if (loaded_at > m_reset_at && m_misses - loaded_at < m_cache_size) {
+            return 0;
+        }
+        m_loaded_at[vertex] = ++m_misses;
+        return 1;
+    }
+
+    std::size_t touch_triangle(const std::uint32_t* triangle) {
+        return touch(triangle[0]) + touch(triangle[1]) + touch(triangle[2]);
+    }
+
+    void reset() { m_reset_at = m_misses; }
+};
+
+struct TriangleCluster {
+    std::size_t first_triangle {0};
+    std::size_t triangle_count {0};
+    float sort_key {0.0f};
+};
+
+// Hard boundaries fall where the cache has nothing of a triangle left; soft
+// ones split the resulting clusters further wherever the ACMR from the
+// cluster start is within `threshold` of the whole cluster's.
+std::vector<TriangleCluster> split_clusters(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count,
+    uint32 cache_size,
+    float threshold
+) {
+    const std::size_t triangle_count = indices.size() / 3;
+    std::vector<std::size_t> hard_starts;
+    FifoCache cache(vertex_count, cache_size);
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        if (cache.touch_triangle(&indices[t * 3]) == 3 || t == 0) {
+            hard_starts.push_back(t);
+        }
+    }
+    hard_starts.push_back(triangle_count);
+
+    std::vector<TriangleCluster> clusters;
+    for (std::size_t h = 0; h + 1 < hard_starts.size(); ++h) {
+        const auto begin = hard_starts[h];
+        const auto end = hard_starts[h + 1];
+
+        cache.reset();
+        std::size_t misses = 0;
+        for (auto t = begin; t < end; ++t) {
+            misses += cache.touch_triangle(&indices[t * 3]);
+        }
+        const float target = static_cast<float>(misses) /
+                             static_cast<float>(end - begin) * threshold;
+
+        cache.reset();
+        misses = 0;
+        auto start = begin;
+        for (auto t = begin; t < end; ++t) {
+            misses += cache.touch_triangle(&indices[t * 3]);
+            const auto count = t + 1 - start;
+            if (t + 1 == end ||
+                static_cast<float>(misses) <=
+                    target * static_cast<float>(count)) {
+                clusters.push_back({
+                    .first_triangle = start,
+                    .triangle_count = count,
+                });
+                cache.reset();
+                misses = 0;
+                start = t + 1;
+            }
+        }
+    }
+    return clusters;
+}
+
+} // namespace
+
+VertexCacheStats analyze_vertex_cache(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count,
+    uint32 cache_size
+) {
+    VertexCacheStats stats;
+    const std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0 || vertex_count == 0) {
+        return stats;
+    }
+    FifoCache cache(vertex_count, cache_size);
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        stats.vertices_transformed += cache.touch_triangle(&indices[t * 3]);
+    }
+    stats.acmr = static_cast<float>(stats.vertices_transformed) /
+                 static_cast<float>(triangle_count);
+    stats.atvr = static_cast<float>(stats.vertices_transformed) /
+                 static_cast<float>(vertex_count);
+    return stats;
+}
+
+std::vector<std::uint32_t> optimize_vertex_cache(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count,
+    uint32 cache_size
+) {
+    const std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0 || vertex_count == 0) {
+        return {indices.begin(), indices.end()};
+    }
+
+    // Vertex -> triangle adjacency in compressed rows.
+    std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+    for (std::size_t i = 0; i < triangle_count * 3; ++i) {
+        ++offsets[indices[i] + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<std::uint32_t> adjacency(triangle_count * 3);
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < triangle_count * 3; ++i) {
+        adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+    }
+
+    std::vector<std::uint32_t> live(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        live[v] = offsets[v + 1] - offsets[v];
+    }
+    std::vector<std::size_t> cache_time(vertex_count, 0);
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<std::uint32_t> dead_ends;
+    std::vector<std::uint32_t> candidates;
+    std::vector<std::uint32_t> result;
+    result.reserve(triangle_count * 3);
+
+    std::size_t time = cache_size + 1;
+    std::size_t scan = 0;
+    std::uint32_t fan = indices[0];
+    while (true) {
+        // Emit every remaining triangle around the fanning vertex.
+        candidates.clear();
+        for (auto k = offsets[fan]; k < offsets[fan + 1]; ++k) {
+            const auto t = adjacency[k];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            for (std::size_t c = 0; c < 3; ++c) {
+                const auto v = indices[(t * 3) + c];
+                result.push_back(v);
+                dead_ends.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - cache_time[v] > cache_size) {
+                    cache_time[v] = time++;
+                }
+            }
+        }
+
+        // Prefer the candidate that stays cached longest while its
+        // remaining triangles are emitted.
+        Optional<std::uint32_t> next;
+        std::size_t best_priority = 0;
+        for (auto v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            std::size_t priority = 0;
+            if (time - cache_time[v] + (2 * live[v]) <= cache_size) {
+                priority = time - cache_time[v];
+            }
+            if (!next || priority > best_priority) {
+                next = v;
+                best_priority = priority;
+            }
+        }
+        while (!next && !dead_ends.empty()) {
+            const auto v = dead_ends.back();
+            dead_ends.pop_back();
+            if (live[v] > 0) {
+                next = v;
+            }
+        }
+        while (!next && scan < vertex_count) {
+            if (live[scan] > 0) {
+                next = static_cast<std::uint32_t>(scan);
+            }
+            ++scan;
+        }
+        if (!next) {
+            break;
+        }
+        fan = *next;
+    }
+    return result;
+}
+
+std::vector<std::uint32_t> optimize_overdraw(
+    std::span<const std::uint32_t> indices,
+    std::span<const std::array<float, 3>> positions,
+    uint32 cache_size,
+    float threshold
+) {
+    auto clusters =
+        split_clusters(indices, positions.size(), cache_size, threshold);
+    if (clusters.size() < 2) {
+        return {indices.begin(), indices.end()};
+    }
+
+    // Area-weighted centroid and normal per cluster, with the face winding
+    // of Mesh::compute_smooth_normals().
+    std::vector<Vector3> centroids(clusters.size(), Vector3::Zero);
+    std::vector<Vector3> normals(clusters.size(), Vector3::Zero);
+    Vector3 mesh_centroid = Vector3::Zero;
+    float mesh_area = 0.0f;
+    for (std::size_t c = 0; c < clusters.size(); ++c) {
+        float area = 0.0f;
+        const auto end =
+            clusters[c].first_triangle + clusters[c].triangle_count;
+        for (auto t = clusters[c].first_triangle; t < end; ++t) {
+            Vector3 pa(positions[indices[t * 3]]);
+            Vector3 pb(positions[indices[(t * 3) + 1]]);
+            Vector3 pc(positions[indices[(t * 3) + 2]]);
+            const auto normal = (pb - pa).cross(pa - pc);
+            const float weight = normal.magnitude();
+            centroids[c] += (pa + pb + pc) * (weight / 3.0f);
+            normals[c] += normal;
+            area += weight;
+        }
+        mesh_centroid += centroids[c];
+        mesh_area += area;
+        if (area > 0.0f) {
+            centroids[c] *= 1.0f / area;
+        }
+    }
+    if (mesh_area > 0.0f) {
+        mesh_centroid *= 1.0f / mesh_area;
+    }
+    for (std::size_t c = 0; c < clusters.size(); ++c) {
+        clusters[c].sort_key =
+            (centroids[c] - mesh_centroid).dot(normals[c].normalized());
+    }
+
+    std::stable_sort(
+        clusters.begin(),
+        clusters.end(),
+        [](const TriangleCluster& lhs, const TriangleCluster& rhs) {
+            return lhs.sort_key > rhs.sort_key;
+        }
+    );
+    std::vector<std::uint32_t> result;
+    result.reserve(indices.size());
+    for (const auto& cluster : clusters) {
+        const auto first = indices.begin() + (cluster.first_triangle * 3);
+        result.insert(
+            result.end(),
+            first,
+            first + (cluster.triangle_count * 3)
+        );
+    }
+    return result;
+}
+
+std::vector<std::uint32_t> vertex_fetch_remap(
+    std::span<const std::uint32_t> indices,
+    std::size_t vertex_count
+) {
+    std::vector<std::uint32_t> remap(vertex_count, UnusedVertex);
+    std::uint32_t next = 0;
+    for (auto index : indices) {
+        if (remap[index] == UnusedVertex) {
+            remap[index] = next++;
+        }
+    }
+    return remap;
+}
+
+VertexCacheStats Mesh::vertex_cache_stats(uint32 cache_size) const {
+    if (!m_indices) {
+        return {};
+    }
+    return analyze_vertex_cache(*m_indices, vertex_count(), cache_size);
+}
+
+MeshOptimizeStats Mesh::optimize(const MeshOptimizeOptions& options) {
+    MeshOptimizeStats stats;
+    if (m_packed) {
+        fei::warn("Packed meshes are optimized before they are written");
+        return stats;
+    }
+    if (m_primitive != RenderPrimitive::Triangles || !m_indices ||
+        m_indices->size() < 3 || m_indices->size() % 3 != 0) {
+        fei::warn("Mesh has no triangle list indices, cannot optimize");
+        return stats;
+    }
+    auto& indices = m_indices.value();
+    const auto v_count = vertex_count();
+    if (std::ranges::any_of(indices, [&](std::uint32_t index) {
+            return index >= v_count;
+        })) {
+        fei::warn("Mesh contains an out-of-range index");
+        return stats;
+    }
+
+    stats.before = analyze_vertex_cache(indices, v_count, options.cache_size);
+    auto optimized =
+        optimize_vertex_cache(indices, v_count, options.cache_size);
+    if (options.optimize_overdraw && has_attribute(ATTRIBUTE_POSITION.id)) {
+        optimized = optimize_overdraw(
+            optimized,
+            get_attribute(ATTRIBUTE_POSITION.id).as_float3().value(),
+            options.cache_size,
+            options.overdraw_threshold
+        );
+    }
+    indices = std::move(optimized);
+    for (auto& lod : m_lods) {
+        lod.indices =
+            optimize_vertex_cache(lod.indices, v_count, options.cache_size);
+    }
+
+    if (options.reorder_vertices) {
+        // Coarser levels only use vertices of the full-detail one, but keep
+        // any they add rather than dropping them.
+        auto remap = vertex_fetch_remap(indices, v_count);
+        auto used = static_cast<std::uint32_t>(std::ranges::count_if(
+            remap,
+            [](std::uint32_t index) {
+                return index != UnusedVertex;
+            }
+        ));
+        for (const auto& lod : m_lods) {
+            for (auto index : lod.indices) {
+                if (remap[index] == UnusedVertex) {
+                    remap[index] = used++;
+                }
+            }
+        }
+        for (auto& [id, data] : m_attributes) {
+            data.values.remap(remap, used);
+        }
+        for (auto& index : indices) {
+            index = remap[index];
+        }
+        for (auto& lod : m_lods) {
+            for (auto& index : lod.indices) {
+                index = remap[index];
+            }
+        }
+    }
+    stats.after =
+        analyze_vertex_cache(indices, vertex_count(), options.cache_size);
+    return stats;
+}
+
+} // namespace fei
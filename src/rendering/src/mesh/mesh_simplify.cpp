@@ -0,0 +1,441 @@
+#include "rendering/mesh/mesh_simplify.hpp"
+
+#include "base/log.hpp"
+#include "math/vector.hpp"
+#include "rendering/mesh/mesh.hpp"
+#include "rendering/mesh/mesh_optimize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <queue>
+
+namespace fei {
+
+namespace {
+
+// Border planes outweigh face planes so open edges keep their outline.
+constexpr double border_weight = 10.0;
+
+// Sum of squared distances to a set of planes, as p^T A p + 2 b.p + c.
+// `weight` is the face area behind it and normalizes the error.
+struct Quadric {
+    double a00 {0.0}, a01 {0.0}, a02 {0.0}, a11 {0.0}, a12 {0.0}, a22 {0.0};
+    double b0 {0.0}, b1 {0.0}, b2 {0.0};
+    double c {0.0};
+    double weight {0.0};
+
+    static Quadric from_plane(const Vector3& normal, float distance, double w) {
+        const double x = normal.x;
+        const double y = normal.y;
+        const double z = normal.z;
+        const double d = distance;
+        return Quadric {
+            .a00 = w * x * x,
+            .a01 = w * x * y,
+            .a02 = w * x * z,
+            .a11 = w * y * y,
+            .a12 = w * y * z,
+            .a22 = w * z * z,
+            .b0 = w * x * d,
+            .b1 = w * y * d,
+            .b2 = w * z * d,
+            .c = w * d * d,
+        };
+    }
+
+    Quadric& operator+=(const Quadric& rhs) {
+        a00 += rhs.a00;
+        a01 += rhs.a01;
+        a02 += rhs.a02;
+        a11 += rhs.a11;
+        a12 += rhs.a12;
+        a22 += rhs.a22;
+        b0 += rhs.b0;
+        b1 += rhs.b1;
+        b2 += rhs.b2;
+        c += rhs.c;
+        weight += rhs.weight;
+        return *this;
+    }
+
+    double evaluate(const Vector3& p) const {
+        const double x = p.x;
+        const double y = p.y;
+        const double z = p.z;
+        return (a00 * x * x) + (a11 * y * y) + (a22 * z * z) +
+               (2.0 * ((a01 * x * y) + (a02 * x * z) + (a12 * y * z))) +
+               (2.0 * ((b0 * x) + (b1 * y) + (b2 * z))) + c;
+    }
+};
+
+enum class VertexKind : std::uint8_t {
+    Manifold,
+    // On an edge only one triangle uses; collapses along the border.
+    Border,
+    // Shares its position with another vertex; never collapses.
+    Locked,
+};
+
+struct Collapse {
+    float error {0.0f};
+    std::uint32_t from {0};
+    std::uint32_t to {0};
+    std::uint32_t from_version {0};
+    std::uint32_t to_version {0};
+
+    bool operator>(const Collapse& rhs) const { return error > rhs.error; }
+};
+
+class Simplifier {
+  private:
+    std::vector<std::uint32_t> m_triangles;
+    std::vector<Vector3> m_positions;
+    std::vector<Quadric> m_quadrics;
+    std::vector<VertexKind> m_kinds;
+    std::vector<std::vector<std::uint32_t>> m_adjacency;
+    std::vector<bool> m_removed;
+    std::vector<bool> m_dead;
+    std::vector<std::uint32_t> m_versions;
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>>
+        m_queue;
+    std::size_t m_live_triangles {0};
+    float m_error {0.0f};
+
+  public:
+    Simplifier(
+        std::span<const std::uint32_t> indices,
+        std::span<const std::array<float, 3>> positions
+    );
+
+    std::size_t live_triangles() const { return m_live_triangles; }
+    float error() const { return m_error; }
+
+    // Collapses edges until at most `target_triangles` remain. Returns false
+    // when the next collapse would exceed `max_error` or none is left.
+    bool simplify_to(std::size_t target_triangles, float max_error);
+    std::vector<std::uint32_t> indices() const;
+
+  private:
+    bool is_border_edge(std::uint32_t a, std::uint32_t b) const;
+    bool can_collapse(std::uint32_t from, std::uint32_t to) const;
+    bool flips_triangle(std::uint32_t from, std::uint32_t to) const;
+    float collapse_error(std::uint32_t from, std::uint32_t to) const;
+    void push_collapse(std::uint32_t from, std::uint32_t to);
+    void push_collapses_around(std::uint32_t vertex);
+    void collapse(std::uint32_t from, std::uint32_t to);
+};
+
+Simplifier::Simplifier(
+    std::span<const std::uint32_t> indices,
+    std::span<const std::array<float, 3>> positions
+) :
+    m_triangles(indices.begin(), indices.end()),
+    m_positions(positions.size()), m_quadrics(positions.size()),
+    m_kinds(positions.size(), VertexKind::Manifold),
+    m_adjacency(positions.size()), m_removed(positions.size(), false),
+    m_dead(indices.size() / 3, false), m_versions(positions.size(), 0),
+    m_live_triangles(indices.size() / 3) {
+    // Work in a unit-radius frame so errors come out relative to the mesh.
+    Vector3 min(positions[0]);
+    Vector3 max(positions[0]);
+    for (const auto& position : positions) {
+        for (std::size_t i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], position[i]);
+            max[i] = std::max(max[i], position[i]);
+        }
+    }
+    const auto center = (min + max) * 0.5f;
+    const float radius = ((max - min) * 0.5f).magnitude();
+    const float scale = radius > 0.0f ? 1.0f / radius : 1.0f;
+    for (std::size_t v = 0; v < positions.size(); ++v) {
+        m_positions[v] = (Vector3(positions[v]) - center) * scale;
+    }
+
+    std::map<std::array<float, 3>, std::uint32_t> first_at;
+    for (std::size_t v = 0; v < positions.size(); ++v) {
+        auto [it, inserted] =
+            first_at.emplace(positions[v], static_cast<std::uint32_t>(v));
+        if (!inserted) {
+            m_kinds[it->second] = VertexKind::Locked;
+            m_kinds[v] = VertexKind::Locked;
+        }
+    }
+
+    for (std::size_t t = 0; t < m_dead.size(); ++t) {
+        const auto* corners = &m_triangles[t * 3];
+        for (std::size_t c = 0; c < 3; ++c) {
+            m_adjacency[corners[c]].push_back(static_cast<std::uint32_t>(t));
+        }
+    }
+
+    for (std::size_t t = 0; t < m_dead.size(); ++t) {
+        const auto* corners = &m_triangles[t * 3];
+        const auto& pa = m_positions[corners[0]];
+        const auto& pb = m_positions[corners[1]];
+        const auto& pc = m_positions[corners[2]];
+        const auto cross = (pb - pa).cross(pc - pa);
+        const float area = cross.magnitude() * 0.5f;
+        if (area <= 0.0f) {
+            continue;
+        }
+        const auto normal = cross.normalized();
+        auto quadric = Quadric::from_plane(normal, -normal.dot(pa), area);
+        quadric.weight = area;
+        for (std::size_t c = 0; c < 3; ++c) {
+            m_quadrics[corners[c]] += quadric;
+        }
+
+        for (std::size_t c = 0; c < 3; ++c) {
+            const auto a = corners[c];
+            const auto b = corners[(c + 1) % 3];
+            if (!is_border_edge(a, b)) {
+                continue;
+            }
+            for (auto v : {a, b}) {
+                if (m_kinds[v] == VertexKind::Manifold) {
+                    m_kinds[v] = VertexKind::Border;
+                }
+            }
+            const auto edge = m_positions[b] - m_positions[a];
+            const auto border_normal = edge.cross(normal).normalized();
+            const auto border = Quadric::from_plane(
+                border_normal,
+                -border_normal.dot(m_positions[a]),
+                border_weight * edge.sqr_magnitude()
+            );
+            m_quadrics[a] += border;
+            m_quadrics[b] += border;
+        }
+    }
+
+    for (std::size_t t = 0; t < m_dead.size(); ++t) {
+        const auto* corners = &m_triangles[t * 3];
+        for (std::size_t c = 0; c < 3; ++c) {
+            push_collapse(corners[c], corners[(c + 1) % 3]);
+            push_collapse(corners[(c + 1) % 3], corners[c]);
+        }
+    }
+}
+
+bool Simplifier::is_border_edge(std::uint32_t a, std::uint32_t b) const {
+    std::size_t shared = 0;
+    for (auto t : m_adjacency[a]) {
+        if (m_dead[t]) {
+            continue;
+        }
+        const auto* corners = &m_triangles[t * 3];
+        if (corners[0] == b || corners[1] == b || corners[2] == b) {
+            ++shared;
+        }
+    }
+    return shared == 1;
+}
+
+bool Simplifier::can_collapse(std::uint32_t from, std::uint32_t to) const {
+    switch (m_kinds[from]) {
+        case VertexKind::Manifold:
+            return true;
+        case VertexKind::Border:
+            return m_kinds[to] != VertexKind::Manifold &&
+                   is_border_edge(from, to);
+        case VertexKind::Locked:
+            return false;
+    }
+    return false;
+}
+
+bool Simplifier::flips_triangle(std::uint32_t from, std::uint32_t to) const {
+    for (auto t : m_adjacency[from]) {
+        if (m_dead[t]) {
+            continue;
+        }
+        const auto* corners = &m_triangles[t * 3];
+        if (corners[0] == to || corners[1] == to || corners[2] == to) {
+            continue;
+        }
+        std::array<Vector3, 3> before;
+        std::array<Vector3, 3> after;
+        for (std::size_t c = 0; c < 3; ++c) {
+            before[c] = m_positions[corners[c]];
+            after[c] = m_positions[corners[c] == from ? to : corners[c]];
+        }
+        const auto normal_before =
+            (before[1] - before[0]).cross(before[2] - before[0]);
+        const auto normal_after =
+            (after[1] - after[0]).cross(after[2] - after[0]);
+        if (normal_before.dot(normal_after) <= 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float Simplifier::collapse_error(std::uint32_t from, std::uint32_t to) const {
+    auto quadric = m_quadrics[from];
+    quadric += m_quadrics[to];
+    if (quadric.weight <= 0.0) {
+        return 0.0f;
+    }
+    const double error = quadric.evaluate(m_positions[to]) / quadric.weight;
+    return static_cast<float>(std::sqrt(std::max(error, 0.0)));
+}
+
+void Simplifier::push_collapse(std::uint32_t from, std::uint32_t to) {
+    if (!can_collapse(from, to)) {
+        return;
+    }
+    m_queue.push({
+        .error = collapse_error(from, to),
+        .from = from,
+        .to = to,
+        .from_version = m_versions[from],
+        .to_version = m_versions[to],
+    });
+}
+
+void Simplifier::push_collapses_around(std::uint32_t vertex) {
+    for (auto t : m_adjacency[vertex]) {
+        if (m_dead[t]) {
+            continue;
+        }
+        const auto* corners = &m_triangles[t * 3];
+        for (std::size_t c = 0; c < 3; ++c) {
+            if (corners[c] != vertex) {
+                push_collapse(vertex, corners[c]);
+                push_collapse(corners[c], vertex);
+            }
+        }
+    }
+}
+
+void Simplifier::collapse(std::uint32_t from, std::uint32_t to) {
+    for (auto t : m_adjacency[from]) {
+        if (m_dead[t]) {
+            continue;
+        }
+        auto* corners = &m_triangles[t * 3];
+        if (corners[0] == to || corners[1] == to || corners[2] == to) {
+            m_dead[t] = true;
+            --m_live_triangles;
+            continue;
+        }
+        for (std::size_t c = 0; c < 3; ++c) {
+            if (corners[c] == from) {
+                corners[c] = to;
+            }
+        }
+        m_adjacency[to].push_back(t);
+    }
+    m_adjacency[from].clear();
+    m_removed[from] = true;
+    m_quadrics[to] += m_quadrics[from];
+    ++m_versions[to];
+    push_collapses_around(to);
+}
+
+bool Simplifier::simplify_to(std::size_t target_triangles, float max_error) {
+    while (m_live_triangles > target_triangles) {
+        if (m_queue.empty()) {
+            return false;
+        }
+        const auto next = m_queue.top();
+        if (m_removed[next.from] || m_removed[next.to] ||
+            next.from_version != m_versions[next.from] ||
+            next.to_version != m_versions[next.to]) {
+            m_queue.pop();
+            continue;
+        }
+        if (next.error > max_error) {
+            return false;
+        }
+        m_queue.pop();
+        if (!can_collapse(next.from, next.to) ||
+            flips_triangle(next.from, next.to)) {
+            continue;
+        }
+        collapse(next.from, next.to);
+        m_error = std::max(m_error, next.error);
+    }
+    return true;
+}
+
+std::vector<std::uint32_t> Simplifier::indices() const {
+    std::vector<std::uint32_t> result;
+    result.reserve(m_live_triangles * 3);
+    for (std::size_t t = 0; t < m_dead.size(); ++t) {
+        if (!m_dead[t]) {
+            const auto first = m_triangles.begin() + (t * 3);
+            result.insert(result.end(), first, first + 3);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+std::vector<MeshLod> simplify_lod_chain(
+    std::span<const std::uint32_t> indices,
+    std::span<const std::array<float, 3>> positions,
+    const MeshLodOptions& options
+) {
+    std::vector<MeshLod> lods;
+    if (indices.size() < 3 || positions.empty()) {
+        return lods;
+    }
+
+    // One collapse sequence serves every level, so each level is a
+    // snapshot of it and the errors only grow.
+    Simplifier simplifier(indices, positions);
+    for (uint32 level = 0; level < options.level_count; ++level) {
+        const auto previous = simplifier.live_triangles();
+        const auto target = static_cast<std::size_t>(
+            static_cast<float>(previous) * options.reduction
+        );
+        const bool reached = simplifier.simplify_to(target, options.max_error);
+        if (static_cast<float>(simplifier.live_triangles()) >
+            static_cast<float>(previous) * 0.9f) {
+            break;
+        }
+        lods.push_back({
+            .indices = optimize_vertex_cache(
+                simplifier.indices(),
+                positions.size(),
+                16
+            ),
+            .error = simplifier.error(),
+        });
+        if (!reached) {
+            break;
+        }
+    }
+    return lods;
+}
+
+uint32 Mesh::generate_lods(const MeshLodOptions& options) {
+    m_lods.clear();
+    if (m_packed) {
+        fei::warn("Packed meshes get their levels of detail before writing");
+        return 0;
+    }
+    if (m_primitive != RenderPrimitive::Triangles || !m_indices ||
+        m_indices->size() < 3 || m_indices->size() % 3 != 0 ||
+        !has_attribute(ATTRIBUTE_POSITION.id)) {
+        fei::warn("Mesh has no indexed triangle positions, cannot build LODs");
+        return 0;
+    }
+    const auto& positions =
+        get_attribute(ATTRIBUTE_POSITION.id).as_float3().value();
+    if (std::ranges::any_of(*m_indices, [&](std::uint32_t index) {
+            return index >= positions.size();
+        })) {
+        fei::warn("Mesh contains an out-of-range index");
+        return 0;
+    }
+    m_lods = simplify_lod_chain(*m_indices, positions, options);
+    return static_cast<uint32>(m_lods.size());
+}
+
+} // namespace fei
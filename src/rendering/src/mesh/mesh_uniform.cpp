@@ -4,9 +4,12 @@
 #include "graphics/resource.hpp"
 #include "rendering/components.hpp"
 
+#include <algorithm>
 #include <bit>
 #include <cstring>
+#include <functional>
 #include <limits>
+#include <numeric>
 
 namespace fei {
 
@@ -19,7 +22,41 @@ std::size_t align_up(std::size_t value, std::size_t alignment) {
     return ((value + alignment - 1) / alignment) * alignment;
 }
 
-void ensure_mesh_uniform_buffer(
+void update_mesh_uniform_resource_set(
+    const GraphicsDevice& device,
+    MeshUniforms& mesh_uniforms
+) {
+    ResourceSetDescription description {
+        .layout = mesh_uniforms.resource_layout,
+        .name = "mesh_uniforms",
+    };
+    if (mesh_uniforms.layout == MeshUniformLayout::StorageBuffer) {
+        description.resources = {
+            std::make_shared<BufferRange>(
+                mesh_uniforms.uniform_buffer,
+                0,
+                mesh_uniforms.capacity * mesh_uniforms.stride
+            ),
+            std::make_shared<BufferRange>(
+                mesh_uniforms.instance_buffer,
+                0,
+                mesh_uniforms.instance_capacity * sizeof(uint32)
+            ),
+        };
+    } else {
+        description.resources = {
+            std::make_shared<BufferRange>(
+                mesh_uniforms.uniform_buffer,
+                0,
+                sizeof(MeshUniform)
+            ),
+        };
+    }
+    mesh_uniforms.resource_set =
+        device.create_resource_set(std::move(description));
+}
+
+bool ensure_mesh_uniform_buffer(
     const GraphicsDevice& device,
     MeshUniforms& mesh_uniforms,
     std::size_t required_capacity
@@ -27,7 +64,7 @@ void ensure_mesh_uniform_buffer(
     if (required_capacity == 0 ||
         (mesh_uniforms.uniform_buffer &&
          required_capacity <= mesh_uniforms.capacity)) {
-        return;
+        return false;
     }
 
     const auto capacity = std::bit_ceil(required_capacity);
@@ -35,88 +72,260 @@ void ensure_mesh_uniform_buffer(
         fatal("Mesh uniform buffer exceeds the dynamic offset address range");
     }
 
+    const bool storage =
+        mesh_uniforms.layout == MeshUniformLayout::StorageBuffer;
     mesh_uniforms.uniform_buffer = device.create_buffer(
         BufferDescription {
             .size = capacity * mesh_uniforms.stride,
-            .usages = BufferUsages::Uniform,
+            .usages = storage ? BufferUsages::Storage : BufferUsages::Uniform,
         }
     );
-    mesh_uniforms.resource_set = device.create_resource_set(
-        ResourceSetDescription {
-            .layout = mesh_uniforms.resource_layout,
-            .resources =
-                {
-                    std::make_shared<BufferRange>(
-                        mesh_uniforms.uniform_buffer,
-                        0,
-                        sizeof(MeshUniform)
-                    ),
-                },
-            .name = "mesh_uniforms",
+    mesh_uniforms.capacity = capacity;
+    return true;
+}
+
+bool ensure_mesh_instance_buffer(
+    const GraphicsDevice& device,
+    MeshUniforms& mesh_uniforms,
+    std::size_t required_count
+) {
+    if (mesh_uniforms.instance_buffer &&
+        required_count <= mesh_uniforms.instance_capacity) {
+        return false;
+    }
+
+    const auto capacity = std::bit_ceil(required_count);
+    mesh_uniforms.instance_buffer = device.create_buffer(
+        BufferDescription {
+            .size = capacity * sizeof(uint32),
+            .usages = BufferUsages::Storage,
         }
     );
-    mesh_uniforms.capacity = capacity;
+    mesh_uniforms.instance_capacity = capacity;
+    return true;
+}
+
+void queue_identity_mesh_instances(
+    const RenderQueue& render_queue,
+    const MeshUniforms& mesh_uniforms
+) {
+    std::vector<uint32> identity(mesh_uniforms.capacity);
+    std::iota(identity.begin(), identity.end(), uint32 {0});
+    render_queue.write_buffer(
+        mesh_uniforms.instance_buffer,
+        0,
+        identity.data(),
+        identity.size() * sizeof(uint32)
+    );
+}
+
+void write_mesh_uniform(
+    MeshUniforms& mesh_uniforms,
+    const MeshUniforms::Entry& entry,
+    const Transform3d& transform3d
+) {
+    MeshUniform uniform {
+        .world_from_local = transform3d.to_matrix(),
+    };
+    std::memcpy(
+        mesh_uniforms.upload_data.data() + entry.slot * mesh_uniforms.stride,
+        &uniform,
+        sizeof(uniform)
+    );
+    mesh_uniforms.dirty_slots.push_back(entry.slot);
+}
+
+MeshUniforms::Entry& acquire_mesh_uniform_slot(
+    MeshUniforms& mesh_uniforms,
+    Entity entity
+) {
+    uint32 slot {};
+    if (!mesh_uniforms.free_slots.empty()) {
+        slot = mesh_uniforms.free_slots.back();
+        mesh_uniforms.free_slots.pop_back();
+    } else {
+        slot = static_cast<uint32>(mesh_uniforms.slot_count++);
+        mesh_uniforms.upload_data.resize(
+            mesh_uniforms.slot_count * mesh_uniforms.stride
+        );
+    }
+
+    MeshUniforms::Entry entry {.slot = slot};
+    if (mesh_uniforms.layout == MeshUniformLayout::StorageBuffer) {
+        entry.instance_index = slot;
+    } else {
+        entry.dynamic_offset = static_cast<uint32>(slot * mesh_uniforms.stride);
+    }
+    return mesh_uniforms.entries.emplace(entity, entry).first->second;
+}
+
+void release_unseen_mesh_uniform_slots(MeshUniforms& mesh_uniforms) {
+    std::erase_if(mesh_uniforms.entries, [&](const auto& entry) {
+        if (entry.second.last_seen_frame == mesh_uniforms.frame) {
+            return false;
+        }
+        mesh_uniforms.free_slots.push_back(entry.second.slot);
+        return true;
+    });
+    // Hand out low slots first so the live range stays compact.
+    std::ranges::sort(mesh_uniforms.free_slots, std::greater {});
+}
+
+void queue_dirty_mesh_uniform_ranges(
+    const RenderQueue& render_queue,
+    MeshUniforms& mesh_uniforms
+) {
+    auto& dirty_slots = mesh_uniforms.dirty_slots;
+    std::ranges::sort(dirty_slots);
+    const auto unique_end = std::ranges::unique(dirty_slots).begin();
+    dirty_slots.erase(unique_end, dirty_slots.end());
+
+    std::size_t run_begin = 0;
+    while (run_begin < dirty_slots.size()) {
+        auto run_end = run_begin + 1;
+        while (run_end < dirty_slots.size() &&
+               dirty_slots[run_end] == dirty_slots[run_end - 1] + 1) {
+            ++run_end;
+        }
+
+        const auto offset = dirty_slots[run_begin] * mesh_uniforms.stride;
+        render_queue.write_buffer(
+            mesh_uniforms.uniform_buffer,
+            static_cast<uint32>(offset),
+            mesh_uniforms.upload_data.data() + offset,
+            (run_end - run_begin) * mesh_uniforms.stride
+        );
+        run_begin = run_end;
+    }
+    dirty_slots.clear();
 }
 
 } // namespace
 
+uint32 allocate_mesh_instances(
+    const GraphicsDevice& device,
+    const RenderQueue& render_queue,
+    MeshUniforms& mesh_uniforms,
+    std::span<const uint32> slots
+) {
+    const auto first = static_cast<uint32>(mesh_uniforms.instance_count);
+    if (slots.empty()) {
+        return first;
+    }
+    if (mesh_uniforms.layout != MeshUniformLayout::StorageBuffer) {
+        fatal("Mesh instancing requires the storage buffer mesh layout");
+    }
+
+    const auto required = mesh_uniforms.instance_count + slots.size();
+    if (ensure_mesh_instance_buffer(device, mesh_uniforms, required)) {
+        // Earlier draws this frame keep the previous set and buffer; only
+        // the identity range has to be carried over.
+        queue_identity_mesh_instances(render_queue, mesh_uniforms);
+        update_mesh_uniform_resource_set(device, mesh_uniforms);
+    }
+    render_queue.write_buffer(
+        mesh_uniforms.instance_buffer,
+        first * sizeof(uint32),
+        slots.data(),
+        slots.size_bytes()
+    );
+    mesh_uniforms.instance_count = required;
+    return first;
+}
+
+ShaderDefs mesh_uniform_shader_defs(const MeshUniforms& mesh_uniforms) {
+    if (mesh_uniforms.layout == MeshUniformLayout::StorageBuffer) {
+        return {ShaderDefVal::bool_def(MESH_STORAGE_BUFFER_SHADER_DEF)};
+    }
+    return {};
+}
+
 void prepare_mesh_uniforms(
-    Query<Entity, const Mesh3d, const Transform3d> query,
+    Query<Entity, const Transform3d>::Filter<With<Mesh3d>> query,
+    Query<Entity, const Transform3d>::Filter<With<Mesh3d>, Changed<Transform3d>>
+        changed_query,
     ResRO<GraphicsDevice> device,
     ResRO<RenderQueue> render_queue,
     ResRW<MeshUniforms> mesh_uniforms
 ) {
+    const bool storage =
+        mesh_uniforms->layout == MeshUniformLayout::StorageBuffer;
     if (!mesh_uniforms->resource_layout) {
-        auto mesh_binding = uniform_buffer("Mesh");
+        // The storage buffer is bound with a constant zero offset so both
+        // layouts share one binding path in the draw code.
+        auto mesh_binding = storage ? storage_buffer_read_only("Meshes") :
+                                      uniform_buffer("Mesh");
         mesh_binding.options.set(ResourceLayoutElementOptions::DynamicBinding);
+        std::vector elements {std::move(mesh_binding)};
+        if (storage) {
+            elements.push_back(storage_buffer_read_only("MeshInstances"));
+        }
         mesh_uniforms->resource_layout = device->create_resource_layout(
             ResourceLayoutDescription::sequencial(
                 {ShaderStages::Vertex, ShaderStages::Fragment},
-                {std::move(mesh_binding)}
+                std::move(elements)
             )
         );
     }
 
     if (mesh_uniforms->stride == 0) {
-        mesh_uniforms->stride = align_up(
-            sizeof(MeshUniform),
-            device->uniform_buffer_offset_alignment()
-        );
+        mesh_uniforms->stride =
+            storage ? sizeof(MeshUniform) :
+                      align_up(
+                          sizeof(MeshUniform),
+                          device->uniform_buffer_offset_alignment()
+                      );
     }
 
-    ensure_mesh_uniform_buffer(*device, *mesh_uniforms, query.size());
-    mesh_uniforms->entries.clear();
-    mesh_uniforms->upload_data.resize(query.size() * mesh_uniforms->stride);
-
-    std::size_t index = 0;
-    for (const auto& [entity, mesh3d, transform3d] : query) {
-        (void)mesh3d;
-        MeshUniform uniform {
-            .world_from_local = transform3d.to_matrix(),
-        };
+    const auto frame = ++mesh_uniforms->frame;
+    std::size_t seen_count = 0;
+    for (const auto& [entity, transform3d] : query) {
+        auto it = mesh_uniforms->entries.find(entity);
+        if (it == mesh_uniforms->entries.end()) {
+            auto& entry = acquire_mesh_uniform_slot(*mesh_uniforms, entity);
+            write_mesh_uniform(*mesh_uniforms, entry, transform3d);
+            entry.last_seen_frame = frame;
+        } else {
+            it->second.last_seen_frame = frame;
+        }
+        ++seen_count;
+    }
+    if (seen_count != mesh_uniforms->entries.size()) {
+        release_unseen_mesh_uniform_slots(*mesh_uniforms);
+    }
 
-        const auto offset = index++ * mesh_uniforms->stride;
-        mesh_uniforms->entries.emplace(
-            entity,
-            MeshUniforms::Entry {
-                .dynamic_offset = static_cast<uint32>(offset),
-            }
-        );
-        std::memcpy(
-            mesh_uniforms->upload_data.data() + offset,
-            &uniform,
-            sizeof(uniform)
-        );
+    for (const auto& [entity, transform3d] : changed_query) {
+        auto it = mesh_uniforms->entries.find(entity);
+        if (it != mesh_uniforms->entries.end()) {
+            write_mesh_uniform(*mesh_uniforms, it->second, transform3d);
+        }
     }
 
-    if (!mesh_uniforms->upload_data.empty()) {
-        render_queue->write_buffer(
-            mesh_uniforms->uniform_buffer,
-            0,
-            mesh_uniforms->upload_data.data(),
-            mesh_uniforms->upload_data.size()
+    if (ensure_mesh_uniform_buffer(
+            *device,
+            *mesh_uniforms,
+            mesh_uniforms->slot_count
+        )) {
+        // A grown buffer starts empty; re-upload every live slot.
+        mesh_uniforms->dirty_slots.resize(mesh_uniforms->slot_count);
+        std::iota(
+            mesh_uniforms->dirty_slots.begin(),
+            mesh_uniforms->dirty_slots.end(),
+            uint32 {0}
         );
+        if (storage) {
+            ensure_mesh_instance_buffer(
+                *device,
+                *mesh_uniforms,
+                mesh_uniforms->capacity
+            );
+            queue_identity_mesh_instances(*render_queue, *mesh_uniforms);
+        }
+        update_mesh_uniform_resource_set(*device, *mesh_uniforms);
     }
+    mesh_uniforms->instance_count = mesh_uniforms->capacity;
+
+    queue_dirty_mesh_uniform_ranges(*render_queue, *mesh_uniforms);
 }
 
 } // namespace fei
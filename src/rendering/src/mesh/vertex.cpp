@@ -1,7 +1,9 @@
 #include "rendering/mesh/vertex.hpp"
 
 #include "base/optional.hpp"
+#include "rendering/mesh/mesh_optimize.hpp"
 
+#include <algorithm>
 #include <tuple>
 #include <type_traits>
 
@@ -49,6 +51,25 @@ VertexFormat VertexAttributeValues::vertex_format() const {
     );
 }
 
+void VertexAttributeValues::remap(
+    std::span<const std::uint32_t> remap,
+    std::size_t new_size
+) {
+    std::visit(
+        [&](auto& values) {
+            std::remove_cvref_t<decltype(values)> remapped(new_size);
+            const auto count = std::min(values.size(), remap.size());
+            for (std::size_t i = 0; i < count; ++i) {
+                if (remap[i] != UnusedVertex) {
+                    remapped[remap[i]] = values[i];
+                }
+            }
+            values = std::move(remapped);
+        },
+        m_value
+    );
+}
+
 Optional<std::vector<std::array<float, 3>>&>
 VertexAttributeValues::as_float3() {
     if (auto* ptr = std::get_if<std::vector<std::array<float, 3>>>(&m_value)) {
@@ -12,6 +12,7 @@
 #include "rendering/gpu_image.hpp"
 #include "rendering/mesh/mesh.hpp"
 #include "rendering/mesh/mesh_aabb.hpp"
+#include "rendering/mesh/mesh_geometry_pool.hpp"
 #include "rendering/mesh/mesh_loader.hpp"
 #include "rendering/mesh/mesh_uniform.hpp"
 #include "rendering/pipeline_cache.hpp"
@@ -24,11 +25,53 @@
 #include "rendering/shader_compiler.hpp"
 #include "rendering/view.hpp"
 #include "rendering/visibility.hpp"
+#include "task/plugin.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 
 namespace fei {
 
 namespace {
 
+// Pipelines are created on the general task pool; at most this many start
+// backend preparation per frame.
+constexpr std::size_t pipeline_finalize_budget = 16;
+
+// Bytes each asset moves per frame, for byte-based asset budgets.
+std::size_t mesh_byte_size(const Mesh& mesh) {
+    return mesh.vertex_buffer_size() + mesh.index_buffer_size();
+}
+
+std::size_t gpu_mesh_byte_size(const GpuMesh& mesh) {
+    const auto& geometry = mesh.geometry();
+    return static_cast<std::size_t>(geometry.vertex_count()) *
+               mesh.vertex_buffer_layout().layout.stride +
+           static_cast<std::size_t>(geometry.index_count()) *
+               sizeof(std::uint32_t);
+}
+
+std::size_t gpu_image_byte_size(const GpuImage& image) {
+    auto texture = image.texture();
+    if (!texture) {
+        return 0;
+    }
+    return texture_data_size(
+        texture->format(),
+        texture->width(),
+        texture->height(),
+        std::max<uint32>(texture->depth(), 1)
+    );
+}
+
+PipelineCache
+make_pipeline_cache(const GraphicsDevice& device, TaskPool& workers) {
+    PipelineCache cache(device, &workers);
+    cache.set_finalize_budget(pipeline_finalize_budget);
+    return cache;
+}
+
 std::filesystem::path default_shader_cache_root() {
 #ifdef FEI_SHADER_CACHE_PATH
     return FEI_SHADER_CACHE_PATH;
@@ -47,6 +90,13 @@ void process_pipelines(ResRW<PipelineCache> pipeline_cache) {
     pipeline_cache->process_queued_pipelines();
 }
 
+void maintain_mesh_geometry_pool(
+    ResRO<GraphicsDevice> device,
+    ResRW<MeshGeometryPool> pool
+) {
+    pool->maintain(*device);
+}
+
 void begin_render_resource_set_cache(ResRW<RenderResourceSetCache> cache) {
     cache->begin_frame();
 }
@@ -67,6 +117,9 @@ void present_main_swapchain(
 }
 
 void RenderingPlugin::setup(App& app) {
+    if (!app.has_plugin<TaskPlugin>()) {
+        app.add_plugin<TaskPlugin>();
+    }
     app.resource<AssetServer>().emplace_source<ShaderAssetSource>();
     app.add_resource(SlangLibraryShaderCompiler {});
     app.add_resource(ShaderVariantCompiler(
@@ -100,11 +153,23 @@ void RenderingPlugin::setup(App& app) {
             RenderAssetPlugin<Mesh, GpuMesh, GpuMeshAdapter> {},
             RenderingDefaultsPlugin {}
         )
-        .add_resource(PipelineCache(app.resource<GraphicsDevice>()))
+        .add_resource(MeshGeometryPool {})
+        .add_resource(make_pipeline_cache(
+            app.resource<GraphicsDevice>(),
+            app.resource<Tasks>().general()
+        ))
         .add_resource<RenderFrameContext>()
         .add_resource(RenderQueue {})
         .add_resource<RenderResourceSetCache>();
 
+    // Budgets stay unlimited until configured; this only lets byte limits
+    // work out of the box.
+    app.resource<Assets<Mesh>>().apply_budget().byte_size = mesh_byte_size;
+    app.resource<RenderAssets<GpuMesh>>().prepare_budget().byte_size =
+        gpu_mesh_byte_size;
+    app.resource<RenderAssets<GpuImage>>().prepare_budget().byte_size =
+        gpu_image_byte_size;
+
     app.add_resource(ShaderCache(
         app.resource<AssetServer>(),
         app.resource<Assets<Shader>>(),
@@ -113,6 +178,11 @@ void RenderingPlugin::setup(App& app) {
     ));
 
     app.add_systems(PostUpdate, compute_mesh_aabb)
+        .add_systems(
+            RenderUpdate,
+            maintain_mesh_geometry_pool |
+                in_set<RenderingSystems::PrepareAssets>()
+        )
         .add_systems(
             RenderUpdate,
             chain(
@@ -122,16 +192,27 @@ void RenderingPlugin::setup(App& app) {
             ) | in_set<RenderingSystems::PrepareResources>() |
                 in_set<RenderingSystems::PrepareView>()
         )
-        .add_resource<MeshUniforms>()
+        .add_resource(
+            MeshUniforms {
+                .layout = m_settings.mesh_uniform_layout.value_or(
+                    app.resource<GraphicsDevice>()
+                            .supports_vertex_storage_buffers() ?
+                        MeshUniformLayout::StorageBuffer :
+                        MeshUniformLayout::DynamicUniform
+                ),
+            }
+        )
         .add_systems(
             RenderUpdate,
-            check_mesh_visibility | in_set<RenderingSystems::CheckVisibility>()
+            chain(check_mesh_visibility, select_mesh_lods) |
+                in_set<RenderingSystems::CheckVisibility>()
         )
         .add_systems(
             RenderUpdate,
             process_pipelines | in_set<RenderingSystems::PreparePipelines>()
         )
         .add_resource<ViewVisibleEntities>()
+        .add_resource<MeshLodSettings>()
         .add_systems(
             RenderUpdate,
             chain(
@@ -2,10 +2,35 @@
 
 #include "base/log.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace fei {
 
+namespace {
+
+constexpr uint64 pass_submit_bit = uint64 {1} << 32;
+
+uint64 primary_submit_key(uint32 segment) {
+    return uint64 {segment} << 33;
+}
+
+uint64 pass_submit_key(uint32 segment, uint32 order) {
+    return primary_submit_key(segment) | pass_submit_bit | order;
+}
+
+void accumulate_stats(
+    CommandBufferStats& total,
+    const CommandBufferStats& add
+) {
+    total.draws += add.draws;
+    total.draws_saved += add.draws_saved;
+    total.binds += add.binds;
+    total.binds_skipped += add.binds_skipped;
+}
+
+} // namespace
+
 bool RenderFrameContext::begin(const GraphicsDevice& device) {
     if (m_state == State::Recording || m_state == State::Skipped) {
         error("RenderFrameContext::begin called while already recording");
@@ -19,22 +44,99 @@ bool RenderFrameContext::begin(const GraphicsDevice& device) {
         return false;
     }
     m_command_buffer->begin();
+    {
+        std::scoped_lock lock(m_passes->mutex);
+        m_passes->device = &device;
+        m_passes->parallel_recording = device.supports_parallel_recording();
+        m_passes->segment = 0;
+        m_passes->segment_has_passes = false;
+        m_passes->recordings.clear();
+    }
     m_state = State::Recording;
     return true;
 }
 
-std::shared_ptr<CommandBuffer> RenderFrameContext::finish() {
+void RenderFrameContext::split_primary_segment() {
+    if (m_state != State::Recording || !m_passes->segment_has_passes) {
+        return;
+    }
+    auto next = m_passes->device->create_command_buffer();
+    if (!next) {
+        error("GraphicsDevice returned null command buffer for render frame");
+        return;
+    }
+    next->begin();
+    m_passes->recordings.push_back(
+        Recording {
+            .submit_key = primary_submit_key(m_passes->segment),
+            .command_buffer = std::exchange(m_command_buffer, std::move(next)),
+        }
+    );
+    m_passes->segment++;
+    m_passes->segment_has_passes = false;
+}
+
+RenderPassCommands RenderFrameContext::begin_pass(uint32 order) const {
+    if (m_state != State::Recording || !m_command_buffer) {
+        return {};
+    }
+
+    std::unique_lock lock(m_passes->mutex);
+    if (!m_passes->parallel_recording) {
+        // Recording order is submission order on these devices, so passes
+        // take turns on the primary buffer instead.
+        return RenderPassCommands(m_command_buffer.get(), std::move(lock));
+    }
+
+    auto command_buffer = m_passes->device->create_command_buffer();
+    if (!command_buffer) {
+        error("GraphicsDevice returned null command buffer for render pass");
+        return {};
+    }
+    m_passes->recordings.push_back(
+        Recording {
+            .submit_key = pass_submit_key(m_passes->segment, order),
+            .command_buffer = command_buffer,
+        }
+    );
+    m_passes->segment_has_passes = true;
+    lock.unlock();
+
+    command_buffer->begin();
+    return RenderPassCommands(command_buffer.get());
+}
+
+std::vector<std::shared_ptr<CommandBuffer>> RenderFrameContext::finish() {
     if (m_state == State::Skipped) {
         m_state = State::Finished;
-        return nullptr;
+        return {};
     }
     if (m_state != State::Recording || !m_command_buffer) {
         error("RenderFrameContext::finish called while not recording");
-        return nullptr;
+        return {};
+    }
+
+    auto& recordings = m_passes->recordings;
+    recordings.push_back(
+        Recording {
+            .submit_key = primary_submit_key(m_passes->segment),
+            .command_buffer = std::exchange(m_command_buffer, nullptr),
+        }
+    );
+    std::ranges::stable_sort(recordings, {}, &Recording::submit_key);
+
+    std::vector<std::shared_ptr<CommandBuffer>> command_buffers;
+    command_buffers.reserve(recordings.size());
+    m_last_frame_stats = {};
+    for (auto& recording : recordings) {
+        recording.command_buffer->end();
+        accumulate_stats(m_last_frame_stats, recording.command_buffer->stats());
+        command_buffers.push_back(std::move(recording.command_buffer));
     }
-    m_command_buffer->end();
+    recordings.clear();
+    m_passes->device = nullptr;
     m_state = State::Finished;
-    return std::exchange(m_command_buffer, nullptr);
+    return command_buffers;
 }
 
 void begin_render_frame(
@@ -48,9 +150,9 @@ void submit_render_frame(
     ResRO<GraphicsDevice> device,
     ResRW<RenderFrameContext> context
 ) {
-    auto command_buffer = context->finish();
-    if (command_buffer) {
-        device->submit_commands(std::move(command_buffer));
+    auto command_buffers = context->finish();
+    if (!command_buffers.empty()) {
+        device->submit_command_buffers(command_buffers);
     }
 }
 
@@ -2,7 +2,10 @@
 
 #include "base/log.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <numeric>
+#include <tuple>
 #include <utility>
 
 namespace fei {
@@ -35,25 +38,124 @@ void RenderQueue::write_buffer(
         return;
     }
 
-    BufferWrite write {
-        .destination = std::move(destination),
-        .offset = offset,
-        .data = std::vector<std::byte>(size),
-    };
-    std::memcpy(write.data.data(), data, size);
-
+    const auto* bytes = static_cast<const std::byte*>(data);
     std::scoped_lock lock(m_state->mutex);
-    m_state->buffer_writes.push_back(std::move(write));
+    auto& frame = m_state->frames[m_state->frame_index];
+    frame.writes.push_back(
+        BufferWrite {
+            .destination = std::move(destination),
+            .offset = offset,
+            .staging_offset = frame.bytes.size(),
+            .size = size,
+        }
+    );
+    frame.bytes.insert(frame.bytes.end(), bytes, bytes + size);
 }
 
-std::vector<RenderQueue::BufferWrite> RenderQueue::take_buffer_writes() const {
+const RenderQueue::StagingFrame& RenderQueue::take_staging_frame() const {
     std::scoped_lock lock(m_state->mutex);
-    return std::exchange(m_state->buffer_writes, {});
+    auto& taken = m_state->frames[m_state->frame_index];
+    m_state->frame_index = (m_state->frame_index + 1) % staging_frame_count;
+    auto& next = m_state->frames[m_state->frame_index];
+    next.bytes.clear();
+    next.writes.clear();
+    return taken;
 }
 
 std::size_t RenderQueue::pending_buffer_writes() const {
     std::scoped_lock lock(m_state->mutex);
-    return m_state->buffer_writes.size();
+    return m_state->frames[m_state->frame_index].writes.size();
+}
+
+std::size_t RenderQueue::pending_buffer_bytes() const {
+    std::scoped_lock lock(m_state->mutex);
+    return m_state->frames[m_state->frame_index].bytes.size();
+}
+
+RenderQueueStats RenderQueue::last_flush_stats() const {
+    std::scoped_lock lock(m_state->mutex);
+    return m_state->last_flush_stats;
+}
+
+// Writes to the same buffer whose ranges touch or overlap are merged into
+// one update. Bytes are applied in submission order, so the last writer of
+// an overlapping range wins.
+void RenderQueue::record_staging_frame(
+    const StagingFrame& staged,
+    CommandBuffer& command_buffer
+) const {
+    const auto& writes = staged.writes;
+    auto& order = m_state->flush_order;
+    auto& merged = m_state->merged_bytes;
+    order.resize(writes.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::sort(order, [&writes](uint32 lhs, uint32 rhs) {
+        return std::tuple(
+                   writes[lhs].destination.get(),
+                   writes[lhs].offset,
+                   lhs
+               ) <
+               std::tuple(
+                   writes[rhs].destination.get(),
+                   writes[rhs].offset,
+                   rhs
+               );
+    });
+
+    RenderQueueStats stats {
+        .writes = static_cast<uint32>(writes.size()),
+        .bytes = staged.bytes.size(),
+    };
+    command_buffer.reserve_buffer_updates(staged.bytes.size());
+    for (std::size_t begin = 0; begin < order.size();) {
+        const auto& first = writes[order[begin]];
+        const std::size_t range_begin = first.offset;
+        std::size_t range_end = range_begin + first.size;
+        auto end = begin + 1;
+        while (end < order.size()) {
+            const auto& next = writes[order[end]];
+            if (next.destination != first.destination ||
+                next.offset > range_end) {
+                break;
+            }
+            range_end = std::max(range_end, next.offset + next.size);
+            ++end;
+        }
+
+        const auto range_size = range_end - range_begin;
+        if (end - begin == 1) {
+            command_buffer.update_buffer(
+                first.destination,
+                first.offset,
+                staged.bytes.data() + first.staging_offset,
+                first.size
+            );
+        } else {
+            // Indices double as submission order.
+            std::sort(order.begin() + begin, order.begin() + end);
+            merged.resize(range_size);
+            for (auto index = begin; index < end; ++index) {
+                const auto& write = writes[order[index]];
+                std::memcpy(
+                    merged.data() + (write.offset - range_begin),
+                    staged.bytes.data() + write.staging_offset,
+                    write.size
+                );
+            }
+            command_buffer.update_buffer(
+                first.destination,
+                first.offset,
+                merged.data(),
+                range_size
+            );
+        }
+        stats.updates++;
+        stats.update_bytes += range_size;
+        begin = end;
+    }
+
+    std::scoped_lock lock(m_state->mutex);
+    m_state->last_flush_stats = stats;
 }
 
 void flush_render_queue(
@@ -65,14 +167,7 @@ void flush_render_queue(
         return;
     }
 
-    for (auto& write : queue->take_buffer_writes()) {
-        command_buffer->update_buffer(
-            std::move(write.destination),
-            write.offset,
-            write.data.data(),
-            write.data.size()
-        );
-    }
+    queue->record_staging_frame(queue->take_staging_frame(), *command_buffer);
 }
 
 } // namespace fei
@@ -1,6 +1,11 @@
 #include "rendering/resource_set_cache.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <functional>
+#include <string>
+#include <utility>
 
 namespace fei {
 
@@ -12,96 +17,191 @@ void hash_combine(std::size_t& seed, std::size_t value) {
 
 } // namespace
 
-std::size_t RenderResourceSetCache::KeyHash::operator()(const Key& key) const {
-    std::size_t seed = std::hash<const ResourceLayout*> {}(key.layout);
-    for (const auto& resource : key.resources) {
-        hash_combine(
-            seed,
-            std::hash<const BindableResource*> {}(resource.resource)
-        );
-        hash_combine(seed, resource.offset);
-        hash_combine(seed, resource.size);
+RenderResourceSetCache::ResourceKey
+RenderResourceSetCache::resource_key(const BindableResource& resource) {
+    // A raw cast keeps the lookup free of reference count traffic.
+    if (const auto* range = dynamic_cast<const BufferRange*>(&resource)) {
+        return ResourceKey {
+            .resource = range->buffer().get(),
+            .offset = range->offset(),
+            .size = range->size(),
+        };
     }
-    hash_combine(seed, key.resources.size());
-    return seed;
+    return ResourceKey {.resource = &resource};
+}
+
+std::size_t RenderResourceSetCache::entry_bytes(std::size_t resource_count) {
+    // Map node, LRU node and key storage, plus the bindings the resource set
+    // holds.
+    return sizeof(Key) + sizeof(Entry) + 4 * sizeof(void*) +
+           resource_count * (sizeof(ResourceKey) +
+                             sizeof(std::shared_ptr<const BindableResource>));
+}
+
+bool RenderResourceSetCache::KeyEqual::operator()(
+    const Key& lhs,
+    const Key& rhs
+) const {
+    return lhs.layout == rhs.layout && lhs.resources == rhs.resources;
+}
+
+bool RenderResourceSetCache::KeyEqual::operator()(
+    const KeyView& lhs,
+    const Key& rhs
+) const {
+    return lhs.layout == rhs.layout &&
+           std::ranges::equal(lhs.resources, rhs.resources);
+}
+
+void RenderResourceSetCache::touch(Entry& entry) {
+    entry.last_used_frame = m_frame_index;
+    m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+}
+
+void RenderResourceSetCache::erase(Entries::iterator entry) {
+    m_stats.bytes -= entry->second.bytes;
+    m_lru.erase(entry->second.lru);
+    m_entries.erase(entry);
+    ++m_stats.evictions;
+}
+
+void RenderResourceSetCache::evict_over_budget() {
+    // Sets used this frame may still be recorded, so they are never evicted.
+    while (m_stats.bytes > m_budget_bytes && !m_lru.empty()) {
+        auto entry = m_entries.find(*m_lru.back());
+        if (entry->second.last_used_frame == m_frame_index) {
+            break;
+        }
+        erase(entry);
+    }
+    m_stats.size = m_entries.size();
 }
 
 void RenderResourceSetCache::begin_frame() {
+    m_stats.last_frame_requests =
+        m_stats.requests - m_frame_start.requests;
+    m_stats.last_frame_hits = m_stats.hits - m_frame_start.hits;
+    m_stats.last_frame_lookup_ns =
+        m_stats.lookup_ns - m_frame_start.lookup_ns;
+    m_frame_start = m_stats;
+
     ++m_frame_index;
-    for (auto entry = m_entries.begin(); entry != m_entries.end();) {
-        const auto age = m_frame_index >= entry->second.last_used_frame ?
-                             m_frame_index - entry->second.last_used_frame :
-                             0;
-        if (!entry->second.resource_set || age > MaxIdleFrames) {
-            entry = m_entries.erase(entry);
-        } else {
-            ++entry;
+    // Idle entries collect at the back of the LRU list.
+    while (!m_lru.empty()) {
+        auto entry = m_entries.find(*m_lru.back());
+        if (m_frame_index - entry->second.last_used_frame <= MaxIdleFrames) {
+            break;
         }
+        erase(entry);
     }
-    m_stats.size = m_entries.size();
+    evict_over_budget();
 }
 
-std::shared_ptr<ResourceSet> RenderResourceSetCache::get_or_create(
-    const GraphicsDevice& device,
-    std::string name,
-    std::shared_ptr<const ResourceLayout> layout,
-    std::vector<std::shared_ptr<const BindableResource>> resources
+void RenderResourceSetCache::record_latency(
+    std::chrono::steady_clock::time_point start
 ) {
-    ++m_stats.requests;
+    m_stats.lookup_ns += static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start
+        )
+            .count()
+    );
+}
+
+bool RenderResourceSetCache::key_request(
+    const ResourceLayout* layout,
+    std::span<const std::shared_ptr<const BindableResource>> resources
+) {
+    m_request_keys.clear();
     if (!layout) {
-        return nullptr;
+        return false;
     }
-
-    Key key {.layout = layout.get()};
-    key.resources.reserve(resources.size());
+    m_request_hash = std::hash<const ResourceLayout*> {}(layout);
     for (const auto& resource : resources) {
         if (!resource) {
-            return nullptr;
-        }
-        if (auto range =
-                std::dynamic_pointer_cast<const BufferRange>(resource)) {
-            key.resources.push_back(
-                ResourceKey {
-                    .resource = range->buffer().get(),
-                    .offset = range->offset(),
-                    .size = range->size(),
-                }
-            );
-        } else {
-            key.resources.push_back(ResourceKey {.resource = resource.get()});
+            return false;
         }
+        const auto key = resource_key(*resource);
+        hash_combine(
+            m_request_hash,
+            std::hash<const BindableResource*> {}(key.resource)
+        );
+        hash_combine(m_request_hash, key.offset);
+        hash_combine(m_request_hash, key.size);
+        m_request_keys.push_back(key);
     }
+    hash_combine(m_request_hash, resources.size());
+    return true;
+}
 
-    if (auto cached = m_entries.find(key); cached != m_entries.end()) {
-        ++m_stats.hits;
-        cached->second.last_used_frame = m_frame_index;
-        return cached->second.resource_set;
+std::shared_ptr<ResourceSet>
+RenderResourceSetCache::find(const ResourceLayout* layout) {
+    const KeyView view {
+        .layout = layout,
+        .hash = m_request_hash,
+        .resources = m_request_keys,
+    };
+    auto cached = m_entries.find(view);
+    if (cached == m_entries.end()) {
+        return nullptr;
     }
+    ++m_stats.hits;
+    touch(cached->second);
+    return cached->second.resource_set;
+}
+
+std::shared_ptr<ResourceSet> RenderResourceSetCache::create(
+    const GraphicsDevice& device,
+    std::string_view name,
+    std::shared_ptr<const ResourceLayout> layout,
+    std::span<const std::shared_ptr<const BindableResource>> resources
+) {
+    Key key {
+        .layout = layout.get(),
+        .hash = m_request_hash,
+        .resources = m_request_keys,
+    };
 
     ++m_stats.creates;
+    const auto bytes = entry_bytes(resources.size());
     auto resource_set = device.create_resource_set(
         ResourceSetDescription {
-            .layout = layout,
-            .resources = resources,
-            .name = std::move(name),
-        }
-    );
-    m_entries.emplace(
-        std::move(key),
-        Entry {
-            .resource_set = resource_set,
             .layout = std::move(layout),
-            .resources = std::move(resources),
-            .last_used_frame = m_frame_index,
+            .resources = {resources.begin(), resources.end()},
+            .name = std::string(name),
         }
     );
-    m_stats.size = m_entries.size();
+    if (!resource_set) {
+        return nullptr;
+    }
+
+    auto entry = m_entries
+                     .emplace(
+                         std::move(key),
+                         Entry {
+                             .resource_set = resource_set,
+                             .last_used_frame = m_frame_index,
+                             .bytes = bytes,
+                         }
+                     )
+                     .first;
+    m_lru.push_front(&entry->first);
+    entry->second.lru = m_lru.begin();
+    m_stats.bytes += bytes;
+    evict_over_budget();
     return resource_set;
 }
 
+void RenderResourceSetCache::set_budget_bytes(std::size_t bytes) {
+    m_budget_bytes = bytes;
+    evict_over_budget();
+}
+
 void RenderResourceSetCache::clear() {
     m_entries.clear();
+    m_lru.clear();
     m_stats = {};
+    m_frame_start = {};
 }
 
 } // namespace fei
@@ -1,5 +1,6 @@
 #include "shader_artifact_cache.hpp"
 
+#include "base/mapped_file.hpp"
 #include "rendering/shader_compiler.hpp"
 
 #include <algorithm>
@@ -9,10 +10,11 @@
 #include <cstring>
 #include <format>
 #include <fstream>
-#include <iterator>
+#include <mutex>
 #include <span>
 #include <string_view>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -25,6 +27,9 @@ constexpr std::uint32_t ShaderCacheVersion = 1;
 constexpr std::uint64_t MaxCacheCollectionSize = 1'000'000;
 constexpr std::uint64_t MaxCacheStringSize = 64ULL * 1024 * 1024;
 constexpr std::uint64_t MaxCacheBlobSize = 512ULL * 1024 * 1024;
+constexpr std::uint64_t ShaderArchiveMagic = 0x314b434150494546ULL;
+constexpr std::uint32_t ShaderArchiveVersion = 1;
+constexpr const char* ShaderArchiveFileName = "shaders.pack";
 
 class StableHasher {
   private:
@@ -74,6 +79,10 @@ class CacheWriter {
 
     void write(std::span<const std::byte> value) {
         write(static_cast<std::uint64_t>(value.size()));
+        write_raw(value);
+    }
+
+    void write_raw(std::span<const std::byte> value) {
         m_bytes.insert(m_bytes.end(), value.begin(), value.end());
     }
 
@@ -404,19 +413,56 @@ std::optional<std::vector<CachedDependency>> cache_dependencies(
     return cached_dependencies;
 }
 
-std::optional<ShaderVariantCompileOutput> load_shader_cache(
-    const std::filesystem::path& path,
-    std::uint64_t expected_key
-) {
-    std::ifstream input(path, std::ios::binary);
-    if (!input) {
-        return std::nullopt;
+// Content hashes of dependency files, recomputed only when a file's size or
+// write time changes. Every variant of a shader shares its dependencies, so
+// this turns one read per dependency per variant into one per file.
+class DependencyHashes {
+  private:
+    struct Entry {
+        std::filesystem::file_time_type write_time;
+        std::uintmax_t size {0};
+        std::uint64_t hash {0};
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+
+  public:
+    std::optional<std::uint64_t> hash(const std::filesystem::path& path) {
+        std::error_code error;
+        auto write_time = std::filesystem::last_write_time(path, error);
+        auto size = error ? 0 : std::filesystem::file_size(path, error);
+        if (error) {
+            return std::nullopt;
+        }
+
+        std::scoped_lock lock(m_mutex);
+        auto& entry = m_entries[path.generic_string()];
+        if (entry.hash != 0 && entry.write_time == write_time &&
+            entry.size == size) {
+            return entry.hash;
+        }
+        auto hash = shader_file_hash(path);
+        if (!hash) {
+            m_entries.erase(path.generic_string());
+            return std::nullopt;
+        }
+        entry = Entry {
+            .write_time = write_time,
+            .size = size,
+            .hash = *hash,
+        };
+        return hash;
     }
-    std::vector<char> bytes(
-        (std::istreambuf_iterator<char>(input)),
-        std::istreambuf_iterator<char> {}
-    );
-    CacheReader reader(std::as_bytes(std::span(bytes)));
+};
+
+// Parses one artifact, as stored in a loose file or an archive blob.
+std::optional<ShaderVariantCompileOutput> read_shader_cache(
+    std::span<const std::byte> bytes,
+    std::uint64_t expected_key,
+    DependencyHashes& dependency_hashes
+) {
+    CacheReader reader(bytes);
     std::uint64_t magic = 0;
     std::uint32_t version = 0;
     std::uint64_t key = 0;
@@ -440,7 +486,7 @@ std::optional<ShaderVariantCompileOutput> load_shader_cache(
             return std::nullopt;
         }
         auto path = std::filesystem::path(dependency);
-        auto current_hash = shader_file_hash(path);
+        auto current_hash = dependency_hashes.hash(path);
         if (!current_hash || *current_hash != expected_hash) {
             return std::nullopt;
         }
@@ -455,32 +501,39 @@ std::optional<ShaderVariantCompileOutput> load_shader_cache(
     };
 }
 
-void save_shader_cache(
+std::optional<ShaderVariantCompileOutput> load_shader_cache(
     const std::filesystem::path& path,
-    std::uint64_t key,
-    const ShaderCompileRequest& request,
-    const ShaderCompileOutput& output
+    std::uint64_t expected_key,
+    DependencyHashes& dependency_hashes
 ) {
-    auto dependencies = cache_dependencies(request, output);
-    if (!dependencies) {
-        return;
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::nullopt;
     }
+    return read_shader_cache(file->bytes(), expected_key, dependency_hashes);
+}
 
-    CacheWriter writer;
-    writer.write(ShaderCacheMagic);
-    writer.write(ShaderCacheVersion);
-    writer.write(key);
-    write_shader_description(writer, output.description);
-    writer.write(static_cast<std::uint64_t>(dependencies->size()));
-    for (const auto& dependency : *dependencies) {
-        writer.write(dependency.path.generic_string());
-        writer.write(dependency.content_hash);
+std::optional<std::uint64_t>
+shader_cache_file_key(std::span<const std::byte> bytes) {
+    CacheReader reader(bytes);
+    std::uint64_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t key = 0;
+    if (!reader.read(magic) || !reader.read(version) || !reader.read(key) ||
+        magic != ShaderCacheMagic || version != ShaderCacheVersion) {
+        return std::nullopt;
     }
+    return key;
+}
 
+bool write_file_atomically(
+    const std::filesystem::path& path,
+    std::span<const std::byte> bytes
+) {
     std::error_code error;
     std::filesystem::create_directories(path.parent_path(), error);
     if (error) {
-        return;
+        return false;
     }
     auto temporary_path = path;
     temporary_path += ".tmp";
@@ -490,15 +543,14 @@ void save_shader_cache(
             std::ios::binary | std::ios::trunc
         );
         if (!stream) {
-            return;
+            return false;
         }
-        const auto& bytes = writer.bytes();
         stream.write(
             reinterpret_cast<const char*>(bytes.data()),
             static_cast<std::streamsize>(bytes.size())
         );
         if (!stream) {
-            return;
+            return false;
         }
     }
     std::filesystem::remove(path, error);
@@ -506,18 +558,142 @@ void save_shader_cache(
     std::filesystem::rename(temporary_path, path, error);
     if (error) {
         std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    return true;
+}
+
+void save_shader_cache(
+    const std::filesystem::path& path,
+    std::uint64_t key,
+    const ShaderCompileRequest& request,
+    const ShaderCompileOutput& output
+) {
+    auto dependencies = cache_dependencies(request, output);
+    if (!dependencies) {
+        return;
+    }
+
+    CacheWriter writer;
+    writer.write(ShaderCacheMagic);
+    writer.write(ShaderCacheVersion);
+    writer.write(key);
+    write_shader_description(writer, output.description);
+    writer.write(static_cast<std::uint64_t>(dependencies->size()));
+    for (const auto& dependency : *dependencies) {
+        writer.write(dependency.path.generic_string());
+        writer.write(dependency.content_hash);
     }
+
+    (void)write_file_atomically(path, writer.bytes());
 }
 
+struct ShaderArchiveEntry {
+    std::uint64_t key;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+constexpr std::size_t ShaderArchiveHeaderSize =
+    sizeof(ShaderArchiveMagic) + sizeof(ShaderArchiveVersion) +
+    sizeof(std::uint32_t) + sizeof(std::uint64_t);
+
+// Archive layout: magic, version, padding and entry count, then the index
+// sorted by key, then the blobs. Each blob is a loose artifact file verbatim.
+class ShaderArchive {
+  private:
+    MappedFile m_file;
+    std::uint64_t m_entry_count {0};
+
+    explicit ShaderArchive(MappedFile file, std::uint64_t entry_count) :
+        m_file(std::move(file)), m_entry_count(entry_count) {}
+
+  public:
+    static std::optional<ShaderArchive> open(const std::filesystem::path& path
+    ) {
+        auto file = MappedFile::open(path);
+        if (!file) {
+            return std::nullopt;
+        }
+        CacheReader reader(file->bytes());
+        std::uint64_t magic = 0;
+        std::uint32_t version = 0;
+        std::uint32_t padding = 0;
+        std::uint64_t entry_count = 0;
+        if (!reader.read(magic) || !reader.read(version) ||
+            !reader.read(padding) || !reader.read(entry_count) ||
+            magic != ShaderArchiveMagic || version != ShaderArchiveVersion ||
+            entry_count > (file->size() - ShaderArchiveHeaderSize) /
+                              sizeof(ShaderArchiveEntry)) {
+            return std::nullopt;
+        }
+        return ShaderArchive(std::move(*file), entry_count);
+    }
+
+    [[nodiscard]] std::uint64_t entry_count() const { return m_entry_count; }
+
+    [[nodiscard]] ShaderArchiveEntry entry(std::uint64_t index) const {
+        ShaderArchiveEntry entry {};
+        std::memcpy(
+            &entry,
+            m_file.bytes().data() + ShaderArchiveHeaderSize +
+                index * sizeof(ShaderArchiveEntry),
+            sizeof(entry)
+        );
+        return entry;
+    }
+
+    [[nodiscard]] std::optional<std::span<const std::byte>>
+    blob(const ShaderArchiveEntry& entry) const {
+        auto bytes = m_file.bytes();
+        if (entry.offset > bytes.size() ||
+            entry.size > bytes.size() - entry.offset) {
+            return std::nullopt;
+        }
+        return bytes.subspan(
+            static_cast<std::size_t>(entry.offset),
+            static_cast<std::size_t>(entry.size)
+        );
+    }
+
+    [[nodiscard]] std::optional<std::span<const std::byte>>
+    find(std::uint64_t key) const {
+        std::uint64_t first = 0;
+        std::uint64_t last = m_entry_count;
+        while (first < last) {
+            auto middle = first + (last - first) / 2;
+            auto candidate = entry(middle);
+            if (candidate.key == key) {
+                return blob(candidate);
+            }
+            if (candidate.key < key) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return std::nullopt;
+    }
+};
+
 } // namespace
 
+struct ShaderArtifactCache::State {
+    std::optional<ShaderArchive> archive;
+    DependencyHashes dependency_hashes;
+};
+
 ShaderArtifactCache::ShaderArtifactCache(
     std::filesystem::path root,
     std::string compiler_identity
 ) :
-    m_root(std::move(root)), m_compiler_identity(std::move(compiler_identity)) {
+    m_root(std::move(root)), m_compiler_identity(std::move(compiler_identity)),
+    m_state(std::make_unique<State>()) {
+    m_state->archive = ShaderArchive::open(m_root / ShaderArchiveFileName);
 }
 
+ShaderArtifactCache::~ShaderArtifactCache() = default;
+
 std::optional<ShaderArtifactCache::Key>
 ShaderArtifactCache::key(const ShaderCompileRequest& request) const {
     auto value = shader_cache_key(request, m_compiler_identity);
@@ -532,7 +708,16 @@ ShaderArtifactCache::key(const ShaderCompileRequest& request) const {
 
 std::optional<ShaderVariantCompileOutput>
 ShaderArtifactCache::load(const Key& key) const {
-    return load_shader_cache(key.path, key.value);
+    if (m_state->archive) {
+        if (auto blob = m_state->archive->find(key.value)) {
+            auto output =
+                read_shader_cache(*blob, key.value, m_state->dependency_hashes);
+            if (output) {
+                return output;
+            }
+        }
+    }
+    return load_shader_cache(key.path, key.value, m_state->dependency_hashes);
 }
 
 void ShaderArtifactCache::store(
@@ -543,4 +728,112 @@ void ShaderArtifactCache::store(
     save_shader_cache(key.path, key.value, request, output);
 }
 
+Result<ShaderArtifactPackStats, std::string>
+pack_shader_artifacts(const std::filesystem::path& cache_root) {
+    struct PackedArtifact {
+        std::uint64_t key;
+        std::span<const std::byte> bytes;
+    };
+
+    const auto archive_path = cache_root / ShaderArchiveFileName;
+    auto archive = ShaderArchive::open(archive_path);
+    DependencyHashes dependency_hashes;
+    ShaderArtifactPackStats stats;
+    std::vector<MappedFile> loose_files;
+    std::vector<std::filesystem::path> packed_paths;
+    std::vector<PackedArtifact> artifacts;
+
+    // Loose files are newer than the archive, so they go first and win ties.
+    std::error_code error;
+    for (const auto& item :
+         std::filesystem::directory_iterator(cache_root, error)) {
+        if (!item.is_regular_file() || item.path().extension() != ".bin") {
+            continue;
+        }
+        auto file = MappedFile::open(item.path());
+        if (!file) {
+            continue;
+        }
+        packed_paths.push_back(item.path());
+        auto key = shader_cache_file_key(file->bytes());
+        if (!key ||
+            !read_shader_cache(file->bytes(), *key, dependency_hashes)) {
+            stats.dropped++;
+            continue;
+        }
+        artifacts.push_back(
+            PackedArtifact {
+                .key = *key,
+                .bytes = file->bytes(),
+            }
+        );
+        loose_files.push_back(std::move(*file));
+        stats.packed_files++;
+    }
+    if (error) {
+        return failure(
+            "Failed to list shader cache '" + cache_root.string() +
+            "': " + error.message()
+        );
+    }
+
+    if (archive) {
+        for (std::uint64_t i = 0; i < archive->entry_count(); i++) {
+            auto entry = archive->entry(i);
+            auto blob = archive->blob(entry);
+            if (!blob ||
+                !read_shader_cache(*blob, entry.key, dependency_hashes)) {
+                stats.dropped++;
+                continue;
+            }
+            artifacts.push_back(
+                PackedArtifact {
+                    .key = entry.key,
+                    .bytes = *blob,
+                }
+            );
+        }
+    }
+
+    std::ranges::stable_sort(artifacts, {}, &PackedArtifact::key);
+    auto duplicates = std::ranges::unique(artifacts, {}, &PackedArtifact::key);
+    artifacts.erase(duplicates.begin(), duplicates.end());
+
+    CacheWriter writer;
+    writer.write(ShaderArchiveMagic);
+    writer.write(ShaderArchiveVersion);
+    writer.write(std::uint32_t {0});
+    writer.write(static_cast<std::uint64_t>(artifacts.size()));
+    std::uint64_t offset = ShaderArchiveHeaderSize +
+                           artifacts.size() * sizeof(ShaderArchiveEntry);
+    for (const auto& artifact : artifacts) {
+        writer.write(
+            ShaderArchiveEntry {
+                .key = artifact.key,
+                .offset = offset,
+                .size = artifact.bytes.size(),
+            }
+        );
+        offset += artifact.bytes.size();
+    }
+    for (const auto& artifact : artifacts) {
+        writer.write_raw(artifact.bytes);
+    }
+
+    // The old archive must be unmapped before it can be replaced.
+    archive.reset();
+    if (!write_file_atomically(archive_path, writer.bytes())) {
+        return failure(
+            "Failed to write shader archive '" + archive_path.string() + "'"
+        );
+    }
+    loose_files.clear();
+    for (const auto& path : packed_paths) {
+        std::filesystem::remove(path, error);
+    }
+    stats.entries = artifacts.size();
+    stats.bytes = writer.bytes().size();
+    return stats;
+}
+
 } // namespace fei
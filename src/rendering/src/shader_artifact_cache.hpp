@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -11,10 +12,16 @@ struct ShaderCompileOutput;
 struct ShaderCompileRequest;
 struct ShaderVariantCompileOutput;
 
+// Compiled variants keyed by a hash of their compile request. Lookups try the
+// memory-mapped archive written by pack_shader_artifacts() first, then the
+// loose file the runtime stores after a miss.
 class ShaderArtifactCache {
   private:
+    struct State;
+
     std::filesystem::path m_root;
     std::string m_compiler_identity;
+    std::unique_ptr<State> m_state;
 
   public:
     struct Key {
@@ -26,6 +33,7 @@ class ShaderArtifactCache {
         std::filesystem::path root,
         std::string compiler_identity
     );
+    ~ShaderArtifactCache();
 
     [[nodiscard]] std::optional<Key>
     key(const ShaderCompileRequest& request) const;
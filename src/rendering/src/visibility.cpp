@@ -71,6 +71,7 @@ bool Frustum::intersects(
 void VisibleMeshEntities::clear() {
     entities.clear();
     entity_set.clear();
+    lods.clear();
 }
 
 void VisibleMeshEntities::add(Entity entity) {
@@ -83,6 +84,19 @@ bool VisibleMeshEntities::contains(Entity entity) const {
     return entity_set.contains(entity);
 }
 
+void VisibleMeshEntities::set_lod(Entity entity, uint32 lod) {
+    if (lod == 0) {
+        lods.erase(entity);
+        return;
+    }
+    lods[entity] = lod;
+}
+
+uint32 VisibleMeshEntities::lod(Entity entity) const {
+    auto it = lods.find(entity);
+    return it == lods.end() ? 0 : it->second;
+}
+
 void ViewVisibleEntities::clear() {
     meshes.clear();
 }
@@ -91,6 +105,14 @@ VisibleMeshEntities& ViewVisibleEntities::get_or_insert(const ViewId& view_id) {
     return meshes[view_id];
 }
 
+VisibleMeshEntities* ViewVisibleEntities::get(const ViewId& view_id) {
+    auto it = meshes.find(view_id);
+    if (it == meshes.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
 const VisibleMeshEntities*
 ViewVisibleEntities::get(const ViewId& view_id) const {
     auto it = meshes.find(view_id);
@@ -142,4 +164,86 @@ void check_mesh_visibility(
     }
 }
 
+uint32 select_mesh_lod(
+    const GpuMesh& gpu_mesh,
+    const RenderView& view,
+    const Aabb& local_aabb,
+    const Matrix4x4& world_from_local,
+    float error_threshold
+) {
+    const auto& lods = gpu_mesh.lods();
+    if (lods.size() < 2) {
+        return 0;
+    }
+
+    // Clip w grows with view depth under a perspective projection and is
+    // constant under an orthographic one, so projected sizes scale by
+    // 1 / w either way. Take w at the near side of the bounding sphere.
+    auto world_aabb = transform_aabb(local_aabb, world_from_local);
+    const auto center = world_aabb.center();
+    const float radius = world_aabb.extent().magnitude();
+    const auto* w_row = view.clip_from_world[3];
+    const float w = (w_row[0] * center.x) + (w_row[1] * center.y) +
+                    (w_row[2] * center.z) + w_row[3];
+    const float w_per_distance =
+        Vector3(w_row[0], w_row[1], w_row[2]).magnitude();
+    const float near_w = w - (radius * w_per_distance);
+    if (near_w <= 0.0f) {
+        return 0;
+    }
+
+    // Clip space spans 2 units of view height.
+    const float view_height_per_unit =
+        std::abs(view.clip_from_view[1][1]) * 0.5f / near_w;
+    uint32 selected = 0;
+    for (std::size_t level = 1; level < lods.size(); ++level) {
+        const float projected_error =
+            lods[level].error * radius * view_height_per_unit;
+        if (projected_error > error_threshold) {
+            break;
+        }
+        selected = static_cast<uint32>(level);
+    }
+    return selected;
+}
+
+void select_mesh_lods(
+    Query<Entity, const ViewUniformBuffer> query_views,
+    Query<Entity, const Mesh3d, const Transform3d, const Aabb> query_meshes,
+    ResRO<RenderAssets<GpuMesh>> gpu_meshes,
+    ResRO<MeshLodSettings> settings,
+    ResRW<ViewVisibleEntities> visible_entities
+) {
+    for (const auto& [view_entity, view_uniform_buffer] : query_views) {
+        auto view_id = view_uniform_buffer.view.id;
+        if (view_id.source == InvalidViewEntity) {
+            view_id = ViewId::from_source(view_entity);
+        }
+        auto* visible_meshes = visible_entities->get(view_id);
+        if (!visible_meshes || visible_meshes->entities.empty()) {
+            continue;
+        }
+
+        for (const auto& [mesh_entity, mesh, transform, aabb] : query_meshes) {
+            if (!visible_meshes->contains(mesh_entity)) {
+                continue;
+            }
+            auto gpu_mesh = gpu_meshes->get(mesh.mesh);
+            if (!gpu_mesh || gpu_mesh->lod_count() < 2) {
+                continue;
+            }
+            visible_meshes->set_lod(
+                mesh_entity,
+                select_mesh_lod(
+                    *gpu_mesh,
+                    view_uniform_buffer.view,
+                    aabb,
+                    transform.to_matrix(),
+                    settings->error_threshold
+                )
+            );
+        }
+    }
+}
+
 } // namespace fei
@@ -17,6 +17,7 @@ static_assert(std::is_same_v<
 static_assert(std::is_same_v<
               decltype(std::declval<const GpuImage&>().texture()),
               std::shared_ptr<const Texture>>);
+static_assert(!StagedRenderAssetAdapter<GpuImageAdapter, Image, GpuImage>);
 
 TEST_CASE("GpuImage stores the prepared texture", "[rendering][gpu-image]") {
     auto texture = std::make_shared<FakeTexture>(TextureDescription {
@@ -87,3 +88,50 @@ TEST_CASE(
     REQUIRE(upload.bytes.front() == std::byte {1});
     REQUIRE(upload.bytes.back() == std::byte {24});
 }
+
+TEST_CASE(
+    "GpuImageAdapter uploads every stored mip level",
+    "[rendering][gpu-image]"
+) {
+    World world;
+    world.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    auto& device =
+        dynamic_cast<FakeGraphicsDevice&>(world.resource<GraphicsDevice>());
+
+    constexpr std::size_t byte_count = (4 * 4 + 2 * 2 + 1) * 4;
+    auto pixels = std::make_unique<unsigned char[]>(byte_count);
+    for (std::size_t i = 0; i < byte_count; ++i) {
+        pixels[i] = static_cast<unsigned char>(i);
+    }
+    Image image(
+        std::move(pixels),
+        TextureDescription {
+            .width = 4,
+            .height = 4,
+            .depth = 1,
+            .mip_level = 3,
+            .layer = 1,
+            .texture_format = PixelFormat::Rgba8Unorm,
+            .texture_usage = TextureUsage::Sampled,
+            .texture_type = TextureType::Texture2D,
+        },
+        4,
+        3
+    );
+    REQUIRE(image.data_size() == byte_count);
+
+    GpuImageAdapter adapter;
+    auto prepared = adapter.prepare_asset(image, world);
+
+    REQUIRE(prepared.has_value());
+    REQUIRE(device.texture_descriptions[0].mip_level == 3);
+    REQUIRE(device.texture_update_calls.size() == 3);
+    for (std::uint32_t level = 0; level < 3; ++level) {
+        const auto& upload = device.texture_update_calls[level];
+        REQUIRE(upload.mip_level == level);
+        REQUIRE(upload.width == 4u >> level);
+        REQUIRE(upload.height == 4u >> level);
+        REQUIRE(upload.source_data == image.data() + image.level_offset(level));
+        REQUIRE(upload.bytes.size() == image.level_size(level));
+    }
+}
@@ -34,6 +34,7 @@ static_assert(std::is_same_v<
 static_assert(std::is_same_v<
               decltype(std::declval<const GpuMesh&>().index_buffer()),
               Optional<std::shared_ptr<const Buffer>>>);
+static_assert(StagedRenderAssetAdapter<GpuMeshAdapter, Mesh, GpuMesh>);
 
 namespace {
 
@@ -0,0 +1,207 @@
+#include "rendering/mesh/mesh_binary.hpp"
+
+#include "asset/io.hpp"
+#include "ecs/world.hpp"
+#include "rendering/mesh/mesh.hpp"
+#include "rendering/mesh/mesh_factory.hpp"
+#include "test_graphics_device.hpp"
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+using namespace fei;
+using namespace fei::rendering_test;
+
+namespace {
+
+Mesh triangle_mesh() {
+    Mesh mesh(RenderPrimitive::Triangles);
+    mesh.insert_attribute(
+        Mesh::ATTRIBUTE_POSITION,
+        std::vector<std::array<float, 3>> {
+            {0.0f, 0.0f, 0.0f},
+            {2.0f, 0.0f, 0.0f},
+            {0.0f, 3.0f, -1.0f},
+        }
+    );
+    mesh.insert_attribute(
+        Mesh::ATTRIBUTE_UV_0,
+        std::vector<std::array<float, 2>> {
+            {0.0f, 0.0f},
+            {1.0f, 0.0f},
+            {0.0f, 1.0f},
+        }
+    );
+    mesh.insert_indices({0, 1, 2});
+    return mesh;
+}
+
+Reader owning_reader(const std::vector<std::byte>& bytes) {
+    return Reader(
+        std::string_view(
+            reinterpret_cast<const char*>(bytes.data()),
+            bytes.size()
+        )
+    );
+}
+
+bool same_bytes(
+    std::span<const std::byte> bytes,
+    const std::unique_ptr<std::byte[]>& expected
+) {
+    return std::memcmp(bytes.data(), expected.get(), bytes.size()) == 0;
+}
+
+bool same_layout(
+    const MeshVertexBufferLayout& lhs,
+    const MeshVertexBufferLayout& rhs
+) {
+    return lhs.attribute_ids == rhs.attribute_ids &&
+           std::hash<MeshVertexBufferLayout> {}(lhs) ==
+               std::hash<MeshVertexBufferLayout> {}(rhs);
+}
+
+} // namespace
+
+TEST_CASE(
+    "Mesh binaries decode into packed meshes viewing the file bytes",
+    "[rendering][mesh-binary]"
+) {
+    const auto source = triangle_mesh();
+    auto bytes = encode_mesh_binary(source);
+    REQUIRE(bytes.has_value());
+    REQUIRE(is_mesh_binary(*bytes));
+
+    const auto reader = owning_reader(*bytes);
+    auto mesh = decode_mesh_binary(reader);
+    REQUIRE(mesh.has_value());
+    auto packed = mesh->packed();
+    REQUIRE(packed.has_value());
+    REQUIRE(packed->owner);
+
+    REQUIRE(mesh->primitive() == RenderPrimitive::Triangles);
+    REQUIRE(mesh->vertex_count() == 3);
+    REQUIRE(mesh->vertex_size() == source.vertex_size());
+    REQUIRE(same_layout(
+        mesh->vertex_buffer_layout(),
+        source.vertex_buffer_layout()
+    ));
+    REQUIRE(packed->vertices.size() == source.vertex_buffer_size());
+    REQUIRE(same_bytes(packed->vertices, source.vertex_buffer_data()));
+    REQUIRE(packed->indices.size() == source.index_buffer_size());
+    REQUIRE(same_bytes(packed->indices, source.index_buffer_data()));
+    REQUIRE(
+        reinterpret_cast<std::uintptr_t>(packed->vertices.data()) % 16 == 0
+    );
+
+    const auto aabb = mesh->compute_aabb();
+    REQUIRE(aabb.min == Vector3(0.0f, 0.0f, -1.0f));
+    REQUIRE(aabb.max == Vector3(2.0f, 3.0f, 0.0f));
+}
+
+TEST_CASE(
+    "Mesh binaries carry levels of detail",
+    "[rendering][mesh-binary]"
+) {
+    auto source = MeshFactory::create_sphere(1.0f, 32, 16);
+    REQUIRE(source->generate_lods() > 0);
+    const auto ranges = source->lod_ranges();
+
+    auto bytes = encode_mesh_binary(*source);
+    REQUIRE(bytes.has_value());
+    auto mesh = decode_mesh_binary(owning_reader(*bytes));
+    REQUIRE(mesh.has_value());
+
+    const auto decoded = mesh->lod_ranges();
+    REQUIRE(decoded.size() == ranges.size());
+    for (std::size_t level = 0; level < ranges.size(); ++level) {
+        REQUIRE(decoded[level].first_index == ranges[level].first_index);
+        REQUIRE(decoded[level].index_count == ranges[level].index_count);
+        REQUIRE(decoded[level].error == ranges[level].error);
+    }
+    REQUIRE(mesh->packed()->indices.size() == source->index_buffer_size());
+    REQUIRE(same_bytes(mesh->packed()->indices, source->index_buffer_data()));
+
+    World world;
+    world.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    GpuMeshAdapter adapter;
+    auto gpu_mesh = adapter.prepare_asset(*mesh, world);
+    REQUIRE(gpu_mesh.has_value());
+    REQUIRE(gpu_mesh->lod_count() == ranges.size());
+    REQUIRE(gpu_mesh->index_count() == ranges[0].index_count);
+    REQUIRE(gpu_mesh->first_index(1) == ranges[1].first_index);
+    REQUIRE(gpu_mesh->index_count(99) == ranges.back().index_count);
+}
+
+TEST_CASE(
+    "Mesh binaries with bad ranges are rejected",
+    "[rendering][mesh-binary]"
+) {
+    auto bytes = encode_mesh_binary(triangle_mesh());
+    REQUIRE(bytes.has_value());
+
+    SECTION("truncated") {
+        bytes->resize(bytes->size() - 1);
+        REQUIRE_FALSE(decode_mesh_binary(owning_reader(*bytes)).has_value());
+    }
+
+    SECTION("out-of-range index") {
+        const std::uint32_t index = 3;
+        std::memcpy(
+            bytes->data() + bytes->size() - sizeof(index),
+            &index,
+            sizeof(index)
+        );
+        REQUIRE_FALSE(decode_mesh_binary(owning_reader(*bytes)).has_value());
+    }
+
+    SECTION("not a mesh binary") {
+        REQUIRE_FALSE(is_mesh_binary(owning_reader({}).bytes()));
+        (*bytes)[0] = std::byte {'X'};
+        REQUIRE_FALSE(decode_mesh_binary(owning_reader(*bytes)).has_value());
+    }
+}
+
+TEST_CASE(
+    "GpuMeshAdapter uploads packed meshes from their streams",
+    "[rendering][mesh-binary]"
+) {
+    World world;
+    world.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    auto& device =
+        dynamic_cast<FakeGraphicsDevice&>(world.resource<GraphicsDevice>());
+
+    auto bytes = encode_mesh_binary(triangle_mesh());
+    REQUIRE(bytes.has_value());
+    auto mesh = decode_mesh_binary(owning_reader(*bytes));
+    REQUIRE(mesh.has_value());
+
+    GpuMeshAdapter adapter;
+    auto gpu_mesh = adapter.prepare_asset(*mesh, world);
+    REQUIRE(gpu_mesh.has_value());
+    REQUIRE(gpu_mesh->vertex_count() == 3);
+    REQUIRE(gpu_mesh->index_count() == 3);
+    REQUIRE(same_layout(
+        gpu_mesh->vertex_buffer_layout(),
+        mesh->vertex_buffer_layout()
+    ));
+
+    REQUIRE(device.buffer_update_calls.size() == 2);
+    const auto packed = mesh->packed();
+    const auto& vertex_upload = device.buffer_update_calls[0];
+    REQUIRE(vertex_upload.bytes.size() == packed->vertices.size());
+    REQUIRE(
+        std::memcmp(
+            vertex_upload.bytes.data(),
+            packed->vertices.data(),
+            packed->vertices.size()
+        ) == 0
+    );
+}
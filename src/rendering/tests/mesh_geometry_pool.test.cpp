@@ -0,0 +1,281 @@
+#include "rendering/mesh/mesh_geometry_pool.hpp"
+
+#include "ecs/world.hpp"
+#include "rendering/mesh/mesh.hpp"
+#include "test_graphics_device.hpp"
+
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace fei;
+using namespace fei::rendering_test;
+
+namespace {
+
+constexpr uint32 vertex_stride = 12;
+
+std::vector<std::byte> vertex_bytes(std::size_t vertex_count) {
+    return std::vector<std::byte>(vertex_count * vertex_stride);
+}
+
+std::vector<std::byte> index_bytes(std::size_t index_count) {
+    return std::vector<std::byte>(index_count * sizeof(std::uint32_t));
+}
+
+MeshGeometryPoolConfig small_slabs() {
+    return MeshGeometryPoolConfig {
+        .vertex_slab_bytes = 16 * vertex_stride,
+        .index_slab_bytes = 32 * sizeof(std::uint32_t),
+    };
+}
+
+} // namespace
+
+TEST_CASE(
+    "RangeAllocator allocates first fit and merges released neighbours",
+    "[rendering][mesh-pool]"
+) {
+    RangeAllocator allocator(16);
+
+    auto first = allocator.allocate(4);
+    auto second = allocator.allocate(4);
+    auto third = allocator.allocate(4);
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    REQUIRE(third.has_value());
+    REQUIRE(*first == 0);
+    REQUIRE(*second == 4);
+    REQUIRE(*third == 8);
+    REQUIRE(allocator.used() == 12);
+    REQUIRE_FALSE(allocator.allocate(8).has_value());
+
+    allocator.release(*first, 4);
+    allocator.release(*third, 4);
+    REQUIRE(allocator.free_range_count() == 2);
+    REQUIRE(allocator.largest_free_range() == 8);
+
+    allocator.release(*second, 4);
+    REQUIRE(allocator.free_range_count() == 1);
+    REQUIRE(allocator.largest_free_range() == 16);
+    auto whole = allocator.allocate(16);
+    REQUIRE(whole.has_value());
+    REQUIRE(*whole == 0);
+}
+
+TEST_CASE(
+    "MeshGeometryPool sub-allocates meshes of one layout from shared buffers",
+    "[rendering][mesh-pool]"
+) {
+    FakeGraphicsDevice device;
+    MeshGeometryPool pool(small_slabs());
+
+    auto first = pool.allocate(
+        device,
+        1,
+        vertex_stride,
+        vertex_bytes(3),
+        index_bytes(3)
+    );
+    auto second = pool.allocate(
+        device,
+        1,
+        vertex_stride,
+        vertex_bytes(4),
+        index_bytes(6)
+    );
+    auto other_layout =
+        pool.allocate(device, 2, vertex_stride, vertex_bytes(3), {});
+
+    REQUIRE(first);
+    REQUIRE(second);
+    REQUIRE(other_layout);
+    REQUIRE(first->pooled());
+    REQUIRE(first->vertex_buffer() == second->vertex_buffer());
+    REQUIRE(first->index_buffer() == second->index_buffer());
+    REQUIRE(other_layout->vertex_buffer() != first->vertex_buffer());
+    REQUIRE_FALSE(other_layout->index_buffer());
+
+    REQUIRE(second->base_vertex() == 3);
+    REQUIRE(second->first_index() == 3);
+    REQUIRE(second->index_count() == 6);
+    REQUIRE(device.buffer_descriptions.size() == 3);
+
+    const auto& upload = device.buffer_update_calls[2];
+    REQUIRE(upload.buffer == second->vertex_buffer());
+    REQUIRE(upload.offset == 3 * vertex_stride);
+    REQUIRE(upload.bytes.size() == 4 * vertex_stride);
+
+    auto stats = pool.stats();
+    REQUIRE(stats.vertex_slabs == 2);
+    REQUIRE(stats.index_slabs == 1);
+    REQUIRE(stats.geometries == 3);
+    REQUIRE(stats.vertex_used_bytes == 10 * vertex_stride);
+}
+
+TEST_CASE(
+    "MeshGeometryPool reuses freed ranges after the frames in flight",
+    "[rendering][mesh-pool]"
+) {
+    FakeGraphicsDevice device;
+    MeshGeometryPool pool(small_slabs());
+
+    auto keep = pool.allocate(
+        device,
+        1,
+        vertex_stride,
+        vertex_bytes(4),
+        index_bytes(3)
+    );
+    auto freed = pool.allocate(
+        device,
+        1,
+        vertex_stride,
+        vertex_bytes(4),
+        index_bytes(3)
+    );
+    REQUIRE(freed->base_vertex() == 4);
+    freed.reset();
+
+    pool.maintain(device);
+    auto pending = pool.allocate(
+        device,
+        1,
+        vertex_stride,
+        vertex_bytes(4),
+        index_bytes(3)
+    );
+    REQUIRE(pending->base_vertex() == 8);
+
+    pool.maintain(device);
+    auto reused = pool.allocate(
+        device,
+        1,
+        vertex_stride,
+        vertex_bytes(4),
+        index_bytes(3)
+    );
+    REQUIRE(reused->base_vertex() == 4);
+    REQUIRE(reused->vertex_buffer() == keep->vertex_buffer());
+    REQUIRE(pool.stats().vertex_slabs == 1);
+}
+
+TEST_CASE(
+    "MeshGeometryPool empties sparse slabs and releases them",
+    "[rendering][mesh-pool]"
+) {
+    FakeGraphicsDevice device;
+    device.buffer_copy_supported = true;
+    MeshGeometryPool pool(small_slabs());
+
+    std::vector<std::shared_ptr<MeshGeometry>> filler;
+    for (int i = 0; i < 3; ++i) {
+        filler.push_back(
+            pool.allocate(device, 1, vertex_stride, vertex_bytes(4), {})
+        );
+    }
+    auto straggler =
+        pool.allocate(device, 1, vertex_stride, vertex_bytes(4), {});
+    auto overflow =
+        pool.allocate(device, 1, vertex_stride, vertex_bytes(2), {});
+    const auto sparse_buffer = overflow->vertex_buffer();
+    REQUIRE(sparse_buffer != straggler->vertex_buffer());
+    REQUIRE(pool.stats().vertex_slabs == 2);
+
+    // Freeing one filler mesh leaves room for the overflow in the first slab.
+    filler.pop_back();
+    pool.maintain(device);
+    pool.maintain(device);
+    REQUIRE(device.buffer_copy_calls.size() == 1);
+    const auto& copy = device.buffer_copy_calls.front();
+    REQUIRE(copy.src == sparse_buffer);
+    REQUIRE(copy.dst == straggler->vertex_buffer());
+    REQUIRE(copy.size == 2 * vertex_stride);
+    REQUIRE(overflow->vertex_buffer() == straggler->vertex_buffer());
+    REQUIRE(overflow->base_vertex() == 8);
+
+    pool.maintain(device);
+    pool.maintain(device);
+    auto stats = pool.stats();
+    REQUIRE(stats.vertex_slabs == 1);
+    REQUIRE(stats.released_slabs == 1);
+    REQUIRE(stats.moved_bytes == 2 * vertex_stride);
+}
+
+TEST_CASE(
+    "MeshGeometryPool moves residents larger than the defragment budget",
+    "[rendering][mesh-pool]"
+) {
+    FakeGraphicsDevice device;
+    device.buffer_copy_supported = true;
+    auto config = small_slabs();
+    config.defragment_threshold = 0.5f;
+    config.defragment_budget_bytes = vertex_stride;
+    MeshGeometryPool pool(config);
+
+    std::vector<std::shared_ptr<MeshGeometry>> filler;
+    for (int i = 0; i < 4; ++i) {
+        filler.push_back(
+            pool.allocate(device, 1, vertex_stride, vertex_bytes(4), {})
+        );
+    }
+    auto first = pool.allocate(device, 1, vertex_stride, vertex_bytes(2), {});
+    auto second =
+        pool.allocate(device, 1, vertex_stride, vertex_bytes(2), {});
+    REQUIRE(first->vertex_buffer() != filler.front()->vertex_buffer());
+    REQUIRE(pool.stats().vertex_slabs == 2);
+
+    // Both sparse residents are twice the budget; one moves per call.
+    filler.pop_back();
+    pool.maintain(device);
+    pool.maintain(device);
+    REQUIRE(device.buffer_copy_calls.size() == 1);
+
+    pool.maintain(device);
+    REQUIRE(device.buffer_copy_calls.size() == 2);
+    REQUIRE(first->vertex_buffer() == filler.front()->vertex_buffer());
+    REQUIRE(second->vertex_buffer() == filler.front()->vertex_buffer());
+
+    pool.maintain(device);
+    pool.maintain(device);
+    REQUIRE(pool.stats().vertex_slabs == 1);
+    REQUIRE(pool.stats().moved_bytes == 4 * vertex_stride);
+}
+
+TEST_CASE(
+    "GpuMeshAdapter allocates from the MeshGeometryPool when present",
+    "[rendering][mesh-pool]"
+) {
+    World world;
+    world.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    world.add_resource(MeshGeometryPool {});
+    auto& device =
+        dynamic_cast<FakeGraphicsDevice&>(world.resource<GraphicsDevice>());
+
+    Mesh mesh(RenderPrimitive::Triangles);
+    mesh.insert_attribute(
+        Mesh::ATTRIBUTE_POSITION,
+        std::vector<std::array<float, 3>> {
+            {0.0f, 0.0f, 0.0f},
+            {1.0f, 0.0f, 0.0f},
+            {0.0f, 1.0f, 0.0f},
+        }
+    );
+    mesh.insert_indices({0, 1, 2});
+
+    GpuMeshAdapter adapter;
+    auto first = adapter.prepare_asset(mesh, world);
+    auto second = adapter.prepare_asset(mesh, world);
+
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    REQUIRE(device.buffer_descriptions.size() == 2);
+    REQUIRE(first->vertex_buffer() == second->vertex_buffer());
+    REQUIRE(second->base_vertex() == 3);
+    REQUIRE(second->first_index() == 3);
+    REQUIRE(second->index_count() == 3);
+    REQUIRE(second->vertex_count() == 3);
+}
@@ -0,0 +1,315 @@
+#include "rendering/mesh/mesh.hpp"
+
+#include "task/plugin.hpp"
+
+#include <array>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mikktspace.h>
+#include <numbers>
+#include <vector>
+
+using namespace fei;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+// Flat grid in the XY plane spanning [0, side - 1] on both axes, wound so
+// its smooth normals point along +Z.
+Mesh grid_mesh(std::uint32_t side) {
+    std::vector<std::array<float, 3>> positions;
+    positions.reserve(std::size_t {side} * side);
+    for (std::uint32_t y = 0; y < side; ++y) {
+        for (std::uint32_t x = 0; x < side; ++x) {
+            positions.push_back(
+                {static_cast<float>(x), static_cast<float>(y), 0.0f}
+            );
+        }
+    }
+    std::vector<std::uint32_t> indices;
+    indices.reserve(std::size_t {side - 1} * (side - 1) * 6);
+    for (std::uint32_t y = 0; y + 1 < side; ++y) {
+        for (std::uint32_t x = 0; x + 1 < side; ++x) {
+            const auto corner = (y * side) + x;
+            indices.insert(
+                indices.end(),
+                {corner,
+                 corner + side,
+                 corner + 1,
+                 corner + 1,
+                 corner + side,
+                 corner + side + 1}
+            );
+        }
+    }
+
+    Mesh mesh(RenderPrimitive::Triangles);
+    mesh.insert_attribute(Mesh::ATTRIBUTE_POSITION, std::move(positions));
+    mesh.insert_indices(std::move(indices));
+    return mesh;
+}
+
+struct SphereData {
+    std::vector<std::array<float, 3>> positions;
+    std::vector<std::array<float, 3>> normals;
+    std::vector<std::array<float, 2>> uvs;
+    std::vector<std::uint32_t> indices;
+};
+
+// UV sphere whose seam column is duplicated at u = 0 and u = 1, so vertices
+// there share a position and normal but not a UV.
+SphereData sphere_data(std::uint32_t segments, std::uint32_t rings) {
+    SphereData data;
+    for (std::uint32_t ring = 0; ring <= rings; ++ring) {
+        const float v = static_cast<float>(ring) / static_cast<float>(rings);
+        const float theta = v * std::numbers::pi_v<float>;
+        for (std::uint32_t segment = 0; segment <= segments; ++segment) {
+            const float u =
+                static_cast<float>(segment) / static_cast<float>(segments);
+            const float phi = u * 2.0f * std::numbers::pi_v<float>;
+            const std::array normal {
+                std::sin(theta) * std::cos(phi),
+                std::cos(theta),
+                std::sin(theta) * std::sin(phi),
+            };
+            data.positions.push_back(normal);
+            data.normals.push_back(normal);
+            data.uvs.push_back({u, v});
+        }
+    }
+    for (std::uint32_t ring = 0; ring < rings; ++ring) {
+        for (std::uint32_t segment = 0; segment < segments; ++segment) {
+            const auto corner = (ring * (segments + 1)) + segment;
+            const auto below = corner + segments + 1;
+            data.indices.insert(
+                data.indices.end(),
+                {corner, corner + 1, below, corner + 1, below + 1, below}
+            );
+        }
+    }
+    return data;
+}
+
+// One MikkTSpace pass over every face, the reference for chunked tangents.
+std::vector<std::array<float, 4>> serial_tangents(const SphereData& data) {
+    struct UserData {
+        const SphereData* data;
+        std::vector<std::array<float, 4>> tangents;
+
+        std::uint32_t index(int face, int vert) const {
+            return data->indices[(static_cast<std::size_t>(face) * 3) + vert];
+        }
+    };
+    UserData user_data {
+        .data = &data,
+        .tangents = std::vector<std::array<float, 4>>(data.positions.size()),
+    };
+
+    SMikkTSpaceInterface iface {};
+    iface.m_getNumFaces = [](const SMikkTSpaceContext* ctx) -> int {
+        const auto* d = static_cast<const UserData*>(ctx->m_pUserData);
+        return static_cast<int>(d->data->indices.size() / 3);
+    };
+    iface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext*,
+                                      const int) -> int {
+        return 3;
+    };
+    iface.m_getPosition = [](const SMikkTSpaceContext* ctx,
+                             float pos[],
+                             const int face,
+                             const int vert) {
+        const auto* d = static_cast<const UserData*>(ctx->m_pUserData);
+        const auto& position = d->data->positions[d->index(face, vert)];
+        std::memcpy(pos, position.data(), sizeof(position));
+    };
+    iface.m_getNormal = [](const SMikkTSpaceContext* ctx,
+                           float norm[],
+                           const int face,
+                           const int vert) {
+        const auto* d = static_cast<const UserData*>(ctx->m_pUserData);
+        const auto& normal = d->data->normals[d->index(face, vert)];
+        std::memcpy(norm, normal.data(), sizeof(normal));
+    };
+    iface.m_getTexCoord = [](const SMikkTSpaceContext* ctx,
+                             float uv[],
+                             const int face,
+                             const int vert) {
+        const auto* d = static_cast<const UserData*>(ctx->m_pUserData);
+        const auto& texcoord = d->data->uvs[d->index(face, vert)];
+        std::memcpy(uv, texcoord.data(), sizeof(texcoord));
+    };
+    iface.m_setTSpaceBasic = [](const SMikkTSpaceContext* ctx,
+                                const float fv_tangent[],
+                                const float f_sign,
+                                const int face,
+                                const int vert) {
+        auto* d = static_cast<UserData*>(ctx->m_pUserData);
+        d->tangents[d->index(face, vert)] =
+            {fv_tangent[0], fv_tangent[1], fv_tangent[2], f_sign};
+    };
+
+    SMikkTSpaceContext ctx {};
+    ctx.m_pInterface = &iface;
+    ctx.m_pUserData = &user_data;
+    genTangSpaceDefault(&ctx);
+    return std::move(user_data.tangents);
+}
+
+} // namespace
+
+TEST_CASE(
+    "Mesh kernels give whole-mesh results on meshes split into chunks",
+    "[rendering][mesh]"
+) {
+    // 600 x 600 vertices spans several vertex chunks and smooth-normal
+    // blocks.
+    Tasks tasks(4);
+    constexpr std::uint32_t side = 600;
+    auto mesh = grid_mesh(side);
+
+    mesh.compute_smooth_normals();
+    REQUIRE(mesh.has_attribute(Mesh::ATTRIBUTE_NORMAL.id));
+    const auto& normals =
+        mesh.get_attribute(Mesh::ATTRIBUTE_NORMAL.id).as_float3().value();
+    REQUIRE(normals.size() == std::size_t {side} * side);
+    std::size_t tilted = 0;
+    for (const auto& normal : normals) {
+        if (normal[0] != 0.0f || normal[1] != 0.0f ||
+            std::abs(normal[2] - 1.0f) > 1e-6f) {
+            ++tilted;
+        }
+    }
+    REQUIRE(tilted == 0);
+
+    auto bounds = mesh.compute_aabb();
+    REQUIRE(bounds.min == Vector3(0.0f, 0.0f, 0.0f));
+    REQUIRE(bounds.max == Vector3(599.0f, 599.0f, 0.0f));
+
+    mesh.center_positions();
+    mesh.scale_by(Vector3(2.0f));
+    bounds = mesh.compute_aabb();
+    REQUIRE(bounds.min == Vector3(-599.0f, -599.0f, 0.0f));
+    REQUIRE(bounds.max == Vector3(599.0f, 599.0f, 0.0f));
+
+    mesh.rotate_by(Vector3(0.0f, 0.0f, 90.0f));
+    const auto& positions =
+        mesh.get_attribute(Mesh::ATTRIBUTE_POSITION.id).as_float3().value();
+    const auto& last = positions.back();
+    REQUIRE_THAT(last[0], WithinAbs(-599.0f, 1e-3f));
+    REQUIRE_THAT(last[1], WithinAbs(599.0f, 1e-3f));
+    const auto& rotated_normal =
+        mesh.get_attribute(Mesh::ATTRIBUTE_NORMAL.id).as_float3()->back();
+    REQUIRE_THAT(rotated_normal[2], WithinAbs(1.0f, 1e-6f));
+}
+
+TEST_CASE(
+    "Chunked tangents match a single MikkTSpace pass",
+    "[rendering][mesh]"
+) {
+    // 2 x 320 x 256 faces spans two 128K-face tangent chunks.
+    Tasks tasks(4);
+    const auto data = sphere_data(320, 256);
+    REQUIRE(data.indices.size() / 3 > std::size_t {128 * 1024});
+    const auto reference = serial_tangents(data);
+    const auto count_mismatches =
+        [](const std::vector<std::array<float, 4>>& tangents,
+           const std::vector<std::array<float, 4>>& expected) {
+            REQUIRE(tangents.size() == expected.size());
+            std::size_t mismatches = 0;
+            for (std::size_t v = 0; v < tangents.size(); ++v) {
+                for (int i = 0; i < 4; ++i) {
+                    if (std::abs(tangents[v][i] - expected[v][i]) > 1e-5f) {
+                        ++mismatches;
+                    }
+                }
+            }
+            return mismatches;
+        };
+
+    SECTION("indexed") {
+        Mesh mesh(RenderPrimitive::Triangles);
+        mesh.insert_attribute(Mesh::ATTRIBUTE_POSITION, data.positions);
+        mesh.insert_attribute(Mesh::ATTRIBUTE_NORMAL, data.normals);
+        mesh.insert_attribute(Mesh::ATTRIBUTE_UV_0, data.uvs);
+        mesh.insert_indices(data.indices);
+        mesh.generate_tangents();
+
+        const auto& tangents =
+            mesh.get_attribute(Mesh::ATTRIBUTE_TANGENT.id).as_float4().value();
+        REQUIRE(count_mismatches(tangents, reference) == 0);
+    }
+
+    SECTION("unindexed") {
+        // Every corner is its own vertex, so faces only meet through welds.
+        SphereData corners;
+        for (auto index : data.indices) {
+            corners.indices.push_back(
+                static_cast<std::uint32_t>(corners.positions.size())
+            );
+            corners.positions.push_back(data.positions[index]);
+            corners.normals.push_back(data.normals[index]);
+            corners.uvs.push_back(data.uvs[index]);
+        }
+        const auto corner_reference = serial_tangents(corners);
+
+        Mesh mesh(RenderPrimitive::Triangles);
+        mesh.insert_attribute(Mesh::ATTRIBUTE_POSITION, corners.positions);
+        mesh.insert_attribute(Mesh::ATTRIBUTE_NORMAL, corners.normals);
+        mesh.insert_attribute(Mesh::ATTRIBUTE_UV_0, corners.uvs);
+        mesh.generate_tangents();
+
+        const auto& tangents =
+            mesh.get_attribute(Mesh::ATTRIBUTE_TANGENT.id).as_float4().value();
+        REQUIRE(count_mismatches(tangents, corner_reference) == 0);
+    }
+}
+
+TEST_CASE(
+    "Mesh kernels reject out-of-range indices in any chunk",
+    "[rendering][mesh]"
+) {
+    auto mesh = grid_mesh(600);
+    std::vector<std::uint32_t> broken(
+        mesh.index_buffer_size() / sizeof(std::uint32_t)
+    );
+    const auto index_data = mesh.index_buffer_data();
+    std::memcpy(broken.data(), index_data.get(), mesh.index_buffer_size());
+    broken.back() = 600 * 600;
+    mesh.insert_indices(std::move(broken));
+
+    mesh.compute_smooth_normals();
+    REQUIRE_FALSE(mesh.has_attribute(Mesh::ATTRIBUTE_NORMAL.id));
+    const auto bounds = mesh.compute_aabb();
+    REQUIRE(bounds.min == Vector3(0.0f));
+    REQUIRE(bounds.max == Vector3(0.0f));
+}
+
+TEST_CASE("Mesh kernels on a 5M-vertex mesh", "[.][benchmark][mesh]") {
+    Tasks tasks;
+    // sqrt(5M) rounded up.
+    constexpr std::uint32_t side = 2237;
+    const auto source = grid_mesh(side);
+
+    BENCHMARK_ADVANCED("compute_smooth_normals")(
+        Catch::Benchmark::Chronometer meter
+    ) {
+        std::vector<Mesh> meshes(meter.runs(), source);
+        meter.measure([&](int run) {
+            meshes[run].compute_smooth_normals();
+        });
+    };
+    BENCHMARK("compute_aabb") {
+        return source.compute_aabb();
+    };
+    BENCHMARK_ADVANCED("rotate_by")(Catch::Benchmark::Chronometer meter) {
+        auto mesh = source;
+        meter.measure([&] {
+            mesh.rotate_by(Vector3(0.0f, 0.0f, 1.0f));
+        });
+    };
+}
@@ -0,0 +1,189 @@
+#include "rendering/mesh/mesh_optimize.hpp"
+
+#include "rendering/mesh/mesh.hpp"
+#include "rendering/mesh/mesh_factory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace fei;
+
+namespace {
+
+using Triangle = std::array<std::array<float, 3>, 3>;
+
+// Triangles by corner positions, rotated to start at the smallest corner so
+// reordered index buffers compare equal when they draw the same faces.
+std::vector<Triangle> triangles_of(const Mesh& mesh) {
+    const auto& positions =
+        mesh.get_attribute(Mesh::ATTRIBUTE_POSITION.id).as_float3().value();
+    const auto index_data = mesh.index_buffer_data();
+    const auto* indices =
+        reinterpret_cast<const std::uint32_t*>(index_data.get());
+    const auto index_count = mesh.index_buffer_size() / sizeof(std::uint32_t);
+
+    std::vector<Triangle> triangles;
+    for (std::size_t i = 0; i + 2 < index_count; i += 3) {
+        Triangle triangle {
+            positions[indices[i]],
+            positions[indices[i + 1]],
+            positions[indices[i + 2]],
+        };
+        std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+        triangles.push_back(triangle);
+    }
+    std::ranges::sort(triangles);
+    return triangles;
+}
+
+std::vector<std::uint32_t> indices_of(const Mesh& mesh) {
+    const auto index_data = mesh.index_buffer_data();
+    const auto* indices =
+        reinterpret_cast<const std::uint32_t*>(index_data.get());
+    return {
+        indices,
+        indices + (mesh.index_buffer_size() / sizeof(std::uint32_t)),
+    };
+}
+
+} // namespace
+
+TEST_CASE(
+    "Vertex cache optimization lowers ACMR and keeps every triangle",
+    "[rendering][mesh-optimize]"
+) {
+    auto mesh = MeshFactory::create_plane(1.0f, 1.0f, 64);
+    const auto before = triangles_of(*mesh);
+
+    const auto stats = mesh->optimize();
+
+    REQUIRE(stats.before.acmr > 0.0f);
+    REQUIRE(stats.after.acmr < stats.before.acmr);
+    REQUIRE(stats.after.atvr < stats.before.atvr);
+    REQUIRE(stats.after.acmr == mesh->vertex_cache_stats().acmr);
+    REQUIRE(triangles_of(*mesh) == before);
+}
+
+TEST_CASE(
+    "Vertex fetch reordering numbers vertices by first use",
+    "[rendering][mesh-optimize]"
+) {
+    Mesh mesh(RenderPrimitive::Triangles);
+    mesh.insert_attribute(
+        Mesh::ATTRIBUTE_POSITION,
+        std::vector<std::array<float, 3>> {
+            {9.0f, 9.0f, 9.0f},
+            {0.0f, 0.0f, 0.0f},
+            {1.0f, 0.0f, 0.0f},
+            {0.0f, 1.0f, 0.0f},
+            {1.0f, 1.0f, 0.0f},
+        }
+    );
+    mesh.insert_indices({3, 2, 1, 3, 4, 2});
+    const auto before = triangles_of(mesh);
+
+    mesh.optimize();
+
+    REQUIRE(mesh.vertex_count() == 4);
+    REQUIRE(triangles_of(mesh) == before);
+    const auto indices = indices_of(mesh);
+    std::uint32_t next = 0;
+    for (auto index : indices) {
+        REQUIRE(index <= next);
+        next = std::max(next, index + 1);
+    }
+}
+
+TEST_CASE(
+    "Overdraw ordering draws outward-facing clusters first",
+    "[rendering][mesh-optimize]"
+) {
+    // Two parallel quads facing -X: the one at x = -1 faces away from the
+    // centre, the one at x = +1 towards it.
+    const std::vector<std::array<float, 3>> positions {
+        {1.0f, 0.0f, 0.0f},
+        {1.0f, 1.0f, 0.0f},
+        {1.0f, 0.0f, 1.0f},
+        {1.0f, 1.0f, 1.0f},
+        {-1.0f, 0.0f, 0.0f},
+        {-1.0f, 1.0f, 0.0f},
+        {-1.0f, 0.0f, 1.0f},
+        {-1.0f, 1.0f, 1.0f},
+    };
+    const std::vector<std::uint32_t> indices {
+        0, 1, 2, 1, 3, 2, 4, 5, 6, 5, 7, 6,
+    };
+
+    const auto ordered = optimize_overdraw(indices, positions, 16, 1.05f);
+
+    REQUIRE(
+        ordered ==
+        std::vector<std::uint32_t> {4, 5, 6, 5, 7, 6, 0, 1, 2, 1, 3, 2}
+    );
+}
+
+TEST_CASE(
+    "Overdraw ordering keeps triangles and bounds the ACMR it gives up",
+    "[rendering][mesh-optimize]"
+) {
+    auto mesh = MeshFactory::create_sphere(1.0f, 64, 32);
+    const auto before = triangles_of(*mesh);
+    const auto vertex_optimized = [&] {
+        auto copy = *mesh;
+        return copy.optimize().after;
+    }();
+
+    const auto stats = mesh->optimize({.optimize_overdraw = true});
+
+    REQUIRE(triangles_of(*mesh) == before);
+    REQUIRE(stats.after.acmr < stats.before.acmr);
+    REQUIRE(stats.after.acmr <= vertex_optimized.acmr * 1.1f);
+}
+
+TEST_CASE(
+    "Mesh::optimize leaves unsupported meshes alone",
+    "[rendering][mesh-optimize]"
+) {
+    Mesh lines(RenderPrimitive::Lines);
+    lines.insert_attribute(
+        Mesh::ATTRIBUTE_POSITION,
+        std::vector<std::array<float, 3>> {
+            {0.0f, 0.0f, 0.0f},
+            {1.0f, 0.0f, 0.0f},
+        }
+    );
+    lines.insert_indices({0, 1});
+    auto stats = lines.optimize();
+    REQUIRE(stats.after.vertices_transformed == 0);
+    REQUIRE(indices_of(lines) == std::vector<std::uint32_t> {0, 1});
+
+    Mesh broken(RenderPrimitive::Triangles);
+    broken.insert_attribute(
+        Mesh::ATTRIBUTE_POSITION,
+        std::vector<std::array<float, 3>> {{0.0f, 0.0f, 0.0f}}
+    );
+    broken.insert_indices({0, 0, 5});
+    stats = broken.optimize();
+    REQUIRE(stats.after.vertices_transformed == 0);
+    REQUIRE(indices_of(broken) == std::vector<std::uint32_t> {0, 0, 5});
+}
+
+TEST_CASE(
+    "analyze_vertex_cache simulates a FIFO cache",
+    "[rendering][mesh-optimize]"
+) {
+    const std::vector<std::uint32_t> indices {0, 1, 2, 2, 1, 3, 0, 4, 5};
+
+    auto stats = analyze_vertex_cache(indices, 6, 16);
+    REQUIRE(stats.vertices_transformed == 6);
+    REQUIRE(stats.acmr == 2.0f);
+    REQUIRE(stats.atvr == 1.0f);
+
+    // With three entries vertex 0 has been pushed out by the third triangle.
+    stats = analyze_vertex_cache(indices, 6, 3);
+    REQUIRE(stats.vertices_transformed == 7);
+}
@@ -0,0 +1,141 @@
+#include "rendering/mesh/mesh_simplify.hpp"
+
+#include "rendering/mesh/mesh.hpp"
+#include "rendering/mesh/mesh_factory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace fei;
+
+namespace {
+
+using Triangle = std::array<std::array<float, 3>, 3>;
+
+const std::vector<std::array<float, 3>>& positions_of(const Mesh& mesh) {
+    return mesh.get_attribute(Mesh::ATTRIBUTE_POSITION.id)
+        .as_float3()
+        .value();
+}
+
+// Triangles by corner positions, rotated to start at the smallest corner so
+// renumbered vertices compare equal when they draw the same faces.
+std::vector<Triangle> triangles_of(
+    const std::vector<std::uint32_t>& indices,
+    const std::vector<std::array<float, 3>>& positions
+) {
+    std::vector<Triangle> triangles;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        Triangle triangle {
+            positions[indices[i]],
+            positions[indices[i + 1]],
+            positions[indices[i + 2]],
+        };
+        std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+        triangles.push_back(triangle);
+    }
+    std::ranges::sort(triangles);
+    return triangles;
+}
+
+} // namespace
+
+TEST_CASE(
+    "LOD chains shrink level by level within the error budget",
+    "[rendering][mesh-simplify]"
+) {
+    auto mesh = MeshFactory::create_sphere(1.0f, 64, 32);
+    const auto vertex_count = mesh->vertex_count();
+
+    const auto levels = mesh->generate_lods({
+        .level_count = 3,
+        .reduction = 0.5f,
+        .max_error = 0.05f,
+    });
+
+    REQUIRE(levels > 0);
+    REQUIRE(mesh->lods().size() == levels);
+    const auto ranges = mesh->lod_ranges();
+    REQUIRE(ranges.size() == levels + 1);
+    REQUIRE(ranges[0].first_index == 0);
+    REQUIRE(ranges[0].error == 0.0f);
+    for (std::size_t level = 1; level < ranges.size(); ++level) {
+        const auto& lod = mesh->lods()[level - 1];
+        REQUIRE(ranges[level].index_count == lod.indices.size());
+        REQUIRE(ranges[level].index_count % 3 == 0);
+        REQUIRE(ranges[level].index_count < ranges[level - 1].index_count);
+        REQUIRE(
+            ranges[level].first_index ==
+            ranges[level - 1].first_index + ranges[level - 1].index_count
+        );
+        REQUIRE(ranges[level].error >= ranges[level - 1].error);
+        REQUIRE(ranges[level].error <= 0.05f);
+        REQUIRE(std::ranges::all_of(lod.indices, [&](std::uint32_t index) {
+            return index < vertex_count;
+        }));
+    }
+    const auto& last = ranges.back();
+    REQUIRE(
+        mesh->index_buffer_size() ==
+        (last.first_index + last.index_count) * sizeof(std::uint32_t)
+    );
+}
+
+TEST_CASE(
+    "Flat meshes simplify without error and keep their outline",
+    "[rendering][mesh-simplify]"
+) {
+    auto mesh = MeshFactory::create_plane(2.0f, 2.0f, 16);
+    const auto& positions = positions_of(*mesh);
+
+    mesh->generate_lods({
+        .level_count = 4,
+        .reduction = 0.25f,
+        .max_error = 0.001f,
+    });
+
+    REQUIRE(mesh->lods().size() == 4);
+    const auto& coarsest = mesh->lods().back();
+    REQUIRE(coarsest.indices.size() < 16 * 16 * 6 / 64);
+    REQUIRE(coarsest.error < 1e-4f);
+
+    // Corners cannot collapse without moving the outline.
+    std::vector<std::array<float, 3>> used;
+    for (auto index : coarsest.indices) {
+        used.push_back(positions[index]);
+    }
+    for (const auto& corner : std::vector<std::array<float, 3>> {
+             {-1.0f, 0.0f, -1.0f},
+             {1.0f, 0.0f, -1.0f},
+             {-1.0f, 0.0f, 1.0f},
+             {1.0f, 0.0f, 1.0f},
+         }) {
+        REQUIRE(std::ranges::find(used, corner) != used.end());
+    }
+}
+
+TEST_CASE(
+    "Mesh edits keep levels of detail consistent",
+    "[rendering][mesh-simplify]"
+) {
+    auto mesh = MeshFactory::create_sphere(1.0f, 32, 16);
+    REQUIRE(mesh->generate_lods() > 0);
+    const auto coarse = triangles_of(
+        mesh->lods().front().indices,
+        positions_of(*mesh)
+    );
+
+    mesh->optimize();
+    REQUIRE(
+        triangles_of(mesh->lods().front().indices, positions_of(*mesh)) ==
+        coarse
+    );
+
+    mesh->insert_indices({0, 1, 2});
+    REQUIRE(mesh->lods().empty());
+    REQUIRE(mesh->lod_ranges().empty());
+}
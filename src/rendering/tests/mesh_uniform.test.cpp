@@ -1,11 +1,13 @@
 #include "rendering/mesh/mesh_uniform.hpp"
 
+#include "app/app.hpp"
 #include "ecs/world.hpp"
 #include "rendering/components.hpp"
 #include "test_graphics_device.hpp"
 
 #include <algorithm>
 #include <catch2/catch_test_macros.hpp>
+#include <cstring>
 #include <vector>
 
 using namespace fei;
@@ -80,3 +82,154 @@ TEST_CASE(
     CHECK(range->offset() == 0);
     CHECK(range->size() == sizeof(MeshUniform));
 }
+
+TEST_CASE(
+    "mesh uniforms pack transforms into a storage buffer indexed per draw",
+    "[rendering][mesh][uniform]"
+) {
+    World world;
+    world.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    auto& device =
+        dynamic_cast<FakeGraphicsDevice&>(world.resource<GraphicsDevice>());
+    device.uniform_buffer_alignment = 256;
+    world.add_resource(RenderQueue {});
+    world.add_resource(
+        MeshUniforms {.layout = MeshUniformLayout::StorageBuffer}
+    );
+
+    std::vector<Entity> entities;
+    for (uint32 index = 0; index < 3; ++index) {
+        const auto entity = world.entity();
+        world.add_component(entity, Mesh3d {});
+        world.add_component(entity, Transform3d {});
+        entities.push_back(entity);
+    }
+
+    world.run_system_once(prepare_mesh_uniforms);
+
+    const auto& mesh_uniforms = world.resource<MeshUniforms>();
+    CHECK(mesh_uniforms.stride == sizeof(MeshUniform));
+    CHECK(mesh_uniforms.upload_data.size() == 3 * sizeof(MeshUniform));
+
+    const auto defs = mesh_uniform_shader_defs(mesh_uniforms);
+    REQUIRE(defs.size() == 1);
+    CHECK(defs[0].name == MESH_STORAGE_BUFFER_SHADER_DEF);
+
+    REQUIRE(device.resource_layout_descriptions.size() == 1);
+    const auto& elements = device.resource_layout_descriptions[0].elements;
+    REQUIRE(elements.size() == 2);
+    CHECK(elements[0].kind == ResourceKind::StorageBufferReadOnly);
+    CHECK(elements[1].kind == ResourceKind::StorageBufferReadOnly);
+
+    REQUIRE(device.buffer_descriptions.size() == 2);
+    CHECK(device.buffer_descriptions[0].usages == BufferUsages::Storage);
+    CHECK(device.buffer_descriptions[1].size == 4 * sizeof(uint32));
+    const auto range = std::dynamic_pointer_cast<const BufferRange>(
+        device.resource_set_descriptions[0].resources[0]
+    );
+    REQUIRE(range);
+    CHECK(range->size() == device.buffer_descriptions[0].size);
+    // Mesh uploads plus the identity instance mapping.
+    CHECK(world.resource<RenderQueue>().pending_buffer_writes() == 2);
+    CHECK(mesh_uniforms.instance_count == mesh_uniforms.capacity);
+
+    std::vector<uint32> instance_indices;
+    for (const auto entity : entities) {
+        const auto& entry = mesh_uniforms.entries.at(entity);
+        CHECK(entry.dynamic_offset == 0);
+        CHECK(entry.instance_index == entry.slot);
+        instance_indices.push_back(entry.instance_index);
+    }
+    std::ranges::sort(instance_indices);
+    CHECK(instance_indices == std::vector<uint32> {0, 1, 2});
+}
+
+TEST_CASE(
+    "mesh uniforms upload only changed transforms into stable slots",
+    "[rendering][mesh][uniform]"
+) {
+    constexpr ScheduleId test_render_schedule = 79;
+    App app;
+    app.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    auto& device =
+        dynamic_cast<FakeGraphicsDevice&>(app.resource<GraphicsDevice>());
+    device.uniform_buffer_alignment = 128;
+    app.add_resource(RenderQueue {});
+    app.add_resource(MeshUniforms {});
+    app.add_systems(test_render_schedule, prepare_mesh_uniforms);
+    app.world().sort_systems();
+
+    auto& world = app.world();
+    std::vector<Entity> entities;
+    for (uint32 index = 0; index < 4; ++index) {
+        const auto entity = world.entity();
+        world.add_component(entity, Mesh3d {});
+        world.add_component(
+            entity,
+            Transform3d {.position = {static_cast<float>(index), 0.0f, 0.0f}}
+        );
+        entities.push_back(entity);
+    }
+
+    app.run_schedule(test_render_schedule);
+    const auto& mesh_uniforms = app.resource<MeshUniforms>();
+    REQUIRE(mesh_uniforms.entries.size() == 4);
+    REQUIRE(app.resource<RenderQueue>().pending_buffer_writes() == 1);
+    const auto offset_of = [&](Entity entity) {
+        return mesh_uniforms.entries.at(entity).dynamic_offset;
+    };
+    const auto first_offset = offset_of(entities[1]);
+
+    SECTION("static transforms are not uploaded again") {
+        app.add_resource(RenderQueue {});
+        app.run_schedule(test_render_schedule);
+        CHECK(app.resource<RenderQueue>().pending_buffer_writes() == 0);
+        CHECK(offset_of(entities[1]) == first_offset);
+    }
+
+    SECTION("changed transforms are uploaded as coalesced ranges") {
+        world.get_component_rw<Transform3d>(entities[1])->position.y = 2.0f;
+        world.get_component_rw<Transform3d>(entities[2])->position.y = 3.0f;
+        app.add_resource(RenderQueue {});
+        app.run_schedule(test_render_schedule);
+        CHECK(app.resource<RenderQueue>().pending_buffer_writes() == 1);
+
+        world.get_component_rw<Transform3d>(entities[0])->position.y = 1.0f;
+        world.get_component_rw<Transform3d>(entities[3])->position.y = 1.0f;
+        app.add_resource(RenderQueue {});
+        app.run_schedule(test_render_schedule);
+        CHECK(app.resource<RenderQueue>().pending_buffer_writes() == 2);
+
+        MeshUniform uniform {};
+        std::memcpy(
+            &uniform,
+            mesh_uniforms.upload_data.data() + offset_of(entities[1]),
+            sizeof(uniform)
+        );
+        CHECK(
+            uniform.world_from_local ==
+            world.get_component<Transform3d>(entities[1]).to_matrix()
+        );
+    }
+
+    SECTION("despawned meshes release their slot for reuse") {
+        const auto released_offset = offset_of(entities[2]);
+        world.despawn(entities[2]);
+        app.add_resource(RenderQueue {});
+        app.run_schedule(test_render_schedule);
+        CHECK(mesh_uniforms.entries.size() == 3);
+        CHECK(mesh_uniforms.free_slots.size() == 1);
+        CHECK(app.resource<RenderQueue>().pending_buffer_writes() == 0);
+
+        const auto entity = world.entity();
+        world.add_component(entity, Mesh3d {});
+        world.add_component(entity, Transform3d {});
+        app.add_resource(RenderQueue {});
+        app.run_schedule(test_render_schedule);
+        CHECK(offset_of(entity) == released_offset);
+        CHECK(mesh_uniforms.free_slots.empty());
+        CHECK(mesh_uniforms.slot_count == 4);
+        CHECK(device.buffer_descriptions.size() == 1);
+        CHECK(app.resource<RenderQueue>().pending_buffer_writes() == 1);
+    }
+}
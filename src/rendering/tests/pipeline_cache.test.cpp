@@ -1,9 +1,16 @@
 #include "rendering/pipeline_cache.hpp"
 
+#include "graphics/shader_module.hpp"
+#include "task/task_pool.hpp"
 #include "test_graphics_device.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace fei;
 using namespace fei::rendering_test;
@@ -136,3 +143,235 @@ TEST_CASE(
     REQUIRE(cache.get_render_pipeline(render_id) == nullptr);
     REQUIRE(cache.get_compute_pipeline(compute_id) == nullptr);
 }
+
+TEST_CASE(
+    "PipelineCache finalizes at most the budget per processing call",
+    "[rendering][pipeline-cache]"
+) {
+    FakeGraphicsDevice device;
+    PipelineCache cache(device);
+    cache.set_finalize_budget(2);
+
+    auto first = cache.request_render_pipeline(RenderPipelineDescription {});
+    auto second = cache.request_render_pipeline(RenderPipelineDescription {});
+    auto third = cache.request_render_pipeline(RenderPipelineDescription {});
+    auto compute_id =
+        cache.request_compute_pipeline(ComputePipelineDescription {});
+    REQUIRE(cache.pending_pipelines() == 4);
+
+    cache.process_queued_pipelines();
+
+    REQUIRE(device.render_pipeline_descriptions.size() == 2);
+    REQUIRE(device.compute_pipeline_descriptions.empty());
+    REQUIRE(
+        cache.get_render_pipeline_state(first) == CachedPipelineState::Ready
+    );
+    REQUIRE(
+        cache.get_render_pipeline_state(second) == CachedPipelineState::Ready
+    );
+    REQUIRE(
+        cache.get_render_pipeline_state(third) == CachedPipelineState::Queued
+    );
+    REQUIRE(cache.get_render_pipeline(third) == nullptr);
+    REQUIRE(cache.pending_pipelines() == 2);
+
+    cache.process_queued_pipelines();
+
+    REQUIRE(device.render_pipeline_descriptions.size() == 3);
+    REQUIRE(device.compute_pipeline_descriptions.size() == 1);
+    REQUIRE(
+        cache.get_render_pipeline_state(third) == CachedPipelineState::Ready
+    );
+    REQUIRE(
+        cache.get_compute_pipeline_state(compute_id) ==
+        CachedPipelineState::Ready
+    );
+    REQUIRE(cache.pending_pipelines() == 0);
+}
+
+TEST_CASE(
+    "PipelineCache creates pipelines on workers and publishes them within "
+    "the budget",
+    "[rendering][pipeline-cache]"
+) {
+    FakeGraphicsDevice device;
+    TaskPool workers(1);
+    PipelineCache cache(device, &workers);
+    cache.set_finalize_budget(1);
+    REQUIRE(cache.asynchronous());
+
+    std::vector<CachedRenderPipelineId> ids;
+    for (int i = 0; i < 4; i++) {
+        ids.push_back(
+            cache.request_render_pipeline(RenderPipelineDescription {})
+        );
+    }
+    auto compute_id =
+        cache.request_compute_pipeline(ComputePipelineDescription {});
+
+    std::size_t pending = cache.pending_pipelines();
+    REQUIRE(pending == 5);
+    for (int i = 0; i < 10000 && pending > 0; i++) {
+        cache.process_queued_pipelines();
+        const auto now_pending = cache.pending_pipelines();
+        REQUIRE(pending - now_pending <= 1);
+        pending = now_pending;
+        std::this_thread::yield();
+    }
+    cache.wait_for_pipelines();
+
+    REQUIRE(cache.pending_pipelines() == 0);
+    REQUIRE(device.render_pipeline_descriptions.size() == 4);
+    REQUIRE(device.compute_pipeline_descriptions.size() == 1);
+    for (auto id : ids) {
+        REQUIRE(
+            cache.get_render_pipeline_state(id) == CachedPipelineState::Ready
+        );
+        REQUIRE(cache.get_render_pipeline(id) != nullptr);
+    }
+    REQUIRE(
+        cache.get_compute_pipeline_state(compute_id) ==
+        CachedPipelineState::Ready
+    );
+}
+
+TEST_CASE(
+    "PipelineCache reports failed worker creations once finalized",
+    "[rendering][pipeline-cache]"
+) {
+    FakeGraphicsDevice device;
+    device.fail_render_pipeline_creation = true;
+    TaskPool workers(1);
+    PipelineCache cache(device, &workers);
+
+    auto render_id =
+        cache.request_render_pipeline(RenderPipelineDescription {});
+    cache.wait_for_pipelines();
+
+    REQUIRE(
+        cache.get_render_pipeline_state(render_id) ==
+        CachedPipelineState::Failed
+    );
+    REQUIRE(
+        cache.get_render_pipeline_error(render_id) ==
+        "GraphicsDevice returned null render pipeline"
+    );
+    REQUIRE(cache.get_render_pipeline(render_id) == nullptr);
+
+    cache.process_queued_pipelines();
+    REQUIRE(device.render_pipeline_descriptions.size() == 1);
+}
+
+TEST_CASE(
+    "PipelineCache compiles deferred shaders in the creation job",
+    "[rendering][pipeline-cache]"
+) {
+    FakeGraphicsDevice device;
+    TaskPool workers(1);
+    PipelineCache cache(device, &workers);
+    auto vertex_shader =
+        std::make_shared<ShaderModule>(ShaderDescription {.path = "vertex"});
+    auto fragment_shader =
+        std::make_shared<ShaderModule>(ShaderDescription {.path = "fragment"});
+    std::thread::id compile_thread;
+
+    RenderPipelineDescription description {};
+    description.shader_program.shaders = {vertex_shader, nullptr};
+    auto render_id = cache.request_render_pipeline(
+        description,
+        {
+            DeferredPipelineShader {
+                .slot = 1,
+                .compile = [&](std::string&)
+                    -> std::shared_ptr<const ShaderModule> {
+                    compile_thread = std::this_thread::get_id();
+                    return fragment_shader;
+                },
+            },
+        }
+    );
+    cache.wait_for_pipelines();
+
+    REQUIRE(
+        cache.get_render_pipeline_state(render_id) == CachedPipelineState::Ready
+    );
+    CHECK(compile_thread != std::this_thread::get_id());
+    REQUIRE(device.render_pipeline_descriptions.size() == 1);
+    const auto& shaders =
+        device.render_pipeline_descriptions[0].shader_program.shaders;
+    REQUIRE(shaders.size() == 2);
+    CHECK(shaders[0] == vertex_shader);
+    CHECK(shaders[1] == fragment_shader);
+}
+
+TEST_CASE(
+    "PipelineCache fails pipelines whose deferred shader does not compile",
+    "[rendering][pipeline-cache]"
+) {
+    FakeGraphicsDevice device;
+    PipelineCache cache(device);
+
+    auto render_id = cache.request_render_pipeline(
+        RenderPipelineDescription {},
+        {
+            DeferredPipelineShader {
+                .slot = 0,
+                .compile = [](std::string& error)
+                    -> std::shared_ptr<const ShaderModule> {
+                    error = "shader did not compile";
+                    return nullptr;
+                },
+            },
+        }
+    );
+    cache.process_queued_pipelines();
+
+    REQUIRE(
+        cache.get_render_pipeline_state(render_id) ==
+        CachedPipelineState::Failed
+    );
+    REQUIRE(
+        cache.get_render_pipeline_error(render_id) == "shader did not compile"
+    );
+    REQUIRE(device.render_pipeline_descriptions.empty());
+}
+
+TEST_CASE(
+    "PipelineCache publishes pipelines once the device prepared them",
+    "[rendering][pipeline-cache]"
+) {
+    FakeGraphicsDevice device;
+    device.prepare_pipelines_on_flush = true;
+    PipelineCache cache(device);
+    cache.set_finalize_budget(1);
+
+    auto first = cache.request_render_pipeline(RenderPipelineDescription {});
+    auto second = cache.request_render_pipeline(RenderPipelineDescription {});
+
+    cache.process_queued_pipelines();
+
+    REQUIRE(device.pipelines_to_prepare.size() == 1);
+    REQUIRE(
+        cache.get_render_pipeline_state(first) == CachedPipelineState::Queued
+    );
+    REQUIRE(cache.get_render_pipeline(first) == nullptr);
+
+    device.flush();
+    cache.process_queued_pipelines();
+
+    REQUIRE(
+        cache.get_render_pipeline_state(first) == CachedPipelineState::Ready
+    );
+    REQUIRE(
+        cache.get_render_pipeline_state(second) == CachedPipelineState::Queued
+    );
+    REQUIRE(device.pipelines_to_prepare.size() == 1);
+
+    device.flush();
+    cache.process_queued_pipelines();
+
+    REQUIRE(
+        cache.get_render_pipeline_state(second) == CachedPipelineState::Ready
+    );
+    REQUIRE(cache.pending_pipelines() == 0);
+}
@@ -2,9 +2,16 @@
 
 #include "app/app.hpp"
 #include "asset/plugin.hpp"
+#include "core/transform.hpp"
+#include "rendering/components.hpp"
+#include "rendering/mesh/mesh_uniform.hpp"
+#include "rendering/render_phase.hpp"
+#include "rendering/render_queue.hpp"
 #include "test_graphics_device.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <utility>
 
 using namespace fei;
 using namespace fei::rendering_test;
@@ -26,3 +33,74 @@ TEST_CASE(
 
     REQUIRE(device.present_calls == 0);
 }
+
+TEST_CASE(
+    "RenderingPlugin applies the configured mesh uniform layout",
+    "[rendering][plugin]"
+) {
+    App app;
+    app.add_plugin<AssetsPlugin>()
+        .add_resource_as<GraphicsDevice>(FakeGraphicsDevice {})
+        .add_plugin(
+            RenderingPlugin(
+                RenderingSettings {
+                    .mesh_uniform_layout = MeshUniformLayout::StorageBuffer,
+                }
+            )
+        );
+
+    REQUIRE(
+        app.resource<MeshUniforms>().layout == MeshUniformLayout::StorageBuffer
+    );
+}
+
+TEST_CASE(
+    "RenderingPlugin instances identical meshes when storage buffers work",
+    "[rendering][plugin]"
+) {
+    FakeGraphicsDevice fake_device;
+    fake_device.vertex_storage_buffers_supported = true;
+
+    App app;
+    app.add_plugin<AssetsPlugin>()
+        .add_resource_as<GraphicsDevice>(std::move(fake_device))
+        .add_plugin<RenderingPlugin>();
+
+    auto& world = app.world();
+    for (uint32 index = 0; index < 3; ++index) {
+        const auto entity = world.entity();
+        world.add_component(entity, Mesh3d {});
+        world.add_component(entity, Transform3d {});
+    }
+    world.run_system_once(prepare_mesh_uniforms);
+
+    auto& mesh_uniforms = app.resource<MeshUniforms>();
+    REQUIRE(mesh_uniforms.layout == MeshUniformLayout::StorageBuffer);
+    REQUIRE(mesh_uniforms.entries.size() == 3);
+
+    auto vertices = std::make_shared<FakeBuffer>(
+        BufferDescription {.size = 48, .usages = BufferUsages::Vertex}
+    );
+    RenderPhase<MeshDrawItem> phase;
+    for (const auto& [entity, entry] : mesh_uniforms.entries) {
+        phase.items.push_back(
+            MeshDrawItem {
+                .entity = entity,
+                .mesh_set = mesh_uniforms.resource_set,
+                .mesh_uniform_instance_index = entry.instance_index,
+                .vertex_buffer = vertices,
+                .vertex_count = 4,
+            }
+        );
+    }
+    sort_mesh_draw_items(phase);
+    instance_mesh_draw_items(
+        phase,
+        app.resource<GraphicsDevice>(),
+        app.resource<RenderQueue>(),
+        mesh_uniforms
+    );
+
+    REQUIRE(phase.items.size() == 1);
+    CHECK(phase.items[0].instance_count == 3);
+}
@@ -4,10 +4,13 @@
 #include "ecs/event.hpp"
 #include "ecs/world.hpp"
 
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
+#include <cstddef>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 using namespace fei;
 
@@ -51,6 +54,58 @@ class RetryingAdapter : public RenderAssetAdapter<SourceAsset, PreparedAsset> {
     }
 };
 
+// Sources with a negative value stand in for assets whose dependencies never
+// finish loading.
+class PendingAdapter : public RenderAssetAdapter<SourceAsset, PreparedAsset> {
+  public:
+    Optional<PreparedAsset>
+    prepare_asset(const SourceAsset& source_asset, World&) override {
+        if (source_asset.value < 0) {
+            return nullopt;
+        }
+        return PreparedAsset {.value = source_asset.value * 2};
+    }
+};
+
+class StagingAdapter : public RenderAssetAdapter<SourceAsset, PreparedAsset> {
+  public:
+    struct Staged {
+        int value {0};
+    };
+
+    static inline std::atomic<int> stage_count = 0;
+    static inline int create_count = 0;
+
+    Optional<PreparedAsset>
+    prepare_asset(const SourceAsset& source_asset, World& world) override {
+        auto staged = stage_asset(source_asset);
+        if (!staged) {
+            return nullopt;
+        }
+        return create_asset(*staged, world);
+    }
+
+    Optional<Staged> stage_asset(const SourceAsset& source_asset) const {
+        ++stage_count;
+        if (source_asset.value < 0) {
+            return nullopt;
+        }
+        return Staged {.value = source_asset.value * 2};
+    }
+
+    Optional<PreparedAsset> create_asset(Staged staged, World&) const {
+        ++create_count;
+        return PreparedAsset {.value = staged.value};
+    }
+};
+
+static_assert(
+    StagedRenderAssetAdapter<StagingAdapter, SourceAsset, PreparedAsset>
+);
+static_assert(
+    !StagedRenderAssetAdapter<DoublingAdapter, SourceAsset, PreparedAsset>
+);
+
 } // namespace
 
 TEST_CASE(
@@ -136,6 +191,7 @@ TEST_CASE(
     );
 
     World world;
+    world.add_resource(Events<AssetEvent<PreparedAsset>> {});
     world.add_resource(std::move(extracted));
     world.add_resource(std::move(render_assets));
 
@@ -155,6 +211,61 @@ TEST_CASE(
     REQUIRE(extracted_after.removed.empty());
 }
 
+TEST_CASE(
+    "prepare_assets reports added, replaced and removed render assets",
+    "[rendering][render-asset]"
+) {
+    constexpr AssetId added_id = 1;
+    constexpr AssetId replaced_id = 2;
+    constexpr AssetId removed_id = 3;
+    SourceAsset source {.value = 21};
+
+    ExtractedAssets<SourceAsset> extracted;
+    for (auto id : {added_id, replaced_id}) {
+        extracted.extracted.push_back(
+            ExtractedAssets<SourceAsset>::Entry {
+                .id = id,
+                .asset = &source,
+            }
+        );
+    }
+    extracted.removed.insert(removed_id);
+
+    RenderAssets<PreparedAsset> render_assets;
+    render_assets.insert(
+        replaced_id,
+        std::make_unique<PreparedAsset>(PreparedAsset {1})
+    );
+    render_assets.insert(
+        removed_id,
+        std::make_unique<PreparedAsset>(PreparedAsset {2})
+    );
+
+    World world;
+    world.add_resource(Events<AssetEvent<PreparedAsset>> {});
+    world.add_resource(std::move(extracted));
+    world.add_resource(std::move(render_assets));
+
+    world.run_system_once(
+        prepare_assets<SourceAsset, PreparedAsset, DoublingAdapter>
+    );
+
+    std::vector<AssetEvent<PreparedAsset>> events;
+    world.run_system_once([&](EventReader<AssetEvent<PreparedAsset>> reader) {
+        for (auto event = reader.next(); event; event = reader.next()) {
+            events.push_back(*event);
+        }
+    });
+
+    REQUIRE(events.size() == 3);
+    REQUIRE(events[0].type == AssetEventType::Removed);
+    REQUIRE(events[0].id == removed_id);
+    REQUIRE(events[1].type == AssetEventType::Added);
+    REQUIRE(events[1].id == added_id);
+    REQUIRE(events[2].type == AssetEventType::Modified);
+    REQUIRE(events[2].id == replaced_id);
+}
+
 TEST_CASE(
     "prepare_assets keeps failed assets pending for retry",
     "[rendering][render-asset]"
@@ -179,6 +290,7 @@ TEST_CASE(
     );
 
     World world;
+    world.add_resource(Events<AssetEvent<PreparedAsset>> {});
     world.add_resource(std::move(extracted));
     world.add_resource(std::move(render_assets));
 
@@ -234,3 +346,195 @@ TEST_CASE(
     REQUIRE(extracted.extracted[0].asset != nullptr);
     REQUIRE(extracted.extracted[0].asset->value == 5);
 }
+
+TEST_CASE(
+    "extract_render_assets keeps pending retries ahead of new assets",
+    "[rendering][render-asset]"
+) {
+    World world;
+    Assets<SourceAsset> source_assets(nullptr);
+    std::vector<AssetId> ids;
+    for (int value = 0; value < 4; ++value) {
+        auto source = std::make_unique<SourceAsset>(SourceAsset {value});
+        ids.push_back(source_assets.add(std::move(source)).id());
+    }
+
+    ExtractedAssets<SourceAsset> pending;
+    for (auto id : {ids[2], ids[0]}) {
+        pending.extracted.push_back(
+            ExtractedAssets<SourceAsset>::Entry {.id = id, .asset = nullptr}
+        );
+    }
+
+    world.add_resource(Events<AssetEvent<SourceAsset>> {});
+    world.add_resource(std::move(source_assets));
+    world.add_resource(std::move(pending));
+
+    world.run_system_once([&](EventWriter<AssetEvent<SourceAsset>> writer) {
+        for (auto id : {ids[3], ids[0], ids[1]}) {
+            writer.send(
+                AssetEvent<SourceAsset> {
+                    .type = AssetEventType::Added,
+                    .id = id,
+                }
+            );
+        }
+    });
+    world.run_system_once(extract_render_assets<SourceAsset>);
+
+    const auto& extracted =
+        world.resource<ExtractedAssets<SourceAsset>>().extracted;
+    REQUIRE(extracted.size() == 4);
+    REQUIRE(extracted[0].id == ids[2]);
+    REQUIRE(extracted[1].id == ids[0]);
+    REQUIRE(extracted[2].id == ids[3]);
+    REQUIRE(extracted[3].id == ids[1]);
+}
+
+TEST_CASE(
+    "prepare_assets carries work past its budget to later frames",
+    "[rendering][render-asset]"
+) {
+    std::vector<SourceAsset> sources {{1}, {2}, {3}, {4}, {5}};
+    ExtractedAssets<SourceAsset> extracted;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        extracted.extracted.push_back(
+            ExtractedAssets<SourceAsset>::Entry {
+                .id = static_cast<AssetId>(i),
+                .asset = &sources[i],
+            }
+        );
+    }
+
+    RenderAssets<PreparedAsset> render_assets;
+    render_assets.prepare_budget() = AssetBudget<PreparedAsset> {
+        .max_count = 0,
+        .max_bytes = 10,
+        .max_time = {},
+        .byte_size =
+            [](const PreparedAsset& asset) {
+                return static_cast<std::size_t>(asset.value);
+            },
+    };
+
+    World world;
+    world.add_resource(Events<AssetEvent<PreparedAsset>> {});
+    world.add_resource(std::move(extracted));
+    world.add_resource(std::move(render_assets));
+
+    // Doubled values 2, 4, 6 reach the 10 byte budget on the third asset.
+    world.run_system_once(
+        prepare_assets<SourceAsset, PreparedAsset, DoublingAdapter>
+    );
+    auto& prepared = world.resource<RenderAssets<PreparedAsset>>();
+    REQUIRE(prepared.get(2).has_value());
+    REQUIRE_FALSE(prepared.get(3).has_value());
+    REQUIRE(
+        world.resource<ExtractedAssets<SourceAsset>>().extracted.size() == 2
+    );
+
+    // The first asset of a frame always fits, even when it alone exceeds
+    // the budget.
+    world.run_system_once(
+        prepare_assets<SourceAsset, PreparedAsset, DoublingAdapter>
+    );
+    REQUIRE(prepared.get(3).has_value());
+    REQUIRE(prepared.get(4).has_value());
+    REQUIRE(world.resource<ExtractedAssets<SourceAsset>>().extracted.empty());
+}
+
+TEST_CASE(
+    "prepare_assets stages assets in batches before creating them",
+    "[rendering][render-asset]"
+) {
+    StagingAdapter::stage_count = 0;
+    StagingAdapter::create_count = 0;
+
+    std::vector<SourceAsset> sources(20);
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        sources[i].value = static_cast<int>(i);
+    }
+    sources[3].value = -1;
+    ExtractedAssets<SourceAsset> extracted;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        extracted.extracted.push_back(
+            ExtractedAssets<SourceAsset>::Entry {
+                .id = static_cast<AssetId>(i),
+                .asset = &sources[i],
+            }
+        );
+    }
+
+    RenderAssets<PreparedAsset> render_assets;
+    render_assets.prepare_budget().max_count = 12;
+
+    World world;
+    world.add_resource(Events<AssetEvent<PreparedAsset>> {});
+    world.add_resource(std::move(extracted));
+    world.add_resource(std::move(render_assets));
+
+    // Twelve items fit: a first batch of eight and a second batch trimmed
+    // to the five left in the budget. The stage that is not ready is not
+    // charged and retries behind the untried assets.
+    world.run_system_once(
+        prepare_assets<SourceAsset, PreparedAsset, StagingAdapter>
+    );
+    auto& prepared = world.resource<RenderAssets<PreparedAsset>>();
+    REQUIRE(StagingAdapter::stage_count.load() == 13);
+    REQUIRE(StagingAdapter::create_count == 12);
+    REQUIRE(prepared.get(12)->value == 24);
+    REQUIRE_FALSE(prepared.get(3).has_value());
+    REQUIRE_FALSE(prepared.get(13).has_value());
+    const auto& pending = world.resource<ExtractedAssets<SourceAsset>>();
+    REQUIRE(pending.extracted.size() == 8);
+    REQUIRE(pending.extracted.front().id == 13);
+    REQUIRE(pending.extracted.back().id == 3);
+
+    sources[3].value = 3;
+    world.run_system_once(
+        prepare_assets<SourceAsset, PreparedAsset, StagingAdapter>
+    );
+    REQUIRE(prepared.get(3)->value == 6);
+    REQUIRE(prepared.get(19)->value == 38);
+    REQUIRE(world.resource<ExtractedAssets<SourceAsset>>().extracted.empty());
+}
+
+TEST_CASE(
+    "prepare_assets does not let an asset that is never ready use the budget",
+    "[rendering][render-asset]"
+) {
+    std::vector<SourceAsset> sources {{-1}, {1}, {2}};
+    ExtractedAssets<SourceAsset> extracted;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        extracted.extracted.push_back(
+            ExtractedAssets<SourceAsset>::Entry {
+                .id = static_cast<AssetId>(i),
+                .asset = &sources[i],
+            }
+        );
+    }
+
+    RenderAssets<PreparedAsset> render_assets;
+    render_assets.prepare_budget().max_count = 1;
+
+    World world;
+    world.add_resource(Events<AssetEvent<PreparedAsset>> {});
+    world.add_resource(std::move(extracted));
+    world.add_resource(std::move(render_assets));
+
+    auto& prepared = world.resource<RenderAssets<PreparedAsset>>();
+    const auto& pending = world.resource<ExtractedAssets<SourceAsset>>();
+    for (std::size_t frame = 1; frame < sources.size(); ++frame) {
+        world.run_system_once(
+            prepare_assets<SourceAsset, PreparedAsset, PendingAdapter>
+        );
+        REQUIRE(prepared.get(static_cast<AssetId>(frame)).has_value());
+        REQUIRE(pending.extracted.back().id == 0);
+    }
+
+    world.run_system_once(
+        prepare_assets<SourceAsset, PreparedAsset, PendingAdapter>
+    );
+    REQUIRE_FALSE(prepared.get(0).has_value());
+    REQUIRE(pending.extracted.size() == 1);
+}
@@ -5,9 +5,12 @@
 #include "rendering/resource_set_cache.hpp"
 #include "test_graphics_device.hpp"
 
+#include <algorithm>
+#include <array>
 #include <catch2/catch_test_macros.hpp>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <span>
 #include <thread>
 #include <vector>
@@ -28,15 +31,21 @@ class LifecycleCommandBuffer : public CommandBuffer {
     uint32 begin_calls {0};
     uint32 end_calls {0};
     std::vector<BufferUpdate> buffer_updates;
+    std::size_t reserved_update_bytes {0};
 
-    void begin() override { ++begin_calls; }
+    void begin() override {
+        ++begin_calls;
+        reset_recording_state();
+    }
     void end() override { ++end_calls; }
-    void begin_render_pass(const RenderPassDescription&) override {}
-    void end_render_pass() override {}
+    void begin_render_pass(const RenderPassDescription&) override {
+        invalidate_bind_state();
+    }
+    void end_render_pass() override { invalidate_bind_state(); }
     void set_viewport(int32, int32, uint32, uint32) override {}
     void set_scissor(int32, int32, uint32, uint32) override {}
-    void set_vertex_buffer(std::shared_ptr<const Buffer>) override {}
-    void set_resource_set(
+    void set_vertex_buffer_impl(std::shared_ptr<const Buffer>) override {}
+    void set_resource_set_impl(
         uint32,
         std::shared_ptr<const ResourceSet>,
         std::span<const uint32>
@@ -56,8 +65,12 @@ class LifecycleCommandBuffer : public CommandBuffer {
             }
         );
     }
-    void draw(std::size_t, std::size_t) override {}
-    void draw_indexed(std::size_t, uint32, int32) override {}
+    void reserve_buffer_updates(std::size_t size) override {
+        reserved_update_bytes += size;
+    }
+    void draw_impl(std::size_t, std::size_t, uint32, uint32) override {}
+    void
+    draw_indexed_impl(std::size_t, uint32, int32, uint32, uint32) override {}
     void dispatch(std::size_t, std::size_t, std::size_t) override {}
 
   protected:
@@ -107,10 +120,11 @@ TEST_CASE(
     REQUIRE(commands->begin_calls == 1);
 
     auto finished = frame.finish();
-    REQUIRE(finished == commands);
+    REQUIRE(finished.size() == 1);
+    REQUIRE(finished.front() == commands);
     REQUIRE(commands->end_calls == 1);
     REQUIRE(frame.command_buffer() == nullptr);
-    REQUIRE(frame.finish() == nullptr);
+    REQUIRE(frame.finish().empty());
     REQUIRE(commands->end_calls == 1);
 }
 
@@ -157,6 +171,114 @@ TEST_CASE(
     CHECK(uploaded == 0x12345678);
 }
 
+TEST_CASE(
+    "RenderQueue stages writes contiguously across frames",
+    "[rendering][frame][queue]"
+) {
+    App app;
+    app.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    app.add_resource(RenderFrameContext {});
+    app.add_resource(RenderQueue {});
+
+    auto& device =
+        dynamic_cast<FakeGraphicsDevice&>(app.resource<GraphicsDevice>());
+    auto buffer = device.create_buffer(
+        BufferDescription {.size = 16, .usages = BufferUsages::Uniform}
+    );
+    auto& queue = app.resource<RenderQueue>();
+
+    for (uint32 frame = 0; frame < RenderQueue::staging_frame_count + 1;
+         ++frame) {
+        const std::array<uint32, 2> values {frame, frame + 100};
+        queue.write_buffer(buffer, 0, &values[0], sizeof(uint32));
+        queue.write_buffer(buffer, 8, &values[1], sizeof(uint32));
+        CHECK(queue.pending_buffer_writes() == 2);
+        CHECK(queue.pending_buffer_bytes() == 2 * sizeof(uint32));
+
+        auto commands = std::make_shared<LifecycleCommandBuffer>();
+        device.next_command_buffer = commands;
+        auto& context = app.resource<RenderFrameContext>();
+        REQUIRE(context.begin(device));
+        app.world().run_system_once(flush_render_queue);
+        (void)context.finish();
+
+        CHECK(queue.pending_buffer_writes() == 0);
+        CHECK(commands->reserved_update_bytes == 2 * sizeof(uint32));
+        REQUIRE(commands->buffer_updates.size() == 2);
+        for (std::size_t index = 0; index < values.size(); ++index) {
+            uint32 uploaded {};
+            std::memcpy(
+                &uploaded,
+                commands->buffer_updates[index].data.data(),
+                sizeof(uploaded)
+            );
+            CHECK(uploaded == values[index]);
+        }
+        CHECK(commands->buffer_updates[1].offset == 8);
+    }
+}
+
+TEST_CASE(
+    "RenderQueue coalesces touching writes with last writer wins",
+    "[rendering][frame][queue]"
+) {
+    App app;
+    app.add_resource_as<GraphicsDevice>(FakeGraphicsDevice {});
+    app.add_resource(RenderFrameContext {});
+    app.add_resource(RenderQueue {});
+
+    auto& device =
+        dynamic_cast<FakeGraphicsDevice&>(app.resource<GraphicsDevice>());
+    auto commands = std::make_shared<LifecycleCommandBuffer>();
+    device.next_command_buffer = commands;
+    auto buffer = device.create_buffer(
+        BufferDescription {.size = 16, .usages = BufferUsages::Uniform}
+    );
+    auto other = device.create_buffer(
+        BufferDescription {.size = 16, .usages = BufferUsages::Uniform}
+    );
+
+    auto& queue = app.resource<RenderQueue>();
+    const std::array<std::uint8_t, 4> low {1, 1, 1, 1};
+    const std::array<std::uint8_t, 4> high {2, 2, 2, 2};
+    const std::array<std::uint8_t, 4> middle {3, 3, 3, 3};
+    queue.write_buffer(buffer, 4, high.data(), high.size());
+    queue.write_buffer(other, 0, low.data(), low.size());
+    queue.write_buffer(buffer, 0, low.data(), low.size());
+    queue.write_buffer(buffer, 2, middle.data(), middle.size());
+    queue.write_buffer(buffer, 12, high.data(), high.size());
+
+    REQUIRE(app.resource<RenderFrameContext>().begin(device));
+    app.world().run_system_once(flush_render_queue);
+
+    REQUIRE(commands->buffer_updates.size() == 3);
+    const auto merged = std::ranges::find(
+        commands->buffer_updates,
+        std::size_t {8},
+        [](const auto& update) { return update.data.size(); }
+    );
+    REQUIRE(merged != commands->buffer_updates.end());
+    CHECK(merged->buffer == buffer);
+    CHECK(merged->offset == 0);
+    const std::vector<std::byte> expected {
+        std::byte {1},
+        std::byte {1},
+        std::byte {3},
+        std::byte {3},
+        std::byte {3},
+        std::byte {3},
+        std::byte {2},
+        std::byte {2},
+    };
+    CHECK(merged->data == expected);
+
+    const auto stats = queue.last_flush_stats();
+    CHECK(stats.writes == 5);
+    CHECK(stats.bytes == 20);
+    CHECK(stats.updates == 3);
+    CHECK(stats.update_bytes == 16);
+}
+
 TEST_CASE(
     "RenderQueue retains writes while the frame has no command buffer",
     "[rendering][frame][queue]"
@@ -207,7 +329,7 @@ TEST_CASE(
 
     REQUIRE_FALSE(frame.begin(device));
     REQUIRE_FALSE(frame.recording());
-    REQUIRE(frame.finish() == nullptr);
+    REQUIRE(frame.finish().empty());
 }
 
 TEST_CASE(
@@ -239,6 +361,119 @@ TEST_CASE(
     REQUIRE(commands->end_calls == 1);
 }
 
+TEST_CASE(
+    "RenderFrameContext submits pass command buffers in a defined order",
+    "[rendering][frame]"
+) {
+    FakeGraphicsDevice device;
+    device.parallel_recording = true;
+    std::vector<std::shared_ptr<LifecycleCommandBuffer>> created;
+    device.command_buffer_factory = [&created]() {
+        created.push_back(std::make_shared<LifecycleCommandBuffer>());
+        return created.back();
+    };
+    RenderFrameContext frame;
+
+    REQUIRE(frame.begin(device));
+    auto* primary = frame.command_buffer();
+    {
+        auto late = frame.begin_pass(2);
+        auto early = frame.begin_pass(1);
+        REQUIRE(late);
+        REQUIRE(early);
+        CHECK(late.get() != primary);
+        CHECK(early.get() != late.get());
+        late->draw(0, 3);
+        early->draw(0, 3, 4, 0);
+    }
+    // Touching the primary again continues it behind the passes.
+    auto* continued = frame.command_buffer();
+    CHECK(continued != primary);
+    continued->draw(0, 3);
+    auto after = frame.begin_pass(0);
+    REQUIRE(created.size() == 5);
+    CHECK(created[4]->begin_calls == 1);
+
+    auto finished = frame.finish();
+    REQUIRE(finished.size() == 5);
+    CHECK(finished[0] == created[0]);
+    CHECK(finished[1] == created[2]);
+    CHECK(finished[2] == created[1]);
+    CHECK(finished[3] == created[3]);
+    CHECK(finished[4] == created[4]);
+    for (const auto& commands : created) {
+        CHECK(commands->begin_calls == 1);
+        CHECK(commands->end_calls == 1);
+    }
+    CHECK(frame.last_frame_stats().draws == 3);
+    CHECK(frame.last_frame_stats().draws_saved == 3);
+    CHECK_FALSE(frame.begin_pass(0));
+}
+
+TEST_CASE(
+    "RenderFrameContext records passes concurrently",
+    "[rendering][frame]"
+) {
+    constexpr uint32 pass_count = 8;
+    FakeGraphicsDevice device;
+    device.parallel_recording = true;
+    std::mutex created_mutex;
+    device.command_buffer_factory = [&created_mutex]() {
+        std::scoped_lock lock(created_mutex);
+        return std::make_shared<LifecycleCommandBuffer>();
+    };
+    RenderFrameContext frame;
+    REQUIRE(frame.begin(device));
+
+    std::array<CommandBuffer*, pass_count> recorded {};
+    std::vector<std::thread> workers;
+    for (uint32 index = 0; index < pass_count; ++index) {
+        workers.emplace_back([&frame, &recorded, index]() {
+            auto commands = frame.begin_pass(pass_count - 1 - index);
+            commands->draw(0, 3);
+            recorded[pass_count - 1 - index] = commands.get();
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto finished = frame.finish();
+    REQUIRE(finished.size() == pass_count + 1);
+    for (uint32 order = 0; order < pass_count; ++order) {
+        CHECK(finished[order + 1].get() == recorded[order]);
+    }
+    CHECK(frame.last_frame_stats().draws == pass_count);
+}
+
+TEST_CASE(
+    "RenderFrameContext shares the primary buffer without parallel recording",
+    "[rendering][frame]"
+) {
+    FakeGraphicsDevice device;
+    auto commands = std::make_shared<LifecycleCommandBuffer>();
+    device.next_command_buffer = commands;
+    RenderFrameContext frame;
+    REQUIRE(frame.begin(device));
+
+    {
+        auto pass = frame.begin_pass(1);
+        REQUIRE(pass.get() == commands.get());
+        pass->draw(0, 3);
+    }
+    auto pass = frame.begin_pass(0);
+    REQUIRE(pass.get() == commands.get());
+    pass = {};
+    REQUIRE(frame.command_buffer() == commands.get());
+
+    auto finished = frame.finish();
+    REQUIRE(finished.size() == 1);
+    CHECK(finished.front() == commands);
+    CHECK(commands->begin_calls == 1);
+    CHECK(commands->end_calls == 1);
+    CHECK(frame.last_frame_stats().draws == 1);
+}
+
 TEST_CASE(
     "RenderResourceSetCache keys physical resources and buffer ranges",
     "[rendering][resource-set-cache]"
@@ -253,10 +488,24 @@ TEST_CASE(
     auto same_range = std::make_shared<BufferRange>(buffer, 0, 16);
     auto other_range = std::make_shared<BufferRange>(buffer, 16, 16);
 
-    auto first = cache.get_or_create(device, "first", layout, {first_range});
-    auto hit = cache.get_or_create(device, "same", layout, {same_range});
-    auto different =
-        cache.get_or_create(device, "different", layout, {other_range});
+    auto first = cache.get_or_create(
+        device,
+        "first",
+        layout,
+        ResourceBindings<1> {first_range}
+    );
+    auto hit = cache.get_or_create(
+        device,
+        "same",
+        layout,
+        ResourceBindings<1> {same_range}
+    );
+    auto different = cache.get_or_create(
+        device,
+        "different",
+        layout,
+        ResourceBindings<1> {other_range}
+    );
 
     REQUIRE(first == hit);
     REQUIRE(first != different);
@@ -285,10 +534,18 @@ TEST_CASE(
             .texture_type = TextureType::Texture2D,
         }
     );
-    auto texture_set =
-        cache.get_or_create(device, "texture", layout, {first_texture});
-    auto rebuilt_set =
-        cache.get_or_create(device, "rebuilt", layout, {rebuilt_texture});
+    auto texture_set = cache.get_or_create(
+        device,
+        "texture",
+        layout,
+        ResourceBindings<1> {first_texture}
+    );
+    auto rebuilt_set = cache.get_or_create(
+        device,
+        "rebuilt",
+        layout,
+        ResourceBindings<1> {rebuilt_texture}
+    );
     REQUIRE(texture_set != rebuilt_set);
 
     for (uint32 frame = 0; frame < 121; ++frame) {
@@ -296,3 +553,70 @@ TEST_CASE(
     }
     REQUIRE(cache.stats().size == 0);
 }
+
+TEST_CASE(
+    "RenderResourceSetCache evicts least recently used sets over budget",
+    "[rendering][resource-set-cache]"
+) {
+    FakeGraphicsDevice device;
+    RenderResourceSetCache cache;
+    auto layout = device.create_resource_layout(ResourceLayoutDescription {});
+    auto buffer = device.create_buffer(
+        BufferDescription {.size = 64, .usages = BufferUsages::Uniform}
+    );
+    auto range = [&](std::size_t offset) {
+        return ResourceBindings<1> {
+            std::make_shared<BufferRange>(buffer, offset, 16),
+        };
+    };
+
+    auto first = cache.get_or_create(device, "first", layout, range(0));
+    auto second = cache.get_or_create(device, "second", layout, range(16));
+    const auto entry_bytes = cache.stats().bytes / 2;
+    REQUIRE(entry_bytes > 0);
+
+    // Both sets are in use this frame, so a tighter budget keeps them.
+    cache.set_budget_bytes(entry_bytes);
+    REQUIRE(cache.stats().size == 2);
+    cache.set_budget_bytes(RenderResourceSetCache::DefaultBudgetBytes);
+
+    cache.begin_frame();
+    REQUIRE(cache.get_or_create(device, "first", layout, range(0)) == first);
+    cache.set_budget_bytes(entry_bytes);
+    REQUIRE(cache.stats().size == 1);
+    REQUIRE(cache.stats().evictions == 1);
+    REQUIRE(cache.stats().bytes == entry_bytes);
+
+    cache.begin_frame();
+    REQUIRE(cache.get_or_create(device, "first", layout, range(0)) == first);
+    REQUIRE(cache.get_or_create(device, "second", layout, range(16)) != second);
+}
+
+TEST_CASE(
+    "RenderResourceSetCache reports per-frame hit rate",
+    "[rendering][resource-set-cache]"
+) {
+    FakeGraphicsDevice device;
+    RenderResourceSetCache cache;
+    auto layout = device.create_resource_layout(ResourceLayoutDescription {});
+    auto buffer = device.create_buffer(
+        BufferDescription {.size = 64, .usages = BufferUsages::Uniform}
+    );
+    const ResourceBindings<1> range {
+        std::make_shared<BufferRange>(buffer, 0, 16),
+    };
+
+    for (uint32 i = 0; i < 4; ++i) {
+        (void)cache.get_or_create(device, "set", layout, range);
+    }
+    cache.begin_frame();
+    CHECK(cache.stats().last_frame_requests == 4);
+    CHECK(cache.stats().last_frame_hits == 3);
+    CHECK(cache.stats().last_frame_lookup_ns <= cache.stats().lookup_ns);
+
+    (void)cache.get_or_create(device, "set", layout, range);
+    cache.begin_frame();
+    CHECK(cache.stats().last_frame_requests == 1);
+    CHECK(cache.stats().last_frame_hits == 1);
+    CHECK(cache.stats().requests == 5);
+}
@@ -2,6 +2,7 @@
 
 #include "test_graphics_device.hpp"
 
+#include <algorithm>
 #include <array>
 #include <catch2/catch_test_macros.hpp>
 #include <memory>
@@ -28,16 +29,24 @@ class RecordingCommandBuffer : public CommandBuffer {
     usize draw_indexed_count {0};
     uint32 draw_first_index {0};
     int32 draw_vertex_offset {0};
+    uint32 draw_instance_count {0};
+    uint32 draw_first_instance {0};
     int32 scissor_x {0};
     int32 scissor_y {0};
     uint32 scissor_width {0};
     uint32 scissor_height {0};
+    uint32 bind_calls {0};
 
-    void begin() override { began = true; }
+    void begin() override {
+        began = true;
+        reset_recording_state();
+    }
     void end() override { ended = true; }
 
-    void begin_render_pass(const RenderPassDescription&) override {}
-    void end_render_pass() override {}
+    void begin_render_pass(const RenderPassDescription&) override {
+        invalidate_bind_state();
+    }
+    void end_render_pass() override { invalidate_bind_state(); }
 
     void set_viewport(int32, int32, uint32, uint32) override {}
     void set_scissor(int32 x, int32 y, uint32 width, uint32 height) override {
@@ -47,15 +56,17 @@ class RecordingCommandBuffer : public CommandBuffer {
         scissor_height = height;
     }
 
-    void set_vertex_buffer(std::shared_ptr<const Buffer> buffer) override {
+    void set_vertex_buffer_impl(std::shared_ptr<const Buffer> buffer) override {
+        ++bind_calls;
         vertex_buffer = std::move(buffer);
     }
 
-    void set_resource_set(
+    void set_resource_set_impl(
         uint32 slot,
         std::shared_ptr<const ResourceSet> resource_set,
         std::span<const uint32> dynamic_offsets
     ) override {
+        ++bind_calls;
         resource_sets.at(slot) = std::move(resource_set);
         resource_set_dynamic_offsets.at(slot).assign(
             dynamic_offsets.begin(),
@@ -70,19 +81,30 @@ class RecordingCommandBuffer : public CommandBuffer {
         std::size_t
     ) override {}
 
-    void draw(std::size_t start, std::size_t count) override {
+    void draw_impl(
+        std::size_t start,
+        std::size_t count,
+        uint32 instance_count,
+        uint32 first_instance
+    ) override {
         draw_start = start;
         draw_count = count;
+        draw_instance_count = instance_count;
+        draw_first_instance = first_instance;
     }
 
-    void draw_indexed(
+    void draw_indexed_impl(
         std::size_t count,
         uint32 first_index,
-        int32 vertex_offset
+        int32 vertex_offset,
+        uint32 instance_count,
+        uint32 first_instance
     ) override {
         draw_indexed_count = count;
         draw_first_index = first_index;
         draw_vertex_offset = vertex_offset;
+        draw_instance_count = instance_count;
+        draw_first_instance = first_instance;
     }
 
     void dispatch(std::size_t, std::size_t, std::size_t) override {}
@@ -91,6 +113,7 @@ class RecordingCommandBuffer : public CommandBuffer {
     void set_render_pipeline_impl(
         std::shared_ptr<const Pipeline> pipeline
     ) override {
+        ++bind_calls;
         render_pipeline = std::move(pipeline);
     }
 
@@ -101,6 +124,7 @@ class RecordingCommandBuffer : public CommandBuffer {
         IndexFormat format,
         uint32 offset
     ) override {
+        ++bind_calls;
         index_buffer = std::move(buffer);
         index_format = format;
         index_offset = offset;
@@ -187,7 +211,7 @@ TEST_CASE(
     phase.items.push_back(MeshDrawItem {.pipeline = pipeline_0});
     phase.items.push_back(MeshDrawItem {.pipeline = pipeline_1});
 
-    sort_by_pipeline(phase);
+    sort_mesh_draw_items(phase);
 
     REQUIRE(phase.items[0].pipeline == pipeline_0);
     REQUIRE(phase.items[1].pipeline == pipeline_1);
@@ -198,6 +222,91 @@ TEST_CASE(
     REQUIRE(phase.items.empty());
 }
 
+TEST_CASE(
+    "sort_mesh_draw_items orders by state then depth",
+    "[rendering][phase]"
+) {
+    FakeGraphicsDevice device;
+    PipelineCache cache(device);
+    auto pipeline_0 =
+        cache.request_render_pipeline(RenderPipelineDescription {});
+    auto pipeline_1 =
+        cache.request_render_pipeline(RenderPipelineDescription {});
+    auto material_set = make_resource_set();
+
+    RenderPhase<MeshDrawItem> phase;
+    auto push = [&](CachedRenderPipelineId pipeline, float depth) {
+        phase.items.push_back(
+            MeshDrawItem {
+                .pipeline = pipeline,
+                .material_set = material_set,
+                .depth = depth,
+            }
+        );
+    };
+    push(pipeline_1, 2.0f);
+    push(pipeline_0, 8.0f);
+    push(pipeline_1, -1.0f);
+    push(pipeline_0, 0.5f);
+    push(pipeline_0, 3.0f);
+
+    SECTION("front to back groups pipelines and sorts near to far") {
+        sort_mesh_draw_items(phase);
+
+        const std::array expected {
+            std::pair {pipeline_0, 0.5f},
+            std::pair {pipeline_0, 3.0f},
+            std::pair {pipeline_0, 8.0f},
+            std::pair {pipeline_1, -1.0f},
+            std::pair {pipeline_1, 2.0f},
+        };
+        for (std::size_t index = 0; index < expected.size(); ++index) {
+            CHECK(phase.items[index].pipeline == expected[index].first);
+            CHECK(phase.items[index].depth == expected[index].second);
+        }
+    }
+
+    SECTION("back to front sorts far to near across pipelines") {
+        sort_mesh_draw_items(phase, MeshSortOrder::BackToFront);
+
+        const std::array expected {8.0f, 3.0f, 2.0f, 0.5f, -1.0f};
+        for (std::size_t index = 0; index < expected.size(); ++index) {
+            CHECK(phase.items[index].depth == expected[index]);
+        }
+    }
+}
+
+TEST_CASE(
+    "radix_sort_phase_entries is a stable sort on the full key",
+    "[rendering][phase]"
+) {
+    std::vector<PhaseSortEntry> entries;
+    uint64 state = 0x2545f4914f6cdd1dull;
+    for (uint32 index = 0; index < 512; ++index) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Few distinct keys so stability is exercised.
+        entries.push_back(
+            PhaseSortEntry {
+                .key = (state % 37) << 40 | (state % 3),
+                .index = index,
+            }
+        );
+    }
+    auto expected = entries;
+    std::ranges::stable_sort(expected, {}, &PhaseSortEntry::key);
+
+    std::vector<PhaseSortEntry> scratch;
+    radix_sort_phase_entries(entries, scratch);
+
+    REQUIRE(entries.size() == expected.size());
+    for (std::size_t index = 0; index < entries.size(); ++index) {
+        CHECK(entries[index].key == expected[index].key);
+        CHECK(entries[index].index == expected[index].index);
+    }
+}
+
 TEST_CASE(
     "make_mesh_draw_item captures mesh buffers and draw counts",
     "[rendering][phase]"
@@ -225,7 +334,7 @@ TEST_CASE(
         static_cast<CachedRenderPipelineId>(7),
         view_set,
         mesh_set,
-        768,
+        MeshUniforms::Entry {.dynamic_offset = 768, .instance_index = 9},
         material_set,
         gpu_mesh,
         3.5f
@@ -236,6 +345,7 @@ TEST_CASE(
     REQUIRE(item.view_set == view_set);
     REQUIRE(item.mesh_set == mesh_set);
     REQUIRE(item.mesh_uniform_dynamic_offset == 768);
+    REQUIRE(item.mesh_uniform_instance_index == 9);
     REQUIRE(item.material_set == material_set);
     REQUIRE(item.vertex_buffer == vertex_buffer);
     REQUIRE(item.index_buffer == index_buffer);
@@ -291,9 +401,77 @@ TEST_CASE(
     REQUIRE(command_buffer.index_format == IndexFormat::Uint32);
     REQUIRE(command_buffer.index_offset == 0);
     REQUIRE(command_buffer.draw_indexed_count == 3);
+    REQUIRE(command_buffer.draw_instance_count == 1);
+    REQUIRE(command_buffer.draw_first_instance == 0);
     REQUIRE(command_buffer.draw_count == 0);
 }
 
+TEST_CASE(
+    "CommandBuffer skips binds that match the recorded state",
+    "[rendering][phase][command-buffer]"
+) {
+    FakeGraphicsDevice device;
+    PipelineCache cache(device);
+    auto pipeline_id =
+        cache.request_render_pipeline(RenderPipelineDescription {});
+    cache.process_queued_pipelines();
+
+    MeshDrawItem item {
+        .pipeline = pipeline_id,
+        .view_set = make_resource_set(),
+        .mesh_set = make_resource_set(),
+        .material_set = make_resource_set(),
+        .mesh_uniform_dynamic_offset = 256,
+        .vertex_buffer = std::make_shared<FakeBuffer>(
+            BufferDescription {.size = 48, .usages = BufferUsages::Vertex}
+        ),
+        .index_buffer = std::make_shared<FakeBuffer>(
+            BufferDescription {.size = 12, .usages = BufferUsages::Index}
+        ),
+        .index_count = 3,
+        .vertex_count = 4,
+    };
+    RecordingCommandBuffer command_buffer;
+    command_buffer.begin();
+
+    draw_mesh_item(command_buffer, cache, item);
+    REQUIRE(command_buffer.bind_calls == 6);
+
+    SECTION("identical items only record the draw") {
+        draw_mesh_item(command_buffer, cache, item);
+        CHECK(command_buffer.bind_calls == 6);
+        CHECK(command_buffer.stats().draws == 2);
+        CHECK(command_buffer.stats().binds == 6);
+        CHECK(command_buffer.stats().binds_skipped == 6);
+    }
+
+    SECTION("changed dynamic offsets rebind only that set") {
+        item.mesh_uniform_dynamic_offset = 512;
+        draw_mesh_item(command_buffer, cache, item);
+        CHECK(command_buffer.bind_calls == 7);
+        CHECK(
+            command_buffer.resource_set_dynamic_offsets[1] ==
+            std::vector<uint32> {512}
+        );
+    }
+
+    SECTION("render pass boundaries rebind everything") {
+        command_buffer.end_render_pass();
+        draw_mesh_item(command_buffer, cache, item);
+        CHECK(command_buffer.bind_calls == 12);
+    }
+
+    SECTION("instanced draws count the draws they replace") {
+        item.instance_count = 5;
+        draw_mesh_item(command_buffer, cache, item);
+        CHECK(command_buffer.stats().draws_saved == 4);
+
+        command_buffer.begin();
+        CHECK(command_buffer.stats().draws == 0);
+        CHECK(command_buffer.stats().draws_saved == 0);
+    }
+}
+
 TEST_CASE(
     "draw_mesh_item records non-indexed mesh draw state",
     "[rendering][phase]"
@@ -312,6 +490,7 @@ TEST_CASE(
         .view_set = make_resource_set(),
         .mesh_set = make_resource_set(),
         .material_set = make_resource_set(),
+        .mesh_uniform_instance_index = 6,
         .vertex_buffer = vertex_buffer,
         .vertex_count = 4,
     };
@@ -324,6 +503,8 @@ TEST_CASE(
     REQUIRE(command_buffer.index_buffer == nullptr);
     REQUIRE(command_buffer.draw_start == 0);
     REQUIRE(command_buffer.draw_count == 4);
+    REQUIRE(command_buffer.draw_instance_count == 1);
+    REQUIRE(command_buffer.draw_first_instance == 6);
     REQUIRE(command_buffer.draw_indexed_count == 0);
 }
 
@@ -352,3 +533,89 @@ TEST_CASE(
     REQUIRE(command_buffer.draw_count == 0);
     REQUIRE(command_buffer.draw_indexed_count == 0);
 }
+
+TEST_CASE(
+    "instance_mesh_draw_items merges identical draws into instanced draws",
+    "[rendering][phase]"
+) {
+    FakeGraphicsDevice device;
+    PipelineCache cache(device);
+    auto pipeline_id =
+        cache.request_render_pipeline(RenderPipelineDescription {});
+    cache.process_queued_pipelines();
+
+    RenderQueue render_queue;
+    MeshUniforms mesh_uniforms {.layout = MeshUniformLayout::StorageBuffer};
+    mesh_uniforms.stride = sizeof(MeshUniform);
+    mesh_uniforms.capacity = 4;
+    mesh_uniforms.instance_count = 4;
+    mesh_uniforms.uniform_buffer = device.create_buffer(
+        BufferDescription {
+            .size = 4 * sizeof(MeshUniform),
+            .usages = BufferUsages::Storage,
+        }
+    );
+
+    auto view_set = make_resource_set();
+    auto material_set = make_resource_set();
+    auto shared_vertices = std::make_shared<FakeBuffer>(
+        BufferDescription {.size = 48, .usages = BufferUsages::Vertex}
+    );
+    auto other_vertices = std::make_shared<FakeBuffer>(
+        BufferDescription {.size = 48, .usages = BufferUsages::Vertex}
+    );
+    auto make_item = [&](std::shared_ptr<const Buffer> vertices, uint32 slot) {
+        return MeshDrawItem {
+            .pipeline = pipeline_id,
+            .view_set = view_set,
+            .material_set = material_set,
+            .mesh_uniform_instance_index = slot,
+            .vertex_buffer = std::move(vertices),
+            .vertex_count = 4,
+        };
+    };
+
+    RenderPhase<MeshDrawItem> phase;
+    phase.items.push_back(make_item(shared_vertices, 2));
+    phase.items.push_back(make_item(other_vertices, 1));
+    phase.items.push_back(make_item(shared_vertices, 0));
+    phase.items.push_back(make_item(shared_vertices, 3));
+    sort_mesh_draw_items(phase);
+
+    SECTION("dynamic uniform layouts keep one draw per item") {
+        mesh_uniforms.layout = MeshUniformLayout::DynamicUniform;
+        instance_mesh_draw_items(phase, device, render_queue, mesh_uniforms);
+        CHECK(phase.items.size() == 4);
+        CHECK(render_queue.pending_buffer_writes() == 0);
+    }
+
+    SECTION("storage layouts draw each run once") {
+        instance_mesh_draw_items(phase, device, render_queue, mesh_uniforms);
+
+        REQUIRE(phase.items.size() == 2);
+        const auto batched =
+            std::ranges::find(phase.items, 3u, &MeshDrawItem::instance_count);
+        REQUIRE(batched != phase.items.end());
+        CHECK(batched->vertex_buffer == shared_vertices);
+        CHECK(batched->mesh_uniform_instance_index == 4);
+        CHECK(batched->mesh_set == mesh_uniforms.resource_set);
+        CHECK(mesh_uniforms.instance_count == 7);
+        // The grown instance buffer re-uploads the identity range.
+        CHECK(render_queue.pending_buffer_writes() == 2);
+        // Scratch keeps its capacity for the next phase.
+        CHECK(mesh_uniforms.instance_slots.capacity() >= 3);
+        CHECK(phase.sorted_items.empty());
+        CHECK(phase.sorted_items.capacity() >= 2);
+
+        const auto single =
+            std::ranges::find(phase.items, 1u, &MeshDrawItem::instance_count);
+        REQUIRE(single != phase.items.end());
+        CHECK(single->mesh_uniform_instance_index == 1);
+
+        RecordingCommandBuffer command_buffer;
+        draw_mesh_item(command_buffer, cache, *batched);
+        CHECK(command_buffer.draw_count == 4);
+        CHECK(command_buffer.draw_instance_count == 3);
+        CHECK(command_buffer.draw_first_instance == 4);
+    }
+}
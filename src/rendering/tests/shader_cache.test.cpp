@@ -12,7 +12,9 @@
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 using namespace fei;
@@ -538,6 +540,71 @@ TEST_CASE(
     REQUIRE(third_compiler.requests.size() == 1);
 }
 
+TEST_CASE(
+    "ShaderVariantCompiler loads variants from a packed artifact archive",
+    "[rendering][shader-cache][shader-compiler]"
+) {
+    auto root = std::filesystem::current_path() / "build" / "test" /
+                "shader-cache-archive";
+    std::filesystem::remove_all(root);
+    auto dependency_path = root / "shaders" / "shared.slang";
+    write_text_file(dependency_path, "dependency content");
+    write_text_file(root / "shaders" / "test.slang", "shader source");
+
+    auto config = RuntimeShaderCompilerConfig {
+        .source_root = root / "shaders",
+        .cache_root = root / "cache",
+    };
+    auto compile = [&](ShaderVariantCompiler& compiler, std::string entry) {
+        return compiler.compile_with_dependencies(
+            "test.slang",
+            "shader source",
+            ShaderStages::Fragment,
+            std::move(entry),
+            {}
+        );
+    };
+
+    RecordingShaderCompiler first_compiler;
+    first_compiler.dependencies = {dependency_path};
+    {
+        ShaderVariantCompiler variant_compiler(first_compiler, config);
+        REQUIRE(compile(variant_compiler, "first_main").has_value());
+        REQUIRE(compile(variant_compiler, "second_main").has_value());
+    }
+
+    auto packed = pack_shader_artifacts(config.cache_root);
+
+    REQUIRE(packed.has_value());
+    CHECK(packed->entries == 2);
+    CHECK(packed->packed_files == 2);
+    CHECK(packed->dropped == 0);
+    for (const auto& item :
+         std::filesystem::directory_iterator(config.cache_root)) {
+        CHECK(item.path().extension() != ".bin");
+    }
+
+    RecordingShaderCompiler second_compiler;
+    second_compiler.dependencies = {dependency_path};
+    {
+        ShaderVariantCompiler variant_compiler(second_compiler, config);
+        auto cached = compile(variant_compiler, "second_main");
+        REQUIRE(cached.has_value());
+        CHECK(cached->description.source == "#version 450\nvoid main() {}\n");
+        REQUIRE(compile(variant_compiler, "third_main").has_value());
+    }
+    CHECK(second_compiler.requests.size() == 1);
+
+    write_text_file(dependency_path, "changed dependency content");
+
+    auto repacked = pack_shader_artifacts(config.cache_root);
+
+    REQUIRE(repacked.has_value());
+    CHECK(repacked->entries == 0);
+    CHECK(repacked->packed_files == 0);
+    CHECK(repacked->dropped == 3);
+}
+
 TEST_CASE(
     "ShaderVariantCompiler skips cache writes when dependencies change during "
     "compilation",
@@ -13,8 +13,10 @@
 #include "graphics/texture_readback.hpp"
 #include "graphics/texture_view.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <span>
 #include <utility>
@@ -77,6 +79,14 @@ struct BufferUpdateCall {
     std::vector<std::byte> bytes;
 };
 
+struct BufferCopyCall {
+    std::shared_ptr<Buffer> src;
+    std::uint32_t src_offset {0};
+    std::shared_ptr<Buffer> dst;
+    std::uint32_t dst_offset {0};
+    std::uint32_t size {0};
+};
+
 class FakeGraphicsDevice : public GraphicsDevice {
   public:
     mutable std::vector<ShaderDescription> shader_descriptions;
@@ -91,6 +101,9 @@ class FakeGraphicsDevice : public GraphicsDevice {
     mutable std::vector<SamplerDescription> sampler_descriptions;
     mutable std::vector<TextureUpdateCall> texture_update_calls;
     mutable std::vector<BufferUpdateCall> buffer_update_calls;
+    mutable std::vector<BufferCopyCall> buffer_copy_calls;
+    bool buffer_copy_supported {false};
+    bool vertex_storage_buffers_supported {false};
     mutable uint32 present_calls {0};
 
     mutable std::vector<std::shared_ptr<FakeBuffer>> buffers;
@@ -98,10 +111,17 @@ class FakeGraphicsDevice : public GraphicsDevice {
     mutable std::vector<std::shared_ptr<Pipeline>> render_pipelines;
     mutable std::vector<std::shared_ptr<Pipeline>> compute_pipelines;
     mutable std::shared_ptr<CommandBuffer> next_command_buffer;
+    // Takes precedence over next_command_buffer when set.
+    std::function<std::shared_ptr<CommandBuffer>()> command_buffer_factory;
     mutable std::vector<std::shared_ptr<CommandBuffer>> submitted_commands;
     bool fail_render_pipeline_creation {false};
     bool fail_compute_pipeline_creation {false};
     std::size_t uniform_buffer_alignment {256};
+    bool parallel_recording {false};
+    // Prepares pipelines at flush(), the way the OpenGL backend links them.
+    bool prepare_pipelines_on_flush {false};
+    mutable std::vector<std::shared_ptr<Pipeline>> pipelines_to_prepare;
+    mutable std::vector<std::shared_ptr<Pipeline>> prepared_pipelines;
 
     [[nodiscard]] std::size_t
     uniform_buffer_offset_alignment() const override {
@@ -137,9 +157,16 @@ class FakeGraphicsDevice : public GraphicsDevice {
     }
 
     std::shared_ptr<CommandBuffer> create_command_buffer() const override {
+        if (command_buffer_factory) {
+            return command_buffer_factory();
+        }
         return next_command_buffer;
     }
 
+    [[nodiscard]] bool supports_parallel_recording() const override {
+        return parallel_recording;
+    }
+
     std::shared_ptr<Pipeline> create_render_pipeline(
         const RenderPipelineDescription& desc
     ) const override {
@@ -217,10 +244,8 @@ class FakeGraphicsDevice : public GraphicsDevice {
             .layer = layer,
         };
 
-        const auto byte_count = static_cast<std::size_t>(width) *
-                                static_cast<std::size_t>(height) *
-                                static_cast<std::size_t>(depth) *
-                                get_pixel_format_size(call.texture->format());
+        const auto byte_count =
+            texture_data_size(call.texture->format(), width, height, depth);
         if (data != nullptr && byte_count > 0) {
             const auto* bytes = static_cast<const std::byte*>(data);
             call.bytes.assign(bytes, bytes + byte_count);
@@ -245,6 +270,32 @@ class FakeGraphicsDevice : public GraphicsDevice {
         buffer_update_calls.push_back(std::move(call));
     }
 
+    void copy_buffer(
+        std::shared_ptr<Buffer> src,
+        std::uint32_t src_offset,
+        std::shared_ptr<Buffer> dst,
+        std::uint32_t dst_offset,
+        std::uint32_t size
+    ) const override {
+        buffer_copy_calls.push_back(
+            BufferCopyCall {
+                .src = std::move(src),
+                .src_offset = src_offset,
+                .dst = std::move(dst),
+                .dst_offset = dst_offset,
+                .size = size,
+            }
+        );
+    }
+
+    bool supports_buffer_copy() const override {
+        return buffer_copy_supported;
+    }
+
+    bool supports_vertex_storage_buffers() const override {
+        return vertex_storage_buffers_supported;
+    }
+
     MappedResource
     map(std::shared_ptr<MappableResource>, MapMode map_mode) const override {
         return MappedResource(nullptr, map_mode, std::span<std::byte> {});
@@ -258,6 +309,29 @@ class FakeGraphicsDevice : public GraphicsDevice {
     }
 
     void present(const Swapchain&) const override { ++present_calls; }
+
+    void flush() const override {
+        prepared_pipelines.insert(
+            prepared_pipelines.end(),
+            pipelines_to_prepare.begin(),
+            pipelines_to_prepare.end()
+        );
+        pipelines_to_prepare.clear();
+    }
+
+    [[nodiscard]] bool
+    prepare_pipeline(const std::shared_ptr<Pipeline>& pipeline) const override {
+        if (!prepare_pipelines_on_flush ||
+            std::ranges::find(prepared_pipelines, pipeline) !=
+                prepared_pipelines.end()) {
+            return true;
+        }
+        if (std::ranges::find(pipelines_to_prepare, pipeline) ==
+            pipelines_to_prepare.end()) {
+            pipelines_to_prepare.push_back(pipeline);
+        }
+        return false;
+    }
 };
 
 } // namespace fei::rendering_test
@@ -2,8 +2,10 @@
 
 #include "math/common.hpp"
 #include "math/matrix.hpp"
+#include "rendering/mesh/mesh_geometry_pool.hpp"
 
 #include <catch2/catch_test_macros.hpp>
+#include <memory>
 
 using namespace fei;
 
@@ -83,3 +85,49 @@ TEST_CASE(
     REQUIRE_FALSE(visible_entities.get(shadow_cascade)->contains(30));
     REQUIRE(visible_entities.get(next_shadow_cascade)->contains(30));
 }
+
+TEST_CASE(
+    "select_mesh_lod coarsens with distance and projection",
+    "[rendering][visibility]"
+) {
+    GpuMesh gpu_mesh(
+        std::make_shared<MeshGeometry>(nullptr, nullptr, 8, 36),
+        RenderPrimitive::Triangles,
+        MeshVertexBufferLayout {
+            .attribute_ids = {},
+            .layout = VertexBufferLayout(VertexStepMode::Vertex, {}),
+        },
+        {
+            {.first_index = 0, .index_count = 24, .error = 0.0f},
+            {.first_index = 24, .index_count = 9, .error = 0.01f},
+            {.first_index = 33, .index_count = 3, .error = 0.1f},
+        }
+    );
+    Aabb unit_bounds {
+        .min = {-0.5f, -0.5f, -0.5f},
+        .max = {0.5f, 0.5f, 0.5f},
+    };
+    RenderView view;
+    view.clip_from_view = perspective(90.0f * DEG2RAD, 1.0f, 0.1f, 1000.0f);
+    view.clip_from_world = view.clip_from_view;
+    const auto lod_at = [&](float distance) {
+        return select_mesh_lod(
+            gpu_mesh,
+            view,
+            unit_bounds,
+            translate(0.0f, 0.0f, -distance),
+            0.001f
+        );
+    };
+
+    REQUIRE(lod_at(0.5f) == 0);
+    REQUIRE(lod_at(2.0f) == 0);
+    REQUIRE(lod_at(10.0f) == 1);
+    REQUIRE(lod_at(500.0f) == 2);
+    REQUIRE(gpu_mesh.first_index(lod_at(10.0f)) == 24);
+    REQUIRE(gpu_mesh.index_count(lod_at(10.0f)) == 9);
+
+    view.clip_from_view = orthographic(-5.0f, 5.0f, 5.0f, -5.0f, 0.1f, 10.0f);
+    view.clip_from_world = view.clip_from_view;
+    REQUIRE(lod_at(2.0f) == lod_at(8.0f));
+}
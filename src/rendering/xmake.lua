@@ -80,7 +80,7 @@ target("fei-rendering")
     add_headerfiles("include/**.hpp")
     add_files("src/*.cpp", "src/mesh/*.cpp")
     add_includedirs("include", {public = true})
-    add_deps("fei-base", "fei-refl", "fei-ecs", "fei-app", "fei-math", "fei-asset", "fei-core", "fei-graphics", "fei-profiling")
+    add_deps("fei-base", "fei-refl", "fei-ecs", "fei-app", "fei-math", "fei-asset", "fei-core", "fei-graphics", "fei-profiling", "fei-task")
     add_packages("tinyobjloader", "mikktspace")
     if spirv_cross_sdk then
         add_includedirs(spirv_cross_sdk.include_dir, {public = true})
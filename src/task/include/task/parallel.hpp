@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace fei {
+
+class TaskPool;
+
+// The pool parallel_for() uses when none is given. Tasks installs its general
+// pool for as long as it lives; with no pool installed, chunks run on the
+// calling thread.
+TaskPool* parallel_task_pool();
+void set_parallel_task_pool(TaskPool* pool);
+
+// Number of chunks parallel_for() splits `count` into; chunk `i` starts at
+// `i * chunk_size`.
+inline std::size_t
+parallel_chunk_count(std::size_t count, std::size_t chunk_size) {
+    chunk_size = std::max<std::size_t>(chunk_size, 1);
+    return (count + chunk_size - 1) / chunk_size;
+}
+
+namespace detail {
+
+void run_parallel_chunks(
+    TaskPool* pool,
+    std::size_t chunk_count,
+    const std::function<void(std::size_t)>& run_chunk
+);
+
+template<typename F>
+void parallel_for(
+    TaskPool* pool,
+    std::size_t count,
+    std::size_t chunk_size,
+    F&& func
+) {
+    chunk_size = std::max<std::size_t>(chunk_size, 1);
+    const auto chunk_count = parallel_chunk_count(count, chunk_size);
+    if (chunk_count <= 1) {
+        if (count > 0) {
+            func(std::size_t {0}, count);
+        }
+        return;
+    }
+    run_parallel_chunks(pool, chunk_count, [&](std::size_t chunk) {
+        const auto begin = chunk * chunk_size;
+        func(begin, std::min(begin + chunk_size, count));
+    });
+}
+
+} // namespace detail
+
+// Calls `func(begin, end)` for consecutive chunks of [0, count), spread over
+// `pool`. The calling thread works through chunks too and returns once every
+// chunk has run, so this is safe to call from pool threads. Ranges of one
+// chunk run inline; the first exception thrown by a chunk is rethrown after
+// all chunks finish.
+template<typename F>
+void parallel_for(
+    TaskPool& pool,
+    std::size_t count,
+    std::size_t chunk_size,
+    F&& func
+) {
+    detail::parallel_for(&pool, count, chunk_size, std::forward<F>(func));
+}
+
+// As above, over parallel_task_pool().
+template<typename F>
+void parallel_for(std::size_t count, std::size_t chunk_size, F&& func) {
+    detail::parallel_for(
+        parallel_task_pool(),
+        count,
+        chunk_size,
+        std::forward<F>(func)
+    );
+}
+
+} // namespace fei
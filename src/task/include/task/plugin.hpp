@@ -16,6 +16,7 @@ struct TaskSystems {
     struct DrainCompletions : SystemSet<DrainCompletions> {};
 };
 
+// The general pool also backs parallel_for() while the Tasks owning it lives.
 class Tasks {
   private:
     std::unique_ptr<TaskPool> m_general;
@@ -24,12 +25,12 @@ class Tasks {
     explicit Tasks(
         std::size_t thread_count = ThreadPool::default_thread_count()
     );
-    ~Tasks() = default;
+    ~Tasks();
 
     Tasks(const Tasks&) = delete;
     Tasks& operator=(const Tasks&) = delete;
     Tasks(Tasks&&) noexcept = default;
-    Tasks& operator=(Tasks&&) noexcept = default;
+    Tasks& operator=(Tasks&& other) noexcept;
 
     TaskPool& general() { return *m_general; }
     const TaskPool& general() const { return *m_general; }
@@ -37,6 +38,9 @@ class Tasks {
     std::size_t drain_completions();
 
     static void drain_completion_system(ResRW<Tasks> tasks);
+
+  private:
+    void uninstall_parallel_pool();
 };
 
 class TaskPlugin : public Plugin {
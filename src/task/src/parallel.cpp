@@ -0,0 +1,82 @@
+#include "task/parallel.hpp"
+
+#include "task/task_pool.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+namespace fei {
+
+namespace {
+
+std::atomic<TaskPool*> installed_pool {nullptr};
+
+struct ParallelChunks {
+    const std::function<void(std::size_t)>* run_chunk {nullptr};
+    std::size_t chunk_count {0};
+    std::atomic<std::size_t> next {0};
+    std::atomic<std::size_t> finished {0};
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+};
+
+// Workers that start after every chunk was claimed return without touching
+// `run_chunk`, which may be gone by then.
+void work_on(ParallelChunks& chunks) {
+    for (auto chunk = chunks.next.fetch_add(1); chunk < chunks.chunk_count;
+         chunk = chunks.next.fetch_add(1)) {
+        try {
+            (*chunks.run_chunk)(chunk);
+        } catch (...) {
+            std::scoped_lock lock(chunks.exception_mutex);
+            if (!chunks.exception) {
+                chunks.exception = std::current_exception();
+            }
+        }
+        if (chunks.finished.fetch_add(1) + 1 == chunks.chunk_count) {
+            chunks.finished.notify_all();
+        }
+    }
+}
+
+} // namespace
+
+TaskPool* parallel_task_pool() {
+    return installed_pool.load(std::memory_order_acquire);
+}
+
+void set_parallel_task_pool(TaskPool* pool) {
+    installed_pool.store(pool, std::memory_order_release);
+}
+
+void detail::run_parallel_chunks(
+    TaskPool* pool,
+    std::size_t chunk_count,
+    const std::function<void(std::size_t)>& run_chunk
+) {
+    auto chunks = std::make_shared<ParallelChunks>();
+    chunks->run_chunk = &run_chunk;
+    chunks->chunk_count = chunk_count;
+
+    // The caller takes part, so chunk_count - 1 helpers are enough.
+    const auto helpers =
+        pool ? std::min(pool->thread_count(), chunk_count - 1) : 0;
+    for (std::size_t i = 0; i < helpers; ++i) {
+        pool->submit([chunks]() {
+            work_on(*chunks);
+        });
+    }
+    work_on(*chunks);
+
+    for (auto finished = chunks->finished.load(); finished < chunk_count;
+         finished = chunks->finished.load()) {
+        chunks->finished.wait(finished);
+    }
+    if (chunks->exception) {
+        std::rethrow_exception(chunks->exception);
+    }
+}
+
+} // namespace fei
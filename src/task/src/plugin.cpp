@@ -3,11 +3,28 @@
 #include "app/app.hpp"
 #include "ecs/system_config.hpp"
 #include "ecs/system_params.hpp"
+#include "task/parallel.hpp"
+
+#include <utility>
 
 namespace fei {
 
 Tasks::Tasks(std::size_t thread_count) :
-    m_general(std::make_unique<TaskPool>(thread_count)) {}
+    m_general(std::make_unique<TaskPool>(thread_count)) {
+    set_parallel_task_pool(m_general.get());
+}
+
+Tasks::~Tasks() {
+    uninstall_parallel_pool();
+}
+
+Tasks& Tasks::operator=(Tasks&& other) noexcept {
+    if (this != &other) {
+        uninstall_parallel_pool();
+        m_general = std::move(other.m_general);
+    }
+    return *this;
+}
 
 std::size_t Tasks::drain_completions() {
     return m_general->drain_completions();
@@ -17,6 +34,12 @@ void Tasks::drain_completion_system(ResRW<Tasks> tasks) {
     tasks->drain_completions();
 }
 
+void Tasks::uninstall_parallel_pool() {
+    if (m_general && parallel_task_pool() == m_general.get()) {
+        set_parallel_task_pool(nullptr);
+    }
+}
+
 void TaskPlugin::setup(App& app) {
     if (!app.has_resource<Tasks>()) {
         app.add_resource(Tasks {});
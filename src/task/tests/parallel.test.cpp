@@ -0,0 +1,114 @@
+#include "task/parallel.hpp"
+
+#include "task/plugin.hpp"
+#include "task/task_pool.hpp"
+
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace fei;
+
+TEST_CASE("parallel_for visits every index once", "[task][parallel]") {
+    TaskPool pool(4);
+    std::vector<int> visits(10'000, 0);
+    std::atomic<std::size_t> chunks {0};
+
+    parallel_for(
+        pool,
+        visits.size(),
+        64,
+        [&](std::size_t begin, std::size_t end) {
+            chunks.fetch_add(1);
+            for (auto i = begin; i < end; ++i) {
+                ++visits[i];
+            }
+        }
+    );
+
+    REQUIRE(chunks.load() == parallel_chunk_count(visits.size(), 64));
+    for (auto count : visits) {
+        REQUIRE(count == 1);
+    }
+}
+
+TEST_CASE(
+    "parallel_for runs small ranges inline and nests",
+    "[task][parallel]"
+) {
+    Tasks tasks(4);
+    std::size_t calls = 0;
+    parallel_for(10, 64, [&](std::size_t begin, std::size_t end) {
+        ++calls;
+        REQUIRE(begin == 0);
+        REQUIRE(end == 10);
+    });
+    REQUIRE(calls == 1);
+    parallel_for(0, 64, [&](std::size_t, std::size_t) {
+        ++calls;
+    });
+    REQUIRE(calls == 1);
+
+    std::atomic<std::size_t> total {0};
+    parallel_for(8, 1, [&](std::size_t, std::size_t) {
+        parallel_for(1'000, 10, [&](std::size_t begin, std::size_t end) {
+            total.fetch_add(end - begin);
+        });
+    });
+    REQUIRE(total.load() == 8'000);
+}
+
+TEST_CASE("parallel_for rethrows chunk exceptions", "[task][parallel]") {
+    std::atomic<std::size_t> finished {0};
+    REQUIRE_THROWS_AS(
+        parallel_for(
+            100,
+            1,
+            [&](std::size_t begin, std::size_t) {
+                if (begin == 42) {
+                    throw std::runtime_error("failed");
+                }
+                finished.fetch_add(1);
+            }
+        ),
+        std::runtime_error
+    );
+    REQUIRE(finished.load() == 99);
+}
+
+TEST_CASE(
+    "parallel_for uses the pool of the live Tasks",
+    "[task][parallel]"
+) {
+    const auto chunk_threads = [] {
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        parallel_for(64, 1, [&](std::size_t, std::size_t) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::scoped_lock lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        });
+        return threads;
+    };
+
+    REQUIRE(parallel_task_pool() == nullptr);
+    const auto inline_threads = chunk_threads();
+    REQUIRE(inline_threads.size() == 1);
+    REQUIRE(inline_threads.contains(std::this_thread::get_id()));
+
+    {
+        Tasks tasks(2);
+        REQUIRE(parallel_task_pool() == &tasks.general());
+        Tasks moved = std::move(tasks);
+        REQUIRE(parallel_task_pool() == &moved.general());
+        REQUIRE(chunk_threads().size() > 1);
+    }
+    REQUIRE(parallel_task_pool() == nullptr);
+}
@@ -0,0 +1,209 @@
+#include "asset/io.hpp"
+#include "asset/loader.hpp"
+#include "core/image.hpp"
+#include "core/image_binary.hpp"
+#include "core/image_compress.hpp"
+#include "core/image_mips.hpp"
+#include "graphics/enums.hpp"
+#include "task/plugin.hpp"
+
+#include <CLI/CLI.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<std::filesystem::path> inputs;
+    std::filesystem::path output_dir;
+    bool mips = true;
+    fei::MipFilter filter = fei::MipFilter::Kaiser;
+    // "auto" picks bc7 for 8-bit images and bc6h for float images.
+    std::string format = "auto";
+    bool srgb = false;
+    bool verbose = false;
+};
+
+void configure_options(CLI::App& app, Options& options) {
+    app.add_option("inputs", options.inputs, "Images to convert")
+        ->required()
+        ->check(CLI::ExistingFile);
+    app.add_option(
+        "-o,--output-dir",
+        options.output_dir,
+        "Directory for the converted images (default: next to each input)"
+    );
+    app.add_flag("!--no-mips", options.mips, "Store the first level only");
+    app.add_option("--filter", options.filter, "Mip filter")
+        ->transform(CLI::CheckedTransformer(
+            std::map<std::string, fei::MipFilter> {
+                {"box", fei::MipFilter::Box},
+                {"kaiser", fei::MipFilter::Kaiser},
+            },
+            CLI::ignore_case
+        ));
+    auto* format = app.add_option(
+        "-f,--format",
+        options.format,
+        "Block compression: auto, bc1, bc3, bc4, bc5, bc6h, bc7 or none"
+    );
+    format->check(CLI::IsMember(
+        {"auto", "bc1", "bc3", "bc4", "bc5", "bc6h", "bc7", "none"},
+        CLI::ignore_case
+    ));
+    app.add_flag(
+        "--srgb",
+        options.srgb,
+        "Treat 8-bit RGBA colour as sRGB when filtering and sampling"
+    );
+    app.add_flag("-v,--verbose", options.verbose, "Enable verbose output");
+}
+
+// The block format to encode `image` into, or nullopt to keep it as is.
+std::optional<fei::PixelFormat>
+target_format(const Options& options, const fei::Image& image) {
+    const bool hdr = image.texture_description().texture_format ==
+                     fei::PixelFormat::Rgba32Float;
+    auto format = options.format;
+    if (format == "none") {
+        return std::nullopt;
+    }
+    if (format == "auto") {
+        format = hdr ? "bc6h" : "bc7";
+    }
+    if (format == "bc1") {
+        return options.srgb ? fei::PixelFormat::Bc1RgbaUnormSrgb :
+                              fei::PixelFormat::Bc1RgbaUnorm;
+    }
+    if (format == "bc3") {
+        return options.srgb ? fei::PixelFormat::Bc3RgbaUnormSrgb :
+                              fei::PixelFormat::Bc3RgbaUnorm;
+    }
+    if (format == "bc4") {
+        return fei::PixelFormat::Bc4RUnorm;
+    }
+    if (format == "bc5") {
+        return fei::PixelFormat::Bc5RgUnorm;
+    }
+    if (format == "bc6h") {
+        return fei::PixelFormat::Bc6hRgbUfloat;
+    }
+    return options.srgb ? fei::PixelFormat::Bc7RgbaUnormSrgb :
+                          fei::PixelFormat::Bc7RgbaUnorm;
+}
+
+std::filesystem::path
+output_path(const Options& options, const std::filesystem::path& input) {
+    auto path = options.output_dir.empty() ?
+                    input :
+                    options.output_dir / input.filename();
+    path.replace_extension(fei::ImageBinaryExtension);
+    return path;
+}
+
+bool write_file(
+    const std::filesystem::path& path,
+    const std::vector<std::byte>& bytes
+) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(
+        reinterpret_cast<const char*>(bytes.data()),
+        static_cast<std::streamsize>(bytes.size())
+    );
+    return static_cast<bool>(stream);
+}
+
+// Loads `input` and bakes the mip chain and block compression.
+bool convert(const Options& options, const std::filesystem::path& input) {
+    auto reader = fei::Reader::map_file(input);
+    if (!reader) {
+        std::cerr << input.string() << ": " << reader.error().message << '\n';
+        return false;
+    }
+    fei::ImageLoader loader;
+    fei::LoadContext context(input);
+    auto loaded = loader.load(*reader, context);
+    if (!loaded) {
+        std::cerr << input.string() << ": " << loaded.error().message << '\n';
+        return false;
+    }
+    std::unique_ptr<fei::Image> image = std::move(*loaded);
+    auto& description = image->texture_description();
+    if (options.srgb &&
+        description.texture_format == fei::PixelFormat::Rgba8Unorm) {
+        description.texture_format = fei::PixelFormat::Rgba8UnormSrgb;
+    }
+    // Image binaries given as input are already baked.
+    const bool baked =
+        fei::is_block_compressed_format(description.texture_format);
+
+    if (options.mips && !baked && image->data_levels() == 1) {
+        auto mips = fei::generate_mips(*image, options.filter);
+        if (!mips) {
+            std::cerr << input.string() << ": " << mips.error() << '\n';
+            return false;
+        }
+        image = std::move(*mips);
+    }
+    if (const auto target = target_format(options, *image);
+        target && !baked) {
+        auto compressed = fei::compress_image(*image, *target);
+        if (!compressed) {
+            std::cerr << input.string() << ": " << compressed.error() << '\n';
+            return false;
+        }
+        image = std::move(*compressed);
+    }
+
+    auto bytes = fei::encode_image_binary(*image);
+    if (!bytes) {
+        std::cerr << input.string() << ": " << bytes.error() << '\n';
+        return false;
+    }
+    const auto output = output_path(options, input);
+    if (!write_file(output, *bytes)) {
+        std::cerr << output.string() << ": failed to write\n";
+        return false;
+    }
+    if (options.verbose) {
+        std::cout << input.string() << " -> " << output.string() << " ("
+                  << image->width() << 'x' << image->height() << ", "
+                  << image->data_levels() << " levels, " << bytes->size()
+                  << " bytes)\n";
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    CLI::App app {"Convert images into the engine's binary image format"};
+    configure_options(app, options);
+    CLI11_PARSE(app, argc, argv);
+    // Its pool spreads the image kernels over every core.
+    fei::Tasks tasks;
+
+    if (!options.output_dir.empty()) {
+        std::filesystem::create_directories(options.output_dir);
+    }
+    std::size_t failures = 0;
+    for (const auto& input : options.inputs) {
+        if (!convert(options, input)) {
+            ++failures;
+        }
+    }
+    if (failures > 0) {
+        std::cerr << failures << " of " << options.inputs.size()
+                  << " images failed to convert.\n";
+        return 1;
+    }
+    std::cout << "Converted " << options.inputs.size() << " images.\n";
+    return 0;
+}
@@ -0,0 +1,6 @@
+target("fei-image-convert")
+    set_kind("binary")
+    set_default(false)
+    add_files("*.cpp")
+    add_packages("cli11")
+    add_deps("fei-core")
@@ -0,0 +1,165 @@
+#include "asset/io.hpp"
+#include "asset/loader.hpp"
+#include "rendering/mesh/mesh.hpp"
+#include "rendering/mesh/mesh_binary.hpp"
+#include "rendering/mesh/mesh_loader.hpp"
+#include "task/plugin.hpp"
+
+#include <CLI/CLI.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<std::filesystem::path> inputs;
+    std::filesystem::path output_dir;
+    bool optimize = true;
+    bool optimize_overdraw = false;
+    std::uint32_t lod_levels = 3;
+    bool verbose = false;
+};
+
+void configure_options(CLI::App& app, Options& options) {
+    app.add_option("inputs", options.inputs, "OBJ meshes to convert")
+        ->required()
+        ->check(CLI::ExistingFile);
+    app.add_option(
+        "-o,--output-dir",
+        options.output_dir,
+        "Directory for the converted meshes (default: next to each input)"
+    );
+    app.add_flag(
+        "!--no-optimize",
+        options.optimize,
+        "Keep the source triangle and vertex order"
+    );
+    app.add_flag(
+        "--overdraw",
+        options.optimize_overdraw,
+        "Also order triangle clusters to reduce overdraw"
+    );
+    app.add_option(
+        "--lods",
+        options.lod_levels,
+        "Coarser levels of detail to generate (0 disables)"
+    );
+    app.add_flag("-v,--verbose", options.verbose, "Enable verbose output");
+}
+
+std::filesystem::path
+output_path(const Options& options, const std::filesystem::path& input) {
+    auto path = options.output_dir.empty() ?
+                    input :
+                    options.output_dir / input.filename();
+    path.replace_extension(fei::MeshBinaryExtension);
+    return path;
+}
+
+bool write_file(
+    const std::filesystem::path& path,
+    const std::vector<std::byte>& bytes
+) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(
+        reinterpret_cast<const char*>(bytes.data()),
+        static_cast<std::streamsize>(bytes.size())
+    );
+    return static_cast<bool>(stream);
+}
+
+// Loads `input` and bakes everything the runtime would otherwise compute.
+bool convert(const Options& options, const std::filesystem::path& input) {
+    auto reader = fei::Reader::map_file(input);
+    if (!reader) {
+        std::cerr << input.string() << ": " << reader.error().message << '\n';
+        return false;
+    }
+    fei::MeshLoader loader;
+    fei::LoadContext context(input);
+    auto mesh = loader.load(*reader, context);
+    if (!mesh) {
+        std::cerr << input.string() << ": " << mesh.error().message << '\n';
+        return false;
+    }
+    if (!(*mesh)->packed()) {
+        if (!(*mesh)->has_attribute(fei::Mesh::ATTRIBUTE_NORMAL.id)) {
+            (*mesh)->compute_smooth_normals();
+        }
+        if ((*mesh)->has_attribute(fei::Mesh::ATTRIBUTE_NORMAL.id) &&
+            (*mesh)->has_attribute(fei::Mesh::ATTRIBUTE_UV_0.id) &&
+            !(*mesh)->has_attribute(fei::Mesh::ATTRIBUTE_TANGENT.id)) {
+            (*mesh)->generate_tangents();
+        }
+        if (options.optimize) {
+            const auto stats = (*mesh)->optimize({
+                .optimize_overdraw = options.optimize_overdraw,
+            });
+            if (options.verbose) {
+                std::cout << input.string() << ": ACMR "
+                          << stats.before.acmr << " -> " << stats.after.acmr
+                          << ", ATVR " << stats.before.atvr << " -> "
+                          << stats.after.atvr << '\n';
+            }
+        }
+        if (options.lod_levels > 0) {
+            (*mesh)->generate_lods({.level_count = options.lod_levels});
+            if (options.verbose) {
+                for (const auto& lod : (*mesh)->lod_ranges()) {
+                    std::cout << input.string() << ": LOD "
+                              << lod.index_count / 3 << " triangles, error "
+                              << lod.error << '\n';
+                }
+            }
+        }
+    }
+
+    auto bytes = fei::encode_mesh_binary(**mesh);
+    if (!bytes) {
+        std::cerr << input.string() << ": " << bytes.error() << '\n';
+        return false;
+    }
+    const auto output = output_path(options, input);
+    if (!write_file(output, *bytes)) {
+        std::cerr << output.string() << ": failed to write\n";
+        return false;
+    }
+    if (options.verbose) {
+        std::cout << input.string() << " -> " << output.string() << " ("
+                  << (*mesh)->vertex_count() << " vertices, "
+                  << bytes->size() << " bytes)\n";
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    CLI::App app {"Convert meshes into the engine's binary mesh format"};
+    configure_options(app, options);
+    CLI11_PARSE(app, argc, argv);
+    // Its pool spreads the mesh kernels over every core.
+    fei::Tasks tasks;
+
+    if (!options.output_dir.empty()) {
+        std::filesystem::create_directories(options.output_dir);
+    }
+    std::size_t failures = 0;
+    for (const auto& input : options.inputs) {
+        if (!convert(options, input)) {
+            ++failures;
+        }
+    }
+    if (failures > 0) {
+        std::cerr << failures << " of " << options.inputs.size()
+                  << " meshes failed to convert.\n";
+        return 1;
+    }
+    std::cout << "Converted " << options.inputs.size() << " meshes.\n";
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include "base/thread_pool.hpp"
+#include "pbr/shader_variants.hpp"
+#include "rendering/shader_compiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <CLI/CLI.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::filesystem::path cache_root =
+#ifdef FEI_SHADER_CACHE_PATH
+        FEI_SHADER_CACHE_PATH;
+#else
+        std::filesystem::current_path() / "build" / "cache" / "shaders";
+#endif
+    std::size_t jobs = fei::ThreadPool::default_thread_count();
+    bool list = false;
+    bool pack = false;
+    bool pack_only = false;
+    bool verbose = false;
+};
+
+struct Failure {
+    const fei::ShaderVariantRequest* variant;
+    fei::ShaderCompileError error;
+};
+
+void configure_options(CLI::App& app, Options& options) {
+    app.add_option(
+        "--cache-root",
+        options.cache_root,
+        "Shader artifact cache directory to fill"
+    );
+    app.add_option("-j,--jobs", options.jobs, "Number of compile threads")
+        ->check(CLI::PositiveNumber);
+    app.add_flag("--list", options.list, "Print the variants and exit");
+    app.add_flag(
+        "--pack",
+        options.pack,
+        "Pack the cache into a single archive after compiling"
+    );
+    app.add_flag(
+        "--pack-only",
+        options.pack_only,
+        "Pack the existing cache without compiling"
+    );
+    app.add_flag("-v,--verbose", options.verbose, "Enable verbose output");
+}
+
+std::string describe(const fei::ShaderVariantRequest& variant) {
+    std::string text = variant.logical_path.generic_string();
+    text += ':';
+    text += variant.entry;
+    for (const auto& def : variant.defs) {
+        text += ' ';
+        text += def.name;
+        std::visit(
+            [&](auto value) {
+                if constexpr (!std::is_same_v<decltype(value), bool>) {
+                    text += '=' + std::to_string(value);
+                } else if (!value) {
+                    text += "=0";
+                }
+            },
+            def.value
+        );
+    }
+    return text;
+}
+
+int pack(const Options& options) {
+    auto stats = fei::pack_shader_artifacts(options.cache_root);
+    if (!stats) {
+        std::cerr << "Error: " << stats.error() << '\n';
+        return 1;
+    }
+    std::cout << "Packed " << stats->entries << " shader variants ("
+              << stats->packed_files << " loose, " << stats->dropped
+              << " stale dropped, " << stats->bytes << " bytes).\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    CLI::App app {"Compile the engine's shader variants into the cache"};
+    configure_options(app, options);
+    CLI11_PARSE(app, argc, argv);
+
+    const auto variants =
+        fei::pbr_shader_variants(fei::PbrShaderVariantSpace::defaults());
+    if (options.list) {
+        for (const auto& variant : variants) {
+            std::cout << describe(variant) << '\n';
+        }
+        return 0;
+    }
+    if (options.pack_only) {
+        return pack(options);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next {0};
+    std::mutex output_mutex;
+    std::vector<Failure> failures;
+
+    // Every worker owns its compiler; the Slang compiler creates a global
+    // session per compile and the variants are distinct, so no two workers
+    // write the same artifact.
+    auto compile_variants = [&] {
+        fei::SlangLibraryShaderCompiler compiler;
+        fei::ShaderVariantCompiler variant_compiler(
+            compiler,
+            fei::RuntimeShaderCompilerConfig {
+                .cache_root = options.cache_root,
+            }
+        );
+        for (auto index = next.fetch_add(1); index < variants.size();
+             index = next.fetch_add(1)) {
+            const auto& variant = variants[index];
+            auto result = variant_compiler.compile_with_dependencies(
+                variant.logical_path,
+                variant.stage,
+                variant.entry,
+                variant.defs
+            );
+            std::scoped_lock lock(output_mutex);
+            if (!result) {
+                failures.push_back(
+                    Failure {
+                        .variant = &variant,
+                        .error = std::move(result).error(),
+                    }
+                );
+            } else if (options.verbose) {
+                std::cout << "Compiled " << describe(variant) << '\n';
+            }
+        }
+    };
+
+    const auto worker_count = std::min(options.jobs, variants.size());
+    {
+        fei::ThreadPool pool(worker_count);
+        std::vector<std::future<void>> workers;
+        workers.reserve(worker_count);
+        for (std::size_t i = 0; i < worker_count; i++) {
+            workers.push_back(pool.submit(compile_variants));
+        }
+        for (auto& worker : workers) {
+            worker.get();
+        }
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start
+    );
+    for (const auto& failure : failures) {
+        std::cerr << "Error: " << describe(*failure.variant) << ": "
+                  << failure.error.message << '\n';
+        if (!failure.error.diagnostics.empty()) {
+            std::cerr << failure.error.diagnostics << '\n';
+        }
+    }
+    std::cout << "Compiled " << variants.size() - failures.size() << " of "
+              << variants.size() << " shader variants into "
+              << options.cache_root.generic_string() << " in "
+              << elapsed.count() << " ms using " << worker_count
+              << " threads.\n";
+    if (!failures.empty()) {
+        return 1;
+    }
+    return options.pack ? pack(options) : 0;
+}
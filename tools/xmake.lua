@@ -1,2 +1,5 @@
+includes("image_convert")
+includes("mesh_convert")
 includes("reflgen")
+includes("shader_precompile")
 includes("tasks")